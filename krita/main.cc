@@ -54,6 +54,7 @@
 #include <opengl/kis_opengl.h>
 #include "input/KisQtWidgetsTweaker.h"
 #include <KisUsageLogger.h>
+#include <KisStartupTrace.h>
 #include <kis_image_config.h>
 
 #if defined Q_OS_WIN
@@ -137,6 +138,8 @@ void resetRotation()
 
 extern "C" int main(int argc, char **argv)
 {
+    // start the clock of the startup trace as early as possible
+    KisStartupTrace::instance();
 
     // The global initialization of the random generator
     qsrand(time(0));
@@ -399,10 +402,14 @@ extern "C" int main(int argc, char **argv)
 
     KisApplicationArguments args(app);
 
+    if (!args.startupTrace().isEmpty()) {
+        KisStartupTrace::instance()->setOutputFile(args.startupTrace());
+    }
+
     if (singleApplication && app.isRunning()) {
         // only pass arguments to main instance if they are not for batch processing
         // any batch processing would be done in this separate instance
-        const bool batchRun = args.exportAs() || args.exportSequence();
+        const bool batchRun = args.exportAs() || args.exportSequence() || args.batchConversion();
 
         if (!batchRun) {
             QByteArray ba = args.serialize();
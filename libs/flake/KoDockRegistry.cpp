@@ -44,6 +44,9 @@ void KoDockRegistry::init()
     KoPluginLoader::instance()->load(QString::fromLatin1("Calligra/Dock"),
                                      QString::fromLatin1("[X-Flake-PluginVersion] == 28"),
                                      config);
+
+    // the application may have postponed loading of its own dockers until the registry is used
+    KoPluginLoader::instance()->loadDeferred(QString::fromLatin1("Krita/Dock"));
 }
 
 KoDockRegistry::~KoDockRegistry()
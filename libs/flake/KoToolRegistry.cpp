@@ -51,6 +51,9 @@ void KoToolRegistry::init()
                                      QString::fromLatin1("[X-Flake-PluginVersion] == 28"),
                                      config);
 
+    // the application may have postponed loading of its own tools until the registry is used
+    KoPluginLoader::instance()->loadDeferred(QString::fromLatin1("Krita/Tool"));
+
     // register generic tools
     add(new KoCreateShapesToolFactory());
     add(new KoPathToolFactory());
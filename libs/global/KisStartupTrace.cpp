@@ -0,0 +1,167 @@
+/*
+ *  Copyright (c) 2020 Krita developers
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+#include "KisStartupTrace.h"
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QHash>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QThread>
+#include <QVector>
+
+#include "kis_debug.h"
+
+Q_GLOBAL_STATIC(KisStartupTrace, s_instance)
+
+namespace {
+struct Event {
+    QString name;
+    QString category;
+    qint64 start;
+    qint64 duration;
+    int threadId;
+};
+}
+
+struct KisStartupTrace::Private
+{
+    QElapsedTimer timer;
+    QString outputFile;
+    bool isRecording = true;
+    QVector<Event> events;
+    QHash<Qt::HANDLE, int> threadIds;
+    mutable QMutex mutex;
+};
+
+KisStartupTrace::Scope::Scope(const QString &name, const QString &category)
+    : m_name(name)
+    , m_category(category)
+    , m_start(KisStartupTrace::instance()->elapsed())
+{
+}
+
+KisStartupTrace::Scope::~Scope()
+{
+    KisStartupTrace *trace = KisStartupTrace::instance();
+    trace->addEvent(m_name, m_category, m_start, trace->elapsed() - m_start);
+}
+
+KisStartupTrace::KisStartupTrace()
+    : d(new Private)
+{
+    d->timer.start();
+    d->outputFile = QString::fromLocal8Bit(qgetenv("KRITA_STARTUP_TRACE"));
+}
+
+KisStartupTrace::~KisStartupTrace()
+{
+}
+
+KisStartupTrace *KisStartupTrace::instance()
+{
+    return s_instance;
+}
+
+void KisStartupTrace::setOutputFile(const QString &filename)
+{
+    QMutexLocker l(&d->mutex);
+    d->outputFile = filename;
+}
+
+QString KisStartupTrace::outputFile() const
+{
+    QMutexLocker l(&d->mutex);
+    return d->outputFile;
+}
+
+bool KisStartupTrace::isRecording() const
+{
+    QMutexLocker l(&d->mutex);
+    return d->isRecording;
+}
+
+qint64 KisStartupTrace::elapsed() const
+{
+    return d->timer.nsecsElapsed() / 1000;
+}
+
+void KisStartupTrace::addEvent(const QString &name, const QString &category, qint64 start, qint64 duration)
+{
+    QMutexLocker l(&d->mutex);
+    if (!d->isRecording) return;
+
+    const Qt::HANDLE thread = QThread::currentThreadId();
+    auto it = d->threadIds.find(thread);
+    if (it == d->threadIds.end()) {
+        it = d->threadIds.insert(thread, d->threadIds.size() + 1);
+    }
+
+    Event event;
+    event.name = name;
+    event.category = category;
+    event.start = start;
+    event.duration = duration;
+    event.threadId = *it;
+    d->events.append(event);
+}
+
+bool KisStartupTrace::finish()
+{
+    QMutexLocker l(&d->mutex);
+    if (!d->isRecording) return true;
+    d->isRecording = false;
+
+    if (d->outputFile.isEmpty()) {
+        d->events.clear();
+        return true;
+    }
+
+    const qint64 pid = QCoreApplication::applicationPid();
+
+    QJsonArray events;
+    Q_FOREACH (const Event &event, d->events) {
+        QJsonObject object;
+        object["name"] = event.name;
+        object["cat"] = event.category;
+        object["ph"] = "X";
+        object["ts"] = event.start;
+        object["dur"] = event.duration;
+        object["pid"] = pid;
+        object["tid"] = event.threadId;
+        events.append(object);
+    }
+    d->events.clear();
+
+    QJsonObject root;
+    root["traceEvents"] = events;
+    root["displayTimeUnit"] = "ms";
+
+    QFile file(d->outputFile);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        warnKrita << "Could not write startup trace to" << d->outputFile;
+        return false;
+    }
+
+    file.write(QJsonDocument(root).toJson(QJsonDocument::Compact));
+    return true;
+}
@@ -0,0 +1,101 @@
+/*
+ *  Copyright (c) 2020 Krita developers
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+#ifndef KISSTARTUPTRACE_H
+#define KISSTARTUPTRACE_H
+
+#include <QString>
+#include <QScopedPointer>
+
+#include "kritaglobal_export.h"
+
+/**
+ * @brief The KisStartupTrace class records the timings of the startup
+ * phases of Krita and writes them as a Chrome trace (JSON Trace Event
+ * Format), which can be opened in chrome://tracing or Perfetto.
+ *
+ * The trace is written when the output file is set, either with the
+ * KRITA_STARTUP_TRACE environment variable or with the --startup-trace
+ * command line option. Recording stops when the startup is finished,
+ * see finish().
+ *
+ * Use Scope to time a block of code:
+ *
+ * \code
+ * {
+ *     KisStartupTrace::Scope scope("loadPlugins", "startup");
+ *     loadPlugins();
+ * }
+ * \endcode
+ */
+class KRITAGLOBAL_EXPORT KisStartupTrace
+{
+public:
+    /**
+     * Records the time from its construction to its destruction
+     * as one event of the trace
+     */
+    class KRITAGLOBAL_EXPORT Scope
+    {
+    public:
+        Scope(const QString &name, const QString &category);
+        ~Scope();
+
+    private:
+        Q_DISABLE_COPY(Scope)
+
+        QString m_name;
+        QString m_category;
+        qint64 m_start;
+    };
+
+public:
+    KisStartupTrace();
+    ~KisStartupTrace();
+
+    static KisStartupTrace *instance();
+
+    void setOutputFile(const QString &filename);
+    QString outputFile() const;
+
+    /// @return true until finish() is called
+    bool isRecording() const;
+
+    /// @return the time in microseconds since the creation of the trace
+    qint64 elapsed() const;
+
+    /**
+     * Adds an event starting at \p start that took \p duration
+     * microseconds. Can be called from any thread.
+     */
+    void addEvent(const QString &name, const QString &category, qint64 start, qint64 duration);
+
+    /**
+     * Stops recording and writes the trace into the output file, if set
+     *
+     * @return false if the trace could not be written
+     */
+    bool finish();
+
+private:
+    Q_DISABLE_COPY(KisStartupTrace)
+
+    struct Private;
+    const QScopedPointer<Private> d;
+};
+
+#endif // KISSTARTUPTRACE_H
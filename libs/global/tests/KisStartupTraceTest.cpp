@@ -0,0 +1,73 @@
+/*
+ *  Copyright (c) 2020 Krita developers
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include "KisStartupTraceTest.h"
+
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTemporaryDir>
+
+#include "KisStartupTrace.h"
+
+void KisStartupTraceTest::testWriteTrace()
+{
+    QTemporaryDir dir;
+    const QString filename = dir.filePath("trace.json");
+
+    KisStartupTrace *trace = KisStartupTrace::instance();
+    trace->setOutputFile(filename);
+    QVERIFY(trace->isRecording());
+
+    {
+        KisStartupTrace::Scope outer("outer", "startup");
+        KisStartupTrace::Scope inner("inner", "plugins");
+        QTest::qSleep(10);
+    }
+
+    QVERIFY(trace->finish());
+    QVERIFY(!trace->isRecording());
+
+    // nothing is recorded after the startup is finished
+    {
+        KisStartupTrace::Scope late("late", "startup");
+    }
+
+    QFile file(filename);
+    QVERIFY(file.open(QIODevice::ReadOnly));
+
+    const QJsonDocument doc = QJsonDocument::fromJson(file.readAll());
+    const QJsonArray events = doc.object().value("traceEvents").toArray();
+    QCOMPARE(events.size(), 2);
+
+    // the inner scope is destroyed first
+    const QJsonObject inner = events[0].toObject();
+    const QJsonObject outer = events[1].toObject();
+
+    QCOMPARE(inner.value("name").toString(), QString("inner"));
+    QCOMPARE(inner.value("cat").toString(), QString("plugins"));
+    QCOMPARE(inner.value("ph").toString(), QString("X"));
+    QCOMPARE(outer.value("name").toString(), QString("outer"));
+
+    QVERIFY(inner.value("dur").toDouble() >= 10000);
+    QVERIFY(outer.value("dur").toDouble() >= inner.value("dur").toDouble());
+    QVERIFY(outer.value("ts").toDouble() <= inner.value("ts").toDouble());
+    QCOMPARE(inner.value("tid").toInt(), outer.value("tid").toInt());
+}
+
+QTEST_GUILESS_MAIN(KisStartupTraceTest)
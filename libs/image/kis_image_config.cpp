@@ -306,6 +306,17 @@ void KisImageConfig::setSwapDir(const QString &swapDir)
     m_config.writeEntry("swaplocation", swapDir);
 }
 
+bool KisImageConfig::lazyLoadLayerData(bool requestDefault) const
+{
+    return !requestDefault ?
+        m_config.readEntry("lazyLoadLayerData", false) : false;
+}
+
+void KisImageConfig::setLazyLoadLayerData(bool value)
+{
+    m_config.writeEntry("lazyLoadLayerData", value);
+}
+
 int KisImageConfig::numberOfOnionSkins() const
 {
     return m_config.readEntry("numberOfOnionSkins", 10);
@@ -78,6 +78,14 @@ public:
     QString swapDir(bool requestDefault = false);
     void setSwapDir(const QString &swapDir);
 
+    /**
+     * @return true if the pixel data of the loaded documents should be
+     * kept compressed in the swap and decompressed only when some tile
+     * is accessed for the first time.
+     */
+    bool lazyLoadLayerData(bool requestDefault = false) const;
+    void setLazyLoadLayerData(bool value);
+
     int numberOfOnionSkins() const;
     void setNumberOfOnionSkins(int value);
 
@@ -34,6 +34,7 @@
 struct KisOnionSkinCache::Private
 {
     KisPaintDeviceSP cachedProjection;
+    KisOnionSkinCompositor::TintedFramesCache tintedFrames;
 
     int cacheTime = 0;
     int cacheConfigSeqNo = 0;
@@ -96,7 +97,7 @@ KisPaintDeviceSP KisOnionSkinCache::projection(KisPaintDeviceSP source)
             }
 
             const QRect extent = compositor->calculateExtent(source);
-            compositor->composite(source, cachedProjection, extent);
+            compositor->composite(source, cachedProjection, extent, &m_d->tintedFrames);
 
             cachedProjection->setDefaultBounds(source->defaultBounds());
 
@@ -124,6 +125,7 @@ void KisOnionSkinCache::reset()
 {
     QWriteLocker writeLocker(&m_d->lock);
     m_d->cachedProjection = 0;
+    m_d->tintedFrames.clear();
 }
 
 KisPaintDeviceSP KisOnionSkinCache::lodCapableDevice() const
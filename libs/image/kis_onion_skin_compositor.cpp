@@ -18,6 +18,8 @@
 
 #include "kis_onion_skin_compositor.h"
 
+#include <QtConcurrent>
+
 #include "kis_paint_device.h"
 #include "kis_painter.h"
 #include "KoColor.h"
@@ -27,6 +29,8 @@
 
 #include "kis_image_config.h"
 #include "kis_raster_keyframe_channel.h"
+#include "kis_paint_device_frames_interface.h"
+#include "krita_utils.h"
 
 Q_GLOBAL_STATIC(KisOnionSkinCompositor, s_instance)
 
@@ -40,6 +44,14 @@ struct KisOnionSkinCompositor::Private
     QVector<int> forwardOpacities;
     int configSeqNo = 0;
     QList<int> colorLabelFilter;
+    QSize patchSize;
+
+    struct Skin {
+        int frameId;
+        QColor tintColor;
+        int opacity;
+        KisPaintDeviceSP tintedDevice;
+    };
 
     int skinOpacity(int offset)
     {
@@ -73,16 +85,63 @@ struct KisOnionSkinCompositor::Private
         return keyframe;
     }
 
-    void tryCompositeFrame(KisRasterKeyframeChannel *keyframes, KisKeyframeSP keyframe, KisPainter &gcFrame, KisPainter &gcDest, KisPaintDeviceSP tintSource, int opacity, const QRect &rect)
+    bool isTintedFrameValid(const TintedFrame &frame, const Skin &skin,
+                            KisPaintDeviceFramesInterface *frames,
+                            const KoColorSpace *colorSpace)
     {
-        if (keyframe.isNull() || opacity == OPACITY_TRANSPARENT_U8) return;
+        return frame.device &&
+            frame.sequenceNumber == frames->frameSequenceNumber(skin.frameId) &&
+            frame.offset == frames->frameOffset(skin.frameId) &&
+            frame.tintColor == skin.tintColor &&
+            frame.tintFactor == tintFactor &&
+            *frame.device->colorSpace() == *colorSpace;
+    }
 
-        keyframes->fetchFrame(keyframe, gcFrame.device());
+    void tintFrame(KisPaintDeviceSP frameDevice, const QColor &tintColor)
+    {
+        if (!tintFactor) return;
+
+        const KoColorSpace *colorSpace = frameDevice->colorSpace();
+        KisPaintDeviceSP tintDevice = setUpTintDevice(tintColor, colorSpace);
+
+        KisPainter gc(frameDevice);
+        gc.setChannelFlags(colorSpace->channelFlags(true, false));
+        gc.setOpacity(tintFactor);
+
+        const QRect frameRect = frameDevice->extent();
+        gc.bitBlt(frameRect.topLeft(), tintDevice, frameRect);
+
+        /**
+         * The pixels outside the extent are not tinted by the painter,
+         * so tint the default pixel of the frame separately
+         */
+        const KoColor defaultPixel = frameDevice->defaultPixel();
+        if (defaultPixel.opacityU8() != OPACITY_TRANSPARENT_U8) {
+            KisPaintDeviceSP pixelDevice = new KisPaintDevice(colorSpace);
+            pixelDevice->setDefaultPixel(defaultPixel);
+
+            const QRect pixelRect(0, 0, 1, 1);
+            KisPainter pixelGc(pixelDevice);
+            pixelGc.setChannelFlags(colorSpace->channelFlags(true, false));
+            pixelGc.setOpacity(tintFactor);
+            pixelGc.bitBlt(pixelRect.topLeft(), tintDevice, pixelRect);
+
+            KoColor tintedPixel(colorSpace);
+            pixelDevice->pixel(0, 0, &tintedPixel);
+            frameDevice->setDefaultPixel(tintedPixel);
+        }
+    }
 
-        gcFrame.bitBlt(rect.topLeft(), tintSource, rect);
+    void compositePatch(const QVector<Skin> &skins, KisPaintDeviceSP targetDevice,
+                        const KoColorSpace *colorSpace, const QRect &rect)
+    {
+        KisPainter gcDest(targetDevice);
+        gcDest.setCompositeOp(colorSpace->compositeOp(COMPOSITE_BEHIND));
 
-        gcDest.setOpacity(opacity);
-        gcDest.bitBlt(rect.topLeft(), gcFrame.device(), rect);
+        Q_FOREACH (const Skin &skin, skins) {
+            gcDest.setOpacity(skin.opacity);
+            gcDest.bitBlt(rect.topLeft(), skin.tintedDevice, rect);
+        }
     }
 
     void refreshConfig()
@@ -91,6 +150,7 @@ struct KisOnionSkinCompositor::Private
 
         numberOfSkins = config.numberOfOnionSkins();
         tintFactor = config.onionSkinTintFactor();
+        patchSize = QSize(config.updatePatchWidth(), config.updatePatchHeight());
         backwardTintColor = config.onionSkinTintColorBackward();
         forwardTintColor = config.onionSkinTintColorForward();
 
@@ -136,21 +196,23 @@ void KisOnionSkinCompositor::setColorLabelFilter(QList<int> colors)
     m_d->colorLabelFilter = colors;
 }
 
-void KisOnionSkinCompositor::composite(const KisPaintDeviceSP sourceDevice, KisPaintDeviceSP targetDevice, const QRect& rect)
+void KisOnionSkinCompositor::composite(const KisPaintDeviceSP sourceDevice, KisPaintDeviceSP targetDevice, const QRect& rect,
+                                       TintedFramesCache *tintedFrames)
 {
     KisRasterKeyframeChannel *keyframes = sourceDevice->keyframeChannel();
+    KisPaintDeviceFramesInterface *frames = sourceDevice->framesInterface();
+    const KoColorSpace *colorSpace = sourceDevice->colorSpace();
 
-    KisPaintDeviceSP frameDevice = new KisPaintDevice(sourceDevice->colorSpace());
-    KisPainter gcFrame(frameDevice);
-    QBitArray channelFlags = targetDevice->colorSpace()->channelFlags(true, false);
-    gcFrame.setChannelFlags(channelFlags);
-    gcFrame.setOpacity(m_d->tintFactor);
-
-    KisPaintDeviceSP backwardTintDevice = m_d->setUpTintDevice(m_d->backwardTintColor, sourceDevice->colorSpace());
-    KisPaintDeviceSP forwardTintDevice = m_d->setUpTintDevice(m_d->forwardTintColor, sourceDevice->colorSpace());
+    TintedFramesCache localCache;
+    if (!tintedFrames) {
+        tintedFrames = &localCache;
+    }
 
-    KisPainter gcDest(targetDevice);
-    gcDest.setCompositeOp(sourceDevice->colorSpace()->compositeOp(COMPOSITE_BEHIND));
+    /**
+     * The skins are collected in the order they are composited. Since the
+     * "behind" composite op is used, the nearest frames go first.
+     */
+    QVector<Private::Skin> skins;
 
     KisKeyframeSP keyframeBck;
     KisKeyframeSP keyframeFwd;
@@ -162,15 +224,68 @@ void KisOnionSkinCompositor::composite(const KisPaintDeviceSP sourceDevice, KisP
         keyframeBck = m_d->getNextFrameToComposite(keyframes, keyframeBck, true);
         keyframeFwd = m_d->getNextFrameToComposite(keyframes, keyframeFwd, false);
 
-        if (!keyframeBck.isNull()) {
-            m_d->tryCompositeFrame(keyframes, keyframeBck, gcFrame, gcDest, backwardTintDevice, m_d->skinOpacity(-offset), rect);
+        if (!keyframeBck.isNull() && m_d->skinOpacity(-offset) != OPACITY_TRANSPARENT_U8) {
+            skins.append({keyframes->frameId(keyframeBck), m_d->backwardTintColor, m_d->skinOpacity(-offset), KisPaintDeviceSP()});
         }
 
-        if (!keyframeFwd.isNull()) {
-            m_d->tryCompositeFrame(keyframes, keyframeFwd, gcFrame, gcDest, forwardTintDevice, m_d->skinOpacity(offset), rect);
+        if (!keyframeFwd.isNull() && m_d->skinOpacity(offset) != OPACITY_TRANSPARENT_U8) {
+            skins.append({keyframes->frameId(keyframeFwd), m_d->forwardTintColor, m_d->skinOpacity(offset), KisPaintDeviceSP()});
+        }
+    }
+
+    TintedFramesCache usedFrames;
+    QVector<int> outdatedSkins;
+
+    for (int i = 0; i < skins.size(); i++) {
+        Private::Skin &skin = skins[i];
+
+        TintedFramesCache::const_iterator it = tintedFrames->constFind(skin.frameId);
+
+        if (it != tintedFrames->constEnd() &&
+            m_d->isTintedFrameValid(*it, skin, frames, colorSpace)) {
+
+            skin.tintedDevice = it->device;
+            usedFrames.insert(skin.frameId, *it);
+        } else {
+            skin.tintedDevice = new KisPaintDevice(colorSpace);
+            frames->fetchFrame(skin.frameId, skin.tintedDevice);
+
+            TintedFrame frame;
+            frame.sequenceNumber = frames->frameSequenceNumber(skin.frameId);
+            frame.offset = frames->frameOffset(skin.frameId);
+            frame.tintColor = skin.tintColor;
+            frame.tintFactor = m_d->tintFactor;
+            frame.device = skin.tintedDevice;
+            usedFrames.insert(skin.frameId, frame);
+
+            outdatedSkins.append(i);
         }
     }
 
+    /**
+     * Tinting is the expensive part, so the outdated frames are tinted
+     * in parallel. Every outdated skin has got its own freshly fetched
+     * device, so the jobs are independent.
+     */
+    QtConcurrent::blockingMap(outdatedSkins,
+        [this, &skins] (int index) {
+            const Private::Skin &skin = skins[index];
+            m_d->tintFrame(skin.tintedDevice, skin.tintColor);
+        });
+
+    /**
+     * Drop the frames that are not used at the current time anymore
+     */
+    tintedFrames->swap(usedFrames);
+
+    if (skins.isEmpty() || rect.isEmpty()) return;
+
+    QVector<QRect> patches = KritaUtils::splitRectIntoPatches(rect, m_d->patchSize);
+
+    QtConcurrent::blockingMap(patches,
+        [this, &skins, targetDevice, colorSpace] (const QRect &patch) {
+            m_d->compositePatch(skins, targetDevice, colorSpace, patch);
+        });
 }
 
 QRect KisOnionSkinCompositor::calculateFullExtent(const KisPaintDeviceSP device)
@@ -19,6 +19,10 @@
 #ifndef KIS_ONION_SKIN_COMPOSITOR_H
 #define KIS_ONION_SKIN_COMPOSITOR_H
 
+#include <QColor>
+#include <QHash>
+#include <QPoint>
+
 #include "kis_types.h"
 #include "kritaimage_export.h"
 
@@ -31,7 +35,32 @@ public:
     ~KisOnionSkinCompositor() override;
     static KisOnionSkinCompositor *instance();
 
-    void composite(const KisPaintDeviceSP sourceDevice, KisPaintDeviceSP targetDevice, const QRect &rect);
+    /**
+     * A tinted copy of a single frame. It stays valid while the content
+     * revision, the offset of the frame and the tint settings are unchanged.
+     */
+    struct TintedFrame {
+        int sequenceNumber = -1;
+        QPoint offset;
+        QColor tintColor;
+        int tintFactor = 0;
+        KisPaintDeviceSP device;
+    };
+
+    /**
+     * Tinted frames of a single paint device, keyed by frame id
+     */
+    typedef QHash<int, TintedFrame> TintedFramesCache;
+
+    /**
+     * Composites the onion skins of \p sourceDevice into \p targetDevice.
+     *
+     * If \p tintedFrames is not null, the tinted frames are taken from it
+     * and only outdated frames are tinted again. After the call the cache
+     * contains exactly the frames used for the current time.
+     */
+    void composite(const KisPaintDeviceSP sourceDevice, KisPaintDeviceSP targetDevice, const QRect &rect,
+                   TintedFramesCache *tintedFrames = 0);
 
     QRect calculateFullExtent(const KisPaintDeviceSP device);
     QRect calculateExtent(const KisPaintDeviceSP device);
@@ -53,6 +53,7 @@
 #include "tiles3/kis_hline_iterator.h"
 #include "tiles3/kis_vline_iterator.h"
 #include "tiles3/kis_random_accessor.h"
+#include "tiles3/kis_tile.h"
 
 #include "kis_default_bounds.h"
 
@@ -151,6 +152,7 @@ public:
     {
 
         m_lodData.reset();
+        m_lodSyncState = LodSyncState();
         m_externalFrameData.reset();
 
         if (!m_frames.isEmpty()) {
@@ -222,6 +224,12 @@ public:
         return data->cache()->invalidate();
     }
 
+    int frameSequenceNumber(int frameId) const
+    {
+        DataSP data = m_frames[frameId];
+        return data->cache()->sequenceNumber();
+    }
+
 private:
     typedef KisPaintDeviceData Data;
     typedef QSharedPointer<Data> DataSP;
@@ -366,11 +374,11 @@ public:
         return m_frames.keys();
     }
 
-    bool readFrame(QIODevice *stream, int frameId)
+    bool readFrame(QIODevice *stream, int frameId, bool lazyDecompression)
     {
         bool retval = false;
         DataSP data = m_frames[frameId];
-        retval = data->dataManager()->read(stream);
+        retval = data->dataManager()->read(stream, lazyDecompression);
         data->cache()->invalidate();
         return retval;
     }
@@ -406,6 +414,7 @@ public:
     void updateLodDataStruct(LodDataStruct *dst, const QRect &srcRect);
     void uploadLodDataStruct(LodDataStruct *dst);
     QRegion regionForLodSyncing() const;
+    QRegion regionForLodSyncing(LodDataStruct *dst) const;
 
     void updateLodDataManager(KisDataManager *srcDataManager,
                               KisDataManager *dstDataManager, const QPoint &srcOffset, const QPoint &dstOffset,
@@ -566,6 +575,31 @@ private:
     DataSP m_data;
     mutable QScopedPointer<Data> m_lodData;
     mutable QScopedPointer<Data> m_externalFrameData;
+
+    /**
+     * The state of the source and the LoD data at the moment of the
+     * last LoD synchronization. The tiles written since the recorded
+     * modification epochs and the tiles that have disappeared since
+     * then form the region that should be regenerated on the next
+     * synchronization. The data objects are identified by their
+     * content ids, which, unlike pointers, are never reused.
+     */
+    struct LodSyncState {
+        bool isValid = false;
+
+        quint64 sourceContentId = 0;
+        QPoint sourceOffset;
+        QRegion sourceTiles;
+        int sourceEpoch = 0;
+
+        quint64 lodContentId = 0;
+        QRegion lodTiles;
+        int lodEpoch = 0;
+    };
+
+    LodSyncState m_lodSyncState;
+
+    bool canSyncLodIncrementally(Data *srcData, int newLod) const;
     mutable QMutex m_dataSwitchLock;
 
     FramesHash m_frames;
@@ -646,6 +680,13 @@ struct KisPaintDevice::Private::StrategyPolicy {
 struct KisPaintDevice::Private::LodDataStructImpl : public KisPaintDevice::LodDataStruct {
     LodDataStructImpl(Data *_lodData) : lodData(_lodData) {}
     QScopedPointer<Data> lodData;
+
+    quint64 sourceContentId = 0;
+    QPoint sourceOffset;
+    QRegion sourceTiles;
+    int sourceEpoch = 0;
+
+    QRegion syncRegion;
 };
 
 QRegion KisPaintDevice::Private::regionForLodSyncing() const
@@ -654,39 +695,109 @@ QRegion KisPaintDevice::Private::regionForLodSyncing() const
     return srcData->dataManager()->region().translated(srcData->x(), srcData->y());
 }
 
-KisPaintDevice::LodDataStruct* KisPaintDevice::Private::createLodDataStruct(int newLod)
+QRegion KisPaintDevice::Private::regionForLodSyncing(LodDataStruct *_dst) const
 {
-    KIS_SAFE_ASSERT_RECOVER_NOOP(newLod > 0);
+    LodDataStructImpl *dst = dynamic_cast<LodDataStructImpl*>(_dst);
+    KIS_SAFE_ASSERT_RECOVER(dst) { return regionForLodSyncing(); }
 
-    Data *srcData = currentNonLodData();
+    return dst->syncRegion;
+}
 
-    Data *lodData = new Data(q, srcData, false);
-    LodDataStruct *lodStruct = new LodDataStructImpl(lodData);
+bool KisPaintDevice::Private::canSyncLodIncrementally(Data *srcData, int newLod) const
+{
+    if (!m_lodData || !m_lodSyncState.isValid) return false;
 
-    int expectedX = KisLodTransform::coordToLodCoord(srcData->x(), newLod);
-    int expectedY = KisLodTransform::coordToLodCoord(srcData->y(), newLod);
+    const int expectedX = KisLodTransform::coordToLodCoord(srcData->x(), newLod);
+    const int expectedY = KisLodTransform::coordToLodCoord(srcData->y(), newLod);
 
     /**
      * We compare color spaces as pure pointers, because they must be
      * exactly the same, since they come from the common source.
      */
-    if (lodData->levelOfDetail() != newLod ||
-        lodData->colorSpace() != srcData->colorSpace() ||
-        lodData->x() != expectedX ||
-        lodData->y() != expectedY) {
+    return m_lodSyncState.sourceContentId == srcData->contentId() &&
+        m_lodSyncState.lodContentId == m_lodData->contentId() &&
+        m_lodSyncState.sourceOffset == QPoint(srcData->x(), srcData->y()) &&
+        m_lodData->levelOfDetail() == newLod &&
+        m_lodData->colorSpace() == srcData->colorSpace() &&
+        m_lodData->x() == expectedX &&
+        m_lodData->y() == expectedY &&
+        !memcmp(m_lodData->dataManager()->defaultPixel(),
+                srcData->dataManager()->defaultPixel(),
+                srcData->dataManager()->pixelSize());
+}
+
+KisPaintDevice::LodDataStruct* KisPaintDevice::Private::createLodDataStruct(int newLod)
+{
+    KIS_SAFE_ASSERT_RECOVER_NOOP(newLod > 0);
+
+    Data *srcData = currentNonLodData();
+    LodDataStructImpl *lodStruct = 0;
+
+    if (canSyncLodIncrementally(srcData, newLod)) {
+        /**
+         * The LoD plane is still valid for everything but the tiles
+         * changed since the last sync. These are the tiles modified
+         * in the source device and the tiles modified in the LoD plane
+         * itself, e.g. by a cancelled Instant Preview stroke.
+         */
+        Data *lodData = new Data(q, m_lodData.data(), true);
+        lodStruct = new LodDataStructImpl(lodData);
+
+        KisDataManagerSP srcDataManager = srcData->dataManager();
+        KisDataManagerSP lodDataManager = m_lodData->dataManager();
+
+        QRegion dirtyRegion =
+            (srcDataManager->modifiedRegion(m_lodSyncState.sourceEpoch) +
+             (m_lodSyncState.sourceTiles - srcDataManager->region()))
+                .translated(srcData->x(), srcData->y());
+
+        const QRegion dirtyLodRegion =
+            (lodDataManager->modifiedRegion(m_lodSyncState.lodEpoch) +
+             (m_lodSyncState.lodTiles - lodDataManager->region()))
+                .translated(m_lodData->x(), m_lodData->y());
+
+        Q_FOREACH (const QRect &rc, dirtyLodRegion.rects()) {
+            dirtyRegion += KisLodTransform::upscaledRect(rc, newLod);
+        }
+
+        lodStruct->syncRegion = dirtyRegion;
+
+    } else {
+        Data *lodData = new Data(q, srcData, false);
+        lodStruct = new LodDataStructImpl(lodData);
+
+        int expectedX = KisLodTransform::coordToLodCoord(srcData->x(), newLod);
+        int expectedY = KisLodTransform::coordToLodCoord(srcData->y(), newLod);
+
+        /**
+         * We compare color spaces as pure pointers, because they must be
+         * exactly the same, since they come from the common source.
+         */
+        if (lodData->levelOfDetail() != newLod ||
+            lodData->colorSpace() != srcData->colorSpace() ||
+            lodData->x() != expectedX ||
+            lodData->y() != expectedY) {
 
 
-        lodData->prepareClone(srcData);
+            lodData->prepareClone(srcData);
 
-        lodData->setLevelOfDetail(newLod);
-        lodData->setX(expectedX);
-        lodData->setY(expectedY);
+            lodData->setLevelOfDetail(newLod);
+            lodData->setX(expectedX);
+            lodData->setY(expectedY);
 
-        // FIXME: different kind of synchronization
+            // FIXME: different kind of synchronization
+        }
+
+        lodStruct->syncRegion = regionForLodSyncing();
     }
 
+    lodStruct->sourceContentId = srcData->contentId();
+    lodStruct->sourceOffset = QPoint(srcData->x(), srcData->y());
+    lodStruct->sourceTiles = srcData->dataManager()->region();
+    lodStruct->sourceEpoch = KisTile::startModificationEpoch();
+
     //QRegion dirtyRegion = syncWholeDevice(srcData);
-    lodData->cache()->invalidate();
+    lodStruct->lodData->cache()->invalidate();
 
     return lodStruct;
 }
@@ -827,6 +938,15 @@ void KisPaintDevice::Private::uploadLodDataStruct(LodDataStruct *_dst)
 
     m_lodData->prepareClone(dst->lodData.data());
     m_lodData->dataManager()->bitBltRough(dst->lodData->dataManager(), dst->lodData->dataManager()->extent());
+
+    m_lodSyncState.isValid = true;
+    m_lodSyncState.sourceContentId = dst->sourceContentId;
+    m_lodSyncState.sourceOffset = dst->sourceOffset;
+    m_lodSyncState.sourceTiles = dst->sourceTiles;
+    m_lodSyncState.sourceEpoch = dst->sourceEpoch;
+    m_lodSyncState.lodContentId = m_lodData->contentId();
+    m_lodSyncState.lodTiles = m_lodData->dataManager()->region();
+    m_lodSyncState.lodEpoch = KisTile::startModificationEpoch();
 }
 
 void KisPaintDevice::Private::transferFromData(Data *data, KisPaintDeviceSP targetDevice)
@@ -1493,11 +1613,11 @@ bool KisPaintDevice::write(KisPaintDeviceWriter &store)
     return m_d->dataManager()->write(store);
 }
 
-bool KisPaintDevice::read(QIODevice *stream)
+bool KisPaintDevice::read(QIODevice *stream, bool lazyDecompression)
 {
     bool retval;
 
-    retval = m_d->dataManager()->read(stream);
+    retval = m_d->dataManager()->read(stream, lazyDecompression);
     m_d->cache()->invalidate();
 
     return retval;
@@ -2051,6 +2171,11 @@ QRegion KisPaintDevice::regionForLodSyncing() const
     return m_d->regionForLodSyncing();
 }
 
+QRegion KisPaintDevice::regionForLodSyncing(LodDataStruct *dst) const
+{
+    return m_d->regionForLodSyncing(dst);
+}
+
 KisPaintDevice::LodDataStruct* KisPaintDevice::createLodDataStruct(int lod)
 {
     return m_d->createLodDataStruct(lod);
@@ -2148,12 +2273,12 @@ bool KisPaintDeviceFramesInterface::writeFrame(KisPaintDeviceWriter &store, int
     return q->m_d->writeFrame(store, frameId);
 }
 
-bool KisPaintDeviceFramesInterface::readFrame(QIODevice *stream, int frameId)
+bool KisPaintDeviceFramesInterface::readFrame(QIODevice *stream, int frameId, bool lazyDecompression)
 {
     KIS_ASSERT_RECOVER(frameId >= 0) {
         return false;
     }
-    return q->m_d->readFrame(stream, frameId);
+    return q->m_d->readFrame(stream, frameId, lazyDecompression);
 }
 
 int KisPaintDeviceFramesInterface::currentFrameId() const
@@ -2182,6 +2307,12 @@ void KisPaintDeviceFramesInterface::setFrameOffset(int frameId, const QPoint &of
     return q->m_d->setFrameOffset(frameId, offset);
 }
 
+int KisPaintDeviceFramesInterface::frameSequenceNumber(int frameId) const
+{
+    KIS_ASSERT_RECOVER_RETURN_VALUE(frameId >= 0, -1);
+    return q->m_d->frameSequenceNumber(frameId);
+}
+
 KisPaintDeviceFramesInterface::TestingDataObjects
 KisPaintDeviceFramesInterface::testingGetDataObjects() const
 {
@@ -131,8 +131,12 @@ public:
 
     /**
      * Fill this paint device with the pixels from the specified file store.
+     *
+     * If \p lazyDecompression is true, the pixel data is kept compressed
+     * in the swap and is decompressed tile-by-tile only when somebody
+     * accesses it for the first time.
      */
-    bool read(QIODevice *stream);
+    bool read(QIODevice *stream, bool lazyDecompression = false);
 
 public:
 
@@ -853,6 +857,15 @@ public:
     };
 
     QRegion regionForLodSyncing() const;
+
+    /**
+     * Returns the region of the device that must be regenerated to
+     * bring \p dst up to date. When the LoD plane has been synchronized
+     * before, only the tiles changed since the last synchronization are
+     * returned, otherwise the result is the same as regionForLodSyncing().
+     */
+    QRegion regionForLodSyncing(LodDataStruct *dst) const;
+
     LodDataStruct* createLodDataStruct(int lod);
     void updateLodDataStruct(LodDataStruct *dst, const QRect &srcRect);
     void uploadLodDataStruct(LodDataStruct *dst);
@@ -19,6 +19,8 @@
 #ifndef __KIS_PAINT_DEVICE_DATA_H
 #define __KIS_PAINT_DEVICE_DATA_H
 
+#include <atomic>
+
 #include "KoAlwaysInline.h"
 #include "kundo2command.h"
 
@@ -57,7 +59,8 @@ public:
           m_x(0), m_y(0),
           m_colorSpace(0),
           m_levelOfDetail(0),
-          m_cacheInvalidator(this)
+          m_cacheInvalidator(this),
+          m_contentId(nextContentId())
         {
         }
 
@@ -70,7 +73,8 @@ public:
           m_y(rhs->m_y),
           m_colorSpace(rhs->m_colorSpace),
           m_levelOfDetail(rhs->m_levelOfDetail),
-          m_cacheInvalidator(this)
+          m_cacheInvalidator(this),
+          m_contentId(nextContentId())
         {
             m_cache.setupCache();
         }
@@ -78,6 +82,7 @@ public:
     void init(const KoColorSpace *cs, KisDataManagerSP dataManager) {
         m_colorSpace = cs;
         m_dataManager = dataManager;
+        m_contentId = nextContentId();
         m_cache.setupCache();
     }
 
@@ -99,6 +104,7 @@ public:
 
         void forcedRedo() {
             m_data->m_dataManager = m_newDm;
+            m_data->m_contentId = nextContentId();
             m_data->m_colorSpace = m_newCs;
             m_data->m_cache.setupCache();
         }
@@ -116,6 +122,7 @@ public:
 
         void undo() override {
             m_data->m_dataManager = m_oldDm;
+            m_data->m_contentId = nextContentId();
             m_data->m_colorSpace = m_oldCs;
             m_data->m_cache.setupCache();
 
@@ -199,12 +206,14 @@ public:
 
         if (copyContent) {
             m_dataManager = new KisDataManager(*srcData->dataManager());
+            m_contentId = nextContentId();
         } else if (m_dataManager->pixelSize() !=
                    srcData->dataManager()->pixelSize()) {
             // NOTE: we don't check default pixel value! it is the task of
             //       the higher level!
 
             m_dataManager = new KisDataManager(srcData->dataManager()->pixelSize(), srcData->dataManager()->defaultPixel());
+            m_contentId = nextContentId();
             m_cache.setupCache();
         } else {
             m_dataManager->clear();
@@ -262,6 +271,20 @@ public:
         return &m_cacheInvalidator;
     }
 
+    /**
+     * A number unique among all the data objects, which changes every
+     * time the data manager is replaced. Unlike the pointer to the data
+     * it cannot be reused by another object.
+     */
+    ALWAYS_INLINE quint64 contentId() const {
+        return m_contentId;
+    }
+
+private:
+    static quint64 nextContentId() {
+        static std::atomic<quint64> lastContentId(0);
+        return ++lastContentId;
+    }
 
 private:
     struct CacheInvalidator : public KisIteratorCompleteListener {
@@ -284,6 +307,7 @@ private:
     const KoColorSpace* m_colorSpace;
     qint32 m_levelOfDetail;
     CacheInvalidator m_cacheInvalidator;
+    quint64 m_contentId;
 };
 
 #endif /* __KIS_PAINT_DEVICE_DATA_H */
@@ -104,8 +104,10 @@ public:
      *
      * NOTE: the frame must be created manually with createFrame()
      *       beforehand!
+     *
+     * \see KisPaintDevice::read()
      */
-    bool readFrame(QIODevice *stream, int frameId);
+    bool readFrame(QIODevice *stream, int frameId, bool lazyDecompression = false);
 
 
     /**
@@ -132,6 +134,13 @@ public:
      */
     void setFrameOffset(int frameId, const QPoint &offset);
 
+    /**
+     * Returns the sequence number of the cache of \p frameId. It changes
+     * every time the content of the frame is modified, so it can be used
+     * as a revision of the frame content.
+     */
+    int frameSequenceNumber(int frameId) const;
+
     struct TestingDataObjects {
         typedef KisPaintDeviceData Data;
         typedef QHash<int, Data*> FramesHash;
@@ -44,6 +44,13 @@ struct KisSyncLodCacheStrokeStrategy::Private
         KisPaintDeviceSP device;
     };
 
+    class ScheduleProcessData : public KisStrokeJobData {
+    public:
+        ScheduleProcessData()
+            : KisStrokeJobData(SEQUENTIAL)
+            {}
+    };
+
     class ProcessData : public KisStrokeJobData {
     public:
         ProcessData(KisPaintDeviceSP _device, const QRect &_rect)
@@ -93,6 +100,7 @@ KisSyncLodCacheStrokeStrategy::~KisSyncLodCacheStrokeStrategy()
 void KisSyncLodCacheStrokeStrategy::doStrokeCallback(KisStrokeJobData *data)
 {
     Private::InitData *initData = dynamic_cast<Private::InitData*>(data);
+    Private::ScheduleProcessData *scheduleData = dynamic_cast<Private::ScheduleProcessData*>(data);
     Private::ProcessData *processData = dynamic_cast<Private::ProcessData*>(data);
     Private::AdditionalProcessNode *additionalProcessNode = dynamic_cast<Private::AdditionalProcessNode*>(data);
 
@@ -100,6 +108,32 @@ void KisSyncLodCacheStrokeStrategy::doStrokeCallback(KisStrokeJobData *data)
         KisPaintDeviceSP dev = initData->device;
         const int lod = dev->defaultBounds()->currentLevelOfDetail();
         m_d->dataObjects.insert(dev, dev->createLodDataStruct(lod));
+    } else if (scheduleData) {
+        using KritaUtils::splitRegionIntoPatches;
+        using KritaUtils::optimalPatchSize;
+
+        /**
+         * The regions are calculated only now, when all the preceding
+         * strokes have already modified the devices. In the common case
+         * the LoD planes are synchronized incrementally and only a few
+         * tiles (if any) need to be regenerated.
+         */
+        QVector<KisStrokeJobData*> jobs;
+
+        auto it = m_d->dataObjects.begin();
+        auto end = m_d->dataObjects.end();
+
+        for (; it != end; ++it) {
+            KisPaintDeviceSP dev = it.key();
+            const QRegion region = dev->regionForLodSyncing(it.value());
+            const QVector<QRect> rects = splitRegionIntoPatches(region, optimalPatchSize());
+
+            Q_FOREACH (const QRect &rc, rects) {
+                jobs << new Private::ProcessData(dev, rc);
+            }
+        }
+
+        addMutatedJobs(jobs);
     } else if (processData) {
         KisPaintDeviceSP dev = processData->device;
         KIS_ASSERT(m_d->dataObjects.contains(dev));
@@ -134,8 +168,6 @@ void KisSyncLodCacheStrokeStrategy::cancelStrokeCallback()
 QList<KisStrokeJobData*> KisSyncLodCacheStrokeStrategy::createJobsData(KisImageWSP _image)
 {
     using KisLayerUtils::recursiveApplyNodes;
-    using KritaUtils::splitRegionIntoPatches;
-    using KritaUtils::optimalPatchSize;
 
     KisImageSP image = _image;
 
@@ -153,14 +185,7 @@ QList<KisStrokeJobData*> KisSyncLodCacheStrokeStrategy::createJobsData(KisImageW
         jobsData << new Private::InitData(device);
     }
 
-    Q_FOREACH (KisPaintDeviceSP device, deviceList) {
-        QRegion region = device->regionForLodSyncing();
-        QVector<QRect> rects = splitRegionIntoPatches(region, optimalPatchSize());
-
-        Q_FOREACH (const QRect &rc, rects) {
-            jobsData << new Private::ProcessData(device, rc);
-        }
-    }
+    jobsData << new Private::ScheduleProcessData();
 
     recursiveApplyNodes(image->root(),
                         [&jobsData](KisNodeSP node) {
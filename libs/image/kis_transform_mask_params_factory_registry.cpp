@@ -20,6 +20,8 @@
 
 #include <QGlobalStatic>
 
+#include <KoPluginLoader.h>
+
 #include "kis_transform_mask_params_interface.h"
 #include "kis_transform_mask.h"
 
@@ -73,5 +75,8 @@ void KisTransformMaskParamsFactoryRegistry::autoAddKeyframe(KisTransformMaskSP m
 KisTransformMaskParamsFactoryRegistry*
 KisTransformMaskParamsFactoryRegistry::instance()
 {
+    // the factories are registered by the transform tool plugin, which
+    // is not loaded in batch mode until something needs it
+    KoPluginLoader::instance()->loadDeferred(QString::fromLatin1("Krita/Tool"));
     return s_instance;
 }
@@ -158,4 +158,87 @@ void KisOnionSkinCompositorTest::testSettings()
     QVERIFY(chk.checkDevice(compositeDevice, p.image, "02_single_skin_tinted"));
 }
 
+void KisOnionSkinCompositorTest::testTintedFramesCache()
+{
+    KisImageConfig config(false);
+    config.setOnionSkinTintFactor(64);
+    config.setOnionSkinTintColorBackward(Qt::blue);
+    config.setOnionSkinTintColorForward(Qt::red);
+    config.setNumberOfOnionSkins(1);
+    config.setOnionSkinOpacity(-1, 128);
+    config.setOnionSkinOpacity(1, 128);
+
+    KisOnionSkinCompositor *compositor = KisOnionSkinCompositor::instance();
+    compositor->configChanged();
+
+    TestUtil::MaskParent p;
+
+    KisImageAnimationInterface *i = p.image->animationInterface();
+    KisPaintDeviceSP paintDevice = p.layer->paintDevice();
+    paintDevice->createKeyframeChannel(KoID());
+    KisKeyframeChannel *keyframes = paintDevice->keyframeChannel();
+
+    keyframes->addKeyframe(0);
+    keyframes->addKeyframe(10);
+    keyframes->addKeyframe(20);
+
+    paintDevice->fill(QRect(0,0,256,512), KoColor(Qt::red, paintDevice->colorSpace()));
+
+    i->switchCurrentTimeAsync(20);
+    p.image->waitForDone();
+
+    paintDevice->fill(QRect(0,256,512,256), KoColor(Qt::blue, paintDevice->colorSpace()));
+
+    i->switchCurrentTimeAsync(10);
+    p.image->waitForDone();
+
+    const QRect rc(0,0,512,512);
+    KisOnionSkinCompositor::TintedFramesCache cache;
+
+    KisPaintDeviceSP referenceDevice = new KisPaintDevice(p.image->colorSpace());
+    compositor->composite(paintDevice, referenceDevice, rc);
+
+    KisPaintDeviceSP cachedDevice = new KisPaintDevice(p.image->colorSpace());
+    compositor->composite(paintDevice, cachedDevice, rc, &cache);
+
+    QCOMPARE(cache.size(), 2);
+    QImage referenceImage = referenceDevice->convertToQImage(0, rc);
+    QCOMPARE(cachedDevice->convertToQImage(0, rc), referenceImage);
+
+    // the frames should not be tinted again when nothing has changed
+
+    const KisPaintDeviceSP tintedFrame = cache.begin()->device;
+    const int tintedFrameId = cache.begin().key();
+
+    cachedDevice->clear();
+    compositor->composite(paintDevice, cachedDevice, rc, &cache);
+
+    QCOMPARE(cache.size(), 2);
+    QVERIFY(cache[tintedFrameId].device == tintedFrame);
+    QCOMPARE(cachedDevice->convertToQImage(0, rc), referenceImage);
+
+    // changing the tint should invalidate the cached frames
+
+    config.setOnionSkinTintColorBackward(Qt::green);
+    compositor->configChanged();
+
+    referenceDevice->clear();
+    compositor->composite(paintDevice, referenceDevice, rc);
+
+    cachedDevice->clear();
+    compositor->composite(paintDevice, cachedDevice, rc, &cache);
+
+    QCOMPARE(cachedDevice->convertToQImage(0, rc), referenceDevice->convertToQImage(0, rc));
+
+    // frames that are not used anymore should be dropped from the cache
+
+    i->switchCurrentTimeAsync(20);
+    p.image->waitForDone();
+
+    cachedDevice->clear();
+    compositor->composite(paintDevice, cachedDevice, rc, &cache);
+
+    QCOMPARE(cache.size(), 1);
+}
+
 QTEST_MAIN(KisOnionSkinCompositorTest)
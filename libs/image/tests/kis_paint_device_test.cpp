@@ -1532,6 +1532,80 @@ void KisPaintDeviceTest::testLodDevice()
                                   "lod", "lod1-offset-6-14"));
 }
 
+void KisPaintDeviceTest::testIncrementalLodSync()
+{
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb8();
+    KisPaintDeviceSP dev = new KisPaintDevice(cs);
+
+    TestingLodDefaultBounds *bounds = new TestingLodDefaultBounds();
+    dev->setDefaultBounds(bounds);
+
+    fillGradientDevice(dev, QRect(0,0,200,200));
+
+    bounds->testingSetLevelOfDetail(1);
+    syncLodCache(dev, 1);
+
+    // nothing has changed since the last sync
+    QScopedPointer<KisPaintDevice::LodDataStruct> s(dev->createLodDataStruct(1));
+    QVERIFY(dev->regionForLodSyncing(s.data()).isEmpty());
+
+    bounds->testingSetLevelOfDetail(0);
+    dev->fill(QRect(70,70,10,10), KoColor(Qt::blue, cs));
+
+    // only the modified tile should be regenerated
+    bounds->testingSetLevelOfDetail(1);
+    s.reset(dev->createLodDataStruct(1));
+    const QRegion region = dev->regionForLodSyncing(s.data());
+    QCOMPARE(region, QRegion(QRect(64,64,64,64)));
+
+    Q_FOREACH (const QRect &rc, KritaUtils::splitRegionIntoPatches(region, KritaUtils::optimalPatchSize())) {
+        dev->updateLodDataStruct(s.data(), rc);
+    }
+    dev->uploadLodDataStruct(s.data());
+
+    // the result should be the same as the one of the full sync
+    TestingLodDefaultBounds *refBounds = new TestingLodDefaultBounds();
+    KisPaintDeviceSP ref = new KisPaintDevice(cs);
+    ref->setDefaultBounds(refBounds);
+
+    fillGradientDevice(ref, QRect(0,0,200,200));
+    ref->fill(QRect(70,70,10,10), KoColor(Qt::blue, cs));
+
+    refBounds->testingSetLevelOfDetail(1);
+    syncLodCache(ref, 1);
+
+    QCOMPARE(dev->exactBounds(), ref->exactBounds());
+    QCOMPARE(dev->convertToQImage(0,0,0,100,100), ref->convertToQImage(0,0,0,100,100));
+
+    // the removed tiles should be regenerated as well
+    bounds->testingSetLevelOfDetail(0);
+    dev->clear(QRect(128,128,64,64));
+
+    bounds->testingSetLevelOfDetail(1);
+    s.reset(dev->createLodDataStruct(1));
+    const QRegion removedRegion = dev->regionForLodSyncing(s.data());
+    QCOMPARE(removedRegion, QRegion(QRect(128,128,64,64)));
+
+    Q_FOREACH (const QRect &rc, KritaUtils::splitRegionIntoPatches(removedRegion, KritaUtils::optimalPatchSize())) {
+        dev->updateLodDataStruct(s.data(), rc);
+    }
+    dev->uploadLodDataStruct(s.data());
+
+    TestingLodDefaultBounds *clearedRefBounds = new TestingLodDefaultBounds();
+    KisPaintDeviceSP clearedRef = new KisPaintDevice(cs);
+    clearedRef->setDefaultBounds(clearedRefBounds);
+
+    fillGradientDevice(clearedRef, QRect(0,0,200,200));
+    clearedRef->fill(QRect(70,70,10,10), KoColor(Qt::blue, cs));
+    clearedRef->clear(QRect(128,128,64,64));
+
+    clearedRefBounds->testingSetLevelOfDetail(1);
+    syncLodCache(clearedRef, 1);
+
+    QCOMPARE(dev->exactBounds(), clearedRef->exactBounds());
+    QCOMPARE(dev->convertToQImage(0,0,0,100,100), clearedRef->convertToQImage(0,0,0,100,100));
+}
+
 void KisPaintDeviceTest::benchmarkLod1Generation()
 {
     const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb8();
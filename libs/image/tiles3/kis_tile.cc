@@ -24,6 +24,14 @@
 #include "kis_memento_manager.h"
 #include "kis_debug.h"
 
+namespace {
+QAtomicInt s_currentModificationEpoch;
+}
+
+int KisTile::startModificationEpoch()
+{
+    return s_currentModificationEpoch.fetchAndAddOrdered(1) + 1;
+}
 
 void KisTile::init(qint32 col, qint32 row,
                    KisTileData *defaultTileData, KisMementoManager* mm)
@@ -31,6 +39,7 @@ void KisTile::init(qint32 col, qint32 row,
     m_col = col;
     m_row = row;
     m_lockCounter = 0;
+    m_modificationEpoch.store(s_currentModificationEpoch.load());
 
     m_extent = QRect(m_col * KisTileData::WIDTH, m_row * KisTileData::HEIGHT,
                      KisTileData::WIDTH, KisTileData::HEIGHT);
@@ -237,6 +246,8 @@ void KisTile::lockForWrite()
 
     blockSwapping();
 
+    m_modificationEpoch.store(s_currentModificationEpoch.load());
+
     /* We are doing COW here */
     if (lazyCopying()) {
         m_COWMutex.lock();
@@ -22,6 +22,7 @@
 #include <QReadWriteLock>
 
 #include <QMutex>
+#include <QAtomicInt>
 #include <QAtomicPointer>
 
 #include <QRect>
@@ -131,6 +132,25 @@ public:
         return m_tileData;
     }
 
+    /**
+     * The modification epoch the tile has been created or locked for
+     * writing in for the last time
+     */
+    inline int modificationEpoch() const {
+        return m_modificationEpoch.load();
+    }
+
+    /**
+     * Starts a new modification epoch and returns its number. All the
+     * tiles created or locked for writing after the call will have
+     * modificationEpoch() equal or greater than the returned value.
+     *
+     * The tiles being written at the moment of the call might get
+     * either of the epochs, so the caller should ensure that nobody
+     * writes into the tiles it is interested in.
+     */
+    static int startModificationEpoch();
+
 private:
     void init(qint32 col, qint32 row,
               KisTileData *defaultTileData, KisMementoManager* mm);
@@ -160,6 +180,8 @@ private:
 
     QAtomicPointer<KisMementoManager> m_mementoManager;
 
+    QAtomicInt m_modificationEpoch;
+
     /**
      * This is a special mutex for guarding copy-on-write
      * operations. We do not use lockless way here as it'll
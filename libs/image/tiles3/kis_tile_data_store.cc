@@ -286,6 +286,24 @@ bool KisTileDataStore::trySwapTileData(KisTileData *td)
     return result;
 }
 
+bool KisTileDataStore::tryAdoptCompressedTileData(KisTileData *td, const quint8 *buffer, qint32 bufferSize)
+{
+    QReadLocker lock(&m_iteratorLock);
+
+    bool result = false;
+    if (!td->m_swapLock.tryLockForWrite()) return result;
+
+    if (td->data()) {
+        if (m_swappedStore.tryAdoptCompressedTileData(td, buffer, bufferSize)) {
+            unregisterTileDataImp(td);
+            result = true;
+        }
+    }
+    td->m_swapLock.unlock();
+
+    return result;
+}
+
 KisTileDataStoreIterator* KisTileDataStore::beginIteration()
 {
     m_iteratorLock.lockForWrite();
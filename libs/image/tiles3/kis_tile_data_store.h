@@ -118,6 +118,17 @@ public:
      */
     bool trySwapTileData(KisTileData *td);
 
+    /**
+     * Try to move the tile data directly into the swap using
+     * the data that has already been compressed by KisTileCompressor2.
+     * It may fail if the tile is being accessed at the same moment of
+     * time or the swap is too full, then the data should be
+     * decompressed by the caller as usual.
+     *
+     * \see KisSwappedDataStore::tryAdoptCompressedTileData()
+     */
+    bool tryAdoptCompressedTileData(KisTileData *td, const quint8 *buffer, qint32 bufferSize);
+
 
     /**
      * WARN: The following three method are only for usage
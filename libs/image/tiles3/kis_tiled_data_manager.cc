@@ -138,7 +138,7 @@ bool KisTiledDataManager::write(KisPaintDeviceWriter &store)
 
     return retval;
 }
-bool KisTiledDataManager::read(QIODevice *stream)
+bool KisTiledDataManager::read(QIODevice *stream, bool lazyDecompression)
 {
     clear();
 
@@ -174,6 +174,7 @@ bool KisTiledDataManager::read(QIODevice *stream)
 
     KisAbstractTileCompressorSP compressor =
         KisTileCompressorFactory::create(tilesVersion);
+    compressor->setLazyDecompression(lazyDecompression);
 
     bool readSuccess = true;
     for (quint32 i = 0; i < numTiles; i++) {
@@ -681,6 +682,54 @@ QRegion KisTiledDataManager::region() const
     return region;
 }
 
+QRegion KisTiledDataManager::nonSharedRegion(const KisTiledDataManager *other) const
+{
+    QRegion region;
+    KisTileSP tile;
+
+    {
+        KisTileHashTableConstIterator iter(m_hashTable);
+
+        while ((tile = iter.tile())) {
+            KisTileSP otherTile = other->m_hashTable->getExistingTile(tile->col(), tile->row());
+
+            if (!otherTile || otherTile->tileData() != tile->tileData()) {
+                region += tile->extent();
+            }
+            iter.next();
+        }
+    }
+
+    {
+        KisTileHashTableConstIterator iter(other->m_hashTable);
+
+        while ((tile = iter.tile())) {
+            if (!m_hashTable->tileExists(tile->col(), tile->row())) {
+                region += tile->extent();
+            }
+            iter.next();
+        }
+    }
+
+    return region;
+}
+
+QRegion KisTiledDataManager::modifiedRegion(int epoch) const
+{
+    QRegion region;
+
+    KisTileHashTableConstIterator iter(m_hashTable);
+    KisTileSP tile;
+
+    while ((tile = iter.tile())) {
+        if (tile->modificationEpoch() >= epoch) {
+            region += tile->extent();
+        }
+        iter.next();
+    }
+    return region;
+}
+
 void KisTiledDataManager::setPixel(qint32 x, qint32 y, const quint8 * data)
 {
     KisTileDataWrapper tw(this, x, y, KisTileDataWrapper::WRITE);
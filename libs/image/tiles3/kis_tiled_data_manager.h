@@ -209,7 +209,13 @@ protected:
      * Reads and writes the tiles 
      */
     bool write(KisPaintDeviceWriter &store);
-    bool read(QIODevice *stream);
+
+    /**
+     * When \p lazyDecompression is true, the compressed tiles are
+     * put into the swap as they are and decompressed only when
+     * somebody accesses them for the first time.
+     */
+    bool read(QIODevice *stream, bool lazyDecompression = false);
 
     void purge(const QRect& area);
 
@@ -228,6 +234,24 @@ public:
 
     QRegion region() const;
 
+    /**
+     * Returns the region covered by the tiles whose data is not
+     * shared with the corresponding tiles of \p other. Since writing
+     * into a shared tile always detaches its data (copy-on-write),
+     * comparing against a shallow copy made earlier gives the region
+     * modified since the moment of copying. Tiles existing only in
+     * one of the data managers are included as well.
+     */
+    QRegion nonSharedRegion(const KisTiledDataManager *other) const;
+
+    /**
+     * Returns the region covered by the tiles created or written since
+     * the start of the modification \p epoch, see
+     * KisTile::startModificationEpoch(). The tiles removed since then
+     * are not a part of the region, compare region() for them.
+     */
+    QRegion modifiedRegion(int epoch) const;
+
     void clear(QRect clearRect, quint8 clearValue);
     void clear(QRect clearRect, const quint8 *clearPixel);
     void clear(qint32 x, qint32 y, qint32 w, qint32 h, quint8 clearValue);
@@ -19,9 +19,20 @@
 #include "kis_abstract_tile_compressor.h"
 
 KisAbstractTileCompressor::KisAbstractTileCompressor()
+    : m_lazyDecompression(false)
 {
 }
 
 KisAbstractTileCompressor::~KisAbstractTileCompressor()
 {
 }
+
+void KisAbstractTileCompressor::setLazyDecompression(bool value)
+{
+    m_lazyDecompression = value;
+}
+
+bool KisAbstractTileCompressor::lazyDecompression() const
+{
+    return m_lazyDecompression;
+}
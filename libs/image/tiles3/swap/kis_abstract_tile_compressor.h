@@ -90,6 +90,15 @@ public:
      */
     virtual qint32 tileDataBufferSize(KisTileData *tileData) = 0;
 
+    /**
+     * When enabled, readTile() doesn't decompress the tiles, but
+     * passes their compressed data directly to the swap, so that
+     * it is decompressed only on the first access to the tile.
+     * Compressors that cannot do that just ignore the flag.
+     */
+    void setLazyDecompression(bool value);
+    bool lazyDecompression() const;
+
 protected:
     inline qint32 xToCol(KisTiledDataManager *dm, qint32 x) {
         return dm->xToCol(x);
@@ -102,6 +111,9 @@ protected:
     inline qint32 pixelSize(KisTiledDataManager *dm) {
         return dm->pixelSize();
     }
+
+private:
+    bool m_lazyDecompression;
 };
 
 #endif /* __KIS_ABSTRACT_TILE_COMPRESSOR_H */
@@ -26,10 +26,12 @@
 //#define COMPRESSOR_VERSION 2
 
 KisSwappedDataStore::KisSwappedDataStore()
-    : m_memoryMetric(0)
+    : m_memoryMetric(0),
+      m_swapFileUsage(0)
 {
     KisImageConfig config(true);
     const quint64 maxSwapSize = config.maxSwapSize() * MiB;
+    m_maxSwapSize = maxSwapSize;
     const quint64 swapSlabSize = config.swapSlabSize() * MiB;
     const quint64 swapWindowSize = config.swapWindowSize() * MiB;
 
@@ -85,6 +87,42 @@ bool KisSwappedDataStore::trySwapOutTileData(KisTileData *td)
     td->setSwapChunk(chunk);
 
     m_memoryMetric += td->pixelSize();
+    m_swapFileUsage += chunk.size();
+
+    return true;
+}
+
+bool KisSwappedDataStore::tryAdoptCompressedTileData(KisTileData *td, const quint8 *buffer, qint32 bufferSize)
+{
+    Q_ASSERT(td->data());
+    QMutexLocker locker(&m_lock);
+
+    if (bufferSize <= 0 || bufferSize > m_compressor->tileDataBufferSize(td)) {
+        return false;
+    }
+
+    /**
+     * The allocator crashes when it runs out of the swap space, so
+     * we leave the second half of it to the swapper. The tiles that
+     * didn't fit will just be decompressed by the caller.
+     */
+    if (m_swapFileUsage + bufferSize > m_maxSwapSize / 2) {
+        return false;
+    }
+
+    KisChunk chunk = m_allocator->getChunk(bufferSize);
+    quint8 *ptr = m_swapSpace->getWriteChunkPtr(chunk);
+    if (!ptr) {
+        m_allocator->freeChunk(chunk);
+        return false;
+    }
+    memcpy(ptr, buffer, bufferSize);
+
+    td->releaseMemory();
+    td->setSwapChunk(chunk);
+
+    m_memoryMetric += td->pixelSize();
+    m_swapFileUsage += chunk.size();
 
     return true;
 }
@@ -104,6 +142,7 @@ void KisSwappedDataStore::swapInTileData(KisTileData *td)
     quint8 *ptr = m_swapSpace->getReadChunkPtr(chunk);
     Q_ASSERT(ptr);
     m_compressor->decompressTileData(ptr, chunk.size(), td);
+    m_swapFileUsage -= chunk.size();
     m_allocator->freeChunk(chunk);
 
     m_memoryMetric -= td->pixelSize();
@@ -113,7 +152,10 @@ void KisSwappedDataStore::forgetTileData(KisTileData *td)
 {
     QMutexLocker locker(&m_lock);
 
-    m_allocator->freeChunk(td->swapChunk());
+    KisChunk chunk = td->swapChunk();
+    m_swapFileUsage -= chunk.size();
+
+    m_allocator->freeChunk(chunk);
     td->setSwapChunk(KisChunk());
 
     m_memoryMetric -= td->pixelSize();
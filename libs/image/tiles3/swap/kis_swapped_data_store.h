@@ -58,6 +58,18 @@ public:
      */
     void swapInTileData(KisTileData *td);
 
+    /**
+     * Put the data of \a td into the swap file directly from \a buffer,
+     * that has already been compressed by KisTileCompressor2, and free
+     * memory occupied by td->data(). The data will be decompressed
+     * only when somebody swaps the tile data in. Returns false if the
+     * buffer has unexpected format or there is not enough space in the
+     * swap file, the tile data is not changed in such a case.
+     * LOCKING: the lock on the tile data should be taken
+     *          by the caller before making a call.
+     */
+    bool tryAdoptCompressedTileData(KisTileData *td, const quint8 *buffer, qint32 bufferSize);
+
     /**
      * Forget all the information linked with the tile data.
      * This should be done before deleting of the tile data,
@@ -86,6 +98,9 @@ private:
     QMutex m_lock;
 
     qint64 m_memoryMetric;
+
+    quint64 m_maxSwapSize;
+    quint64 m_swapFileUsage;
 };
 
 #endif /* __KIS_SWAPPED_DATA_STORE_H */
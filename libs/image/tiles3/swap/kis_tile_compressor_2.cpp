@@ -20,6 +20,7 @@
 #include "kis_lzf_compression.h"
 #include <QIODevice>
 #include "kis_paint_device_writer.h"
+#include "../kis_tile_data_store.h"
 #define TILE_DATA_SIZE(pixelSize) ((pixelSize) * KisTileData::WIDTH * KisTileData::HEIGHT)
 
 const QString KisTileCompressor2::m_compressionName = "LZF";
@@ -84,6 +85,21 @@ bool KisTileCompressor2::readTile(QIODevice *stream, KisTiledDataManager *dm)
 
         stream->read(m_streamingBuffer.data(), dataSize);
 
+        if (lazyDecompression() && isValidTileDataBuffer((quint8*)m_streamingBuffer.data(), dataSize, tileDataSize)) {
+            /**
+             * Make sure the tile has its own tile data (not the
+             * shared default one) and then move the compressed data
+             * into the swap as it is
+             */
+            tile->lockForWrite();
+            KisTileData *td = tile->tileData();
+            tile->unlockForWrite();
+
+            if (KisTileDataStore::instance()->tryAdoptCompressedTileData(td, (quint8*)m_streamingBuffer.data(), dataSize)) {
+                return true;
+            }
+        }
+
         tile->lockForWrite();
         bool res = decompressTileData((quint8*)m_streamingBuffer.data(), dataSize, tile->tileData());
         tile->unlockForWrite();
@@ -170,6 +186,13 @@ bool KisTileCompressor2::decompressTileData(quint8 *buffer,
 
 }
 
+bool KisTileCompressor2::isValidTileDataBuffer(const quint8 *buffer, qint32 bufferSize, qint32 tileDataSize)
+{
+    return bufferSize > 1 &&
+        ((buffer[0] == COMPRESSED_DATA_FLAG && bufferSize <= tileDataSize + 1) ||
+         (buffer[0] == RAW_DATA_FLAG && bufferSize == tileDataSize + 1));
+}
+
 qint32 KisTileCompressor2::tileDataBufferSize(KisTileData *tileData)
 {
     return TILE_DATA_SIZE(tileData->pixelSize()) + 1;
@@ -44,6 +44,12 @@ private:
      */
     qint32 maxHeaderLength();
 
+    /**
+     * Checks that the \p buffer looks like a result of
+     * compressTileData(), so it can be decompressed later safely
+     */
+    bool isValidTileDataBuffer(const quint8 *buffer, qint32 bufferSize, qint32 tileDataSize);
+
     QString getHeader(KisTileSP tile, qint32 compressedSize);
 
     void prepareWorkBuffers(qint32 tileDataSize);
@@ -165,6 +165,40 @@ void KisTileCompressorsTest::testRoundTrip2()
     delete compressor;
 }
 
+void KisTileCompressorsTest::testLazyRoundTrip2()
+{
+    KisTileCompressor2 compressor;
+
+    quint8 defaultPixel = 0;
+    KisTiledDataManager dm(1, &defaultPixel);
+
+    quint8 oddPixel1 = 128;
+    dm.clear(64, 64, 64, 64, &oddPixel1);
+
+    KisTileSP tile11 = dm.getTile(1, 1, false);
+
+    KoStoreFake fakeStore;
+    KisFakePaintDeviceWriter writer(&fakeStore);
+    QVERIFY(compressor.writeTile(tile11, writer));
+    tile11 = 0;
+
+    fakeStore.startReading();
+    dm.clear();
+
+    compressor.setLazyDecompression(true);
+    QVERIFY(compressor.readTile(fakeStore.device(), &dm));
+
+    tile11 = dm.getTile(1, 1, false);
+
+    // the data should still be in the swap
+    QVERIFY(!tile11->tileData()->data());
+
+    tile11->lockForRead();
+    QVERIFY(memoryIsFilled(oddPixel1, tile11->data(), TILESIZE));
+    tile11->unlockForRead();
+    tile11 = 0;
+}
+
 void KisTileCompressorsTest::testLowLevelRoundTrip2()
 {
     KisAbstractTileCompressor *compressor = new KisTileCompressor2();
@@ -38,6 +38,7 @@ private Q_SLOTS:
     void testRoundTrip2();
     void testLowLevelRoundTrip2();
     void testLowLevelRoundTripIncompressible2();
+    void testLazyRoundTrip2();
 };
 
 #endif /* KIS_TILE_COMPRESSORS_TEST_H */
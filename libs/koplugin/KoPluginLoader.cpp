@@ -21,11 +21,17 @@
 
 #include <KoJsonTrader.h>
 
+#include <QCoreApplication>
+#include <QFileInfo>
+#include <QHash>
 #include <QJsonObject>
 #include <QPluginLoader>
+#include <QThread>
 
 #include "KritaPluginDebug.h"
 
+#include <KisStartupTrace.h>
+
 #include <KConfig>
 #include <KSharedConfig>
 #include <KConfigGroup>
@@ -34,7 +40,13 @@
 class Q_DECL_HIDDEN KoPluginLoader::Private
 {
 public:
+    struct DeferredLoad {
+        QString versionString;
+        PluginsConfig config;
+    };
+
     QStringList loadedServiceTypes;
+    QHash<QString, DeferredLoad> deferredServiceTypes;
 };
 
 KoPluginLoader::KoPluginLoader()
@@ -61,6 +73,8 @@ void KoPluginLoader::load(const QString & serviceType, const QString & versionSt
         return;
     }
     d->loadedServiceTypes << serviceType;
+    d->deferredServiceTypes.remove(serviceType);
+
     QString query = QString::fromLatin1("(Type == 'Service')");
     if (!versionString.isEmpty()) {
         query += QString::fromLatin1(" and (%1)").arg(versionString);
@@ -130,6 +144,7 @@ void KoPluginLoader::load(const QString & serviceType, const QString & versionSt
     QList<QString> whiteList;
     Q_FOREACH (const QString &serviceName, serviceNames.keys()) {
         debugPlugin << "loading" << serviceName;
+        KisStartupTrace::Scope traceScope(QFileInfo(serviceName).fileName(), serviceType);
         QPluginLoader *loader = serviceNames[serviceName];
         KPluginFactory *factory = qobject_cast<KPluginFactory *>(loader->instance());
         QObject *plugin = 0;
@@ -158,3 +173,42 @@ void KoPluginLoader::load(const QString & serviceType, const QString & versionSt
 
     qDeleteAll(offers);
 }
+
+void KoPluginLoader::defer(const QString &serviceType, const QString &versionString, const PluginsConfig &config)
+{
+    if (d->loadedServiceTypes.contains(serviceType)) {
+        return;
+    }
+
+    Private::DeferredLoad deferred;
+    deferred.versionString = versionString;
+    deferred.config = config;
+    d->deferredServiceTypes.insert(serviceType, deferred);
+
+    debugPlugin << "Deferred loading of" << serviceType;
+}
+
+void KoPluginLoader::loadDeferred(const QString &serviceType)
+{
+    /**
+     * The plugin objects are parented to the loader, so they can be
+     * created in the GUI thread only. The registries triggering the load
+     * are first used from the GUI thread during startup or document
+     * loading, the calls made later from the worker threads just skip it.
+     */
+    if (QCoreApplication::instance() &&
+        QThread::currentThread() != QCoreApplication::instance()->thread()) {
+        return;
+    }
+
+    auto it = d->deferredServiceTypes.find(serviceType);
+    if (it == d->deferredServiceTypes.end()) {
+        return;
+    }
+
+    const Private::DeferredLoad deferred = *it;
+    d->deferredServiceTypes.erase(it);
+
+    KisStartupTrace::Scope traceScope(serviceType, "deferred plugins");
+    load(serviceType, deferred.versionString, deferred.config);
+}
@@ -114,6 +114,29 @@ public:
      */
     void load(const QString & serviceType, const QString & versionString = QString(), const PluginsConfig &config = PluginsConfig(), QObject* owner = 0, bool cache = true);
 
+    /**
+     * Registers the plugins of \p serviceType for loading without actually loading
+     * their libraries. The plugins are instantiated by the first call to
+     * loadDeferred() for the same service type, usually made by the registry
+     * the plugins add their factories to, when the registry is first used.
+     * Nothing is loaded if the registry is never used, e.g. in batch mode.
+     *
+     * The arguments have the same meaning as in load(). Deferred plugins
+     * are always deleted after instantiation.
+     */
+    void defer(const QString & serviceType, const QString & versionString = QString(), const PluginsConfig &config = PluginsConfig());
+
+    /**
+     * Loads the plugins of \p serviceType registered with defer(). Does
+     * nothing if the service type was not deferred or is already loaded.
+     *
+     * Every registry that the plugins of \p serviceType add anything to
+     * must call it on first use, not only the one they are named after.
+     * Must be called from the GUI thread, the calls from other threads
+     * are ignored.
+     */
+    void loadDeferred(const QString & serviceType);
+
 public:
     /// DO NOT USE! Use instance() instead
     // TODO: turn KoPluginLoader into namespace and do not expose object at all
@@ -21,6 +21,7 @@
 
 #include <QHash>
 #include <QList>
+#include <QAtomicInt>
 #include <QMutex>
 #include <QThreadStorage>
 
@@ -67,20 +68,67 @@ struct KoColorConversionCache::CachedTransformation {
     }
 
     bool available() {
-        return use == 0;
+        return use.loadAcquire() == 0;
     }
 
     KoColorConversionTransformation* transfo;
-    int use;
+    QAtomicInt use;
 };
 
 typedef QPair<KoColorConversionCacheKey, KoCachedColorConversionTransformation> FastPathCacheItem;
 
+namespace {
+
+/**
+ * The cache is split into shards, each protected by its own mutex, so
+ * that threads converting between different pairs of color spaces don't
+ * wait for each other
+ */
+const int NUM_SHARDS = 16;
+
+}
+
 struct KoColorConversionCache::Private {
-    QMultiHash< KoColorConversionCacheKey, CachedTransformation*> cache;
-    QMutex cacheMutex;
+
+    struct Shard {
+        QMultiHash< KoColorConversionCacheKey, CachedTransformation*> cache;
+        QMutex mutex;
+    };
+
+    Shard shards[NUM_SHARDS];
 
     QThreadStorage<FastPathCacheItem*> fastStorage;
+
+    QAtomicInt hits;
+    QAtomicInt misses;
+    QAtomicInt clones;
+    QAtomicInt contentions;
+
+    Shard& shardForKey(const KoColorConversionCacheKey &key) {
+        return shards[qHash(key) % NUM_SHARDS];
+    }
+
+    void lockShard(Shard &shard) {
+        if (!shard.mutex.tryLock()) {
+            contentions.ref();
+            shard.mutex.lock();
+        }
+    }
+
+    /**
+     * Returns a transformation for \p key that is not used by any thread
+     * or null. The shard must be locked.
+     */
+    CachedTransformation* findAvailable(Shard &shard, const KoColorConversionCacheKey &key, CachedTransformation **busy) {
+        auto it = shard.cache.find(key);
+        for (; it != shard.cache.end() && it.key() == key; ++it) {
+            if (it.value()->available()) {
+                return it.value();
+            }
+            *busy = it.value();
+        }
+        return 0;
+    }
 };
 
 
@@ -90,8 +138,10 @@ KoColorConversionCache::KoColorConversionCache() : d(new Private)
 
 KoColorConversionCache::~KoColorConversionCache()
 {
-    Q_FOREACH (CachedTransformation* transfo, d->cache) {
-        delete transfo;
+    for (int i = 0; i < NUM_SHARDS; i++) {
+        Q_FOREACH (CachedTransformation* transfo, d->shards[i].cache) {
+            delete transfo;
+        }
     }
     delete d;
 }
@@ -114,24 +164,51 @@ KoCachedColorConversionTransformation KoColorConversionCache::cachedConverter(co
 
     cacheItem = 0;
 
-    QMutexLocker lock(&d->cacheMutex);
-    QList< CachedTransformation* > cachedTransfos = d->cache.values(key);
-    if (cachedTransfos.size() != 0) {
-        Q_FOREACH (CachedTransformation* ct, cachedTransfos) {
-            if (ct->available()) {
-                ct->transfo->setSrcColorSpace(src);
-                ct->transfo->setDstColorSpace(dst);
+    Private::Shard &shard = d->shardForKey(key);
+    CachedTransformation *busy = 0;
 
-                cacheItem = new FastPathCacheItem(key, KoCachedColorConversionTransformation(this, ct));
-                break;
-            }
-        }
+    d->lockShard(shard);
+    CachedTransformation *ct = d->findAvailable(shard, key, &busy);
+    if (ct) {
+        ct->transfo->setSrcColorSpace(src);
+        ct->transfo->setDstColorSpace(dst);
+        cacheItem = new FastPathCacheItem(key, KoCachedColorConversionTransformation(this, ct));
+        d->hits.ref();
+    } else if (busy) {
+        // keep the busy transformation alive while it is being cloned
+        busy->use.ref();
     }
+    shard.mutex.unlock();
+
     if (!cacheItem) {
-        KoColorConversionTransformation* transfo = src->createColorConverter(dst, _renderingIntent, _conversionFlags);
-        CachedTransformation* ct = new CachedTransformation(transfo);
-        d->cache.insert(key, ct);
+        /**
+         * All the transformations for this key are used by other
+         * threads. Cloning one of them is much cheaper than going
+         * through the conversion system and compiling a new one.
+         * Neither of them needs the shard to be locked.
+         */
+        KoColorConversionTransformation* transfo = 0;
+
+        if (busy) {
+            transfo = busy->transfo->clone();
+            busy->use.deref();
+        }
+
+        if (transfo) {
+            d->clones.ref();
+        } else {
+            transfo = src->createColorConverter(dst, _renderingIntent, _conversionFlags);
+            d->misses.ref();
+        }
+
+        ct = new CachedTransformation(transfo);
+        ct->transfo->setSrcColorSpace(src);
+        ct->transfo->setDstColorSpace(dst);
         cacheItem = new FastPathCacheItem(key, KoCachedColorConversionTransformation(this, ct));
+
+        d->lockShard(shard);
+        shard.cache.insert(key, ct);
+        shard.mutex.unlock();
     }
 
     d->fastStorage.setLocalData(cacheItem);
@@ -142,19 +219,33 @@ void KoColorConversionCache::colorSpaceIsDestroyed(const KoColorSpace* cs)
 {
     d->fastStorage.setLocalData(0);
 
-    QMutexLocker lock(&d->cacheMutex);
-    QMultiHash< KoColorConversionCacheKey, CachedTransformation*>::iterator endIt = d->cache.end();
-    for (QMultiHash< KoColorConversionCacheKey, CachedTransformation*>::iterator it = d->cache.begin(); it != endIt;) {
-        if (it.key().src == cs || it.key().dst == cs) {
-            Q_ASSERT(it.value()->available()); // That's terribely evil, if that assert fails, that means that someone is using a color transformation with a color space which is currently being deleted
-            delete it.value();
-            it = d->cache.erase(it);
-        } else {
-            ++it;
+    for (int i = 0; i < NUM_SHARDS; i++) {
+        Private::Shard &shard = d->shards[i];
+        QMutexLocker lock(&shard.mutex);
+
+        QMultiHash< KoColorConversionCacheKey, CachedTransformation*>::iterator endIt = shard.cache.end();
+        for (QMultiHash< KoColorConversionCacheKey, CachedTransformation*>::iterator it = shard.cache.begin(); it != endIt;) {
+            if (it.key().src == cs || it.key().dst == cs) {
+                Q_ASSERT(it.value()->available()); // That's terribely evil, if that assert fails, that means that someone is using a color transformation with a color space which is currently being deleted
+                delete it.value();
+                it = shard.cache.erase(it);
+            } else {
+                ++it;
+            }
         }
     }
 }
 
+KoColorConversionCache::Statistics KoColorConversionCache::statistics() const
+{
+    Statistics stats;
+    stats.hits = d->hits.loadAcquire();
+    stats.misses = d->misses.loadAcquire();
+    stats.clones = d->clones.loadAcquire();
+    stats.contentions = d->contentions.loadAcquire();
+    return stats;
+}
+
 //--------- KoCachedColorConversionTransformation ----------//
 
 struct KoCachedColorConversionTransformation::Private {
@@ -168,18 +259,18 @@ KoCachedColorConversionTransformation::KoCachedColorConversionTransformation(KoC
     Q_ASSERT(transfo->available());
     d->cache = cache;
     d->transfo = transfo;
-    d->transfo->use++;
+    d->transfo->use.ref();
 }
 
 KoCachedColorConversionTransformation::KoCachedColorConversionTransformation(const KoCachedColorConversionTransformation& rhs) : d(new Private(*rhs.d))
 {
-    d->transfo->use++;
+    d->transfo->use.ref();
 }
 
 KoCachedColorConversionTransformation::~KoCachedColorConversionTransformation()
 {
-    d->transfo->use--;
-    Q_ASSERT(d->transfo->use >= 0);
+    d->transfo->use.deref();
+    Q_ASSERT(d->transfo->use.loadAcquire() >= 0);
     delete d;
 }
 
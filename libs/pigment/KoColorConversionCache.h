@@ -28,12 +28,33 @@ class KoColorSpace;
 /**
  * This class holds a cache of KoColorConversionTransformations.
  *
+ * A cached transformation is used by one thread at a time. When all the
+ * transformations for a pair of color spaces are busy, the cache clones
+ * one of them (see KoColorConversionTransformation::clone()) instead of
+ * creating a new one. The cache is split into shards with separate
+ * locks, so threads working with different color spaces don't contend.
+ *
  * This class is not part of public API, and can be changed without notice.
  */
 class KoColorConversionCache
 {
 public:
     struct CachedTransformation;
+
+    /**
+     * Counters of the requests that missed the per-thread fast path
+     */
+    struct Statistics {
+        /// an idle transformation was found in the cache
+        int hits = 0;
+        /// a new transformation was created by the color space
+        int misses = 0;
+        /// a busy transformation was cloned
+        int clones = 0;
+        /// a thread had to wait for the lock of a shard
+        int contentions = 0;
+    };
+
 public:
     KoColorConversionCache();
     ~KoColorConversionCache();
@@ -58,6 +79,11 @@ public:
      * @param src source color space
      */
     void colorSpaceIsDestroyed(const KoColorSpace* src);
+
+    /**
+     * @return the counters of the cache since its creation
+     */
+    Statistics statistics() const;
 private:
     struct Private;
     Private* const d;
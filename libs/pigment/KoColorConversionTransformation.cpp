@@ -79,6 +79,11 @@ void KoColorConversionTransformation::transformInPlace(const quint8 *src, quint8
     }
 }
 
+KoColorConversionTransformation* KoColorConversionTransformation::clone() const
+{
+    return 0;
+}
+
 void KoColorConversionTransformation::setSrcColorSpace(const KoColorSpace* cs) const
 {
     Q_ASSERT(*d->srcColorSpace == *cs);
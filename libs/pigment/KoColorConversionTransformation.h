@@ -135,6 +135,16 @@ public:
      */
     bool isValid() const override { return true; }
 
+    /**
+     * Creates a copy of the transformation that can be used in another
+     * thread concurrently with this one. The copy shares the precompiled
+     * data with the original, so it is much cheaper than creating a new
+     * transformation with KoColorSpace::createColorConverter().
+     *
+     * @return the copy or null if the transformation cannot be shared
+     */
+    virtual KoColorConversionTransformation* clone() const;
+
 private:
 
     void setSrcColorSpace(const KoColorSpace*) const;
@@ -19,6 +19,8 @@
 #ifndef _KO_COLORCONVERSIONS_H_
 #define _KO_COLORCONVERSIONS_H_
 
+#include <cmath>
+
 #include <QtGlobal>
 #include "kritapigment_export.h"
 
@@ -31,11 +33,185 @@ KRITAPIGMENT_EXPORT void rgb_to_hsv(int R, int G, int B, int *H, int *S, int *V)
 KRITAPIGMENT_EXPORT void hsv_to_rgb(int H, int S, int V, int *R, int *G, int *B);
 
 // Floating point versions. RGBSL are 0-1, H is 0-360.
-KRITAPIGMENT_EXPORT void RGBToHSV(float r, float g, float b, float *h, float *s, float *v);
-KRITAPIGMENT_EXPORT void HSVToRGB(float h, float s, float v, float *r, float *g, float *b);
+// They are inline, because the adjustments call them for every pixel.
+inline void RGBToHSV(float r, float g, float b, float *h, float *s, float *v)
+{
+    const double epsilon = 1e-6;
+    const float undefinedHue = -1;
+
+    float max = qMax(r, qMax(g, b));
+    float min = qMin(r, qMin(g, b));
+
+    *v = max;
+
+    if (max > epsilon) {
+        *s = (max - min) / max;
+    } else {
+        *s = 0;
+    }
+
+    if (*s < epsilon) {
+        *h = undefinedHue;
+    } else {
+        float delta = max - min;
+
+        if (r == max) {
+            *h = (g - b) / delta;
+        } else if (g == max) {
+            *h = 2 + (b - r) / delta;
+        } else {
+            *h = 4 + (r - g) / delta;
+        }
+
+        *h *= 60;
+        if (*h < 0) {
+            *h += 360;
+        }
+    }
+}
+
+inline void HSVToRGB(float h, float s, float v, float *r, float *g, float *b)
+{
+    const double epsilon = 1e-6;
+    const float undefinedHue = -1;
+
+    if (s < epsilon || h == undefinedHue) {
+        // Achromatic case
+
+        *r = v;
+        *g = v;
+        *b = v;
+    } else {
+        float f, p, q, t;
+        int i;
+
+        if (h > 360 - epsilon) {
+            h -= 360;
+        }
+
+        h /= 60;
+        i = static_cast<int>(floor(h));
+        f = h - i;
+        p = v * (1 - s);
+        q = v * (1 - (s * f));
+        t = v * (1 - (s * (1 - f)));
+
+        switch (i) {
+        case 0:
+            *r = v;
+            *g = t;
+            *b = p;
+            break;
+        case 1:
+            *r = q;
+            *g = v;
+            *b = p;
+            break;
+        case 2:
+            *r = p;
+            *g = v;
+            *b = t;
+            break;
+        case 3:
+            *r = p;
+            *g = q;
+            *b = v;
+            break;
+        case 4:
+            *r = t;
+            *g = p;
+            *b = v;
+            break;
+        case 5:
+            *r = v;
+            *g = p;
+            *b = q;
+            break;
+        }
+    }
+}
+
+/*
+A Fast HSL-to-RGB Transform
+by Ken Fishkin
+from "Graphics Gems", Academic Press, 1990
+*/
+
+inline void RGBToHSL(float r, float g, float b, float *h, float *s, float *l)
+{
+    const float undefinedHue = -1;
+
+    float v;
+    float m;
+    float vm;
+    float r2, g2, b2;
+
+    v = qMax(r, g);
+    v = qMax(v, b);
+    m = qMin(r, g);
+    m = qMin(m, b);
+
+    if ((*l = (m + v) / 2.0) <= 0.0) {
+        *h = undefinedHue;
+        *s = 0;
+        return;
+    }
+    if ((*s = vm = v - m) > 0.0) {
+        *s /= (*l <= 0.5) ? (v + m) :
+              (2.0 - v - m) ;
+    } else {
+        *h = undefinedHue;
+        return;
+    }
+
+
+    r2 = (v - r) / vm;
+    g2 = (v - g) / vm;
+    b2 = (v - b) / vm;
+
+    if (r == v)
+        *h = (g == m ? 5.0 + b2 : 1.0 - g2);
+    else if (g == v)
+        *h = (b == m ? 1.0 + r2 : 3.0 - b2);
+    else
+        *h = (r == m ? 3.0 + g2 : 5.0 - r2);
+
+    *h *= 60;
+    *h = fmod(*h, 360.0);
+}
+
+inline void HSLToRGB(float h, float sl, float l, float *r, float *g, float *b)
+{
+    float v;
+
+    v = (l <= 0.5) ? (l * (1.0 + sl)) : (l + sl - l * sl);
+    if (v <= 0) {
+        *r = *g = *b = 0.0;
+    } else {
+        float m;
+        float sv;
+        int sextant;
+        float fract, vsf, mid1, mid2;
 
-KRITAPIGMENT_EXPORT void RGBToHSL(float r, float g, float b, float *h, float *s, float *l);
-KRITAPIGMENT_EXPORT void HSLToRGB(float h, float sl, float l, float *r, float *g, float *b);
+        m = l + l - v;
+        sv = (v - m) / v;
+        h = fmod(h, 360.0);
+        h /= 60.0;
+        sextant = static_cast<int>(h);
+        fract = h - sextant;
+        vsf = v * sv * fract;
+        mid1 = m + vsf;
+        mid2 = v - vsf;
+        switch (sextant) {
+        case 0: *r = v; *g = mid1; *b = m; break;
+        case 1: *r = mid2; *g = v; *b = m; break;
+        case 2: *r = m; *g = v; *b = mid1; break;
+        case 3: *r = m; *g = mid2; *b = v; break;
+        case 4: *r = mid1; *g = m; *b = v; break;
+        case 5: *r = v; *g = m; *b = mid2; break;
+        }
+    }
+}
 
 KRITAPIGMENT_EXPORT void rgb_to_hls(quint8 r, quint8 g, quint8 b, float * h, float * l, float * s);
 
@@ -33,6 +33,7 @@
 #include "KoMixColorsOpImpl.h"
 
 #include "KoConvolutionOpImpl.h"
+#include "KoOptimizedPixelOpsSelector.h"
 #include "KoInvertColorTransformation.h"
 
 /**
@@ -53,7 +54,9 @@ public:
 
 public:
     KoColorSpaceAbstract(const QString &id, const QString &name) :
-        KoColorSpace(id, name, new KoMixColorsOpImpl< _CSTrait>(), new KoConvolutionOpImpl< _CSTrait>()) {
+        KoColorSpace(id, name,
+                     KoOptimizedPixelOpsSelector<_CSTrait>::createMixColorsOp(),
+                     KoOptimizedPixelOpsSelector<_CSTrait>::createConvolutionOp()) {
     }
 
     quint32 colorChannelCount() const override {
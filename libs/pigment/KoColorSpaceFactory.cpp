@@ -87,6 +87,12 @@ const KoColorProfile *KoColorSpaceFactory::colorProfile(const QByteArray &rawDat
     return colorProfile;
 }
 
+bool KoColorSpaceFactory::canCreateColorSpace(const KoColorProfile *profile) const
+{
+    Q_UNUSED(profile);
+    return true;
+}
+
 const KoColorSpace *KoColorSpaceFactory::grabColorSpace(const KoColorProfile * profile)
 {
     QMutexLocker l(&d->mutex);
@@ -95,6 +101,11 @@ const KoColorSpace *KoColorSpaceFactory::grabColorSpace(const KoColorProfile * p
     KoColorSpace* cs;
 
     if (it == d->availableColorspaces.end()) {
+        if (!canCreateColorSpace(profile)) {
+            warnPigment << "Cannot create a color space" << id() << "for profile" << profile->name();
+            return 0;
+        }
+
         cs = createColorSpace(profile);
         KIS_ASSERT_X(cs != nullptr, "KoColorSpaceFactory::grabColorSpace", "createColorSpace returned nullptr.");
         if (cs) {
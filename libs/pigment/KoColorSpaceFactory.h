@@ -134,6 +134,15 @@ public:
     const KoColorSpace *grabColorSpace(const KoColorProfile *profile);
 
 protected:
+    /**
+     * @return false if a color space can't be created for \p profile,
+     * for instance when the profile is loaded lazily and its data
+     * turns out to be broken. Called by grabColorSpace() before
+     * createColorSpace(), so it may do the expensive checks that
+     * profileIsCompatible() can't.
+     */
+    virtual bool canCreateColorSpace(const KoColorProfile *profile) const;
+
     /**
      * creates a color space using the given profile.
      */
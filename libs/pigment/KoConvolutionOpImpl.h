@@ -98,6 +98,18 @@ public:
             }
         }
 
+        storeConvolvedColor(totals, totalWeight, totalWeightTransparent, dst, factor, offset, channelFlags);
+    }
+
+protected:
+    /**
+     * Writes the accumulated \p totals into \p dst according to the
+     * cases described in convolveColors(). Shared with the vectorized
+     * implementations.
+     */
+    static void storeConvolvedColor(const qreal *totals, qreal totalWeight, qreal totalWeightTransparent,
+                                    quint8 *dst, qreal factor, qreal offset, const QBitArray & channelFlags) {
+
         typename _CSTrait::channels_type* dstColor = _CSTrait::nativeArray(dst);
 
         bool allChannels = channelFlags.isEmpty();
@@ -0,0 +1,163 @@
+/*
+ *  Copyright (c) 2020 Krita developers
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+*/
+
+#include "KoHalfConversion.h"
+
+#ifdef HAVE_OPENEXR
+
+#include <QtGlobal>
+
+#include <ksharedconfig.h>
+#include <kconfiggroup.h>
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define HAVE_F16C_INTRINSICS
+#include <cpuid.h>
+#include <immintrin.h>
+#endif
+
+namespace {
+
+void halfToFloatScalar(const half *src, float *dst, int numValues)
+{
+    for (int i = 0; i < numValues; i++) {
+        dst[i] = src[i];
+    }
+}
+
+void floatToHalfScalar(const float *src, half *dst, int numValues)
+{
+    for (int i = 0; i < numValues; i++) {
+        dst[i] = half(src[i]);
+    }
+}
+
+#ifdef HAVE_F16C_INTRINSICS
+
+/**
+ * The functions are compiled for F16C with the target attribute, so that
+ * the rest of the library can still run on the CPUs without it. They are
+ * called only after the runtime check in detectF16C().
+ */
+
+__attribute__((target("avx,f16c")))
+void halfToFloatF16C(const half *src, float *dst, int numValues)
+{
+    int i = 0;
+
+    for (; i + 8 <= numValues; i += 8) {
+        const __m128i values = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        _mm256_storeu_ps(dst + i, _mm256_cvtph_ps(values));
+    }
+
+    halfToFloatScalar(src + i, dst + i, numValues - i);
+}
+
+__attribute__((target("avx,f16c")))
+void floatToHalfF16C(const float *src, half *dst, int numValues)
+{
+    int i = 0;
+
+    for (; i + 8 <= numValues; i += 8) {
+        const __m128i values = _mm256_cvtps_ph(_mm256_loadu_ps(src + i), _MM_FROUND_TO_NEAREST_INT);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), values);
+    }
+
+    floatToHalfScalar(src + i, dst + i, numValues - i);
+}
+
+bool detectF16C()
+{
+    unsigned int eax, ebx, ecx, edx;
+
+    if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx)) {
+        return false;
+    }
+
+    if (!(ecx & bit_OSXSAVE) || !(ecx & bit_AVX) || !(ecx & bit_F16C)) {
+        return false;
+    }
+
+    // check that the OS saves the YMM registers on context switch
+    unsigned int xcrLow, xcrHigh;
+    __asm__ ("xgetbv" : "=a" (xcrLow), "=d" (xcrHigh) : "c" (0));
+
+    return (xcrLow & 0x6) == 0x6;
+}
+
+#endif /* HAVE_F16C_INTRINSICS */
+
+struct Dispatcher
+{
+    Dispatcher()
+        : halfToFloat(&halfToFloatScalar),
+          floatToHalf(&floatToHalfScalar),
+          hasHardwareSupport(false)
+    {
+#ifdef HAVE_F16C_INTRINSICS
+        /**
+         * F16C instructions use the AVX encoding, so respect the same
+         * options as the vectorized composite ops do
+         */
+        KConfigGroup cfg = KSharedConfig::openConfig()->group("");
+        const bool useVectorization = !cfg.readEntry("amdDisableVectorWorkaround", false);
+        const bool disableAVXOptimizations = cfg.readEntry("disableAVXOptimizations", false);
+
+        if (useVectorization && !disableAVXOptimizations && detectF16C()) {
+            halfToFloat = &halfToFloatF16C;
+            floatToHalf = &floatToHalfF16C;
+            hasHardwareSupport = true;
+        }
+#endif
+    }
+
+    void (*halfToFloat)(const half *, float *, int);
+    void (*floatToHalf)(const float *, half *, int);
+    bool hasHardwareSupport;
+};
+
+const Dispatcher& dispatcher()
+{
+    static const Dispatcher s_dispatcher;
+    return s_dispatcher;
+}
+
+}
+
+namespace KoHalfConversion
+{
+
+void halfToFloat(const half *src, float *dst, int numValues)
+{
+    dispatcher().halfToFloat(src, dst, numValues);
+}
+
+void floatToHalf(const float *src, half *dst, int numValues)
+{
+    dispatcher().floatToHalf(src, dst, numValues);
+}
+
+bool hasHardwareSupport()
+{
+    return dispatcher().hasHardwareSupport;
+}
+
+}
+
+#endif /* HAVE_OPENEXR */
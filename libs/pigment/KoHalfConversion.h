@@ -0,0 +1,55 @@
+/*
+ *  Copyright (c) 2020 Krita developers
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+*/
+
+#ifndef KOHALFCONVERSION_H
+#define KOHALFCONVERSION_H
+
+#include <KoConfig.h>
+
+#ifdef HAVE_OPENEXR
+
+#include <half.h>
+
+#include "kritapigment_export.h"
+
+/**
+ * Conversion of arrays of half values to float and back. OpenEXR's half
+ * type converts every value separately (a table lookup to float and a
+ * table lookup with rounding back to half). When the CPU supports F16C,
+ * these functions convert eight values with a single instruction.
+ *
+ * The results are the same as the ones of half's own conversion
+ * operators: float-to-half rounds to the nearest even value.
+ */
+namespace KoHalfConversion
+{
+
+KRITAPIGMENT_EXPORT void halfToFloat(const half *src, float *dst, int numValues);
+KRITAPIGMENT_EXPORT void floatToHalf(const float *src, half *dst, int numValues);
+
+/**
+ * @return true if the conversions use the F16C instructions
+ */
+KRITAPIGMENT_EXPORT bool hasHardwareSupport();
+
+}
+
+#endif /* HAVE_OPENEXR */
+
+#endif /* KOHALFCONVERSION_H */
@@ -0,0 +1,303 @@
+/*
+ *  Copyright (c) 2020 Krita developers
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+*/
+
+#include "KoLut3DColorConversionTransformation.h"
+
+#include <QVector>
+
+#include <cmath>
+
+#include <KoColorModelStandardIds.h>
+#include <KoColorProfile.h>
+#include <KoColorSpace.h>
+#include <KoColorSpaceMaths.h>
+#include <KoColorSpaceTraits.h>
+
+namespace {
+
+/**
+ * The position of a channel value in the grid: the index of the
+ * lower node and the distance to it in 1/256 of the node step
+ */
+struct GridPosition {
+    int index;
+    int fraction;
+};
+
+/**
+ * The exponent of the shaper curve of a channel with the given
+ * estimated gamma. The nodes are spaced uniformly for perceptual
+ * encodings (gamma 2.2 and above) and are packed towards the blacks
+ * for linear ones, otherwise the dark tones of a linear source fall
+ * into the first one or two cells of the grid.
+ */
+qreal shaperExponent(qreal gamma)
+{
+    const qreal perceptualGamma = 2.2;
+    return gamma > 0.0 ? qBound(1.0, perceptualGamma / gamma, perceptualGamma) : 1.0;
+}
+
+/**
+ * The source channel values of the nodes along one axis of the grid.
+ * The values are strictly increasing, so every cell is at least one
+ * level wide.
+ */
+QVector<int> calculateNodeValues(int maxValue, int gridSize, qreal exponent)
+{
+    QVector<int> nodeValues(gridSize);
+
+    for (int i = 0; i < gridSize; i++) {
+        const int value = qRound(std::pow(qreal(i) / (gridSize - 1), exponent) * maxValue);
+        const int minValue = i > 0 ? nodeValues[i - 1] + 1 : 0;
+        const int maxNodeValue = maxValue - (gridSize - 1 - i);
+        nodeValues[i] = qBound(minValue, value, maxNodeValue);
+    }
+
+    return nodeValues;
+}
+
+QVector<GridPosition> calculatePositions(int maxValue, const QVector<int> &nodeValues)
+{
+    const int gridSize = nodeValues.size();
+    QVector<GridPosition> positions(maxValue + 1);
+
+    int index = 0;
+    for (int value = 0; value <= maxValue; value++) {
+        while (index < gridSize - 2 && nodeValues[index + 1] <= value) {
+            index++;
+        }
+
+        const int span = nodeValues[index + 1] - nodeValues[index];
+
+        GridPosition &pos = positions[value];
+        pos.index = index;
+        pos.fraction = ((value - nodeValues[index]) * 256 + span / 2) / span;
+    }
+
+    return positions;
+}
+
+template <typename channel_type>
+void fillGrid(quint8 *data, const QVector<int> &redNodes, const QVector<int> &greenNodes, const QVector<int> &blueNodes)
+{
+    typedef KoBgrTraits<channel_type> Traits;
+
+    const int gridSize = redNodes.size();
+    const channel_type unitValue = KoColorSpaceMathsTraits<channel_type>::unitValue;
+    channel_type *pixel = reinterpret_cast<channel_type*>(data);
+
+    for (int r = 0; r < gridSize; r++) {
+        for (int g = 0; g < gridSize; g++) {
+            for (int b = 0; b < gridSize; b++) {
+                pixel[Traits::red_pos] = redNodes[r];
+                pixel[Traits::green_pos] = greenNodes[g];
+                pixel[Traits::blue_pos] = blueNodes[b];
+                pixel[Traits::alpha_pos] = unitValue;
+                pixel += Traits::channels_nb;
+            }
+        }
+    }
+}
+
+}
+
+struct Q_DECL_HIDDEN KoLut3DColorConversionTransformation::Private {
+    int gridSize = 0;
+    bool sourceIs16Bit = false;
+
+    /// the converted grid, 4 bytes per node in the order of KoBgrU8Traits
+    QVector<quint8> lut;
+
+    /// the positions in the grid for every possible value of the source channels
+    QVector<GridPosition> redPositions;
+    QVector<GridPosition> greenPositions;
+    QVector<GridPosition> bluePositions;
+
+    template <typename channel_type>
+    void applyLut(const quint8 *src, quint8 *dst, qint32 nPixels) const;
+};
+
+template <typename channel_type>
+void KoLut3DColorConversionTransformation::Private::applyLut(const quint8 *src, quint8 *dst, qint32 nPixels) const
+{
+    typedef KoBgrTraits<channel_type> SrcTraits;
+    typedef KoBgrU8Traits DstTraits;
+
+    const int strideB = 4;
+    const int strideG = gridSize * strideB;
+    const int strideR = gridSize * strideG;
+
+    const quint8 *table = lut.constData();
+    const GridPosition *redPos = redPositions.constData();
+    const GridPosition *greenPos = greenPositions.constData();
+    const GridPosition *bluePos = bluePositions.constData();
+    const channel_type *srcPixel = reinterpret_cast<const channel_type*>(src);
+
+    for (qint32 i = 0; i < nPixels; i++) {
+        const GridPosition &r = redPos[srcPixel[SrcTraits::red_pos]];
+        const GridPosition &g = greenPos[srcPixel[SrcTraits::green_pos]];
+        const GridPosition &b = bluePos[srcPixel[SrcTraits::blue_pos]];
+
+        const quint8 *c000 = table + r.index * strideR + g.index * strideG + b.index * strideB;
+        const quint8 *c111 = c000 + strideR + strideG + strideB;
+
+        /**
+         * Select the tetrahedron of the cube containing the point and
+         * sort the fractions: w1 >= w2 >= w3. The point is then a weighted
+         * sum of the four vertices: c000, c1, c2 and c111.
+         */
+        const quint8 *c1;
+        const quint8 *c2;
+        int w1, w2, w3;
+
+        if (r.fraction >= g.fraction) {
+            if (g.fraction >= b.fraction) {
+                c1 = c000 + strideR; c2 = c1 + strideG;
+                w1 = r.fraction; w2 = g.fraction; w3 = b.fraction;
+            } else if (r.fraction >= b.fraction) {
+                c1 = c000 + strideR; c2 = c1 + strideB;
+                w1 = r.fraction; w2 = b.fraction; w3 = g.fraction;
+            } else {
+                c1 = c000 + strideB; c2 = c1 + strideR;
+                w1 = b.fraction; w2 = r.fraction; w3 = g.fraction;
+            }
+        } else {
+            if (b.fraction > g.fraction) {
+                c1 = c000 + strideB; c2 = c1 + strideG;
+                w1 = b.fraction; w2 = g.fraction; w3 = r.fraction;
+            } else if (b.fraction > r.fraction) {
+                c1 = c000 + strideG; c2 = c1 + strideB;
+                w1 = g.fraction; w2 = b.fraction; w3 = r.fraction;
+            } else {
+                c1 = c000 + strideG; c2 = c1 + strideR;
+                w1 = g.fraction; w2 = r.fraction; w3 = b.fraction;
+            }
+        }
+
+        const int k0 = 256 - w1;
+        const int k1 = w1 - w2;
+        const int k2 = w2 - w3;
+        const int k3 = w3;
+
+        for (int ch = 0; ch < 3; ch++) {
+            dst[ch] = (c000[ch] * k0 + c1[ch] * k1 + c2[ch] * k2 + c111[ch] * k3 + 128) >> 8;
+        }
+        dst[DstTraits::alpha_pos] = KoColorSpaceMaths<channel_type, quint8>::scaleToA(srcPixel[SrcTraits::alpha_pos]);
+
+        srcPixel += SrcTraits::channels_nb;
+        dst += DstTraits::pixelSize;
+    }
+}
+
+KoLut3DColorConversionTransformation::KoLut3DColorConversionTransformation(const KoColorSpace* srcCs,
+                                                                           const KoColorSpace* dstCs,
+                                                                           Intent renderingIntent,
+                                                                           ConversionFlags conversionFlags,
+                                                                           const Private &data)
+    : KoColorConversionTransformation(srcCs, dstCs, renderingIntent, conversionFlags)
+    , d(new Private(data))
+{
+}
+
+KoLut3DColorConversionTransformation::~KoLut3DColorConversionTransformation()
+{
+    delete d;
+}
+
+bool KoLut3DColorConversionTransformation::isSupported(const KoColorSpace *srcCs, const KoColorSpace *dstCs)
+{
+    return srcCs->profile() &&
+        srcCs->colorModelId() == RGBAColorModelID &&
+        (srcCs->colorDepthId() == Integer8BitsColorDepthID ||
+         srcCs->colorDepthId() == Integer16BitsColorDepthID) &&
+        dstCs->colorModelId() == RGBAColorModelID &&
+        dstCs->colorDepthId() == Integer8BitsColorDepthID;
+}
+
+int KoLut3DColorConversionTransformation::defaultGridSize()
+{
+    return 33;
+}
+
+KoLut3DColorConversionTransformation* KoLut3DColorConversionTransformation::create(const KoColorConversionTransformation *transformation, int gridSize)
+{
+    const KoColorSpace *srcCs = transformation->srcColorSpace();
+    const KoColorSpace *dstCs = transformation->dstColorSpace();
+
+    if (!isSupported(srcCs, dstCs) || gridSize < 2 || gridSize > 256) {
+        return 0;
+    }
+
+    Private data;
+    data.gridSize = gridSize;
+    data.sourceIs16Bit = srcCs->colorDepthId() == Integer16BitsColorDepthID;
+
+    const int maxValue = data.sourceIs16Bit ?
+        KoColorSpaceMathsTraits<quint16>::unitValue :
+        KoColorSpaceMathsTraits<quint8>::unitValue;
+
+    QVector<qreal> gamma = srcCs->profile()->getEstimatedTRC();
+    if (!srcCs->profile()->hasTRC() || gamma.size() < 3) {
+        gamma.fill(0.0, 3);
+    }
+
+    const QVector<int> redNodes = calculateNodeValues(maxValue, gridSize, shaperExponent(gamma[0]));
+    const QVector<int> greenNodes = calculateNodeValues(maxValue, gridSize, shaperExponent(gamma[1]));
+    const QVector<int> blueNodes = calculateNodeValues(maxValue, gridSize, shaperExponent(gamma[2]));
+
+    // the channels usually share the curve, so share the tables as well
+    data.redPositions = calculatePositions(maxValue, redNodes);
+    data.greenPositions = greenNodes == redNodes ?
+        data.redPositions : calculatePositions(maxValue, greenNodes);
+    data.bluePositions = blueNodes == redNodes ? data.redPositions :
+        blueNodes == greenNodes ? data.greenPositions : calculatePositions(maxValue, blueNodes);
+
+    const int numNodes = gridSize * gridSize * gridSize;
+    QVector<quint8> grid(numNodes * srcCs->pixelSize());
+
+    if (data.sourceIs16Bit) {
+        fillGrid<quint16>(grid.data(), redNodes, greenNodes, blueNodes);
+    } else {
+        fillGrid<quint8>(grid.data(), redNodes, greenNodes, blueNodes);
+    }
+
+    data.lut.resize(numNodes * dstCs->pixelSize());
+    transformation->transform(grid.constData(), data.lut.data(), numNodes);
+
+    return new KoLut3DColorConversionTransformation(srcCs, dstCs,
+                                                    transformation->renderingIntent(),
+                                                    transformation->conversionFlags(),
+                                                    data);
+}
+
+void KoLut3DColorConversionTransformation::transform(const quint8 *src, quint8 *dst, qint32 nPixels) const
+{
+    if (d->sourceIs16Bit) {
+        d->applyLut<quint16>(src, dst, nPixels);
+    } else {
+        d->applyLut<quint8>(src, dst, nPixels);
+    }
+}
+
+KoColorConversionTransformation* KoLut3DColorConversionTransformation::clone() const
+{
+    return new KoLut3DColorConversionTransformation(srcColorSpace(), dstColorSpace(),
+                                                    renderingIntent(), conversionFlags(),
+                                                    *d);
+}
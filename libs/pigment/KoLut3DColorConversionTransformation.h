@@ -0,0 +1,93 @@
+/*
+ *  Copyright (c) 2020 Krita developers
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+*/
+
+#ifndef _KO_LUT3D_COLOR_CONVERSION_TRANSFORMATION_H_
+#define _KO_LUT3D_COLOR_CONVERSION_TRANSFORMATION_H_
+
+#include <KoColorConversionTransformation.h>
+
+#include "kritapigment_export.h"
+
+/**
+ * A color conversion that approximates another conversion with a 3D
+ * lookup table. The table is baked once by passing a grid of colors
+ * through the original transformation, then every pixel is converted
+ * with tetrahedral interpolation between the eight nearest nodes of
+ * the grid.
+ *
+ * The nodes are not spaced uniformly in the encoded values of the
+ * source: every channel has a shaper curve derived from the estimated
+ * TRC of the source profile, so that a linear source gets as many
+ * nodes in the dark tones as a perceptual one.
+ *
+ * It makes sense for the conversions that are expensive to calculate,
+ * but are used for a lot of pixels with the same settings, e.g. the
+ * conversion of the canvas to the display profile with soft-proofing.
+ * With the default grid the result usually stays within one level of
+ * an 8-bit channel from the original conversion, the exact error
+ * depends on how nonlinear the conversion is. The alpha channel is
+ * copied as is.
+ *
+ * Only RGBA 8-bit and 16-bit integer source color spaces with a profile
+ * and RGBA 8-bit destination color spaces are supported, see isSupported().
+ */
+class KRITAPIGMENT_EXPORT KoLut3DColorConversionTransformation : public KoColorConversionTransformation
+{
+public:
+    ~KoLut3DColorConversionTransformation() override;
+
+    /**
+     * @return true if a transformation between the given color spaces
+     *         can be baked into a lookup table
+     */
+    static bool isSupported(const KoColorSpace *srcCs, const KoColorSpace *dstCs);
+
+    /**
+     * The number of nodes of the grid along every axis
+     */
+    static int defaultGridSize();
+
+    /**
+     * Bakes \p transformation into a lookup table. The transformation is
+     * not used after the function returns, so it can be deleted.
+     *
+     * @return the new transformation or null if the color spaces of
+     *         \p transformation are not supported
+     */
+    static KoLut3DColorConversionTransformation* create(const KoColorConversionTransformation *transformation,
+                                                        int gridSize = defaultGridSize());
+
+    void transform(const quint8 *src, quint8 *dst, qint32 nPixels) const override;
+
+    /**
+     * The clones share the lookup table
+     */
+    KoColorConversionTransformation* clone() const override;
+
+private:
+    struct Private;
+    KoLut3DColorConversionTransformation(const KoColorSpace* srcCs,
+                                         const KoColorSpace* dstCs,
+                                         Intent renderingIntent,
+                                         ConversionFlags conversionFlags,
+                                         const Private &data);
+    Private* const d;
+};
+
+#endif
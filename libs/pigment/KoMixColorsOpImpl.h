@@ -46,7 +46,9 @@ public:
         mixColorsImpl(PointerToArray(colors, _CSTrait::pixelSize), NoWeightsSurrogate(nColors), nColors, dst);
     }
 
-private:
+protected:
+    typedef typename KoColorSpaceMathsTraits<typename _CSTrait::channels_type>::compositetype compositetype;
+
     struct ArrayOfPointers {
         ArrayOfPointers(const quint8 * const* colors)
             : m_colors(colors)
@@ -166,9 +168,16 @@ private:
             weightsWrapper.nextPixel();
         }
 
-        // set totalAlpha to the minimum between its value and the unit value of the channels
-        const int sumOfWeights = weightsWrapper.normalizeFactor();
+        storeMixedColor(totals, totalAlpha, weightsWrapper.normalizeFactor(), dst);
+    }
 
+    /**
+     * Divides the accumulated \p totals by \p totalAlpha and writes the
+     * result into \p dst. Shared with the vectorized implementations, so
+     * that they produce exactly the same values.
+     */
+    static void storeMixedColor(const compositetype *totals, compositetype totalAlpha, int sumOfWeights, quint8 *dst) {
+        // set totalAlpha to the minimum between its value and the unit value of the channels
         if (totalAlpha > KoColorSpaceMathsTraits<typename _CSTrait::channels_type>::unitValue * sumOfWeights) {
             totalAlpha = KoColorSpaceMathsTraits<typename _CSTrait::channels_type>::unitValue * sumOfWeights;
         }
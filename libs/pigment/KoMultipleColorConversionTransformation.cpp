@@ -68,3 +68,20 @@ void KoMultipleColorConversionTransformation::transform(const quint8 *src, quint
     delete [] buff2;
     delete [] buff1;
 }
+
+KoColorConversionTransformation* KoMultipleColorConversionTransformation::clone() const
+{
+    KoMultipleColorConversionTransformation *chain =
+        new KoMultipleColorConversionTransformation(srcColorSpace(), dstColorSpace(), renderingIntent(), conversionFlags());
+
+    Q_FOREACH (KoColorConversionTransformation* transfo, d->transfos) {
+        KoColorConversionTransformation *copy = transfo->clone();
+        if (!copy) {
+            delete chain;
+            return 0;
+        }
+        chain->appendTransfo(copy);
+    }
+
+    return chain;
+}
@@ -50,6 +50,11 @@ public:
      */
     void appendTransfo(KoColorConversionTransformation* transfo);
     void transform(const quint8 *src, quint8 *dst, qint32 nPixels) const override;
+
+    /**
+     * The chain can be cloned only if all its transformations can
+     */
+    KoColorConversionTransformation* clone() const override;
 private:
     struct Private;
     Private* const d;
@@ -0,0 +1,206 @@
+/*
+ *  Copyright (c) 2020 Krita developers
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include "KoMixColorsOpsBenchmark.h"
+
+#include <KoColorSpaceTraits.h>
+#include <KoColorSpaceMaths.h>
+#include <KoMixColorsOpImpl.h>
+#include <KoConvolutionOpImpl.h>
+#include <KoOptimizedPixelOpsFactory.h>
+
+#include <numeric>
+
+#include <QBitArray>
+#include <QScopedPointer>
+#include <QTest>
+#include <QVector>
+
+/**
+ * The number of pixels mixed in a single call is typical for the color
+ * smudge brush (mixColors) and for a 5x5 blur kernel (convolveColors)
+ */
+const int NUM_PIXELS_MIX = 1024;
+const int NUM_PIXELS_CONVOLVE = 25;
+
+const int NUM_ITERATIONS = 2048;
+
+/**
+ * The largest pixel we benchmark is 4 x float
+ */
+const int BUFFER_SIZE = NUM_PIXELS_MIX * KoRgbF32Traits::pixelSize;
+
+namespace {
+
+template<class Traits>
+void fillRandomPixels(quint8 *buffer, int numPixels)
+{
+    typedef typename Traits::channels_type channels_type;
+    channels_type *pixels = Traits::nativeArray(buffer);
+
+    for (int i = 0; i < numPixels * int(Traits::channels_nb); i++) {
+        pixels[i] = KoColorSpaceMaths<quint8, channels_type>::scaleToA(quint8(qrand() & 0xff));
+    }
+}
+
+struct OpsSet {
+    int pixelSize;
+    KoMixColorsOp *mixOp;
+    KoConvolutionOp *convolutionOp;
+};
+
+OpsSet createOps(const QString &depth, bool optimized)
+{
+    if (depth == "U8") {
+        return {int(KoBgrU8Traits::pixelSize),
+                optimized ? KoOptimizedPixelOpsFactory::createMixColorsOp32() : new KoMixColorsOpImpl<KoBgrU8Traits>(),
+                optimized ? KoOptimizedPixelOpsFactory::createConvolutionOp32() : new KoConvolutionOpImpl<KoBgrU8Traits>()};
+    } else if (depth == "U16") {
+        return {int(KoBgrU16Traits::pixelSize),
+                optimized ? KoOptimizedPixelOpsFactory::createMixColorsOp64() : new KoMixColorsOpImpl<KoBgrU16Traits>(),
+                optimized ? KoOptimizedPixelOpsFactory::createConvolutionOp64() : new KoConvolutionOpImpl<KoBgrU16Traits>()};
+    }
+
+    return {int(KoRgbF32Traits::pixelSize),
+            optimized ? KoOptimizedPixelOpsFactory::createMixColorsOp128() : new KoMixColorsOpImpl<KoRgbF32Traits>(),
+            optimized ? KoOptimizedPixelOpsFactory::createConvolutionOp128() : new KoConvolutionOpImpl<KoRgbF32Traits>()};
+}
+
+void addRows()
+{
+    QTest::addColumn<QString>("depth");
+    QTest::addColumn<bool>("optimized");
+
+    QTest::newRow("U8, scalar") << "U8" << false;
+    QTest::newRow("U8, optimized") << "U8" << true;
+    QTest::newRow("U16, scalar") << "U16" << false;
+    QTest::newRow("U16, optimized") << "U16" << true;
+    QTest::newRow("F32, scalar") << "F32" << false;
+    QTest::newRow("F32, optimized") << "F32" << true;
+}
+
+}
+
+void KoMixColorsOpsBenchmark::initTestCase()
+{
+    m_buffer = new quint8[BUFFER_SIZE];
+
+    qsrand(42);
+
+    /**
+     * The buffer is filled for the largest pixel size, the
+     * smaller depths just read random bytes of it
+     */
+    fillRandomPixels<KoRgbF32Traits>(m_buffer, NUM_PIXELS_MIX);
+}
+
+void KoMixColorsOpsBenchmark::cleanupTestCase()
+{
+    delete[] m_buffer;
+}
+
+void KoMixColorsOpsBenchmark::benchmarkMixColors_data()
+{
+    addRows();
+}
+
+void KoMixColorsOpsBenchmark::benchmarkMixColors()
+{
+    QFETCH(QString, depth);
+    QFETCH(bool, optimized);
+
+    OpsSet ops = createOps(depth, optimized);
+    QScopedPointer<KoMixColorsOp> mixOp(ops.mixOp);
+    QScopedPointer<KoConvolutionOp> convolutionOp(ops.convolutionOp);
+
+    quint8 dst[16];
+
+    QBENCHMARK {
+        for (int i = 0; i < NUM_ITERATIONS; i++) {
+            mixOp->mixColors(m_buffer, NUM_PIXELS_MIX, dst);
+        }
+    }
+}
+
+void KoMixColorsOpsBenchmark::benchmarkMixColorsWeighted_data()
+{
+    addRows();
+}
+
+void KoMixColorsOpsBenchmark::benchmarkMixColorsWeighted()
+{
+    QFETCH(QString, depth);
+    QFETCH(bool, optimized);
+
+    OpsSet ops = createOps(depth, optimized);
+    QScopedPointer<KoMixColorsOp> mixOp(ops.mixOp);
+    QScopedPointer<KoConvolutionOp> convolutionOp(ops.convolutionOp);
+
+    const int numPixels = NUM_PIXELS_CONVOLVE;
+
+    QVector<const quint8*> colors;
+    QVector<qint16> weights;
+
+    for (int i = 0; i < numPixels; i++) {
+        colors << m_buffer + i * ops.pixelSize;
+        weights << ((i % 5) + 1);
+    }
+    weights[0] += 255 - std::accumulate(weights.begin(), weights.end(), 0);
+
+    quint8 dst[16];
+
+    QBENCHMARK {
+        for (int i = 0; i < NUM_ITERATIONS * 32; i++) {
+            mixOp->mixColors(colors.constData(), weights.constData(), numPixels, dst);
+        }
+    }
+}
+
+void KoMixColorsOpsBenchmark::benchmarkConvolveColors_data()
+{
+    addRows();
+}
+
+void KoMixColorsOpsBenchmark::benchmarkConvolveColors()
+{
+    QFETCH(QString, depth);
+    QFETCH(bool, optimized);
+
+    OpsSet ops = createOps(depth, optimized);
+    QScopedPointer<KoMixColorsOp> mixOp(ops.mixOp);
+    QScopedPointer<KoConvolutionOp> convolutionOp(ops.convolutionOp);
+
+    QVector<const quint8*> colors;
+    QVector<qreal> kernel;
+
+    for (int i = 0; i < NUM_PIXELS_CONVOLVE; i++) {
+        colors << m_buffer + i * ops.pixelSize;
+        kernel << 1.0 / NUM_PIXELS_CONVOLVE;
+    }
+
+    quint8 dst[16];
+
+    QBENCHMARK {
+        for (int i = 0; i < NUM_ITERATIONS * 32; i++) {
+            convolutionOp->convolveColors(colors.constData(), kernel.constData(), dst, 1.0, 0.0, NUM_PIXELS_CONVOLVE, QBitArray());
+        }
+    }
+}
+
+QTEST_GUILESS_MAIN(KoMixColorsOpsBenchmark)
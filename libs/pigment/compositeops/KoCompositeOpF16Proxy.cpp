@@ -0,0 +1,89 @@
+/*
+ *  Copyright (c) 2020 Krita developers
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+*/
+
+#include "KoCompositeOpF16Proxy.h"
+
+#ifdef HAVE_OPENEXR
+
+#include <QVector>
+
+#include <KoColorSpace.h>
+#include "KoHalfConversion.h"
+
+
+KoCompositeOpF16Proxy::KoCompositeOpF16Proxy(const KoColorSpace *cs, KoCompositeOp *floatOp)
+    : KoCompositeOp(cs, floatOp->id(), floatOp->description(), floatOp->category()),
+      m_floatOp(floatOp)
+{
+}
+
+KoCompositeOpF16Proxy::~KoCompositeOpF16Proxy()
+{
+}
+
+void KoCompositeOpF16Proxy::composite(const KoCompositeOp::ParameterInfo& params) const
+{
+    const int channelCount = colorSpace()->channelCount();
+    const int rowValues = params.cols * channelCount;
+    const bool constantSource = params.srcRowStride == 0;
+    const int srcValues = constantSource ? channelCount : rowValues;
+
+    QVector<float> srcRow(srcValues);
+    QVector<float> dstRow(rowValues);
+
+    KoCompositeOp::ParameterInfo floatParams(params);
+    floatParams.dstRowStart = reinterpret_cast<quint8*>(dstRow.data());
+    floatParams.dstRowStride = rowValues * sizeof(float);
+    floatParams.srcRowStart = reinterpret_cast<const quint8*>(srcRow.data());
+    floatParams.srcRowStride = constantSource ? 0 : rowValues * sizeof(float);
+    floatParams.rows = 1;
+
+    const quint8 *srcRowStart = params.srcRowStart;
+    quint8 *dstRowStart = params.dstRowStart;
+    const quint8 *maskRowStart = params.maskRowStart;
+
+    if (constantSource) {
+        KoHalfConversion::halfToFloat(reinterpret_cast<const half*>(srcRowStart),
+                                      srcRow.data(), srcValues);
+    }
+
+    for (qint32 row = 0; row < params.rows; row++) {
+        if (!constantSource) {
+            KoHalfConversion::halfToFloat(reinterpret_cast<const half*>(srcRowStart),
+                                          srcRow.data(), srcValues);
+        }
+
+        KoHalfConversion::halfToFloat(reinterpret_cast<const half*>(dstRowStart),
+                                      dstRow.data(), rowValues);
+
+        floatParams.maskRowStart = maskRowStart;
+        m_floatOp->composite(floatParams);
+
+        KoHalfConversion::floatToHalf(dstRow.data(),
+                                      reinterpret_cast<half*>(dstRowStart), rowValues);
+
+        srcRowStart += params.srcRowStride;
+        dstRowStart += params.dstRowStride;
+        if (maskRowStart) {
+            maskRowStart += params.maskRowStride;
+        }
+    }
+}
+
+#endif /* HAVE_OPENEXR */
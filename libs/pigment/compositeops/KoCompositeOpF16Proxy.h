@@ -0,0 +1,67 @@
+/*
+ *  Copyright (c) 2020 Krita developers
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+*/
+
+#ifndef KOCOMPOSITEOPF16PROXY_H
+#define KOCOMPOSITEOPF16PROXY_H
+
+#include <KoConfig.h>
+
+#ifdef HAVE_OPENEXR
+
+#include <QScopedPointer>
+
+#include <KoCompositeOp.h>
+#include "kritapigment_export.h"
+
+/**
+ * Runs a composite op written for the F32 version of a color space on
+ * the pixels of its F16 version. Every row of the source and the
+ * destination is converted to float in one batch (see KoHalfConversion),
+ * composited by the F32 op and converted back. It avoids the per-channel
+ * half <-> float conversions the generic templated ops do for every
+ * arithmetic operation.
+ *
+ * The F32 op is not necessarily vectorized: OptimizedOpsSelector gives a
+ * vectorized Over op, but the generic KoCompositeOpAlphaDarken, because
+ * the vectorized Alpha Darken of F32 is disabled (bug 404133).
+ *
+ * The channel layout of both color spaces must be the same, only the
+ * channel type differs.
+ */
+class KRITAPIGMENT_EXPORT KoCompositeOpF16Proxy : public KoCompositeOp
+{
+public:
+    /**
+     * @param cs the F16 color space the op is created for
+     * @param floatOp the op compositing float pixels with the same
+     *                channels layout. The proxy takes the ownership of it.
+     */
+    KoCompositeOpF16Proxy(const KoColorSpace *cs, KoCompositeOp *floatOp);
+    ~KoCompositeOpF16Proxy() override;
+
+    using KoCompositeOp::composite;
+    void composite(const KoCompositeOp::ParameterInfo& params) const override;
+
+private:
+    QScopedPointer<KoCompositeOp> m_floatOp;
+};
+
+#endif /* HAVE_OPENEXR */
+
+#endif /* KOCOMPOSITEOPF16PROXY_H */
@@ -40,6 +40,7 @@
 #include "compositeops/KoCompositeOpGreater.h"
 #include "compositeops/KoAlphaDarkenParamsWrapper.h"
 #include "KoOptimizedCompositeOpFactory.h"
+#include "compositeops/KoCompositeOpF16Proxy.h"
 
 namespace _Private {
 
@@ -114,6 +115,23 @@ struct OptimizedOpsSelector<KoRgbF32Traits>
     }
 };
 
+#ifdef HAVE_OPENEXR
+/**
+ * The F16 ops run the F32 ones above on rows converted to float. Only
+ * the Over op is vectorized there, Alpha Darken is the generic one.
+ */
+template<>
+struct OptimizedOpsSelector<KoRgbF16Traits>
+{
+    static KoCompositeOp* createAlphaDarkenOp(const KoColorSpace *cs) {
+        return new KoCompositeOpF16Proxy(cs, OptimizedOpsSelector<KoRgbF32Traits>::createAlphaDarkenOp(cs));
+    }
+    static KoCompositeOp* createOverOp(const KoColorSpace *cs) {
+        return new KoCompositeOpF16Proxy(cs, OptimizedOpsSelector<KoRgbF32Traits>::createOverOp(cs));
+    }
+};
+#endif
+
 template<class Traits>
 struct AddGeneralOps<Traits, true>
 {
@@ -0,0 +1,214 @@
+/*
+ *  Copyright (c) 2020 Krita developers
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef KOOPTIMIZEDPIXELOPS_H
+#define KOOPTIMIZEDPIXELOPS_H
+
+#include "KoVcMultiArchBuildSupport.h"
+
+#include <cstring>
+
+#include "KoColorSpaceMaths.h"
+#include "KoMixColorsOpImpl.h"
+#include "KoConvolutionOpImpl.h"
+
+
+/**
+ * Loads all four channels of an RGBA pixel into the lanes of a single
+ * vector. load() returns the vector the mixing op accumulates in, it
+ * is wide enough to keep the sums exact. loadReal() returns qreal lanes
+ * for the convolution op.
+ */
+template<Vc::Implementation _impl, typename channels_type>
+struct KoRgbaPixelLoader;
+
+template<Vc::Implementation _impl>
+struct KoRgbaPixelLoader<_impl, quint8>
+{
+    typedef qint32 lane_type;
+    typedef Vc::SimdArray<qint32, 4> vector_type;
+    typedef Vc::SimdArray<qreal, 4> real_vector_type;
+
+    static inline vector_type load(const quint8 *pixel) {
+        quint32 value;
+        memcpy(&value, pixel, sizeof(quint32));
+
+        /**
+         * The shift is arithmetic, but the mask drops
+         * the replicated sign bits anyway
+         */
+        return (vector_type(qint32(value)) >> (vector_type::IndexesFromZero() * 8)) & vector_type(0xff);
+    }
+
+    static inline real_vector_type loadReal(const quint8 *pixel) {
+        return Vc::simd_cast<real_vector_type>(load(pixel));
+    }
+};
+
+template<Vc::Implementation _impl>
+struct KoRgbaPixelLoader<_impl, quint16>
+{
+    /**
+     * The totals of 16-bit channels do not fit into 32 bits and SSE/AVX
+     * have no 64-bit integer multiplication, so we accumulate in doubles.
+     * They are still exact, because the sums are much smaller than 2^53.
+     */
+    typedef qreal lane_type;
+    typedef Vc::SimdArray<qreal, 4> vector_type;
+    typedef Vc::SimdArray<qreal, 4> real_vector_type;
+
+    static inline vector_type load(const quint16 *pixel) {
+        return Vc::simd_cast<vector_type>(Vc::SimdArray<qint32, 4>(pixel, Vc::Unaligned));
+    }
+
+    static inline real_vector_type loadReal(const quint16 *pixel) {
+        return load(pixel);
+    }
+};
+
+template<Vc::Implementation _impl>
+struct KoRgbaPixelLoader<_impl, float>
+{
+    typedef qreal lane_type;
+    typedef Vc::SimdArray<qreal, 4> vector_type;
+    typedef Vc::SimdArray<qreal, 4> real_vector_type;
+
+    static inline vector_type load(const float *pixel) {
+        return Vc::simd_cast<vector_type>(Vc::SimdArray<float, 4>(pixel, Vc::Unaligned));
+    }
+
+    static inline real_vector_type loadReal(const float *pixel) {
+        return load(pixel);
+    }
+};
+
+/**
+ * A mixing op for 4-channel spaces with alpha in the last channel. All
+ * the channels of a pixel are multiplied and accumulated with a single
+ * vector instruction. The lanes sum up in the same order as the scalar
+ * version does and the final division is shared with it, so the results
+ * are exactly the same as the ones of KoMixColorsOpImpl.
+ */
+template<Vc::Implementation _impl, class _CSTrait>
+class KoOptimizedMixColorsOp : public KoMixColorsOpImpl<_CSTrait>
+{
+    typedef KoMixColorsOpImpl<_CSTrait> BaseClass;
+    typedef typename _CSTrait::channels_type channels_type;
+    typedef typename KoColorSpaceMathsTraits<channels_type>::compositetype compositetype;
+    typedef KoRgbaPixelLoader<_impl, channels_type> Loader;
+    typedef typename Loader::lane_type lane_type;
+    typedef typename Loader::vector_type vector_type;
+
+    static_assert(_CSTrait::channels_nb == 4 && _CSTrait::alpha_pos == 3,
+                  "KoOptimizedMixColorsOp supports RGBA color spaces only");
+
+public:
+    void mixColors(const quint8 * const* colors, const qint16 *weights, quint32 nColors, quint8 *dst) const override {
+        mixColorsImpl(typename BaseClass::ArrayOfPointers(colors), typename BaseClass::WeightsWrapper(weights), nColors, dst);
+    }
+
+    void mixColors(const quint8 *colors, const qint16 *weights, quint32 nColors, quint8 *dst) const override {
+        mixColorsImpl(typename BaseClass::PointerToArray(colors, _CSTrait::pixelSize), typename BaseClass::WeightsWrapper(weights), nColors, dst);
+    }
+
+    void mixColors(const quint8 * const* colors, quint32 nColors, quint8 *dst) const override {
+        mixColorsImpl(typename BaseClass::ArrayOfPointers(colors), typename BaseClass::NoWeightsSurrogate(nColors), nColors, dst);
+    }
+
+    void mixColors(const quint8 *colors, quint32 nColors, quint8 *dst) const override {
+        mixColorsImpl(typename BaseClass::PointerToArray(colors, _CSTrait::pixelSize), typename BaseClass::NoWeightsSurrogate(nColors), nColors, dst);
+    }
+
+private:
+    template<class AbstractSource, class WeightsWrapper>
+    void mixColorsImpl(AbstractSource source, WeightsWrapper weightsWrapper, quint32 nColors, quint8 *dst) const {
+        vector_type totals(Vc::Zero);
+        compositetype totalAlpha = 0;
+
+        while (nColors--) {
+            const channels_type *color = _CSTrait::nativeArray(source.getPixel());
+
+            compositetype alphaTimesWeight = color[_CSTrait::alpha_pos];
+            weightsWrapper.premultiplyAlphaWithWeight(alphaTimesWeight);
+
+            // the alpha lane is accumulated as well, but is never used
+            totals += Loader::load(color) * vector_type(lane_type(alphaTimesWeight));
+            totalAlpha += alphaTimesWeight;
+
+            source.nextPixel();
+            weightsWrapper.nextPixel();
+        }
+
+        lane_type lanes[_CSTrait::channels_nb];
+        totals.store(lanes, Vc::Unaligned);
+
+        compositetype unpackedTotals[_CSTrait::channels_nb];
+        for (int i = 0; i < (int)_CSTrait::channels_nb; i++) {
+            unpackedTotals[i] = lanes[i];
+        }
+
+        BaseClass::storeMixedColor(unpackedTotals, totalAlpha, weightsWrapper.normalizeFactor(), dst);
+    }
+};
+
+/**
+ * A convolution op for 4-channel spaces with alpha in the last channel.
+ * The weighted sum of every pixel is calculated with a single vector
+ * multiply-add, the final (per-call) division is shared with
+ * KoConvolutionOpImpl.
+ */
+template<Vc::Implementation _impl, class _CSTrait>
+class KoOptimizedConvolutionOp : public KoConvolutionOpImpl<_CSTrait>
+{
+    typedef KoConvolutionOpImpl<_CSTrait> BaseClass;
+    typedef typename _CSTrait::channels_type channels_type;
+    typedef KoRgbaPixelLoader<_impl, channels_type> Loader;
+    typedef typename Loader::real_vector_type vector_type;
+
+    static_assert(_CSTrait::channels_nb == 4 && _CSTrait::alpha_pos == 3,
+                  "KoOptimizedConvolutionOp supports RGBA color spaces only");
+
+public:
+    void convolveColors(const quint8* const* colors, const qreal* kernelValues, quint8 *dst, qreal factor, qreal offset, qint32 nPixels, const QBitArray & channelFlags) const override {
+
+        vector_type totals(Vc::Zero);
+
+        qreal totalWeight = 0;
+        qreal totalWeightTransparent = 0;
+
+        for (; nPixels--; colors++, kernelValues++) {
+            qreal weight = *kernelValues;
+            if (weight != 0) {
+                if (_CSTrait::opacityU8(*colors) == 0) {
+                    totalWeightTransparent += weight;
+                } else {
+                    totals += Loader::loadReal(_CSTrait::nativeArray(*colors)) * vector_type(weight);
+                }
+                totalWeight += weight;
+            }
+        }
+
+        qreal unpackedTotals[_CSTrait::channels_nb];
+        totals.store(unpackedTotals, Vc::Unaligned);
+
+        BaseClass::storeConvolvedColor(unpackedTotals, totalWeight, totalWeightTransparent, dst, factor, offset, channelFlags);
+    }
+};
+
+#endif /* KOOPTIMIZEDPIXELOPS_H */
@@ -0,0 +1,52 @@
+/*
+ *  Copyright (c) 2020 Krita developers
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef KOOPTIMIZEDPIXELOPSFACTORY_H
+#define KOOPTIMIZEDPIXELOPSFACTORY_H
+
+#include "kritapigment_export.h"
+
+class KoMixColorsOp;
+class KoConvolutionOp;
+
+/**
+ * Creates the vectorized versions of the mixing and convolution ops
+ * for the RGBA color spaces. The implementation for the current CPU
+ * is selected in runtime, the same way as KoOptimizedCompositeOpFactory
+ * does for the composite ops.
+ *
+ * The suffix is the size of the pixel in bits:
+ *
+ * 32  --- KoBgrU8Traits
+ * 64  --- KoBgrU16Traits
+ * 128 --- KoRgbF32Traits
+ */
+class KRITAPIGMENT_EXPORT KoOptimizedPixelOpsFactory
+{
+public:
+    static KoMixColorsOp* createMixColorsOp32();
+    static KoMixColorsOp* createMixColorsOp64();
+    static KoMixColorsOp* createMixColorsOp128();
+
+    static KoConvolutionOp* createConvolutionOp32();
+    static KoConvolutionOp* createConvolutionOp64();
+    static KoConvolutionOp* createConvolutionOp128();
+};
+
+#endif /* KOOPTIMIZEDPIXELOPSFACTORY_H */
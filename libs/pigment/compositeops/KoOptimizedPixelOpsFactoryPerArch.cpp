@@ -0,0 +1,54 @@
+/*
+ *  Copyright (c) 2020 Krita developers
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#if !defined _MSC_VER
+#pragma GCC diagnostic ignored "-Wundef"
+#endif
+
+#include "KoOptimizedPixelOpsFactoryPerArch.h"
+#include "KoOptimizedPixelOps.h"
+
+#include "KoColorSpaceTraits.h"
+
+#if defined(__clang__)
+#pragma GCC diagnostic ignored "-Wlocal-type-template-args"
+#endif
+
+#define DEFINE_PIXEL_OPS_FACTORIES(_CSTrait)                                          \
+    template<>                                                                        \
+    template<>                                                                        \
+    KoOptimizedMixColorsOpFactoryPerArch<_CSTrait>::ReturnType                        \
+    KoOptimizedMixColorsOpFactoryPerArch<_CSTrait>::create<Vc::CurrentImplementation::current()>(ParamType) \
+    {                                                                                 \
+        return new KoOptimizedMixColorsOp<Vc::CurrentImplementation::current(), _CSTrait>(); \
+    }                                                                                 \
+                                                                                      \
+    template<>                                                                        \
+    template<>                                                                        \
+    KoOptimizedConvolutionOpFactoryPerArch<_CSTrait>::ReturnType                      \
+    KoOptimizedConvolutionOpFactoryPerArch<_CSTrait>::create<Vc::CurrentImplementation::current()>(ParamType) \
+    {                                                                                 \
+        return new KoOptimizedConvolutionOp<Vc::CurrentImplementation::current(), _CSTrait>(); \
+    }
+
+DEFINE_PIXEL_OPS_FACTORIES(KoBgrU8Traits)
+DEFINE_PIXEL_OPS_FACTORIES(KoBgrU16Traits)
+DEFINE_PIXEL_OPS_FACTORIES(KoRgbF32Traits)
+
+#undef DEFINE_PIXEL_OPS_FACTORIES
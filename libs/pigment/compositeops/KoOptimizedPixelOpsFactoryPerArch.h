@@ -0,0 +1,61 @@
+/*
+ *  Copyright (c) 2020 Krita developers
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef KOOPTIMIZEDPIXELOPSFACTORYPERARCH_H
+#define KOOPTIMIZEDPIXELOPSFACTORYPERARCH_H
+
+
+#include <compositeops/KoVcMultiArchBuildSupport.h>
+
+
+class KoMixColorsOp;
+class KoConvolutionOp;
+
+template<Vc::Implementation _impl, class _CSTrait>
+class KoOptimizedMixColorsOp;
+
+template<Vc::Implementation _impl, class _CSTrait>
+class KoOptimizedConvolutionOp;
+
+/**
+ * The ops have no construction parameters, so ParamType is a dummy
+ * needed by createOptimizedClass() only
+ */
+template<class _CSTrait>
+struct KoOptimizedMixColorsOpFactoryPerArch
+{
+    typedef int ParamType;
+    typedef KoMixColorsOp* ReturnType;
+
+    template<Vc::Implementation _impl>
+    static ReturnType create(ParamType);
+};
+
+template<class _CSTrait>
+struct KoOptimizedConvolutionOpFactoryPerArch
+{
+    typedef int ParamType;
+    typedef KoConvolutionOp* ReturnType;
+
+    template<Vc::Implementation _impl>
+    static ReturnType create(ParamType);
+};
+
+
+#endif /* KOOPTIMIZEDPIXELOPSFACTORYPERARCH_H */
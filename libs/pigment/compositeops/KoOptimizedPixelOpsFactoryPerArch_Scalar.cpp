@@ -0,0 +1,48 @@
+/*
+ *  Copyright (c) 2020 Krita developers
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include "KoOptimizedPixelOpsFactoryPerArch.h"
+
+#include "KoColorSpaceTraits.h"
+#include "KoColorSpaceMaths.h"
+#include "KoMixColorsOpImpl.h"
+#include "KoConvolutionOpImpl.h"
+
+#define DEFINE_PIXEL_OPS_FACTORIES(_CSTrait)                                          \
+    template<>                                                                        \
+    template<>                                                                        \
+    KoOptimizedMixColorsOpFactoryPerArch<_CSTrait>::ReturnType                        \
+    KoOptimizedMixColorsOpFactoryPerArch<_CSTrait>::create<Vc::ScalarImpl>(ParamType) \
+    {                                                                                 \
+        return new KoMixColorsOpImpl<_CSTrait>();                                     \
+    }                                                                                 \
+                                                                                      \
+    template<>                                                                        \
+    template<>                                                                        \
+    KoOptimizedConvolutionOpFactoryPerArch<_CSTrait>::ReturnType                      \
+    KoOptimizedConvolutionOpFactoryPerArch<_CSTrait>::create<Vc::ScalarImpl>(ParamType) \
+    {                                                                                 \
+        return new KoConvolutionOpImpl<_CSTrait>();                                   \
+    }
+
+DEFINE_PIXEL_OPS_FACTORIES(KoBgrU8Traits)
+DEFINE_PIXEL_OPS_FACTORIES(KoBgrU16Traits)
+DEFINE_PIXEL_OPS_FACTORIES(KoRgbF32Traits)
+
+#undef DEFINE_PIXEL_OPS_FACTORIES
@@ -115,6 +115,8 @@ bool KoPattern::savePatToDevice(QIODevice* dev) const
     // We only save RGBA at the moment
     // Version is 1 for now...
 
+    const QImage image = pattern();
+
     GimpPatternHeader ph;
     QByteArray utf8Name = name().toUtf8();
     char const* name = utf8Name.data();
@@ -122,8 +124,8 @@ bool KoPattern::savePatToDevice(QIODevice* dev) const
 
     ph.header_size = qToBigEndian((quint32)sizeof(GimpPatternHeader) + nameLength + 1); // trailing 0
     ph.version = qToBigEndian((quint32)1);
-    ph.width = qToBigEndian((quint32)width());
-    ph.height = qToBigEndian((quint32)height());
+    ph.width = qToBigEndian((quint32)image.width());
+    ph.height = qToBigEndian((quint32)image.height());
     ph.bytes = qToBigEndian((quint32)4);
     ph.magic_number = qToBigEndian((quint32)GimpPatternMagic);
 
@@ -139,11 +141,11 @@ bool KoPattern::savePatToDevice(QIODevice* dev) const
         return false;
 
     int k = 0;
-    bytes.resize(width() * height() * 4);
-    for (qint32 y = 0; y < height(); ++y) {
-        for (qint32 x = 0; x < width(); ++x) {
+    bytes.resize(image.width() * image.height() * 4);
+    for (qint32 y = 0; y < image.height(); ++y) {
+        for (qint32 x = 0; x < image.width(); ++x) {
             // RGBA only
-            QRgb pixel = m_pattern.pixel(x, y);
+            QRgb pixel = image.pixel(x, y);
             bytes[k++] = static_cast<char>(qRed(pixel));
             bytes[k++] = static_cast<char>(qGreen(pixel));
             bytes[k++] = static_cast<char>(qBlue(pixel));
@@ -204,6 +206,11 @@ bool KoPattern::saveToDevice(QIODevice *dev) const
     if (index != -1)
         fileExtension = filename().mid(index + 1).toLower();
 
+    DataLocker locker(this);
+    if (!locker.isLoaded()) {
+        return false;
+    }
+
     if (fileExtension == "pat") {
         return savePatToDevice(dev);
     }
@@ -356,11 +363,13 @@ bool KoPattern::init(QByteArray& bytes)
 
 qint32 KoPattern::width() const
 {
+    DataLocker locker(this);
     return m_pattern.width();
 }
 
 qint32 KoPattern::height() const
 {
+    DataLocker locker(this);
     return m_pattern.height();
 }
 
@@ -394,6 +403,22 @@ KoPattern* KoPattern::clone() const
 
 QImage KoPattern::pattern() const
 {
+    DataLocker locker(this);
     return m_pattern;
 }
 
+bool KoPattern::supportsLazyLoading() const
+{
+    return true;
+}
+
+void KoPattern::unloadData()
+{
+    m_pattern = QImage();
+}
+
+qint64 KoPattern::dataSize() const
+{
+    return m_pattern.byteCount();
+}
+
@@ -64,6 +64,12 @@ public:
      */
     QImage pattern() const;
 
+    bool supportsLazyLoading() const override;
+
+protected:
+    void unloadData() override;
+    qint64 dataSize() const override;
+
 private:
 
     bool init(QByteArray& data);
@@ -27,16 +27,9 @@
 
 #include "KoHashGenerator.h"
 #include "KoHashGeneratorProvider.h"
-
-struct Q_DECL_HIDDEN KoResource::Private {
-    QString name;
-    QString filename;
-    bool valid;
-    bool removable;
-    QByteArray md5;
-    QImage image;
-    bool permanent;
-};
+#include "KoResourceCache.h"
+#include "KoResource_p.h"
+#include "kis_assert.h"
 
 KoResource::KoResource(const QString& filename)
     : d(new Private)
@@ -46,10 +39,18 @@ KoResource::KoResource(const QString& filename)
     QFileInfo fileInfo(filename);
     d->removable = fileInfo.isWritable();
     d->permanent = false;
+    d->isLazy = false;
 }
 
 KoResource::~KoResource()
 {
+    if (d->isLazy) {
+        // the cache may be already destroyed on exit
+        KoResourceCache *cache = KoResourceCache::instance();
+        if (cache) {
+            cache->remove(this);
+        }
+    }
     delete d;
 }
 
@@ -162,3 +163,65 @@ void KoResource::setPermanent(bool permanent)
     d->permanent = permanent;
 }
 
+bool KoResource::supportsLazyLoading() const
+{
+    return false;
+}
+
+void KoResource::setLazyLoaded(const QString &name, const QByteArray &md5, const QImage &thumbnail)
+{
+    KIS_SAFE_ASSERT_RECOVER_RETURN(supportsLazyLoading());
+
+    d->name = name;
+    d->md5 = md5;
+    d->image = thumbnail;
+    d->valid = true;
+    d->isLazy = true;
+    d->lazyState.isLoaded.storeRelease(0);
+}
+
+bool KoResource::isLoaded() const
+{
+    return d->lazyState.isLoaded.loadAcquire();
+}
+
+bool KoResource::lockData() const
+{
+    return KoResourceCache::instance()->lockData(const_cast<KoResource*>(this));
+}
+
+void KoResource::unlockData() const
+{
+    KoResourceCache::instance()->unlockData(const_cast<KoResource*>(this));
+}
+
+KoResource::DataLocker::DataLocker(const KoResource *resource)
+    : m_resource(resource),
+      m_isLocked(resource->d->isLazy),
+      m_isLoaded(true)
+{
+    if (m_isLocked) {
+        m_isLoaded = m_resource->lockData();
+    }
+}
+
+KoResource::DataLocker::~DataLocker()
+{
+    if (m_isLocked) {
+        m_resource->unlockData();
+    }
+}
+
+bool KoResource::DataLocker::isLoaded() const
+{
+    return m_isLoaded;
+}
+
+void KoResource::unloadData()
+{
+}
+
+qint64 KoResource::dataSize() const
+{
+    return 0;
+}
@@ -101,18 +101,81 @@ public:
     bool permanent() const;
     void setPermanent(bool permanent);
 
+    /**
+     * Call this when the contents of the resource change so the md5 needs
+     * to be recalculated. The resource servers also use it to restore the
+     * md5 of the unchanged resource files from their index.
+     */
+    void setMD5(const QByteArray &md5);
+
+    /// @return true if the resource can be registered with setLazyLoaded()
+    virtual bool supportsLazyLoading() const;
+
+    /**
+     * Sets up the resource without reading its file. The name, the md5
+     * and the thumbnail (usually taken from the index of the resource
+     * server) are set and the resource is marked as valid. The data of
+     * the resource is loaded on first use, see DataLocker.
+     *
+     * Lazily loaded resources are tracked by KoResourceCache, which
+     * frees the data of the least recently used ones when they take
+     * too much memory.
+     */
+    void setLazyLoaded(const QString &name, const QByteArray &md5, const QImage &thumbnail);
+
+    /// @return false if the data of a lazily loaded resource is not in memory
+    bool isLoaded() const;
+
 protected:
 
     /// override generateMD5 and in your resource subclass
     virtual QByteArray generateMD5() const;
 
-    /// call this when the contents of the resource change so the md5 needs to be recalculated
-    void setMD5(const QByteArray &md5);
+    /**
+     * Loads the data of a lazily loaded resource if it is not in memory
+     * yet and keeps KoResourceCache from freeing it while the locker
+     * exists. The name, the md5 and the thumbnail are kept.
+     *
+     * The accessors of the resource data must create the locker before
+     * reading the data and return a copy of it, never a reference: the
+     * data may be freed by another thread as soon as the locker is gone.
+     * For the resources that are not lazily loaded it does nothing.
+     */
+    class KRITAPIGMENT_EXPORT DataLocker
+    {
+    public:
+        DataLocker(const KoResource *resource);
+        ~DataLocker();
+
+        /// @return false if the data could not be loaded
+        bool isLoaded() const;
+
+    private:
+        Q_DISABLE_COPY(DataLocker)
+
+        const KoResource *m_resource;
+        bool m_isLocked;
+        bool m_isLoaded;
+    };
+
+    /**
+     * Frees the data of the resource, so that DataLocker has to load
+     * it again. Reimplement it together with supportsLazyLoading().
+     */
+    virtual void unloadData();
+
+    /// @return the approximate size in bytes of the resource data
+    virtual qint64 dataSize() const;
 
 protected:
     KoResource(const KoResource &rhs);
 
 private:
+    friend class KoResourceCache;
+
+    bool lockData() const;
+    void unlockData() const;
+
     struct Private;
     Private* const d;
 };
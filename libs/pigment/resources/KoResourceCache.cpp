@@ -0,0 +1,212 @@
+/*
+ * Copyright (c) 2020 Krita developers
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+*/
+#include "KoResourceCache.h"
+
+#include <QGlobalStatic>
+#include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QPair>
+#include <QVector>
+
+#include <algorithm>
+
+#include <resources/KoResource.h>
+#include "KoResource_p.h"
+#include "DebugPigment.h"
+
+Q_GLOBAL_STATIC(KoResourceCache, s_instance)
+
+struct KoResourceCache::Private
+{
+    struct Entry {
+        qint64 size = 0;
+        quint64 lastUse = 0;
+    };
+
+    /**
+     * Guards the bookkeeping below only. The resources are loaded
+     * under their own locks (KoResource::Private::LazyState), so the
+     * loading of one resource doesn't block the access to the others.
+     */
+    QMutex mutex;
+
+    QHash<KoResource*, Entry> loadedResources;
+    qint64 dataSize = 0;
+    qint64 maxDataSize = 256 * 1024 * 1024;
+    quint64 useCounter = 0;
+};
+
+KoResourceCache::KoResourceCache()
+    : m_d(new Private)
+{
+}
+
+KoResourceCache::~KoResourceCache()
+{
+}
+
+KoResourceCache *KoResourceCache::instance()
+{
+    return s_instance;
+}
+
+qint64 KoResourceCache::maxDataSize() const
+{
+    QMutexLocker l(&m_d->mutex);
+    return m_d->maxDataSize;
+}
+
+void KoResourceCache::setMaxDataSize(qint64 value)
+{
+    QMutexLocker l(&m_d->mutex);
+    m_d->maxDataSize = value;
+    evictUnused(0);
+}
+
+qint64 KoResourceCache::dataSize() const
+{
+    QMutexLocker l(&m_d->mutex);
+    return m_d->dataSize;
+}
+
+bool KoResourceCache::lockData(KoResource *resource)
+{
+    KoResource::Private::LazyState &state = resource->d->lazyState;
+    bool isNewlyLoaded = false;
+
+    {
+        QMutexLocker l(&state.mutex);
+
+        // counted even if the loading fails, unlockData() is called anyway
+        state.lockCount++;
+
+        if (!state.isLoaded.loadAcquire()) {
+            if (!load(resource)) {
+                return false;
+            }
+            isNewlyLoaded = true;
+        }
+    }
+
+    QMutexLocker l(&m_d->mutex);
+
+    if (isNewlyLoaded) {
+        Private::Entry entry;
+        entry.size = resource->dataSize();
+        m_d->loadedResources.insert(resource, entry);
+        m_d->dataSize += entry.size;
+    }
+
+    auto it = m_d->loadedResources.find(resource);
+    if (it != m_d->loadedResources.end()) {
+        it->lastUse = ++m_d->useCounter;
+    }
+
+    evictUnused(resource);
+
+    return true;
+}
+
+void KoResourceCache::unlockData(KoResource *resource)
+{
+    KoResource::Private::LazyState &state = resource->d->lazyState;
+
+    QMutexLocker l(&state.mutex);
+    state.lockCount--;
+}
+
+bool KoResourceCache::load(KoResource *resource)
+{
+    KoResource::Private::LazyState &state = resource->d->lazyState;
+
+    const QString name = resource->name();
+    const QByteArray md5 = resource->md5();
+    const QImage thumbnail = resource->image();
+
+    /**
+     * Set in advance to let load() use the accessors of the resource.
+     * The other threads wait for the lock of the resource meanwhile.
+     */
+    state.isLoaded.storeRelease(1);
+
+    const bool result = resource->load();
+
+    resource->setName(name);
+    resource->setMD5(md5);
+    resource->setImage(thumbnail);
+
+    if (!result) {
+        warnPigment << "Could not load lazily loaded resource" << resource->filename();
+        resource->unloadData();
+        state.isLoaded.storeRelease(0);
+    }
+
+    return result;
+}
+
+void KoResourceCache::remove(KoResource *resource)
+{
+    QMutexLocker l(&m_d->mutex);
+
+    auto it = m_d->loadedResources.find(resource);
+    if (it != m_d->loadedResources.end()) {
+        m_d->dataSize -= it->size;
+        m_d->loadedResources.erase(it);
+    }
+}
+
+void KoResourceCache::evictUnused(KoResource *current)
+{
+    if (m_d->dataSize <= m_d->maxDataSize) return;
+
+    QVector<QPair<quint64, KoResource*>> candidates;
+    for (auto it = m_d->loadedResources.begin(); it != m_d->loadedResources.end(); ++it) {
+        if (it.key() == current) continue;
+        candidates << qMakePair(it->lastUse, it.key());
+    }
+
+    std::sort(candidates.begin(), candidates.end());
+
+    for (auto candidate = candidates.begin();
+         candidate != candidates.end() && m_d->dataSize > m_d->maxDataSize;
+         ++candidate) {
+
+        KoResource *resource = candidate->second;
+        KoResource::Private::LazyState &state = resource->d->lazyState;
+
+        /**
+         * Never wait for the lock of the resource here: its owner may be
+         * waiting for the lock of the cache. If the resource is being
+         * loaded or read, it is just skipped.
+         */
+        if (!state.mutex.tryLock()) continue;
+
+        if (!state.lockCount) {
+            auto it = m_d->loadedResources.find(resource);
+            m_d->dataSize -= it->size;
+            m_d->loadedResources.erase(it);
+
+            resource->unloadData();
+            state.isLoaded.storeRelease(0);
+        }
+
+        state.mutex.unlock();
+    }
+}
@@ -0,0 +1,77 @@
+/*
+ * Copyright (c) 2020 Krita developers
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+*/
+#ifndef KORESOURCECACHE_H
+#define KORESOURCECACHE_H
+
+#include <QScopedPointer>
+
+#include <kritapigment_export.h>
+
+class KoResource;
+
+/**
+ * KoResourceCache keeps track of the data of the lazily loaded
+ * resources (see KoResource::setLazyLoaded()). When the loaded data
+ * takes more than maxDataSize() bytes, the data of the least recently
+ * used resources is freed. It will be loaded again on next access.
+ *
+ * Every resource is loaded under its own lock, so a slow load doesn't
+ * block the access to the other resources. The lock of the cache
+ * guards only the bookkeeping of the used memory. The data of a
+ * resource is never freed while a KoResource::DataLocker of it
+ * exists, and the resource that has been accessed last is not freed
+ * either.
+ */
+class KRITAPIGMENT_EXPORT KoResourceCache
+{
+public:
+    KoResourceCache();
+    ~KoResourceCache();
+
+    static KoResourceCache *instance();
+
+    qint64 maxDataSize() const;
+    void setMaxDataSize(qint64 value);
+
+    /// @return the size of the data of the lazily loaded resources currently in memory
+    qint64 dataSize() const;
+
+private:
+    friend class KoResource;
+
+    /**
+     * Loads the data of \p resource if needed and keeps it from being
+     * freed until unlockData() is called. Call unlockData() even if the
+     * loading fails.
+     */
+    bool lockData(KoResource *resource);
+    void unlockData(KoResource *resource);
+
+    /// loads the data, called under the lock of \p resource
+    bool load(KoResource *resource);
+    void remove(KoResource *resource);
+
+    void evictUnused(KoResource *current);
+
+private:
+    struct Private;
+    const QScopedPointer<Private> m_d;
+};
+
+#endif // KORESOURCECACHE_H
@@ -0,0 +1,70 @@
+/*
+ * Copyright (c) 2020 Krita developers
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+*/
+
+#ifndef _KORESOURCE_P_H_
+#define _KORESOURCE_P_H_
+
+#include <resources/KoResource.h>
+
+#include <QAtomicInt>
+#include <QByteArray>
+#include <QImage>
+#include <QMutex>
+#include <QString>
+
+struct Q_DECL_HIDDEN KoResource::Private {
+
+    /**
+     * The state of the data of a lazily loaded resource, used by
+     * KoResourceCache. The mutex guards the loading, the unloading and
+     * the lock count of this resource only.
+     */
+    struct LazyState {
+        LazyState() {}
+
+        // a copy gets its own mutex and is not locked
+        LazyState(const LazyState &rhs)
+            : isLoaded(rhs.isLoaded.loadAcquire())
+        {
+        }
+
+        /**
+         * The mutex is recursive, because load() of some resources
+         * calls their own accessors
+         */
+        QMutex mutex {QMutex::Recursive};
+
+        QAtomicInt isLoaded {1};
+
+        /// the number of DataLockers of the resource, the data is not freed while it's nonzero
+        int lockCount = 0;
+    };
+
+    QString name;
+    QString filename;
+    bool valid;
+    bool removable;
+    QByteArray md5;
+    QImage image;
+    bool permanent;
+    bool isLazy;
+    LazyState lazyState;
+};
+
+#endif
@@ -43,16 +43,6 @@
 #include <DebugPigment.h>
 #include <klocalizedstring.h>
 
-KoGradientSegment::RGBColorInterpolationStrategy *KoGradientSegment::RGBColorInterpolationStrategy::m_instance = 0;
-KoGradientSegment::HSVCWColorInterpolationStrategy *KoGradientSegment::HSVCWColorInterpolationStrategy::m_instance = 0;
-KoGradientSegment::HSVCCWColorInterpolationStrategy *KoGradientSegment::HSVCCWColorInterpolationStrategy::m_instance = 0;
-
-KoGradientSegment::LinearInterpolationStrategy *KoGradientSegment::LinearInterpolationStrategy::m_instance = 0;
-KoGradientSegment::CurvedInterpolationStrategy *KoGradientSegment::CurvedInterpolationStrategy::m_instance = 0;
-KoGradientSegment::SineInterpolationStrategy *KoGradientSegment::SineInterpolationStrategy::m_instance = 0;
-KoGradientSegment::SphereIncreasingInterpolationStrategy *KoGradientSegment::SphereIncreasingInterpolationStrategy::m_instance = 0;
-KoGradientSegment::SphereDecreasingInterpolationStrategy *KoGradientSegment::SphereDecreasingInterpolationStrategy::m_instance = 0;
-
 KoSegmentGradient::KoSegmentGradient(const QString& file)
     : KoAbstractGradient(file)
 {
@@ -534,12 +524,8 @@ KoGradientSegment::RGBColorInterpolationStrategy::RGBColorInterpolationStrategy(
 
 KoGradientSegment::RGBColorInterpolationStrategy *KoGradientSegment::RGBColorInterpolationStrategy::instance()
 {
-    if (m_instance == 0) {
-        m_instance = new RGBColorInterpolationStrategy();
-        Q_CHECK_PTR(m_instance);
-    }
-
-    return m_instance;
+    static RGBColorInterpolationStrategy *instance = new RGBColorInterpolationStrategy();
+    return instance;
 }
 
 void KoGradientSegment::RGBColorInterpolationStrategy::colorAt(KoColor& dst, qreal t, const KoColor& _start, const KoColor& _end) const
@@ -594,12 +580,8 @@ KoGradientSegment::HSVCWColorInterpolationStrategy::HSVCWColorInterpolationStrat
 
 KoGradientSegment::HSVCWColorInterpolationStrategy *KoGradientSegment::HSVCWColorInterpolationStrategy::instance()
 {
-    if (m_instance == 0) {
-        m_instance = new HSVCWColorInterpolationStrategy();
-        Q_CHECK_PTR(m_instance);
-    }
-
-    return m_instance;
+    static HSVCWColorInterpolationStrategy *instance = new HSVCWColorInterpolationStrategy();
+    return instance;
 }
 
 void KoGradientSegment::HSVCWColorInterpolationStrategy::colorAt(KoColor& dst, qreal t, const KoColor& start, const KoColor& end) const
@@ -640,12 +622,8 @@ KoGradientSegment::HSVCCWColorInterpolationStrategy::HSVCCWColorInterpolationStr
 
 KoGradientSegment::HSVCCWColorInterpolationStrategy *KoGradientSegment::HSVCCWColorInterpolationStrategy::instance()
 {
-    if (m_instance == 0) {
-        m_instance = new HSVCCWColorInterpolationStrategy();
-        Q_CHECK_PTR(m_instance);
-    }
-
-    return m_instance;
+    static HSVCCWColorInterpolationStrategy *instance = new HSVCCWColorInterpolationStrategy();
+    return instance;
 }
 
 void KoGradientSegment::HSVCCWColorInterpolationStrategy::colorAt(KoColor& dst, qreal t, const KoColor& start, const KoColor& end) const
@@ -680,12 +658,8 @@ void KoGradientSegment::HSVCCWColorInterpolationStrategy::colorAt(KoColor& dst,
 
 KoGradientSegment::LinearInterpolationStrategy *KoGradientSegment::LinearInterpolationStrategy::instance()
 {
-    if (m_instance == 0) {
-        m_instance = new LinearInterpolationStrategy();
-        Q_CHECK_PTR(m_instance);
-    }
-
-    return m_instance;
+    static LinearInterpolationStrategy *instance = new LinearInterpolationStrategy();
+    return instance;
 }
 
 qreal KoGradientSegment::LinearInterpolationStrategy::calcValueAt(qreal t, qreal middle)
@@ -724,12 +698,8 @@ KoGradientSegment::CurvedInterpolationStrategy::CurvedInterpolationStrategy()
 
 KoGradientSegment::CurvedInterpolationStrategy *KoGradientSegment::CurvedInterpolationStrategy::instance()
 {
-    if (m_instance == 0) {
-        m_instance = new CurvedInterpolationStrategy();
-        Q_CHECK_PTR(m_instance);
-    }
-
-    return m_instance;
+    static CurvedInterpolationStrategy *instance = new CurvedInterpolationStrategy();
+    return instance;
 }
 
 qreal KoGradientSegment::CurvedInterpolationStrategy::valueAt(qreal t, qreal middle) const
@@ -750,12 +720,8 @@ qreal KoGradientSegment::CurvedInterpolationStrategy::valueAt(qreal t, qreal mid
 
 KoGradientSegment::SineInterpolationStrategy *KoGradientSegment::SineInterpolationStrategy::instance()
 {
-    if (m_instance == 0) {
-        m_instance = new SineInterpolationStrategy();
-        Q_CHECK_PTR(m_instance);
-    }
-
-    return m_instance;
+    static SineInterpolationStrategy *instance = new SineInterpolationStrategy();
+    return instance;
 }
 
 qreal KoGradientSegment::SineInterpolationStrategy::valueAt(qreal t, qreal middle) const
@@ -768,12 +734,8 @@ qreal KoGradientSegment::SineInterpolationStrategy::valueAt(qreal t, qreal middl
 
 KoGradientSegment::SphereIncreasingInterpolationStrategy *KoGradientSegment::SphereIncreasingInterpolationStrategy::instance()
 {
-    if (m_instance == 0) {
-        m_instance = new SphereIncreasingInterpolationStrategy();
-        Q_CHECK_PTR(m_instance);
-    }
-
-    return m_instance;
+    static SphereIncreasingInterpolationStrategy *instance = new SphereIncreasingInterpolationStrategy();
+    return instance;
 }
 
 qreal KoGradientSegment::SphereIncreasingInterpolationStrategy::valueAt(qreal t, qreal middle) const
@@ -786,12 +748,8 @@ qreal KoGradientSegment::SphereIncreasingInterpolationStrategy::valueAt(qreal t,
 
 KoGradientSegment::SphereDecreasingInterpolationStrategy *KoGradientSegment::SphereDecreasingInterpolationStrategy::instance()
 {
-    if (m_instance == 0) {
-        m_instance = new SphereDecreasingInterpolationStrategy();
-        Q_CHECK_PTR(m_instance);
-    }
-
-    return m_instance;
+    static SphereDecreasingInterpolationStrategy *instance = new SphereDecreasingInterpolationStrategy();
+    return instance;
 }
 
 qreal KoGradientSegment::SphereDecreasingInterpolationStrategy::valueAt(qreal t, qreal middle) const
@@ -110,7 +110,6 @@ protected:
     private:
         RGBColorInterpolationStrategy();
 
-        static RGBColorInterpolationStrategy *m_instance;
         const KoColorSpace * const m_colorSpace;
     };
 
@@ -126,7 +125,6 @@ protected:
     private:
         HSVCWColorInterpolationStrategy();
 
-        static HSVCWColorInterpolationStrategy *m_instance;
         const KoColorSpace * const m_colorSpace;
     };
 
@@ -142,7 +140,6 @@ protected:
     private:
         HSVCCWColorInterpolationStrategy();
 
-        static HSVCCWColorInterpolationStrategy *m_instance;
         const KoColorSpace * const m_colorSpace;
     };
 
@@ -173,8 +170,6 @@ protected:
 
     private:
         LinearInterpolationStrategy() {}
-
-        static LinearInterpolationStrategy *m_instance;
     };
 
     class CurvedInterpolationStrategy : public InterpolationStrategy
@@ -189,7 +184,6 @@ protected:
     private:
         CurvedInterpolationStrategy();
 
-        static CurvedInterpolationStrategy *m_instance;
         qreal m_logHalf;
     };
 
@@ -204,8 +198,6 @@ protected:
         }
     private:
         SphereIncreasingInterpolationStrategy() {}
-
-        static SphereIncreasingInterpolationStrategy *m_instance;
     };
 
     class SphereDecreasingInterpolationStrategy : public InterpolationStrategy
@@ -219,8 +211,6 @@ protected:
         }
     private:
         SphereDecreasingInterpolationStrategy() {}
-
-        static SphereDecreasingInterpolationStrategy *m_instance;
     };
 
     class SineInterpolationStrategy : public InterpolationStrategy
@@ -234,8 +224,6 @@ protected:
         }
     private:
         SineInterpolationStrategy() {}
-
-        static SineInterpolationStrategy *m_instance;
     };
 private:
     InterpolationStrategy *m_interpolator;
@@ -20,6 +20,8 @@
 #include "TestColorConversionSystem.h"
 
 #include <QTest>
+#include <QThreadPool>
+#include <QRunnable>
 
 #include <DebugPigment.h>
 #include <KoColorProfile.h>
@@ -187,6 +189,78 @@ void TestColorConversionSystem::testAlphaU16Conversions()
     }
 }
 
+namespace {
+struct ConversionJob : public QRunnable
+{
+    ConversionJob(const QByteArray &_src, QByteArray *_dst,
+                  const KoColorSpace *_srcCs, const KoColorSpace *_dstCs)
+        : src(_src), dst(_dst), srcCs(_srcCs), dstCs(_dstCs)
+    {
+    }
+
+    void run() override {
+        const int numPixels = src.size() / srcCs->pixelSize();
+
+        // request the transformation several times to shake the cache
+        for (int i = 0; i < 16; i++) {
+            srcCs->convertPixelsTo((const quint8*)src.constData(),
+                                   (quint8*)dst->data(),
+                                   dstCs,
+                                   numPixels,
+                                   KoColorConversionTransformation::internalRenderingIntent(),
+                                   KoColorConversionTransformation::internalConversionFlags());
+            srcCs->convertPixelsTo((const quint8*)src.constData(),
+                                   (quint8*)dst->data(),
+                                   dstCs,
+                                   numPixels,
+                                   KoColorConversionTransformation::IntentAbsoluteColorimetric,
+                                   KoColorConversionTransformation::internalConversionFlags());
+        }
+    }
+
+    QByteArray src;
+    QByteArray *dst;
+    const KoColorSpace *srcCs;
+    const KoColorSpace *dstCs;
+};
+}
+
+void TestColorConversionSystem::testConcurrentConversions()
+{
+    const KoColorSpace *rgb8 = KoColorSpaceRegistry::instance()->rgb8();
+    const KoColorSpace *lab16 = KoColorSpaceRegistry::instance()->lab16();
+
+    const int numPixels = 4096;
+    QByteArray srcBuf(numPixels * rgb8->pixelSize(), '\0');
+
+    qsrand(1);
+    for (int i = 0; i < srcBuf.size(); i++) {
+        srcBuf[i] = qrand() & 0xFF;
+    }
+
+    QByteArray refBuf(numPixels * lab16->pixelSize(), '\0');
+    rgb8->convertPixelsTo((const quint8*)srcBuf.constData(),
+                          (quint8*)refBuf.data(),
+                          lab16,
+                          numPixels,
+                          KoColorConversionTransformation::IntentAbsoluteColorimetric,
+                          KoColorConversionTransformation::internalConversionFlags());
+
+    const int numJobs = 16;
+    QVector<QByteArray> results(numJobs, QByteArray(refBuf.size(), '\0'));
+
+    QThreadPool pool;
+    pool.setMaxThreadCount(8);
+    for (int i = 0; i < numJobs; i++) {
+        pool.start(new ConversionJob(srcBuf, &results[i], rgb8, lab16));
+    }
+    pool.waitForDone();
+
+    for (int i = 0; i < numJobs; i++) {
+        QCOMPARE(results[i], refBuf);
+    }
+}
+
 void TestColorConversionSystem::benchmarkAlphaToRgbConversion()
 {
     const KoColorSpace *alpha8 = KoColorSpaceRegistry::instance()->alpha8();
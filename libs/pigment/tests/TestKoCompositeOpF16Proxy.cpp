@@ -0,0 +1,195 @@
+/*
+ *  Copyright (c) 2020 Krita developers
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include "TestKoCompositeOpF16Proxy.h"
+
+#include <QTest>
+#include <QBitArray>
+#include <QScopedPointer>
+#include <QVector>
+
+#include <KoConfig.h>
+#include <KoCompositeOpRegistry.h>
+
+#ifdef HAVE_OPENEXR
+#include <KoColorSpaceRegistry.h>
+#include <KoColorModelStandardIds.h>
+
+#include "../compositeops/KoCompositeOps.h"
+
+namespace {
+
+const int NUM_COLUMNS = 67;
+const int NUM_ROWS = 3;
+
+// one padding pixel at the end of every row, the strides must be respected
+const int ROW_PIXELS = NUM_COLUMNS + 1;
+
+QVector<half> randomPixels(int numPixels)
+{
+    QVector<half> pixels(numPixels * 4);
+
+    for (int i = 0; i < numPixels; i++) {
+        for (int ch = 0; ch < 4; ch++) {
+            pixels[i * 4 + ch] = half(float(qrand() & 0xff) / 255.0f);
+        }
+
+        // make some pixels fully transparent and some opaque
+        if (i % 7 == 3) {
+            pixels[i * 4 + KoRgbF16Traits::alpha_pos] = half(0.0f);
+        } else if (i % 7 == 5) {
+            pixels[i * 4 + KoRgbF16Traits::alpha_pos] = half(1.0f);
+        }
+    }
+
+    return pixels;
+}
+
+QVector<quint8> randomMask(int numPixels)
+{
+    QVector<quint8> mask(numPixels);
+
+    for (int i = 0; i < numPixels; i++) {
+        mask[i] = i % 5 == 0 ? 0 : i % 5 == 1 ? 255 : quint8(qrand() & 0xff);
+    }
+
+    return mask;
+}
+
+}
+
+#endif
+
+void TestKoCompositeOpF16Proxy::testComposite_data()
+{
+    QTest::addColumn<QString>("opId");
+    QTest::addColumn<bool>("useMask");
+    QTest::addColumn<bool>("constantSource");
+    QTest::addColumn<float>("opacity");
+    QTest::addColumn<float>("flow");
+    QTest::addColumn<QBitArray>("channelFlags");
+
+    QBitArray allChannels(4, true);
+    QBitArray noGreen(4, true);
+    noGreen.clearBit(1);
+
+    const QStringList ops = QStringList() << COMPOSITE_OVER << COMPOSITE_ALPHA_DARKEN;
+
+    Q_FOREACH (const QString &op, ops) {
+        QTest::newRow(op.toLatin1()) << op << false << false << 1.0f << 1.0f << QBitArray();
+        QTest::newRow(QString("%1-opacity").arg(op).toLatin1()) << op << false << false << 0.7f << 1.0f << QBitArray();
+        QTest::newRow(QString("%1-flow").arg(op).toLatin1()) << op << false << false << 0.7f << 0.4f << QBitArray();
+        QTest::newRow(QString("%1-mask").arg(op).toLatin1()) << op << true << false << 0.7f << 0.4f << QBitArray();
+        QTest::newRow(QString("%1-constant-source").arg(op).toLatin1()) << op << true << true << 0.7f << 0.4f << QBitArray();
+        QTest::newRow(QString("%1-all-channels").arg(op).toLatin1()) << op << true << false << 0.7f << 0.4f << allChannels;
+        QTest::newRow(QString("%1-no-green").arg(op).toLatin1()) << op << true << false << 0.7f << 0.4f << noGreen;
+    }
+}
+
+void TestKoCompositeOpF16Proxy::testComposite()
+{
+#ifdef HAVE_OPENEXR
+    QFETCH(QString, opId);
+    QFETCH(bool, useMask);
+    QFETCH(bool, constantSource);
+    QFETCH(float, opacity);
+    QFETCH(float, flow);
+    QFETCH(QBitArray, channelFlags);
+
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->colorSpace(RGBAColorModelID.id(), Float16BitsColorDepthID.id(), 0);
+    if (!cs) {
+        QSKIP("RGBA F16 color space is not available");
+    }
+
+    QScopedPointer<KoCompositeOp> proxyOp;
+    QScopedPointer<KoCompositeOp> nativeOp;
+
+    if (opId == COMPOSITE_OVER) {
+        proxyOp.reset(_Private::OptimizedOpsSelector<KoRgbF16Traits>::createOverOp(cs));
+        nativeOp.reset(new KoCompositeOpOver<KoRgbF16Traits>(cs));
+    } else {
+        proxyOp.reset(_Private::OptimizedOpsSelector<KoRgbF16Traits>::createAlphaDarkenOp(cs));
+        if (useCreamyAlphaDarken()) {
+            nativeOp.reset(new KoCompositeOpAlphaDarken<KoRgbF16Traits, KoAlphaDarkenParamsWrapperCreamy>(cs));
+        } else {
+            nativeOp.reset(new KoCompositeOpAlphaDarken<KoRgbF16Traits, KoAlphaDarkenParamsWrapperHard>(cs));
+        }
+    }
+
+    QCOMPARE(proxyOp->id(), nativeOp->id());
+
+    qsrand(42);
+
+    const int numPixels = ROW_PIXELS * NUM_ROWS;
+    const QVector<half> src = randomPixels(constantSource ? 1 : numPixels);
+    const QVector<half> dst = randomPixels(numPixels);
+    const QVector<quint8> mask = randomMask(numPixels);
+
+    QVector<half> proxyDst = dst;
+    QVector<half> nativeDst = dst;
+
+    KoCompositeOp::ParameterInfo params;
+    params.srcRowStart = reinterpret_cast<const quint8*>(src.constData());
+    params.srcRowStride = constantSource ? 0 : ROW_PIXELS * KoRgbF16Traits::pixelSize;
+    params.dstRowStride = ROW_PIXELS * KoRgbF16Traits::pixelSize;
+    params.maskRowStart = useMask ? mask.constData() : 0;
+    params.maskRowStride = useMask ? ROW_PIXELS : 0;
+    params.rows = NUM_ROWS;
+    params.cols = NUM_COLUMNS;
+    params.setOpacityAndAverage(opacity, 0.5f * opacity);
+    params.flow = flow;
+    params.channelFlags = channelFlags;
+
+    params.dstRowStart = reinterpret_cast<quint8*>(proxyDst.data());
+    proxyOp->composite(params);
+
+    params.dstRowStart = reinterpret_cast<quint8*>(nativeDst.data());
+    nativeOp->composite(params);
+
+    /**
+     * The proxy rounds to half only once, while the native op rounds
+     * every intermediate value, so they may differ in a couple of units
+     * in the last place of half
+     */
+    const float tolerance = 2e-3f;
+
+    for (int i = 0; i < nativeDst.size(); i++) {
+        const float expected = nativeDst[i];
+        const float result = proxyDst[i];
+
+        if (qAbs(expected - result) > tolerance) {
+            qDebug() << "Pixel" << i / 4 << "channel" << i % 4
+                     << "expected:" << expected << "result:" << result;
+            QFAIL("the proxy and the native op differ");
+        }
+    }
+
+    // the padding pixels are untouched
+    for (int row = 0; row < NUM_ROWS; row++) {
+        const int padding = (row * ROW_PIXELS + NUM_COLUMNS) * 4;
+        for (int ch = 0; ch < 4; ch++) {
+            QCOMPARE(proxyDst[padding + ch].bits(), dst[padding + ch].bits());
+        }
+    }
+#else
+    QSKIP("OpenEXR is not available");
+#endif
+}
+
+QTEST_GUILESS_MAIN(TestKoCompositeOpF16Proxy)
@@ -0,0 +1,156 @@
+/*
+ *  Copyright (c) 2020 Krita developers
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include "TestKoHalfConversion.h"
+
+#include <cmath>
+#include <cstring>
+
+#include <QTest>
+#include <QVector>
+
+#include <KoConfig.h>
+
+#ifdef HAVE_OPENEXR
+#include "../KoHalfConversion.h"
+
+namespace {
+
+/**
+ * Every bit pattern of half, the number is odd so that the
+ * non-vectorized tail of the conversion is tested as well
+ */
+QVector<half> allHalfValues()
+{
+    QVector<half> values(0x10000 + 3);
+
+    for (int i = 0; i < values.size(); i++) {
+        values[i].setBits(quint16(i & 0xFFFF));
+    }
+
+    return values;
+}
+
+QVector<float> floatValues()
+{
+    QVector<float> values;
+
+    qsrand(1);
+    for (int i = 0; i < 100003; i++) {
+        float value;
+        quint32 bits = (quint32(qrand()) << 16) ^ quint32(qrand());
+        std::memcpy(&value, &bits, sizeof(float));
+        values << value;
+    }
+
+    // the values near the rounding points and the limits of half
+    for (int i = 0; i < 0x10000; i++) {
+        half h;
+        h.setBits(quint16(i));
+        const float value = h;
+        values << value << std::nextafter(value, 0.0f) << std::nextafter(value, 1e10f) << std::nextafter(value, -1e10f);
+    }
+
+    values << 0.0f << -0.0f << 65504.0f << 65520.0f << 1e10f << -1e10f << 1e-10f;
+
+    return values;
+}
+
+}
+
+#endif
+
+void TestKoHalfConversion::testHalfToFloat()
+{
+#ifdef HAVE_OPENEXR
+    qDebug() << "F16C support:" << KoHalfConversion::hasHardwareSupport();
+
+    const QVector<half> src = allHalfValues();
+    QVector<float> dst(src.size());
+
+    KoHalfConversion::halfToFloat(src.constData(), dst.data(), src.size());
+
+    for (int i = 0; i < src.size(); i++) {
+        const float expected = src[i];
+
+        if (src[i].isNan()) {
+            QVERIFY(qIsNaN(dst[i]));
+        } else {
+            QCOMPARE(std::memcmp(&dst[i], &expected, sizeof(float)), 0);
+        }
+    }
+#else
+    QSKIP("OpenEXR is not available");
+#endif
+}
+
+void TestKoHalfConversion::testFloatToHalf()
+{
+#ifdef HAVE_OPENEXR
+    const QVector<float> src = floatValues();
+    QVector<half> dst(src.size());
+
+    KoHalfConversion::floatToHalf(src.constData(), dst.data(), src.size());
+
+    for (int i = 0; i < src.size(); i++) {
+        const half expected(src[i]);
+
+        if (expected.isNan()) {
+            QVERIFY(dst[i].isNan());
+        } else if (dst[i].bits() != expected.bits()) {
+            qDebug() << "Value:" << src[i] << "expected:" << expected.bits() << "actual:" << dst[i].bits();
+            QFAIL("half values differ");
+        }
+    }
+#else
+    QSKIP("OpenEXR is not available");
+#endif
+}
+
+void TestKoHalfConversion::benchmarkHalfToFloat()
+{
+#ifdef HAVE_OPENEXR
+    const int numValues = 4 * 64 * 64;
+    QVector<half> src(numValues, half(0.5f));
+    QVector<float> dst(numValues);
+
+    QBENCHMARK {
+        KoHalfConversion::halfToFloat(src.constData(), dst.data(), numValues);
+    }
+#else
+    QSKIP("OpenEXR is not available");
+#endif
+}
+
+void TestKoHalfConversion::benchmarkFloatToHalf()
+{
+#ifdef HAVE_OPENEXR
+    const int numValues = 4 * 64 * 64;
+    QVector<float> src(numValues, 0.5f);
+    QVector<half> dst(numValues);
+
+    QBENCHMARK {
+        KoHalfConversion::floatToHalf(src.constData(), dst.data(), numValues);
+    }
+#else
+    QSKIP("OpenEXR is not available");
+#endif
+}
+
+QTEST_GUILESS_MAIN(TestKoHalfConversion)
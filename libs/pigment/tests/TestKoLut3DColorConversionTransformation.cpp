@@ -0,0 +1,171 @@
+/*
+ *  Copyright (c) 2020 Krita developers
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include "TestKoLut3DColorConversionTransformation.h"
+
+#include <QTest>
+
+#include <KoColorModelStandardIds.h>
+#include <KoColorSpaceRegistry.h>
+#include <KoLut3DColorConversionTransformation.h>
+#include <sdk/tests/kistest.h>
+
+namespace {
+QByteArray randomPixels(const KoColorSpace *cs, int numPixels)
+{
+    QByteArray pixels(numPixels * cs->pixelSize(), '\0');
+
+    qsrand(1);
+    for (int i = 0; i < pixels.size(); i++) {
+        pixels[i] = qrand() & 0xFF;
+    }
+
+    return pixels;
+}
+
+/**
+ * Overwrites the first pixels with a ramp of dark colors, where a grid
+ * uniform in the encoded values of a linear source is the least precise
+ */
+void fillDarkRamp(const KoColorSpace *cs, QByteArray &pixels, int numPixels)
+{
+    QVector<float> channels(4);
+
+    for (int i = 0; i < numPixels; i++) {
+        const float value = 0.1f * i / numPixels;
+        channels[0] = value;
+        channels[1] = 0.5f * value;
+        channels[2] = 0.25f * value;
+        channels[3] = 1.0f;
+        cs->fromNormalisedChannelsValue((quint8*)pixels.data() + i * cs->pixelSize(), channels);
+    }
+}
+}
+
+void TestKoLut3DColorConversionTransformation::testSupportedColorSpaces()
+{
+    KoColorSpaceRegistry *registry = KoColorSpaceRegistry::instance();
+
+    QVERIFY(KoLut3DColorConversionTransformation::isSupported(registry->rgb8(), registry->rgb8()));
+    QVERIFY(KoLut3DColorConversionTransformation::isSupported(registry->rgb16(), registry->rgb8()));
+    QVERIFY(!KoLut3DColorConversionTransformation::isSupported(registry->rgb8(), registry->rgb16()));
+    QVERIFY(!KoLut3DColorConversionTransformation::isSupported(registry->lab16(), registry->rgb8()));
+
+    QScopedPointer<KoColorConversionTransformation> transform(
+        registry->lab16()->createColorConverter(registry->rgb8(),
+                                                KoColorConversionTransformation::internalRenderingIntent(),
+                                                KoColorConversionTransformation::internalConversionFlags()));
+
+    QVERIFY(!KoLut3DColorConversionTransformation::create(transform.data()));
+}
+
+void TestKoLut3DColorConversionTransformation::testConversion_data()
+{
+    QTest::addColumn<QString>("srcColorDepthId");
+    QTest::addColumn<bool>("linearProfile");
+
+    QTest::newRow("rgb8") << Integer8BitsColorDepthID.id() << false;
+    QTest::newRow("rgb16") << Integer16BitsColorDepthID.id() << false;
+    QTest::newRow("rgb8-g10") << Integer8BitsColorDepthID.id() << true;
+    QTest::newRow("rgb16-g10") << Integer16BitsColorDepthID.id() << true;
+}
+
+void TestKoLut3DColorConversionTransformation::testConversion()
+{
+    QFETCH(QString, srcColorDepthId);
+    QFETCH(bool, linearProfile);
+
+    KoColorSpaceRegistry *registry = KoColorSpaceRegistry::instance();
+    const KoColorProfile *profile = 0;
+
+    if (linearProfile) {
+        profile = registry->p709G10Profile();
+        if (!profile) {
+            QSKIP("the linear sRGB profile is not installed");
+        }
+    }
+
+    const KoColorSpace *srcCs = profile ?
+        registry->colorSpace(RGBAColorModelID.id(), srcColorDepthId, profile) :
+        registry->colorSpace(RGBAColorModelID.id(), srcColorDepthId);
+    const KoColorSpace *dstCs = registry->rgb8();
+    QVERIFY(srcCs);
+
+    const int numPixels = 4096;
+    QByteArray src = randomPixels(srcCs, numPixels);
+    fillDarkRamp(srcCs, src, 512);
+
+    QScopedPointer<KoColorConversionTransformation> transform(
+        srcCs->createColorConverter(dstCs,
+                                    KoColorConversionTransformation::IntentPerceptual,
+                                    KoColorConversionTransformation::BlackpointCompensation));
+
+    QScopedPointer<KoColorConversionTransformation> lut(
+        KoLut3DColorConversionTransformation::create(transform.data()));
+    QVERIFY(lut);
+    QCOMPARE(lut->srcColorSpace(), srcCs);
+    QCOMPARE(lut->dstColorSpace(), dstCs);
+
+    QByteArray reference(numPixels * dstCs->pixelSize(), '\0');
+    transform->transform((const quint8*)src.constData(), (quint8*)reference.data(), numPixels);
+
+    QByteArray result(numPixels * dstCs->pixelSize(), '\0');
+    lut->transform((const quint8*)src.constData(), (quint8*)result.data(), numPixels);
+
+    for (int i = 0; i < result.size(); i++) {
+        const int difference = qAbs(int(quint8(result[i])) - int(quint8(reference[i])));
+
+        if (difference > 1) {
+            qDebug() << "pixel" << i / 4 << "channel" << i % 4
+                     << "lut:" << quint8(result[i]) << "reference:" << quint8(reference[i]);
+            QFAIL("the lookup table is too imprecise");
+        }
+    }
+
+    QScopedPointer<KoColorConversionTransformation> clone(lut->clone());
+    QVERIFY(clone);
+
+    QByteArray cloneResult(numPixels * dstCs->pixelSize(), '\0');
+    clone->transform((const quint8*)src.constData(), (quint8*)cloneResult.data(), numPixels);
+    QCOMPARE(cloneResult, result);
+}
+
+void TestKoLut3DColorConversionTransformation::benchmarkConversion()
+{
+    KoColorSpaceRegistry *registry = KoColorSpaceRegistry::instance();
+    const KoColorSpace *srcCs = registry->rgb16();
+    const KoColorSpace *dstCs = registry->rgb8();
+
+    const int numPixels = 1024 * 1024;
+    const QByteArray src = randomPixels(srcCs, numPixels);
+    QByteArray dst(numPixels * dstCs->pixelSize(), '\0');
+
+    QScopedPointer<KoColorConversionTransformation> transform(
+        srcCs->createColorConverter(dstCs,
+                                    KoColorConversionTransformation::IntentPerceptual,
+                                    KoColorConversionTransformation::BlackpointCompensation));
+
+    QScopedPointer<KoColorConversionTransformation> lut(
+        KoLut3DColorConversionTransformation::create(transform.data()));
+
+    QBENCHMARK {
+        lut->transform((const quint8*)src.constData(), (quint8*)dst.data(), numPixels);
+    }
+}
+
+KISTEST_MAIN(TestKoLut3DColorConversionTransformation)
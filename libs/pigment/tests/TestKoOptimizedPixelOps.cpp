@@ -0,0 +1,163 @@
+/*
+ *  Copyright (c) 2020 Krita developers
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include "TestKoOptimizedPixelOps.h"
+
+#include <limits>
+#include <numeric>
+
+#include <QTest>
+#include <QBitArray>
+#include <QScopedPointer>
+#include <QVector>
+
+#include "../KoColorSpaceTraits.h"
+#include "../KoColorSpaceMaths.h"
+#include "../KoMixColorsOpImpl.h"
+#include "../KoConvolutionOpImpl.h"
+#include "../compositeops/KoOptimizedPixelOpsFactory.h"
+
+namespace {
+
+const int NUM_PIXELS = 67;
+
+template<class Traits>
+QVector<quint8> randomPixels(int numPixels)
+{
+    typedef typename Traits::channels_type channels_type;
+
+    QVector<quint8> buffer(numPixels * Traits::pixelSize);
+    channels_type *pixels = Traits::nativeArray(buffer.data());
+
+    for (int i = 0; i < numPixels; i++) {
+        for (int ch = 0; ch < int(Traits::channels_nb); ch++) {
+            pixels[i * Traits::channels_nb + ch] =
+                KoColorSpaceMaths<quint8, channels_type>::scaleToA(quint8(qrand() & 0xff));
+        }
+
+        // make every 7th pixel fully transparent
+        if (i % 7 == 3) {
+            pixels[i * Traits::channels_nb + Traits::alpha_pos] = KoColorSpaceMathsTraits<channels_type>::zeroValue;
+        }
+    }
+
+    return buffer;
+}
+
+template<class Traits>
+void checkMixColors(KoMixColorsOp *optimizedOp)
+{
+    QScopedPointer<KoMixColorsOp> optimized(optimizedOp);
+    KoMixColorsOpImpl<Traits> scalar;
+
+    QVector<quint8> buffer = randomPixels<Traits>(NUM_PIXELS);
+
+    QVector<const quint8*> colors;
+    QVector<qint16> weights;
+    for (int i = 0; i < NUM_PIXELS; i++) {
+        colors << buffer.constData() + i * Traits::pixelSize;
+        weights << (i < 51 ? 5 : 0);
+    }
+
+    quint8 expected[Traits::pixelSize];
+    quint8 result[Traits::pixelSize];
+
+    /**
+     * The optimized op must be bit-exact with the scalar one
+     */
+
+    scalar.mixColors(buffer.constData(), NUM_PIXELS, expected);
+    optimized->mixColors(buffer.constData(), NUM_PIXELS, result);
+    QVERIFY(!memcmp(expected, result, Traits::pixelSize));
+
+    scalar.mixColors(colors.constData(), NUM_PIXELS, expected);
+    optimized->mixColors(colors.constData(), NUM_PIXELS, result);
+    QVERIFY(!memcmp(expected, result, Traits::pixelSize));
+
+    scalar.mixColors(buffer.constData(), weights.constData(), NUM_PIXELS, expected);
+    optimized->mixColors(buffer.constData(), weights.constData(), NUM_PIXELS, result);
+    QVERIFY(!memcmp(expected, result, Traits::pixelSize));
+
+    scalar.mixColors(colors.constData(), weights.constData(), NUM_PIXELS, expected);
+    optimized->mixColors(colors.constData(), weights.constData(), NUM_PIXELS, result);
+    QVERIFY(!memcmp(expected, result, Traits::pixelSize));
+}
+
+template<class Traits>
+void checkConvolveColors(KoConvolutionOp *optimizedOp)
+{
+    typedef typename Traits::channels_type channels_type;
+
+    QScopedPointer<KoConvolutionOp> optimized(optimizedOp);
+    KoConvolutionOpImpl<Traits> scalar;
+
+    QVector<quint8> buffer = randomPixels<Traits>(NUM_PIXELS);
+
+    QVector<const quint8*> colors;
+    QVector<qreal> kernel;
+    for (int i = 0; i < NUM_PIXELS; i++) {
+        colors << buffer.constData() + i * Traits::pixelSize;
+        kernel << (i % 5) * 0.1;
+    }
+
+    const qreal factor = std::accumulate(kernel.begin(), kernel.end(), 0.0);
+
+    QVector<qreal> factors;
+    factors << factor << 2.0 * factor;
+
+    Q_FOREACH (qreal f, factors) {
+        channels_type expected[Traits::channels_nb] = {0};
+        channels_type result[Traits::channels_nb] = {0};
+
+        scalar.convolveColors(colors.constData(), kernel.constData(), reinterpret_cast<quint8*>(expected), f, 0.0, NUM_PIXELS, QBitArray());
+        optimized->convolveColors(colors.constData(), kernel.constData(), reinterpret_cast<quint8*>(result), f, 0.0, NUM_PIXELS, QBitArray());
+
+        /**
+         * The compiler is free to fuse the multiply-adds in the vectorized
+         * code, so the integer channels may differ in one unit
+         */
+        const qreal tolerance = std::numeric_limits<channels_type>::is_integer ? 1.0 : 1e-5;
+
+        for (int ch = 0; ch < int(Traits::channels_nb); ch++) {
+            QVERIFY(qAbs(qreal(expected[ch]) - qreal(result[ch])) <= tolerance);
+        }
+    }
+}
+
+}
+
+void TestKoOptimizedPixelOps::testMixColors()
+{
+    qsrand(42);
+
+    checkMixColors<KoBgrU8Traits>(KoOptimizedPixelOpsFactory::createMixColorsOp32());
+    checkMixColors<KoBgrU16Traits>(KoOptimizedPixelOpsFactory::createMixColorsOp64());
+    checkMixColors<KoRgbF32Traits>(KoOptimizedPixelOpsFactory::createMixColorsOp128());
+}
+
+void TestKoOptimizedPixelOps::testConvolveColors()
+{
+    qsrand(42);
+
+    checkConvolveColors<KoBgrU8Traits>(KoOptimizedPixelOpsFactory::createConvolutionOp32());
+    checkConvolveColors<KoBgrU16Traits>(KoOptimizedPixelOpsFactory::createConvolutionOp64());
+    checkConvolveColors<KoRgbF32Traits>(KoOptimizedPixelOpsFactory::createConvolutionOp128());
+}
+
+QTEST_GUILESS_MAIN(TestKoOptimizedPixelOps)
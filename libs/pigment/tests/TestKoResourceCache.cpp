@@ -0,0 +1,183 @@
+/*
+ * Copyright (c) 2020 Krita developers
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+*/
+#include "TestKoResourceCache.h"
+
+#include <algorithm>
+
+#include <QtTest>
+#include <QTemporaryDir>
+#include <QThread>
+#include <QAtomicInt>
+
+#include <resources/KoPattern.h>
+#include <resources/KoResourceCache.h>
+
+namespace {
+QString createPatternFile(const QTemporaryDir &dir, const QString &name, int size)
+{
+    QImage image(size, size, QImage::Format_ARGB32);
+    image.fill(Qt::red);
+
+    const QString filename = dir.filePath(name + ".png");
+    image.save(filename);
+    return filename;
+}
+
+class PatternReader : public QThread
+{
+public:
+    PatternReader(const QList<KoPattern*> &patterns, int size, QAtomicInt *numErrors)
+        : m_patterns(patterns),
+          m_size(size),
+          m_numErrors(numErrors)
+    {
+    }
+
+    void run() override {
+        for (int i = 0; i < 200; i++) {
+            Q_FOREACH (KoPattern *pattern, m_patterns) {
+                const QImage image = pattern->pattern();
+
+                // the image must stay valid even if the pattern is evicted meanwhile
+                if (image.size() != QSize(m_size, m_size) ||
+                    image.pixel(m_size - 1, m_size - 1) != qRgb(255, 0, 0)) {
+
+                    m_numErrors->ref();
+                }
+
+                if (pattern->width() != m_size) {
+                    m_numErrors->ref();
+                }
+            }
+        }
+    }
+
+private:
+    QList<KoPattern*> m_patterns;
+    int m_size;
+    QAtomicInt *m_numErrors;
+};
+}
+
+void TestKoResourceCache::testLazyLoading()
+{
+    QTemporaryDir dir;
+    const QString filename = createPatternFile(dir, "pattern", 64);
+
+    QImage thumbnail(16, 16, QImage::Format_ARGB32);
+    thumbnail.fill(Qt::blue);
+
+    KoPattern pattern(filename);
+    pattern.setLazyLoaded("Lazy Pattern", "md5sum", thumbnail);
+
+    QVERIFY(pattern.valid());
+    QVERIFY(!pattern.isLoaded());
+    QCOMPARE(pattern.name(), QString("Lazy Pattern"));
+    QCOMPARE(pattern.image(), thumbnail);
+
+    QCOMPARE(pattern.pattern().size(), QSize(64, 64));
+    QVERIFY(pattern.isLoaded());
+
+    // the metadata is not overwritten by the file
+    QCOMPARE(pattern.name(), QString("Lazy Pattern"));
+    QCOMPARE(pattern.md5(), QByteArray("md5sum"));
+    QCOMPARE(pattern.image(), thumbnail);
+}
+
+void TestKoResourceCache::testEviction()
+{
+    QTemporaryDir dir;
+    KoResourceCache *cache = KoResourceCache::instance();
+    const qint64 oldMaxSize = cache->maxDataSize();
+
+    // enough for two patterns only
+    const int patternSize = 128;
+    cache->setMaxDataSize(2 * patternSize * patternSize * 4);
+
+    KoPattern pattern1(createPatternFile(dir, "pattern1", patternSize));
+    KoPattern pattern2(createPatternFile(dir, "pattern2", patternSize));
+    KoPattern pattern3(createPatternFile(dir, "pattern3", patternSize));
+
+    pattern1.setLazyLoaded("Pattern 1", "md5sum1", QImage());
+    pattern2.setLazyLoaded("Pattern 2", "md5sum2", QImage());
+    pattern3.setLazyLoaded("Pattern 3", "md5sum3", QImage());
+
+    QCOMPARE(pattern1.width(), patternSize);
+    QCOMPARE(pattern2.width(), patternSize);
+    QVERIFY(pattern1.isLoaded());
+    QVERIFY(pattern2.isLoaded());
+
+    // touch the first pattern, so that the second one is the least recently used
+    QCOMPARE(pattern1.width(), patternSize);
+
+    QCOMPARE(pattern3.width(), patternSize);
+    QVERIFY(pattern1.isLoaded());
+    QVERIFY(!pattern2.isLoaded());
+    QVERIFY(pattern3.isLoaded());
+    QVERIFY(cache->dataSize() <= cache->maxDataSize());
+
+    // the evicted pattern is loaded again on access
+    QCOMPARE(pattern2.pattern().size(), QSize(patternSize, patternSize));
+    QVERIFY(pattern2.isLoaded());
+
+    cache->setMaxDataSize(oldMaxSize);
+}
+
+void TestKoResourceCache::testConcurrentAccess()
+{
+    QTemporaryDir dir;
+    KoResourceCache *cache = KoResourceCache::instance();
+    const qint64 oldMaxSize = cache->maxDataSize();
+
+    // only one pattern fits, so every access of another thread evicts it
+    const int patternSize = 64;
+    cache->setMaxDataSize(patternSize * patternSize * 4);
+
+    QList<KoPattern*> patterns;
+    for (int i = 0; i < 4; i++) {
+        const QString name = QString("pattern%1").arg(i);
+        KoPattern *pattern = new KoPattern(createPatternFile(dir, name, patternSize));
+        pattern->setLazyLoaded(name, name.toLatin1(), QImage());
+        patterns << pattern;
+    }
+
+    QAtomicInt numErrors;
+    QList<PatternReader*> readers;
+    for (int i = 0; i < 4; i++) {
+        QList<KoPattern*> order = patterns;
+        std::rotate(order.begin(), order.begin() + i, order.end());
+        readers << new PatternReader(order, patternSize, &numErrors);
+    }
+
+    Q_FOREACH (PatternReader *reader, readers) {
+        reader->start();
+    }
+    Q_FOREACH (PatternReader *reader, readers) {
+        reader->wait();
+    }
+
+    QCOMPARE(int(numErrors), 0);
+    QVERIFY(cache->dataSize() <= cache->maxDataSize());
+
+    qDeleteAll(readers);
+    qDeleteAll(patterns);
+    cache->setMaxDataSize(oldMaxSize);
+}
+
+QTEST_GUILESS_MAIN(TestKoResourceCache)
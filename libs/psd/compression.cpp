@@ -89,7 +89,7 @@ static quint32 pack_pb_line (const QByteArray &src,
 
 
 // from gimp's psd-util.c
-quint32 decode_packbits(const char *src, char* dst, quint16 packed_len, quint32 unpacked_len)
+quint32 decode_packbits(const char *src, char* dst, quint32 packed_len, quint32 unpacked_len)
 {
     /*
      *  Decode a PackBits chunk.
@@ -238,6 +238,27 @@ QByteArray Compression::uncompress(quint32 unpacked_len, QByteArray bytes, Compr
     return QByteArray();
 }
 
+bool Compression::uncompress(const char *src, quint32 packed_len,
+                             char *dst, quint32 unpacked_len,
+                             Compression::CompressionType compressionType)
+{
+    switch(compressionType) {
+    case Uncompressed:
+    {
+        const quint32 len = qMin(packed_len, unpacked_len);
+        memcpy(dst, src, len);
+        memset(dst + len, 0, unpacked_len - len);
+        return true;
+    }
+    case RLE:
+        memset(dst, 0, unpacked_len);
+        decode_packbits(src, dst, packed_len, unpacked_len);
+        return true;
+    default:
+        return false;
+    }
+}
+
 QByteArray Compression::compress(QByteArray bytes, Compression::CompressionType compressionType)
 {
     if (bytes.size() < 1) return QByteArray();
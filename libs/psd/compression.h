@@ -34,6 +34,20 @@ public:
     };
 
     static QByteArray uncompress(quint32 unpacked_len, QByteArray bytes, CompressionType compressionType);
+
+    /**
+     * Decompresses \p packed_len bytes from \p src straight into \p dst
+     * without any intermediate allocations. Only Uncompressed and RLE
+     * data can be decoded this way, the ZIP streams should be inflated
+     * as a whole.
+     *
+     * The bytes of \p dst that could not be decoded are set to zero.
+     *
+     * @return false if the compression type is not supported
+     */
+    static bool uncompress(const char *src, quint32 packed_len,
+                           char *dst, quint32 unpacked_len,
+                           CompressionType compressionType);
     static QByteArray compress(QByteArray bytes, CompressionType compressionType);
 };
 
@@ -77,7 +77,9 @@
 #include <kis_meta_data_io_backend.h>
 #include "kisexiv2/kis_exiv2.h"
 #include "KisApplicationArguments.h"
+#include "KisBatchConversionService.h"
 #include <kis_debug.h>
+#include <KisStartupTrace.h>
 #include "kis_action_registry.h"
 #include <kis_brush_server.h>
 #include <KisResourceServerProvider.h>
@@ -284,19 +286,31 @@ void KisApplication::loadResources()
 
     setSplashScreenLoadingText(i18n("Loading Resources..."));
     processEvents();
-    KoResourceServerProvider::instance();
+    {
+        KisStartupTrace::Scope scope("KoResourceServerProvider", "startup");
+        KoResourceServerProvider::instance();
+    }
 
     setSplashScreenLoadingText(i18n("Loading Brush Presets..."));
     processEvents();
-    KisResourceServerProvider::instance();
+    {
+        KisStartupTrace::Scope scope("KisResourceServerProvider", "startup");
+        KisResourceServerProvider::instance();
+    }
 
     setSplashScreenLoadingText(i18n("Loading Brushes..."));
     processEvents();
-    KisBrushServer::instance()->brushServer();
+    {
+        KisStartupTrace::Scope scope("KisBrushServer", "startup");
+        KisBrushServer::instance()->brushServer();
+    }
 
     setSplashScreenLoadingText(i18n("Loading Bundles..."));
     processEvents();
-    KisResourceBundleServerProvider::instance();
+    {
+        KisStartupTrace::Scope scope("KisResourceBundleServerProvider", "startup");
+        KisResourceBundleServerProvider::instance();
+    }
 }
 
 void KisApplication::loadResourceTags()
@@ -333,20 +347,15 @@ void KisApplication::loadPlugins()
 void KisApplication::loadGuiPlugins()
 {
     //    qDebug() << "loadGuiPlugins();";
-    // Load the krita-specific tools
-    setSplashScreenLoadingText(i18n("Loading Plugins for Krita/Tool..."));
-    processEvents();
-    //    qDebug() << "loading tools";
-    KoPluginLoader::instance()->load(QString::fromLatin1("Krita/Tool"),
-                                     QString::fromLatin1("[X-Krita-Version] == 28"));
-
-
-    // Load dockers
-    setSplashScreenLoadingText(i18n("Loading Plugins for Krita/Dock..."));
-    processEvents();
-    //    qDebug() << "loading dockers";
-    KoPluginLoader::instance()->load(QString::fromLatin1("Krita/Dock"),
-                                     QString::fromLatin1("[X-Krita-Version] == 28"));
+    // The krita-specific tools and dockers are loaded when the first main
+    // window needs them. Besides tools, the tool plugins register the
+    // painting assistant and transform mask factories, which loading of
+    // a document needs even in batch mode. Their registries load the
+    // deferred plugins on first use, see KoPluginLoader::loadDeferred()
+    KoPluginLoader::instance()->defer(QString::fromLatin1("Krita/Tool"),
+                                      QString::fromLatin1("[X-Krita-Version] == 28"));
+    KoPluginLoader::instance()->defer(QString::fromLatin1("Krita/Dock"),
+                                      QString::fromLatin1("[X-Krita-Version] == 28"));
 
     // XXX_EXIV: make the exiv io backends real plugins
     setSplashScreenLoadingText(i18n("Loading Plugins Exiv/IO..."));
@@ -357,6 +366,9 @@ void KisApplication::loadGuiPlugins()
 
 bool KisApplication::start(const KisApplicationArguments &args)
 {
+    KisStartupTrace *startupTrace = KisStartupTrace::instance();
+    const qint64 startTime = startupTrace->elapsed();
+
     KisConfig cfg(false);
 
 #if defined(Q_OS_WIN)
@@ -384,7 +396,10 @@ bool KisApplication::start(const KisApplicationArguments &args)
 
     setSplashScreenLoadingText(i18n("Initializing Globals"));
     processEvents();
-    initializeGlobals(args);
+    {
+        KisStartupTrace::Scope scope("initializeGlobals", "startup");
+        initializeGlobals(args);
+    }
 
     const bool doNewImage = args.doNewImage();
     const bool doTemplate = args.doTemplate();
@@ -392,10 +407,12 @@ bool KisApplication::start(const KisApplicationArguments &args)
     const bool exportSequence = args.exportSequence();
     const QString exportFileName = args.exportFileName();
 
-    d->batchRun = (exportAs || exportSequence || !exportFileName.isEmpty());
-    const bool needsMainWindow = (!exportAs && !exportSequence);
+    const bool batchConversion = args.batchConversion();
+
+    d->batchRun = (exportAs || exportSequence || batchConversion || !exportFileName.isEmpty());
+    const bool needsMainWindow = (!exportAs && !exportSequence && !batchConversion);
     // only show the mainWindow when no command-line mode option is passed
-    bool showmainWindow = (!exportAs && !exportSequence); // would be !batchRun;
+    bool showmainWindow = (!exportAs && !exportSequence && !batchConversion); // would be !batchRun;
 
     const bool showSplashScreen = !d->batchRun && qEnvironmentVariableIsEmpty("NOSPLASH");
     if (showSplashScreen && d->splashScreen) {
@@ -416,22 +433,39 @@ bool KisApplication::start(const KisApplicationArguments &args)
     // Make sure we can save resources and tags
     setSplashScreenLoadingText(i18n("Adding resource types"));
     processEvents();
-    addResourceTypes();
+    {
+        KisStartupTrace::Scope scope("addResourceTypes", "startup");
+        addResourceTypes();
+    }
 
     // Load the plugins
-    loadPlugins();
+    {
+        KisStartupTrace::Scope scope("loadPlugins", "startup");
+        loadPlugins();
+    }
 
     // Load all resources
-    loadResources();
+    {
+        KisStartupTrace::Scope scope("loadResources", "startup");
+        loadResources();
+    }
 
     // Load all the tags
-    loadResourceTags();
+    {
+        KisStartupTrace::Scope scope("loadResourceTags", "startup");
+        loadResourceTags();
+    }
 
     // Load the gui plugins
-    loadGuiPlugins();
+    {
+        KisStartupTrace::Scope scope("loadGuiPlugins", "startup");
+        loadGuiPlugins();
+    }
 
     KisPart *kisPart = KisPart::instance();
     if (needsMainWindow) {
+        KisStartupTrace::Scope scope("createMainWindow", "startup");
+
         // show a mainWindow asap, if we want that
         setSplashScreenLoadingText(i18n("Loading Main Window..."));
         processEvents();
@@ -491,12 +525,16 @@ bool KisApplication::start(const KisApplicationArguments &args)
 
     // Check for autosave files that can be restored, if we're not running a batchrun (test)
     if (!d->batchRun) {
+        KisStartupTrace::Scope scope("checkAutosaveFiles", "startup");
         checkAutosaveFiles();
     }
 
     setSplashScreenLoadingText(QString()); // done loading, so clear out label
     processEvents();
 
+    startupTrace->addEvent("KisApplication::start", "startup", startTime, startupTrace->elapsed() - startTime);
+    startupTrace->finish();
+
     //configure the unit manager
     KisSpinBoxUnitManagerFactory::setDefaultUnitManagerBuilder(new KisDocumentAwareSpinBoxUnitManagerBuilder());
     connect(this, &KisApplication::aboutToQuit, &KisSpinBoxUnitManagerFactory::clearUnitManagerBuilder); //ensure the builder is destroyed when the application leave.
@@ -512,6 +550,27 @@ bool KisApplication::start(const KisApplicationArguments &args)
         }
     }
 
+    if (batchConversion) {
+        KisBatchConversionService *service =
+            new KisBatchConversionService(args.batchParallelJobs(), this);
+
+        connect(service, &KisBatchConversionService::sigFinished,
+                this, [service] () { QApplication::exit(service->exitCode()); },
+                Qt::QueuedConnection);
+
+        if (!args.batchServer().isEmpty() && !service->listen(args.batchServer())) {
+            QTimer::singleShot(0, this, [] () { QApplication::exit(1); });
+            return false;
+        }
+
+        if (!args.batchJobs().isEmpty() && !service->addJobsFromFile(args.batchJobs())) {
+            QTimer::singleShot(0, this, [] () { QApplication::exit(1); });
+            return false;
+        }
+
+        return true;
+    }
+
     // Get the command line arguments which we have to parse
     int argsCount = args.filenames().count();
     if (argsCount > 0) {
@@ -45,6 +45,10 @@ struct Q_DECL_HIDDEN KisApplicationArguments::Private
     bool exportAs {false};
     bool exportSequence {false};
     QString exportFileName;
+    QString batchJobs;
+    QString batchServer;
+    int batchParallelJobs {0};
+    QString startupTrace;
     QString workspace;
     QString windowLayout;
     QString session;
@@ -101,6 +105,16 @@ KisApplicationArguments::KisApplicationArguments(const QApplication &app)
     parser.addOption(QCommandLineOption(QStringList() << QLatin1String("export"), i18n("Export to the given filename and exit")));
     parser.addOption(QCommandLineOption(QStringList() << QLatin1String("export-sequence"), i18n("Export animation to the given filename and exit")));
     parser.addOption(QCommandLineOption(QStringList() << QLatin1String("export-filename"), i18n("Filename for export"), QLatin1String("filename")));
+    parser.addOption(QCommandLineOption(QStringList() << QLatin1String("batch-jobs"), i18n("Run the conversion jobs listed in the given file and exit.\n"
+                                                                                           "Every line of the file is a JSON object:\n"
+                                                                                           "    {\"input\": \"in.kra\", \"output\": \"out.png\", \"mimetype\": \"image/png\", \"options\": {}}\n"
+                                                                                           "\"mimetype\" and \"options\" are optional. Use \"-\" to read the jobs from the standard input."),
+                                        QLatin1String("filename")));
+    parser.addOption(QCommandLineOption(QStringList() << QLatin1String("batch-server"), i18n("Accept conversion jobs from the local socket with the given name. "
+                                                                                             "The jobs have the same format as for --batch-jobs, send {\"command\": \"quit\"} to exit."),
+                                        QLatin1String("name")));
+    parser.addOption(QCommandLineOption(QStringList() << QLatin1String("batch-parallel"), i18n("The number of documents converted at once in the batch mode"), QLatin1String("count")));
+    parser.addOption(QCommandLineOption(QStringList() << QLatin1String("startup-trace"), i18n("Write the timings of the startup phases to the given file in the Chrome trace format"), QLatin1String("filename")));
     parser.addPositionalArgument(QLatin1String("[file(s)]"), i18n("File(s) or URL(s) to open"));
     parser.process(app);
 
@@ -143,6 +157,10 @@ KisApplicationArguments::KisApplicationArguments(const QApplication &app)
     d->doTemplate = parser.isSet("template");
     d->exportAs = parser.isSet("export");
     d->exportSequence = parser.isSet("export-sequence");
+    d->batchJobs = parser.value("batch-jobs");
+    d->batchServer = parser.value("batch-server");
+    d->batchParallelJobs = parser.value("batch-parallel").toInt();
+    d->startupTrace = parser.value("startup-trace");
     d->canvasOnly = parser.isSet("canvasonly");
     d->noSplash = parser.isSet("nosplash");
     d->fullScreen = parser.isSet("fullscreen");
@@ -162,6 +180,10 @@ KisApplicationArguments::KisApplicationArguments(const KisApplicationArguments &
     d->doTemplate = rhs.doTemplate();
     d->exportAs = rhs.exportAs();
     d->exportFileName = rhs.exportFileName();
+    d->batchJobs = rhs.batchJobs();
+    d->batchServer = rhs.batchServer();
+    d->batchParallelJobs = rhs.batchParallelJobs();
+    d->startupTrace = rhs.startupTrace();
     d->canvasOnly = rhs.canvasOnly();
     d->workspace = rhs.workspace();
     d->windowLayout = rhs.windowLayout();
@@ -178,6 +200,10 @@ void KisApplicationArguments::operator=(const KisApplicationArguments &rhs)
     d->doTemplate = rhs.doTemplate();
     d->exportAs = rhs.exportAs();
     d->exportFileName = rhs.exportFileName();
+    d->batchJobs = rhs.batchJobs();
+    d->batchServer = rhs.batchServer();
+    d->batchParallelJobs = rhs.batchParallelJobs();
+    d->startupTrace = rhs.startupTrace();
     d->canvasOnly = rhs.canvasOnly();
     d->workspace = rhs.workspace();
     d->windowLayout = rhs.windowLayout();
@@ -295,6 +321,31 @@ QString KisApplicationArguments::exportFileName() const
     return d->exportFileName;
 }
 
+QString KisApplicationArguments::batchJobs() const
+{
+    return d->batchJobs;
+}
+
+QString KisApplicationArguments::batchServer() const
+{
+    return d->batchServer;
+}
+
+int KisApplicationArguments::batchParallelJobs() const
+{
+    return d->batchParallelJobs;
+}
+
+QString KisApplicationArguments::startupTrace() const
+{
+    return d->startupTrace;
+}
+
+bool KisApplicationArguments::batchConversion() const
+{
+    return !d->batchJobs.isEmpty() || !d->batchServer.isEmpty();
+}
+
 QString KisApplicationArguments::workspace() const
 {
     return d->workspace;
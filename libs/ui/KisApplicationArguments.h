@@ -48,6 +48,34 @@ public:
     bool exportAs() const;
     bool exportSequence() const;
     QString exportFileName() const;
+
+    /**
+     * The file with the conversion jobs for the batch mode, "-" means
+     * the standard input
+     */
+    QString batchJobs() const;
+
+    /**
+     * The name of the local socket the batch mode accepts the
+     * conversion jobs from
+     */
+    QString batchServer() const;
+
+    /**
+     * The maximum number of documents converted at once in the batch mode
+     */
+    int batchParallelJobs() const;
+
+    /**
+     * The file the timings of the startup are written to, see KisStartupTrace
+     */
+    QString startupTrace() const;
+
+    /**
+     * @return true if either batchJobs() or batchServer() is set
+     */
+    bool batchConversion() const;
+
     QString workspace() const;
     QString windowLayout() const;
     QString session() const;
@@ -0,0 +1,347 @@
+/*
+ *  Copyright (c) 2020 Krita developers
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include "KisBatchConversionService.h"
+
+#include <cstdio>
+
+#include <QApplication>
+#include <QDir>
+#include <QFile>
+#include <QHash>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QPointer>
+#include <QQueue>
+#include <QThread>
+#include <QTimer>
+#include <QUrl>
+
+#include <KisMimeDatabase.h>
+#include <kis_debug.h>
+#include <kis_image.h>
+#include <kis_memory_statistics_server.h>
+#include <kis_properties_configuration.h>
+
+#include "KisDocument.h"
+#include "KisPart.h"
+
+namespace {
+
+struct ConversionJob {
+    QString input;
+    QString output;
+    QByteArray mimeType;
+    KisPropertiesConfigurationSP options;
+
+    bool fromClient = false;
+    QPointer<QLocalSocket> client;
+};
+
+}
+
+struct KisBatchConversionService::Private
+{
+    KisBatchConversionService *q = 0;
+
+    int maxParallelJobs = 1;
+    int numFailedJobs = 0;
+
+    QQueue<ConversionJob> pendingJobs;
+    QHash<KisDocument*, ConversionJob> runningJobs;
+
+    QLocalServer *server = 0;
+    bool acceptsJobs = false;
+    bool isStartingJobs = false;
+    bool isFinished = false;
+
+    QFile standardOutput;
+
+    bool parseJob(const QByteArray &line, ConversionJob *job, QString *errorMessage);
+    void reportResult(const ConversionJob &job, bool success, const QString &message = QString());
+    void addJob(const QByteArray &line, QLocalSocket *client);
+    bool memoryIsExhausted() const;
+};
+
+bool KisBatchConversionService::Private::parseJob(const QByteArray &line, ConversionJob *job, QString *errorMessage)
+{
+    QJsonParseError error;
+    const QJsonDocument doc = QJsonDocument::fromJson(line, &error);
+
+    if (!doc.isObject()) {
+        *errorMessage = error.errorString();
+        return false;
+    }
+
+    const QJsonObject object = doc.object();
+    const QDir currentDir = QDir::current();
+
+    if (object.contains("input")) {
+        job->input = currentDir.absoluteFilePath(object.value("input").toString());
+    }
+    if (object.contains("output")) {
+        job->output = currentDir.absoluteFilePath(object.value("output").toString());
+    }
+
+    if (job->input.isEmpty() || job->output.isEmpty()) {
+        *errorMessage = "both \"input\" and \"output\" should be specified";
+        return false;
+    }
+
+    job->mimeType = object.value("mimetype").toString().toLatin1();
+    if (job->mimeType.isEmpty()) {
+        job->mimeType = KisMimeDatabase::mimeTypeForFile(job->output, false).toLatin1();
+    }
+
+    if (job->mimeType.isEmpty() || job->mimeType == "application/octetstream") {
+        *errorMessage = "unknown output mimetype";
+        return false;
+    }
+
+    const QJsonObject options = object.value("options").toObject();
+    if (!options.isEmpty()) {
+        job->options = new KisPropertiesConfiguration();
+
+        for (auto it = options.constBegin(); it != options.constEnd(); ++it) {
+            job->options->setProperty(it.key(), it.value().toVariant());
+        }
+    }
+
+    return true;
+}
+
+void KisBatchConversionService::Private::reportResult(const ConversionJob &job, bool success, const QString &message)
+{
+    if (!success) {
+        numFailedJobs++;
+        errKrita << "Could not convert" << job.input << "to" << job.output << ":" << message;
+    }
+
+    QJsonObject object;
+    object.insert("input", job.input);
+    object.insert("output", job.output);
+    object.insert("status", success ? "ok" : "error");
+    if (!message.isEmpty()) {
+        object.insert("message", message);
+    }
+
+    emit q->sigJobResult(job.input, job.output, success, message);
+
+    const QByteArray result = QJsonDocument(object).toJson(QJsonDocument::Compact) + '\n';
+
+    if (job.fromClient) {
+        // the client might have disconnected already
+        if (job.client) {
+            job.client->write(result);
+            job.client->flush();
+        }
+    } else {
+        standardOutput.write(result);
+        standardOutput.flush();
+    }
+}
+
+void KisBatchConversionService::Private::addJob(const QByteArray &rawLine, QLocalSocket *client)
+{
+    const QByteArray line = rawLine.trimmed();
+    if (line.isEmpty() || line.startsWith('#')) return;
+
+    if (client) {
+        const QJsonObject object = QJsonDocument::fromJson(line).object();
+        if (object.value("command").toString() == "quit") {
+            acceptsJobs = false;
+            return;
+        }
+    }
+
+    ConversionJob job;
+    job.fromClient = client;
+    job.client = client;
+
+    QString errorMessage;
+    if (!parseJob(line, &job, &errorMessage)) {
+        reportResult(job, false, errorMessage);
+        return;
+    }
+
+    pendingJobs.enqueue(job);
+}
+
+bool KisBatchConversionService::Private::memoryIsExhausted() const
+{
+    KisMemoryStatisticsServer::Statistics stats =
+        KisMemoryStatisticsServer::instance()->fetchMemoryStatistics(0);
+
+    return stats.realMemorySize > stats.tilesSoftLimit;
+}
+
+KisBatchConversionService::KisBatchConversionService(int maxParallelJobs, QObject *parent)
+    : QObject(parent),
+      m_d(new Private)
+{
+    m_d->q = this;
+
+    m_d->maxParallelJobs =
+        maxParallelJobs > 0 ? maxParallelJobs : qMax(1, QThread::idealThreadCount() / 2);
+
+    m_d->standardOutput.open(stdout, QIODevice::WriteOnly);
+}
+
+KisBatchConversionService::~KisBatchConversionService()
+{
+}
+
+bool KisBatchConversionService::addJobsFromFile(const QString &fileName)
+{
+    QFile file(fileName);
+
+    const bool result = fileName == "-" ?
+        file.open(stdin, QIODevice::ReadOnly) :
+        file.open(QIODevice::ReadOnly);
+
+    if (!result) {
+        errKrita << "Could not open the batch jobs file" << fileName;
+        return false;
+    }
+
+    while (!file.atEnd()) {
+        m_d->addJob(file.readLine(), 0);
+    }
+
+    QTimer::singleShot(0, this, SLOT(slotStartJobs()));
+    return true;
+}
+
+bool KisBatchConversionService::listen(const QString &serverName)
+{
+    KIS_SAFE_ASSERT_RECOVER_RETURN_VALUE(!m_d->server, false);
+
+    m_d->server = new QLocalServer(this);
+    connect(m_d->server, SIGNAL(newConnection()), SLOT(slotNewConnection()));
+
+    if (!m_d->server->listen(serverName)) {
+        errKrita << "Could not listen to" << serverName << ":" << m_d->server->errorString();
+        return false;
+    }
+
+    m_d->acceptsJobs = true;
+    return true;
+}
+
+int KisBatchConversionService::exitCode() const
+{
+    return m_d->numFailedJobs > 0 ? 1 : 0;
+}
+
+void KisBatchConversionService::slotNewConnection()
+{
+    while (QLocalSocket *socket = m_d->server->nextPendingConnection()) {
+        connect(socket, SIGNAL(readyRead()), SLOT(slotReadyRead()));
+        connect(socket, SIGNAL(disconnected()), socket, SLOT(deleteLater()));
+    }
+}
+
+void KisBatchConversionService::slotReadyRead()
+{
+    QLocalSocket *socket = qobject_cast<QLocalSocket*>(sender());
+    KIS_SAFE_ASSERT_RECOVER_RETURN(socket);
+
+    while (socket->canReadLine()) {
+        m_d->addJob(socket->readLine(), socket);
+    }
+
+    QTimer::singleShot(0, this, SLOT(slotStartJobs()));
+}
+
+void KisBatchConversionService::slotStartJobs()
+{
+    /**
+     * Loading of a document processes events, so we can be called
+     * recursively. The outer call will start the jobs anyway.
+     */
+    if (m_d->isStartingJobs) return;
+    m_d->isStartingJobs = true;
+
+    while (!m_d->pendingJobs.isEmpty() &&
+           m_d->runningJobs.size() < m_d->maxParallelJobs) {
+
+        // wait for the running jobs to release some memory
+        if (!m_d->runningJobs.isEmpty() && m_d->memoryIsExhausted()) break;
+
+        const ConversionJob job = m_d->pendingJobs.dequeue();
+
+        KisDocument *doc = KisPart::instance()->createDocument();
+        doc->setFileBatchMode(true);
+
+        if (!doc->openUrl(QUrl::fromLocalFile(job.input))) {
+            const QString message = doc->errorMessage();
+            m_d->reportResult(job, false, !message.isEmpty() ? message : "could not open the input file");
+            delete doc;
+            continue;
+        }
+
+        qApp->processEvents(); // For vector layers to be updated
+        doc->image()->waitForDone();
+
+        connect(doc, SIGNAL(sigCompleteBackgroundSaving(KritaUtils::ExportFileJob, KisImportExportErrorCode, QString)),
+                this, SLOT(slotJobCompleted(KritaUtils::ExportFileJob, KisImportExportErrorCode, QString)));
+
+        m_d->runningJobs.insert(doc, job);
+
+        const bool started =
+            doc->exportDocument(QUrl::fromLocalFile(job.output), job.mimeType, false, job.options);
+
+        // the document might have already reported the failure
+        if (!started && m_d->runningJobs.contains(doc)) {
+            m_d->runningJobs.remove(doc);
+            const QString message = doc->errorMessage();
+            m_d->reportResult(job, false, !message.isEmpty() ? message : "could not export the document");
+            doc->deleteLater();
+        }
+    }
+
+    m_d->isStartingJobs = false;
+
+    if (m_d->pendingJobs.isEmpty() && m_d->runningJobs.isEmpty() &&
+        !m_d->acceptsJobs && !m_d->isFinished) {
+
+        m_d->isFinished = true;
+        emit sigFinished(m_d->numFailedJobs);
+    }
+}
+
+void KisBatchConversionService::slotJobCompleted(const KritaUtils::ExportFileJob &exportJob, KisImportExportErrorCode status, const QString &errorMessage)
+{
+    Q_UNUSED(exportJob);
+
+    KisDocument *doc = qobject_cast<KisDocument*>(sender());
+    KIS_SAFE_ASSERT_RECOVER_RETURN(doc);
+
+    if (!m_d->runningJobs.contains(doc)) return;
+
+    const ConversionJob job = m_d->runningJobs.take(doc);
+    m_d->reportResult(job, status.isOk(),
+                      status.isOk() ? QString() :
+                      !errorMessage.isEmpty() ? errorMessage : status.errorMessage());
+
+    doc->deleteLater();
+
+    QTimer::singleShot(0, this, SLOT(slotStartJobs()));
+}
@@ -0,0 +1,103 @@
+/*
+ *  Copyright (c) 2020 Krita developers
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#ifndef KISBATCHCONVERSIONSERVICE_H
+#define KISBATCHCONVERSIONSERVICE_H
+
+#include <QObject>
+#include <QScopedPointer>
+
+#include "KisImportExportErrorCode.h"
+#include "KisImportExportUtils.h"
+#include "kritaui_export.h"
+
+/**
+ * Converts documents from one format into another in an already
+ * initialized process, so the plugins, resources and color profiles
+ * are loaded only once for the whole batch.
+ *
+ * The jobs are read from a file or from a local socket, one JSON object
+ * per line:
+ *
+ * {"input": "in.kra", "output": "out.png", "mimetype": "image/png", "options": {"compression": 9}}
+ *
+ * "mimetype" is guessed from the output file name if omitted, "options"
+ * are passed to the export filter as its configuration. The result of
+ * every job is reported as a JSON line as well, into the socket the job
+ * came from or into the standard output:
+ *
+ * {"input": "in.kra", "output": "out.png", "status": "ok"}
+ * {"input": "in.kra", "output": "out.png", "status": "error", "message": "..."}
+ *
+ * The documents are loaded one by one in the GUI thread and exported in
+ * the background, so several documents are in flight at once. No new
+ * document is loaded while the tiles engine is above its soft memory
+ * limit.
+ */
+class KRITAUI_EXPORT KisBatchConversionService : public QObject
+{
+    Q_OBJECT
+public:
+    /**
+     * \p maxParallelJobs is the number of documents converted at once,
+     * zero means half of the ideal thread count
+     */
+    KisBatchConversionService(int maxParallelJobs, QObject *parent = 0);
+    ~KisBatchConversionService() override;
+
+    /**
+     * Adds the jobs listed in \p fileName, "-" reads the standard input
+     */
+    bool addJobsFromFile(const QString &fileName);
+
+    /**
+     * Starts accepting the jobs from the local socket \p serverName.
+     * The service finishes only after receiving {"command": "quit"}.
+     */
+    bool listen(const QString &serverName);
+
+    /**
+     * \return the exit code of the batch conversion process: 0 if all
+     * the jobs have been converted successfully, 1 otherwise
+     */
+    int exitCode() const;
+
+Q_SIGNALS:
+    /**
+     * Emitted for every job after it is converted or has failed, the
+     * same result is reported to the job's client or the standard output
+     */
+    void sigJobResult(const QString &input, const QString &output, bool success, const QString &message);
+
+    /**
+     * Emitted when all the jobs are done and no more jobs are expected
+     */
+    void sigFinished(int numFailedJobs);
+
+private Q_SLOTS:
+    void slotNewConnection();
+    void slotReadyRead();
+    void slotStartJobs();
+    void slotJobCompleted(const KritaUtils::ExportFileJob &job, KisImportExportErrorCode status, const QString &errorMessage);
+
+private:
+    struct Private;
+    const QScopedPointer<Private> m_d;
+};
+
+#endif // KISBATCHCONVERSIONSERVICE_H
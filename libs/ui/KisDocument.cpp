@@ -246,6 +246,7 @@ public:
         , globalAssistantsColor(KisConfig(true).defaultAssistantsColor())
         , savingLock(&savingMutex)
         , batchMode(false)
+        , saveCacheToken(new QObject(), &QObject::deleteLater)
     {
         if (QLocale().measurementSystem() == QLocale::ImperialSystem) {
             unit = KoUnit::Inch;
@@ -264,6 +265,7 @@ public:
         , preActivatedNode(0) // the node is from another hierarchy!
         , imageIdleWatcher(2000 /*ms*/)
         , savingLock(&savingMutex)
+        , saveCacheToken(rhs.saveCacheToken)
     {
         copyFromImpl(rhs, _q, CONSTRUCT);
     }
@@ -341,6 +343,8 @@ public:
 
     bool batchMode { false };
 
+    QSharedPointer<QObject> saveCacheToken;
+
     void syncDecorationsWrapperLayerState();
 
     void setImageAndInitIdleWatcher(KisImageSP _image) {
@@ -1672,6 +1676,16 @@ void KisDocument::setWarningMessage(const QString& warningMsg)
     d->lastWarningMessage = warningMsg;
 }
 
+void KisDocument::setLoadingPreview(const QImage &preview)
+{
+    emit sigLoadingPreviewAvailable(preview);
+}
+
+QSharedPointer<QObject> KisDocument::saveCacheToken() const
+{
+    return d->saveCacheToken;
+}
+
 QString KisDocument::warningMessage() const
 {
     return d->lastWarningMessage;
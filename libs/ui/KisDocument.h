@@ -24,6 +24,7 @@
 #include <QDateTime>
 #include <QTransform>
 #include <QList>
+#include <QSharedPointer>
 
 #include <klocalizedstring.h>
 
@@ -47,6 +48,7 @@
 #include <memory>
 
 class QString;
+class QImage;
 
 class KUndo2Command;
 class KoUnit;
@@ -235,6 +237,21 @@ public:
      */
     QString warningMessage() const;
 
+    /**
+     * Called by the import filters when they find a ready-made preview
+     * of the image in the file (e.g. the preview pyramid in .kra), so the
+     * user can see it while the rest of the document is being loaded.
+     */
+    void setLoadingPreview(const QImage &preview);
+
+    /**
+     * An object shared by the document and all the clones made from it
+     * for saving. It is destroyed together with the last of them, so the
+     * savers can use it to tell when the data they keep between the
+     * saves of the document can be released.
+     */
+    QSharedPointer<QObject> saveCacheToken() const;
+
     /**
      * @brief Generates a preview picture of the document
      * @note The preview is used in the File Dialog and also to create the Thumbnail
@@ -451,6 +468,12 @@ Q_SIGNALS:
 
     void sigLoadingFinished();
 
+    /**
+     * Emitted when the import filter has found a preview of the image
+     * being loaded. The image is not yet available at this moment.
+     */
+    void sigLoadingPreviewAvailable(const QImage &preview);
+
     void sigSavingFinished();
 
     void sigGuidesConfigChanged(const KisGuidesConfig &config);
@@ -148,6 +148,7 @@
 #include <kritaversion.h>
 #include "KisCanvasWindow.h"
 #include "kis_action.h"
+#include "widgets/KisLoadingPreviewWidget.h"
 
 #include <mutex>
 
@@ -271,6 +272,7 @@ public:
 
 
     QStackedWidget *widgetStack {0};
+    QPointer<KisLoadingPreviewWidget> loadingPreview;
 
     QMdiArea *mdiArea;
     QMdiSubWindow *activeSubWindow  {0};
@@ -949,6 +951,7 @@ bool KisMainWindow::openDocumentInternal(const QUrl &url, OpenFlags flags)
     d->firstTime = true;
     connect(newdoc, SIGNAL(completed()), this, SLOT(slotLoadCompleted()));
     connect(newdoc, SIGNAL(canceled(QString)), this, SLOT(slotLoadCanceled(QString)));
+    connect(newdoc, SIGNAL(sigLoadingPreviewAvailable(QImage)), this, SLOT(slotLoadingPreviewAvailable(QImage)));
 
     KisDocument::OpenFlags openFlags = KisDocument::None;
     if (flags & RecoveryFile) {
@@ -957,6 +960,7 @@ bool KisMainWindow::openDocumentInternal(const QUrl &url, OpenFlags flags)
 
     bool openRet = !(flags & Import) ? newdoc->openUrl(url, openFlags) : newdoc->importDocument(url);
 
+    delete d->loadingPreview;
 
     if (!openRet) {
         delete newdoc;
@@ -1019,11 +1023,28 @@ void KisMainWindow::slotLoadCompleted()
 
         disconnect(newdoc, SIGNAL(completed()), this, SLOT(slotLoadCompleted()));
         disconnect(newdoc, SIGNAL(canceled(QString)), this, SLOT(slotLoadCanceled(QString)));
+        disconnect(newdoc, SIGNAL(sigLoadingPreviewAvailable(QImage)), this, SLOT(slotLoadingPreviewAvailable(QImage)));
 
         emit loadCompleted();
     }
 }
 
+void KisMainWindow::slotLoadingPreviewAvailable(const QImage &preview)
+{
+    if (preview.isNull()) return;
+
+    /**
+     * The document is loaded in the GUI thread, but the progress
+     * reporting processes the events, so the preview is painted and
+     * can be zoomed and panned while the layers are being loaded.
+     */
+    delete d->loadingPreview;
+    d->loadingPreview = new KisLoadingPreviewWidget(preview, d->widgetStack);
+    d->loadingPreview->setGeometry(d->widgetStack->rect());
+    d->loadingPreview->show();
+    d->loadingPreview->raise();
+}
+
 void KisMainWindow::slotLoadCanceled(const QString & errMsg)
 {
     dbgUI << "KisMainWindow::slotLoadCanceled";
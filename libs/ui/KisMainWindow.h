@@ -321,6 +321,7 @@ private Q_SLOTS:
 
     void slotLoadCompleted();
     void slotLoadCanceled(const QString &);
+    void slotLoadingPreviewAvailable(const QImage &preview);
     void slotSaveCompleted();
     void slotSaveCanceled(const QString &);
     void forceDockTabFonts();
@@ -67,6 +67,8 @@ KisResourceServerProvider::KisResourceServerProvider()
     m_sessionServer->loadResources(KoResourceServerProvider::blacklistFileNames(m_sessionServer->fileNames(), m_sessionServer->blackListedFiles()));
 
     m_layerStyleCollectionServer = new KoResourceServerSimpleConstruction<KisPSDLayerStyleCollectionResource>("psd_layer_style_collections", "*.asl");
+    // loading the styles registers their patterns in the pattern server, keep it in one thread
+    m_layerStyleCollectionServer->setLoadInParallel(false);
     m_layerStyleCollectionServer->loadResources(KoResourceServerProvider::blacklistFileNames(m_layerStyleCollectionServer->fileNames(), m_layerStyleCollectionServer->blackListedFiles()));
 
     connect(this, SIGNAL(notifyBrushBlacklistCleanup()),
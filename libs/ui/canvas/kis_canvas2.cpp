@@ -96,6 +96,8 @@
 #include "KoZoomController.h"
 
 #include <KisStrokeSpeedMonitor.h>
+#include <KisAdaptiveLodController.h>
+#include "kis_paintop_preset.h"
 #include "opengl/kis_opengl_canvas_debugger.h"
 
 #include "kis_algebra_2d.h"
@@ -229,6 +231,8 @@ void KisCanvas2::setup()
     m_d->animationPlayer = new KisAnimationPlayer(this);
     connect(m_d->view->canvasController()->proxyObject, SIGNAL(moveDocumentOffset(QPoint)), SLOT(documentOffsetMoved(QPoint)));
     connect(KisConfigNotifier::instance(), SIGNAL(configChanged()), SLOT(slotConfigChanged()));
+    connect(KisAdaptiveLodController::instance(), SIGNAL(sigPreferredLevelOfDetailChanged()), SLOT(slotPreferredLevelOfDetailChanged()));
+    connect(resourceManager(), SIGNAL(canvasResourceChanged(int,QVariant)), SLOT(slotCanvasResourceChanged(int)));
 
     /**
      * We switch the shape manager every time vector layer or
@@ -809,6 +813,12 @@ void KisCanvas2::updateCanvasProjection()
     KisUpdateInfoList originalInfoObjects;
     m_d->projectionUpdatesCompressor.takeUpdateInfo(originalInfoObjects);
 
+    if (m_d->currentCanvasIsOpenGL) {
+        KisOpenglCanvasDebugger::instance()->
+            notifyUpdatesCompression(m_d->projectionUpdatesCompressor.mergedTilesCount(),
+                                     m_d->projectionUpdatesCompressor.droppedUpdatesCount());
+    }
+
     for (auto it = originalInfoObjects.constBegin();
          it != originalInfoObjects.constEnd();
          ++it) {
@@ -966,6 +976,9 @@ void KisCanvas2::slotUpdateRegionOfInterest()
 
     m_d->regionOfInterest = imageRect.contains(proposedRoi) ? proposedRoi : imageRect;
 
+    m_d->projectionUpdatesCompressor.setViewportImageRect(
+        m_d->coordinatesConverter->widgetRectInImagePixels().toAlignedRect() & imageRect);
+
     if (m_d->regionOfInterest != oldRegionOfInterest) {
         emit sigRegionOfInterestChanged(m_d->regionOfInterest);
     }
@@ -1005,7 +1018,16 @@ void KisCanvas2::notifyLevelOfDetailChange()
     KisConfig cfg(true);
     const int maxLod = cfg.numMipmapLevels();
 
-    const int lod = KisLodTransform::scaleToLod(effectiveZoom, maxLod);
+    int lod = KisLodTransform::scaleToLod(effectiveZoom, maxLod);
+
+    /**
+     * Heavy brushes may make the stroke lag even when the zoom level
+     * itself doesn't require any LoD. In such a case the adaptive
+     * controller will ask for a coarser preview for the current preset.
+     */
+    KisPaintOpPresetSP preset =
+        resourceManager()->resource(KisCanvasResourceProvider::CurrentPaintOpPreset).value<KisPaintOpPresetSP>();
+    lod = qMin(maxLod, qMax(lod, KisAdaptiveLodController::instance()->preferredLevelOfDetail(preset)));
 
     if (m_d->effectiveLodAllowedInImage()) {
         KisImageSP image = this->image();
@@ -1013,6 +1035,20 @@ void KisCanvas2::notifyLevelOfDetailChange()
     }
 }
 
+void KisCanvas2::slotPreferredLevelOfDetailChanged()
+{
+    notifyLevelOfDetailChange();
+}
+
+void KisCanvas2::slotCanvasResourceChanged(int key)
+{
+    if (key == KisCanvasResourceProvider::CurrentPaintOpPreset &&
+        KisAdaptiveLodController::instance()->isEnabled()) {
+
+        notifyLevelOfDetailChange();
+    }
+}
+
 const KoColorProfile *  KisCanvas2::monitorProfile()
 {
     return m_d->displayColorConverter.monitorProfile();
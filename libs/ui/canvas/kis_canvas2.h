@@ -285,6 +285,8 @@ private Q_SLOTS:
     void slotBeginUpdatesBatch();
     void slotEndUpdatesBatch();
     void slotSetLodUpdatesBlocked(bool value);
+    void slotPreferredLevelOfDetailChanged();
+    void slotCanvasResourceChanged(int key);
 
     /**
      * Called whenever the view widget needs to show a different part of
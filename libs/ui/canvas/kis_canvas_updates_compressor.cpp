@@ -18,6 +18,12 @@
 
 #include "kis_canvas_updates_compressor.h"
 
+#include <algorithm>
+#include <QHash>
+#include <QPair>
+
+#include <kis_lod_transform.h>
+
 bool KisCanvasUpdatesCompressor::putUpdateInfo(KisUpdateInfoSP info)
 {
     const int levelOfDetail = info->levelOfDetail();
@@ -39,6 +45,16 @@ bool KisCanvasUpdatesCompressor::putUpdateInfo(KisUpdateInfoSP info)
                  * may have tiles artifacts with "outdated" data
                  */
                 it = m_updatesList.erase(it);
+                m_droppedUpdatesCount++;
+            } else if ((*it)->canBeCompressed() &&
+                       compressTiles(it->data(), info.data())) {
+
+                /**
+                 * All the tiles of the old update have been superseded by
+                 * the new one, so the info can be dropped as well
+                 */
+                it = m_updatesList.erase(it);
+                m_droppedUpdatesCount++;
             } else {
                 ++it;
             }
@@ -54,6 +70,87 @@ void KisCanvasUpdatesCompressor::takeUpdateInfo(KisUpdateInfoList &list)
 {
     KIS_SAFE_ASSERT_RECOVER(list.isEmpty()) { list.clear(); }
 
+    QRect viewportImageRect;
+
+    {
+        QMutexLocker l(&m_mutex);
+        m_updatesList.swap(list);
+        viewportImageRect = m_viewportImageRect;
+    }
+
+    if (viewportImageRect.isEmpty()) return;
+
+    /**
+     * The tiles of a single info never overlap, so they can be uploaded
+     * in any order. Put the visible ones first.
+     */
+    Q_FOREACH (KisUpdateInfoSP info, list) {
+        KisOpenGLUpdateInfo *glInfo = dynamic_cast<KisOpenGLUpdateInfo*>(info.data());
+        if (!glInfo || glInfo->tileList.size() < 2) continue;
+
+        const int lod = glInfo->levelOfDetail();
+        const QRect viewportRect = lod > 0 ?
+            KisLodTransform::scaledRect(KisLodTransform::alignedRect(viewportImageRect, lod), lod) :
+            viewportImageRect;
+
+        std::stable_partition(glInfo->tileList.begin(), glInfo->tileList.end(),
+                              [viewportRect] (KisTextureTileUpdateInfoSP tile) {
+                                  return tile->realPatchRect().intersects(viewportRect);
+                              });
+    }
+}
+
+void KisCanvasUpdatesCompressor::setViewportImageRect(const QRect &rect)
+{
+    QMutexLocker l(&m_mutex);
+    m_viewportImageRect = rect;
+}
+
+int KisCanvasUpdatesCompressor::mergedTilesCount() const
+{
     QMutexLocker l(&m_mutex);
-    m_updatesList.swap(list);
+    return m_mergedTilesCount;
+}
+
+int KisCanvasUpdatesCompressor::droppedUpdatesCount() const
+{
+    QMutexLocker l(&m_mutex);
+    return m_droppedUpdatesCount;
+}
+
+bool KisCanvasUpdatesCompressor::compressTiles(KisUpdateInfo *oldInfo, const KisUpdateInfo *newInfo)
+{
+    KisOpenGLUpdateInfo *oldGLInfo = dynamic_cast<KisOpenGLUpdateInfo*>(oldInfo);
+    const KisOpenGLUpdateInfo *newGLInfo = dynamic_cast<const KisOpenGLUpdateInfo*>(newInfo);
+
+    if (!oldGLInfo || !newGLInfo ||
+        oldGLInfo->levelOfDetail() != newGLInfo->levelOfDetail() ||
+        !oldGLInfo->dirtyImageRect().intersects(newGLInfo->dirtyImageRect())) {
+
+        return false;
+    }
+
+    typedef QPair<int, int> TileIndex;
+
+    QHash<TileIndex, QRect> newPatches;
+    Q_FOREACH (KisTextureTileUpdateInfoSP tile, newGLInfo->tileList) {
+        newPatches.insert(TileIndex(tile->tileCol(), tile->tileRow()), tile->realPatchRect());
+    }
+
+    KisTextureTileUpdateInfoSPList::iterator it = oldGLInfo->tileList.begin();
+    while (it != oldGLInfo->tileList.end()) {
+        QHash<TileIndex, QRect>::const_iterator newPatch =
+            newPatches.constFind(TileIndex((*it)->tileCol(), (*it)->tileRow()));
+
+        if (newPatch != newPatches.constEnd() &&
+            newPatch->contains((*it)->realPatchRect())) {
+
+            it = oldGLInfo->tileList.erase(it);
+            m_mergedTilesCount++;
+        } else {
+            ++it;
+        }
+    }
+
+    return oldGLInfo->tileList.isEmpty();
 }
@@ -22,20 +22,58 @@
 #include <QList>
 #include <QMutex>
 #include <QMutexLocker>
+#include <QRect>
 
 #include "kis_update_info.h"
 
 typedef QList<KisUpdateInfoSP> KisUpdateInfoList;
 
+/**
+ * Collects the update infos generated by the image worker threads until
+ * the GUI thread is ready to upload them.
+ *
+ * Whole infos are dropped when a newer one covers their dirty rect. For
+ * the openGL canvas the compression is also done on the texture-tile grid:
+ * a queued tile patch that is fully covered by the same tile of a newer info
+ * is removed before it reaches the textures. When all tiles of a queued info
+ * are superseded, the info is dropped completely.
+ *
+ * On taking the updates, the tiles intersecting the viewport are moved to the
+ * beginning of every info so that the visible part of the canvas is uploaded
+ * first.
+ */
 class KisCanvasUpdatesCompressor
 {
 public:
     bool putUpdateInfo(KisUpdateInfoSP info);
     void takeUpdateInfo(KisUpdateInfoList &list);
 
+    /**
+     * Sets the part of the image (in image pixels, LoD 0) that is
+     * currently visible on the canvas
+     */
+    void setViewportImageRect(const QRect &rect);
+
+    /**
+     * The number of texture tiles removed from the queue, because a newer
+     * update has superseded them
+     */
+    int mergedTilesCount() const;
+
+    /**
+     * The number of update infos removed from the queue completely
+     */
+    int droppedUpdatesCount() const;
+
+private:
+    bool compressTiles(KisUpdateInfo *oldInfo, const KisUpdateInfo *newInfo);
+
 private:
-    QMutex m_mutex;
+    mutable QMutex m_mutex;
     KisUpdateInfoList m_updatesList;
+    QRect m_viewportImageRect;
+    int m_mergedTilesCount = 0;
+    int m_droppedUpdatesCount = 0;
 };
 
 #endif /* __KIS_CANVAS_UPDATES_COMPRESSOR_H */
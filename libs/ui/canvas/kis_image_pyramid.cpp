@@ -18,11 +18,13 @@
 #include "kis_image_pyramid.h"
 
 #include <QBitArray>
+#include <QtConcurrent>
 #include <KoChannelInfo.h>
 #include <KoCompositeOp.h>
 #include <KoColorSpaceRegistry.h>
 #include <KoColorModelStandardIds.h>
 #include <KoColorSpaceMaths.h>
+#include <KoLut3DColorConversionTransformation.h>
 
 #include "kis_display_filter.h"
 #include "kis_painter.h"
@@ -32,9 +34,14 @@
 #include "kis_debug.h"
 #include "kis_config.h"
 #include "kis_image_config.h"
+#include "krita_utils.h"
 
 //#define DEBUG_PYRAMID
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
 #include <config-ocio.h>
 #ifdef HAVE_OCIO
 #include <OpenColorIO/OpenColorIO.h>
@@ -89,11 +96,15 @@ inline void alignByPow2Lo(qint32 &value, qint32 alignment)
 
 inline void alignRectBy2(qint32 &x, qint32 &y, qint32 &w, qint32 &h)
 {
-    x -= isOdd(x);
-    y -= isOdd(y);
-    w += isOdd(x);
+    if (isOdd(x)) {
+        x--;
+        w++;
+    }
+    if (isOdd(y)) {
+        y--;
+        h++;
+    }
     w += isOdd(w);
-    h += isOdd(y);
     h += isOdd(h);
 }
 
@@ -104,6 +115,7 @@ KisImagePyramid::KisImagePyramid(qint32 pyramidHeight)
         : m_monitorProfile(0)
         , m_monitorColorSpace(0)
         , m_pyramidHeight(pyramidHeight)
+        , m_useDisplayLut(false)
 {
     configChanged();
     connect(KisConfigNotifier::instance(), SIGNAL(configChanged()), this, SLOT(configChanged()));
@@ -127,6 +139,11 @@ void KisImagePyramid::setMonitorProfile(const KoColorProfile* monitorProfile,
     m_renderingIntent = renderingIntent;
     m_conversionFlags = conversionFlags;
 
+    {
+        QMutexLocker l(&m_displayLutLock);
+        m_displayLut.clear();
+    }
+
     rebuildPyramid();
 }
 
@@ -158,6 +175,17 @@ void KisImagePyramid::setDisplayFilter(QSharedPointer<KisDisplayFilter> displayF
 
 void KisImagePyramid::rebuildPyramid()
 {
+    /**
+     * The planes are filled incrementally by the image updates, so
+     * we should not drop them unless the pixel format has really changed
+     */
+    if (m_pyramid.size() == m_pyramidHeight &&
+        !m_pyramid.isEmpty() &&
+        *m_pyramid.first()->colorSpace() == *m_monitorColorSpace) {
+
+        return;
+    }
+
     m_pyramid.clear();
     for (qint32 i = 0; i < m_pyramidHeight; i++) {
         m_pyramid.append(new KisPaintDevice(m_monitorColorSpace));
@@ -208,7 +236,13 @@ void KisImagePyramid::setImage(KisImageWSP newImage)
             }
 
         }
-        //TODO: check whether there is needed recalculateCache()
+
+        /**
+         * The downscaled planes are not touched by retrieveImageData(),
+         * so we should propagate the freshly fetched data explicitly,
+         * otherwise they will stay empty until the next image update
+         */
+        updatePyramidLevels(rc);
     }
 }
 
@@ -325,7 +359,13 @@ void KisImagePyramid::retrieveImageData(const QRect &rect)
         }
 
         QScopedArrayPointer<quint8> dst(new quint8[m_monitorColorSpace->pixelSize() * numPixels]);
-        projectionCs->convertPixelsTo(originalBytes.data(), dst.data(), m_monitorColorSpace, numPixels, m_renderingIntent, m_conversionFlags);
+
+        QSharedPointer<KoColorConversionTransformation> lut = displayLut(projectionCs);
+        if (lut) {
+            lut->transform(originalBytes.data(), dst.data(), numPixels);
+        } else {
+            projectionCs->convertPixelsTo(originalBytes.data(), dst.data(), m_monitorColorSpace, numPixels, m_renderingIntent, m_conversionFlags);
+        }
         originalBytes.swap(dst);
     }
 
@@ -334,17 +374,7 @@ void KisImagePyramid::retrieveImageData(const QRect &rect)
 
 void KisImagePyramid::recalculateCache(KisPPUpdateInfoSP info)
 {
-    KisPaintDevice *src;
-    KisPaintDevice *dst;
-    QRect currentSrcRect = info->dirtyImageRectVar;
-
-    for (int i = FIRST_NOT_ORIGINAL_INDEX; i < m_pyramidHeight; i++) {
-        src = m_pyramid[i-1].data();
-        dst = m_pyramid[i].data();
-        if (!currentSrcRect.isEmpty()) {
-            currentSrcRect = downsampleByFactor2(currentSrcRect, src, dst);
-        }
-    }
+    updatePyramidLevels(info->dirtyImageRectVar);
 
 #ifdef DEBUG_PYRAMID
     QImage image = m_pyramid[ORIGINAL_INDEX]->convertToQImage(m_monitorProfile, m_renderingIntent, m_conversionFlags);
@@ -360,6 +390,55 @@ void KisImagePyramid::recalculateCache(KisPPUpdateInfoSP info)
 #endif
 }
 
+void KisImagePyramid::updatePyramidLevels(const QRect &dirtyRect)
+{
+    if (m_pyramidHeight <= FIRST_NOT_ORIGINAL_INDEX || dirtyRect.isEmpty()) return;
+
+    /**
+     * Align the dirty rect to the size of a pixel of the topmost
+     * plane. Patches of such alignment never share any pixel on any
+     * level of the pyramid, so they can be downsampled concurrently
+     * without any locking.
+     */
+    const qint32 alignment = 1 << (m_pyramidHeight - 1);
+
+    qint32 x1, y1, x2, y2;
+    dirtyRect.getCoords(&x1, &y1, &x2, &y2);
+    alignByPow2Lo(x1, alignment);
+    alignByPow2Lo(y1, alignment);
+    alignByPow2ButOneHi(x2, alignment);
+    alignByPow2ButOneHi(y2, alignment);
+
+    QRect alignedRect;
+    alignedRect.setCoords(x1, y1, x2, y2);
+
+    qint32 patchWidth = m_updatePatchSize.width();
+    qint32 patchHeight = m_updatePatchSize.height();
+    alignByPow2Hi(patchWidth, alignment);
+    alignByPow2Hi(patchHeight, alignment);
+
+    const QVector<QRect> patches =
+        KritaUtils::splitRectIntoPatches(alignedRect, QSize(patchWidth, patchHeight));
+
+    auto downsamplePatch = [this] (const QRect &patchRect) {
+        QRect currentSrcRect = patchRect;
+
+        for (int i = FIRST_NOT_ORIGINAL_INDEX; i < m_pyramidHeight; i++) {
+            if (currentSrcRect.isEmpty()) break;
+
+            currentSrcRect = downsampleByFactor2(currentSrcRect,
+                                                 m_pyramid[i-1].data(),
+                                                 m_pyramid[i].data());
+        }
+    };
+
+    if (patches.size() > 1) {
+        QtConcurrent::blockingMap(patches, downsamplePatch);
+    } else if (!patches.isEmpty()) {
+        downsamplePatch(patches.first());
+    }
+}
+
 QRect KisImagePyramid::downsampleByFactor2(const QRect& srcRect,
         KisPaintDevice* src,
         KisPaintDevice* dst)
@@ -411,18 +490,64 @@ void  KisImagePyramid::downsamplePixels(const quint8 *srcRow0,
                                         quint8 *dstRow,
                                         qint32 numSrcPixels)
 {
+    qint32 numDstPixels = numSrcPixels / 2;
+
+#if defined(__SSE2__)
+    static const qint32 pixelSize = 4; // This is preview argb8 mode
+
     /**
-     * FIXME (mandatory): Use SSE and friends here.
+     * Process four destination pixels (that is, 2x8 source pixels)
+     * at a time. The channels are widened to 16 bits, so the sum of
+     * four 8-bit values cannot overflow. The result is truncated in
+     * exactly the same way the scalar version below does.
      */
+    const __m128i zero = _mm_setzero_si128();
+
+    for (; numDstPixels >= 4; numDstPixels -= 4) {
+        const __m128i row0lo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(srcRow0));
+        const __m128i row0hi = _mm_loadu_si128(reinterpret_cast<const __m128i*>(srcRow0 + 16));
+        const __m128i row1lo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(srcRow1));
+        const __m128i row1hi = _mm_loadu_si128(reinterpret_cast<const __m128i*>(srcRow1 + 16));
+
+        // vertical sums, each register holds two pixels
+        const __m128i sum01 = _mm_add_epi16(_mm_unpacklo_epi8(row0lo, zero), _mm_unpacklo_epi8(row1lo, zero));
+        const __m128i sum23 = _mm_add_epi16(_mm_unpackhi_epi8(row0lo, zero), _mm_unpackhi_epi8(row1lo, zero));
+        const __m128i sum45 = _mm_add_epi16(_mm_unpacklo_epi8(row0hi, zero), _mm_unpacklo_epi8(row1hi, zero));
+        const __m128i sum67 = _mm_add_epi16(_mm_unpackhi_epi8(row0hi, zero), _mm_unpackhi_epi8(row1hi, zero));
+
+        // horizontal sums of the neighbouring pixels
+        __m128i dst01 = _mm_add_epi16(_mm_unpacklo_epi64(sum01, sum23), _mm_unpackhi_epi64(sum01, sum23));
+        __m128i dst23 = _mm_add_epi16(_mm_unpacklo_epi64(sum45, sum67), _mm_unpackhi_epi64(sum45, sum67));
+
+        dst01 = _mm_srli_epi16(dst01, 2);
+        dst23 = _mm_srli_epi16(dst23, 2);
+
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dstRow), _mm_packus_epi16(dst01, dst23));
+
+        dstRow += 4 * pixelSize;
+        srcRow0 += 8 * pixelSize;
+        srcRow1 += 8 * pixelSize;
+    }
+#endif
+
+    downsamplePixelsScalar(srcRow0, srcRow1, dstRow, 2 * numDstPixels);
+}
+
+void KisImagePyramid::downsamplePixelsScalar(const quint8 *srcRow0,
+                                             const quint8 *srcRow1,
+                                             quint8 *dstRow,
+                                             qint32 numSrcPixels)
+{
+    static const qint32 pixelSize = 4; // This is preview argb8 mode
+
+    const qint32 numDstPixels = numSrcPixels / 2;
 
     qint16 b = 0;
     qint16 g = 0;
     qint16 r = 0;
     qint16 a = 0;
 
-    static const qint32 pixelSize = 4; // This is preview argb8 mode
-
-    for (qint32 i = 0; i < numSrcPixels / 2; i++) {
+    for (qint32 i = 0; i < numDstPixels; i++) {
         b = srcRow0[0] + srcRow1[0] + srcRow0[4] + srcRow1[4];
         g = srcRow0[1] + srcRow1[1] + srcRow0[5] + srcRow1[5];
         r = srcRow0[2] + srcRow1[2] + srcRow0[6] + srcRow1[6];
@@ -529,9 +654,41 @@ QImage KisImagePyramid::convertToQImageFast(KisPaintDeviceSP paintDevice,
     return image;
 }
 
+QSharedPointer<KoColorConversionTransformation> KisImagePyramid::displayLut(const KoColorSpace *srcColorSpace)
+{
+    QMutexLocker l(&m_displayLutLock);
+
+    if (!m_useDisplayLut || !m_monitorColorSpace ||
+        (*srcColorSpace == *m_monitorColorSpace &&
+         m_conversionFlags == KoColorConversionTransformation::Empty) ||
+        !KoLut3DColorConversionTransformation::isSupported(srcColorSpace, m_monitorColorSpace)) {
+
+        return QSharedPointer<KoColorConversionTransformation>();
+    }
+
+    if (!m_displayLut || !(*m_displayLut->srcColorSpace() == *srcColorSpace)) {
+        QScopedPointer<KoColorConversionTransformation> transform(
+            srcColorSpace->createColorConverter(m_monitorColorSpace, m_renderingIntent, m_conversionFlags));
+
+        m_displayLut.reset(KoLut3DColorConversionTransformation::create(transform.data()));
+    }
+
+    return m_displayLut;
+}
+
 void KisImagePyramid::configChanged()
 {
     KisConfig cfg(true);
     m_useOcio = cfg.useOcio();
+
+    {
+        QMutexLocker l(&m_displayLutLock);
+        m_useDisplayLut = cfg.useDisplayLut3D();
+        m_displayLut.clear();
+    }
+
+    KisImageConfig imageConfig(true);
+    m_updatePatchSize = QSize(imageConfig.updatePatchWidth(),
+                              imageConfig.updatePatchHeight());
 }
 
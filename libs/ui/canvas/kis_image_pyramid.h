@@ -20,6 +20,8 @@
 #define __KIS_IMAGE_PYRAMID
 
 #include <QImage>
+#include <QMutex>
+#include <QSharedPointer>
 #include <QVector>
 #include <QThreadStorage>
 
@@ -27,9 +29,10 @@
 #include <kis_image.h>
 #include <kis_paint_device.h>
 #include "kis_projection_backend.h"
+#include "kritaui_export.h"
 
 
-class KisImagePyramid : QObject, public KisProjectionBackend
+class KRITAUI_EXPORT KisImagePyramid : QObject, public KisProjectionBackend
 {
     Q_OBJECT
 
@@ -79,6 +82,13 @@ private:
     void rebuildPyramid();
     void clearPyramid();
 
+    /**
+     * Propagates the changes in @p dirtyRect of the original plane
+     * to all the downscaled planes of the pyramid. The rect is split
+     * into independent patches which are processed in parallel.
+     */
+    void updatePyramidLevels(const QRect &dirtyRect);
+
     /**
      * Downsamples @srcRect from @src paint device and writes
      * result into proper place of @dst paint device
@@ -92,8 +102,16 @@ private:
      * and @srcRow1 into one line @dstRow
      * Note: @numSrcPixels must be EVEN
      */
-    void downsamplePixels(const quint8 *srcRow0, const quint8 *srcRow1,
-                          quint8 *dstRow, qint32 numSrcPixels);
+    static void downsamplePixels(const quint8 *srcRow0, const quint8 *srcRow1,
+                                 quint8 *dstRow, qint32 numSrcPixels);
+
+    /**
+     * The portable version of downsamplePixels(). It is used for the
+     * tail of the row and when SSE2 is not available. Both versions
+     * must produce exactly the same result.
+     */
+    static void downsamplePixelsScalar(const quint8 *srcRow0, const quint8 *srcRow1,
+                                       quint8 *dstRow, qint32 numSrcPixels);
 
     /**
      * Searches for the last pyramid plane that can cover
@@ -109,10 +127,20 @@ private:
     QImage convertToQImageFast(KisPaintDeviceSP paintDevice,
                                const QRect& unscaledRect);
 
+    /**
+     * Returns the lookup table for conversion from \p srcColorSpace
+     * to the monitor color space, creating it on the first call, or
+     * null if the lookup table is disabled or not supported
+     */
+    QSharedPointer<KoColorConversionTransformation> displayLut(const KoColorSpace *srcColorSpace);
+
 private Q_SLOTS:
 
     void configChanged();
 
+private:
+    friend class KisImagePyramidTest;
+
 private:
 
     QVector<KisPaintDeviceSP> m_pyramid;
@@ -133,6 +161,11 @@ private:
     qint32 m_pyramidHeight;
 
     bool m_useOcio;
+    QSize m_updatePatchSize;
+
+    bool m_useDisplayLut;
+    QSharedPointer<KoColorConversionTransformation> m_displayLut;
+    QMutex m_displayLutLock;
 
     QBitArray m_channelFlags;
     bool m_allChannelsSelected;
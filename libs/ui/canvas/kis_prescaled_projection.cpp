@@ -95,9 +95,11 @@ KisPrescaledProjection::KisPrescaledProjection()
 {
     updateSettings();
 
-    // we disable building the pyramid with setting its height to 1
-    // XXX: setting it higher than 1 is broken because it's not updated until you show/hide the layer
-    m_d->projectionBackend = new KisImagePyramid(1);
+    // the pyramid covers zoom levels down to 1/8, lower zoom levels
+    // are scaled from the last plane. The downscaled planes take only
+    // a third of the memory of the original one, deeper pyramids would
+    // save little and force coarser alignment of the updated patches
+    m_d->projectionBackend = new KisImagePyramid(4);
 
     connect(KisConfigNotifier::instance(), SIGNAL(configChanged()), SLOT(updateSettings()));
 }
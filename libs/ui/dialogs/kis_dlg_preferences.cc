@@ -551,6 +551,7 @@ ColorSettingsTab::ColorSettingsTab(QWidget *parent, const char *name)
 
     m_page->chkBlackpoint->setChecked(cfg.useBlackPointCompensation());
     m_page->chkAllowLCMSOptimization->setChecked(cfg.allowLCMSOptimization());
+    m_page->chkUseDisplayLut3D->setChecked(cfg.useDisplayLut3D());
     m_page->chkForcePaletteColor->setChecked(cfg.forcePaletteColors());
     KisImageConfig cfgImage(true);
 
@@ -678,6 +679,7 @@ void ColorSettingsTab::setDefault()
 
     m_page->chkBlackpoint->setChecked(cfg.useBlackPointCompensation(true));
     m_page->chkAllowLCMSOptimization->setChecked(cfg.allowLCMSOptimization(true));
+    m_page->chkUseDisplayLut3D->setChecked(cfg.useDisplayLut3D(true));
     m_page->chkForcePaletteColor->setChecked(cfg.forcePaletteColors(true));
     m_page->cmbMonitorIntent->setCurrentIndex(cfg.monitorRenderIntent(true));
     m_page->chkUseSystemMonitorProfile->setChecked(cfg.useSystemMonitorProfile(true));
@@ -917,6 +919,7 @@ PerformanceTab::PerformanceTab(QWidget *parent, const char *name)
     intRegionOfInterestMargin->setSingleStep(1);
     intRegionOfInterestMargin->setPageStep(10);
 
+    connect(chkAdaptiveLevelOfDetail, SIGNAL(toggled(bool)), intAdaptiveLodLatencyBudget, SLOT(setEnabled(bool)));
     connect(chkCachedFramesSizeLimit, SIGNAL(toggled(bool)), intCachedFramesSizeLimit, SLOT(setEnabled(bool)));
     connect(chkUseRegionOfInterest, SIGNAL(toggled(bool)), intRegionOfInterestMargin, SLOT(setEnabled(bool)));
 
@@ -959,6 +962,9 @@ void PerformanceTab::load(bool requestDefault)
         KisConfig cfg2(true);
         chkOpenGLFramerateLogging->setChecked(cfg2.enableOpenGLFramerateLogging(requestDefault));
         chkBrushSpeedLogging->setChecked(cfg2.enableBrushSpeedLogging(requestDefault));
+        chkAdaptiveLevelOfDetail->setChecked(cfg2.adaptiveLevelOfDetail(requestDefault));
+        intAdaptiveLodLatencyBudget->setValue(cfg2.adaptiveLevelOfDetailLatencyBudget(requestDefault));
+        intAdaptiveLodLatencyBudget->setEnabled(chkAdaptiveLevelOfDetail->isChecked());
         chkDisableVectorOptimizations->setChecked(cfg2.enableAmdVectorizationWorkaround(requestDefault));
 #ifdef Q_OS_WIN
         chkDisableAVXOptimizations->setChecked(cfg2.disableAVXOptimizations(requestDefault));
@@ -1004,6 +1010,8 @@ void PerformanceTab::save()
         KisConfig cfg2(true);
         cfg2.setEnableOpenGLFramerateLogging(chkOpenGLFramerateLogging->isChecked());
         cfg2.setEnableBrushSpeedLogging(chkBrushSpeedLogging->isChecked());
+        cfg2.setAdaptiveLevelOfDetail(chkAdaptiveLevelOfDetail->isChecked());
+        cfg2.setAdaptiveLevelOfDetailLatencyBudget(intAdaptiveLodLatencyBudget->value());
         cfg2.setEnableAmdVectorizationWorkaround(chkDisableVectorOptimizations->isChecked());
 #ifdef Q_OS_WIN
         cfg2.setDisableAVXOptimizations(chkDisableAVXOptimizations->isChecked());
@@ -1679,6 +1687,7 @@ bool KisDlgPreferences::editPreferences()
                                           (double)dialog->m_colorSettings->m_page->sldAdaptationState->value()/20);
         cfg.setUseBlackPointCompensation(dialog->m_colorSettings->m_page->chkBlackpoint->isChecked());
         cfg.setAllowLCMSOptimization(dialog->m_colorSettings->m_page->chkAllowLCMSOptimization->isChecked());
+        cfg.setUseDisplayLut3D(dialog->m_colorSettings->m_page->chkUseDisplayLut3D->isChecked());
         cfg.setForcePaletteColors(dialog->m_colorSettings->m_page->chkForcePaletteColor->isChecked());
         cfg.setPasteBehaviour(dialog->m_colorSettings->m_pasteBehaviourGroup.checkedId());
         cfg.setRenderIntent(dialog->m_colorSettings->m_page->cmbMonitorIntent->currentIndex());
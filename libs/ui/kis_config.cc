@@ -587,6 +587,16 @@ void KisConfig::setAllowLCMSOptimization(bool allowLCMSOptimization)
     m_cfg.writeEntry("allowLCMSOptimization", allowLCMSOptimization);
 }
 
+bool KisConfig::useDisplayLut3D(bool defaultValue) const
+{
+    return (defaultValue ? false : m_cfg.readEntry("useDisplayLut3D", false));
+}
+
+void KisConfig::setUseDisplayLut3D(bool value)
+{
+    m_cfg.writeEntry("useDisplayLut3D", value);
+}
+
 bool KisConfig::forcePaletteColors(bool defaultValue) const
 {
     return (defaultValue ? false : m_cfg.readEntry("colorsettings/forcepalettecolors", false));
@@ -1421,6 +1431,26 @@ void KisConfig::setLevelOfDetailEnabled(bool value)
     m_cfg.writeEntry("levelOfDetailEnabled", value);
 }
 
+bool KisConfig::adaptiveLevelOfDetail(bool defaultValue) const
+{
+    return (defaultValue ? false : m_cfg.readEntry("adaptiveLevelOfDetail", false));
+}
+
+void KisConfig::setAdaptiveLevelOfDetail(bool value)
+{
+    m_cfg.writeEntry("adaptiveLevelOfDetail", value);
+}
+
+int KisConfig::adaptiveLevelOfDetailLatencyBudget(bool defaultValue) const
+{
+    return (defaultValue ? 50 : m_cfg.readEntry("adaptiveLevelOfDetailLatencyBudget", 50));
+}
+
+void KisConfig::setAdaptiveLevelOfDetailLatencyBudget(int value)
+{
+    m_cfg.writeEntry("adaptiveLevelOfDetailLatencyBudget", value);
+}
+
 KisOcioConfiguration KisConfig::ocioConfiguration(bool defaultValue) const
 {
     KisOcioConfiguration cfg;
@@ -1790,6 +1820,16 @@ void KisConfig::setCompressKra(bool compress)
     m_cfg.writeEntry("compressLayersInKra", compress);
 }
 
+bool KisConfig::incrementalKraSave(bool defaultValue) const
+{
+    return (defaultValue ? false : m_cfg.readEntry("incrementalKraSave", false));
+}
+
+void KisConfig::setIncrementalKraSave(bool value)
+{
+    m_cfg.writeEntry("incrementalKraSave", value);
+}
+
 bool KisConfig::toolOptionsInDocker(bool defaultValue) const
 {
     return (defaultValue ? true : m_cfg.readEntry("ToolOptionsInDocker", true));
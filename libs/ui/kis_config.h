@@ -156,6 +156,9 @@ public:
     bool allowLCMSOptimization(bool defaultValue = false) const;
     void setAllowLCMSOptimization(bool allowLCMSOptimization);
 
+    bool useDisplayLut3D(bool defaultValue = false) const;
+    void setUseDisplayLut3D(bool value);
+
     bool forcePaletteColors(bool defaultValue = false) const;
     void setForcePaletteColors(bool forcePaletteColors);
 
@@ -384,6 +387,12 @@ public:
     bool levelOfDetailEnabled(bool defaultValue = false) const;
     void setLevelOfDetailEnabled(bool value);
 
+    bool adaptiveLevelOfDetail(bool defaultValue = false) const;
+    void setAdaptiveLevelOfDetail(bool value);
+
+    int adaptiveLevelOfDetailLatencyBudget(bool defaultValue = false) const;
+    void setAdaptiveLevelOfDetailLatencyBudget(int value);
+
     KisOcioConfiguration ocioConfiguration(bool defaultValue = false) const;
     void setOcioConfiguration(const KisOcioConfiguration &cfg);
 
@@ -519,6 +528,15 @@ public:
     bool compressKra(bool defaultValue = false) const;
     void setCompressKra(bool compress);
 
+    /**
+     * When enabled, the pixel data of the layers that have not been
+     * changed since the previous save is copied from the previous
+     * version of the .kra file instead of being serialized again.
+     * Keeps a copy-on-write snapshot of the saved layers in memory.
+     */
+    bool incrementalKraSave(bool defaultValue = false) const;
+    void setIncrementalKraSave(bool value);
+
     bool toolOptionsInDocker(bool defaultValue = false) const;
     void setToolOptionsInDocker(bool inDocker);
 
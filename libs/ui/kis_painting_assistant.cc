@@ -28,6 +28,7 @@
 #include "kis_config.h"
 
 #include <KoStore.h>
+#include <KoPluginLoader.h>
 
 #include <QGlobalStatic>
 #include <QPen>
@@ -920,6 +921,9 @@ KisPaintingAssistantFactoryRegistry::~KisPaintingAssistantFactoryRegistry()
 
 KisPaintingAssistantFactoryRegistry* KisPaintingAssistantFactoryRegistry::instance()
 {
+    // the factories are registered by the assistant tool plugin, which
+    // is not loaded in batch mode until something needs it
+    KoPluginLoader::instance()->loadDeferred(QString::fromLatin1("Krita/Tool"));
     return s_instance;
 }
 
@@ -37,6 +37,11 @@
 #include <QBuffer>
 #include <QFile>
 #include <QApplication>
+#include <QtConcurrent>
+#include <QtEndian>
+
+#include <numeric>
+#include <vector>
 
 #include <klocalizedstring.h>
 #include <QUrl>
@@ -266,6 +271,322 @@ void decode_meta_data(png_textp text, KisMetaData::Store* store, QString type, i
         dbgFile << "Decoding failed";
     }
 }
+
+/**
+ * Parameters of the deflate stream and row filtering used for writing
+ * the image data
+ */
+struct CompressionParams {
+    int level = Z_DEFAULT_COMPRESSION;
+    int strategy = Z_DEFAULT_STRATEGY;
+    bool adaptiveFilters = true;
+};
+
+CompressionParams compressionParams(const KisPNGOptions &options, int colorType, int bitDepth)
+{
+    CompressionParams params;
+    params.level = options.compression;
+
+    // the same defaults libpng uses for choosing the filters
+    params.adaptiveFilters = colorType != PNG_COLOR_TYPE_PALETTE && bitDepth >= 8;
+
+    switch (options.compressionPreset) {
+    case KisPNGOptions::FastNoFilter:
+        params.level = Z_BEST_SPEED;
+        params.adaptiveFilters = false;
+        break;
+    case KisPNGOptions::FastRLE:
+        params.strategy = Z_RLE;
+        break;
+    case KisPNGOptions::DefaultCompression:
+        break;
+    }
+
+    return params;
+}
+
+inline quint8 paethPredictor(int a, int b, int c)
+{
+    const int p = a + b - c;
+    const int pa = qAbs(p - a);
+    const int pb = qAbs(p - b);
+    const int pc = qAbs(p - c);
+
+    return (pa <= pb && pa <= pc) ? a : (pb <= pc ? b : c);
+}
+
+template <int filterType>
+void filterRowImpl(const quint8 *row, const quint8 *prevRow, int rowBytes, int bpp, quint8 *dst)
+{
+    for (int i = 0; i < rowBytes; i++) {
+        const int a = i >= bpp ? row[i - bpp] : 0;
+        const int b = prevRow[i];
+        const int c = i >= bpp ? prevRow[i - bpp] : 0;
+
+        int prediction = 0;
+
+        switch (filterType) {
+        case PNG_FILTER_VALUE_SUB:
+            prediction = a;
+            break;
+        case PNG_FILTER_VALUE_UP:
+            prediction = b;
+            break;
+        case PNG_FILTER_VALUE_AVG:
+            prediction = (a + b) >> 1;
+            break;
+        case PNG_FILTER_VALUE_PAETH:
+            prediction = paethPredictor(a, b, c);
+            break;
+        default:
+            break;
+        }
+
+        dst[i] = quint8(row[i] - prediction);
+    }
+}
+
+void filterRow(int filterType, const quint8 *row, const quint8 *prevRow, int rowBytes, int bpp, quint8 *dst)
+{
+    *dst++ = quint8(filterType);
+
+    switch (filterType) {
+    case PNG_FILTER_VALUE_SUB:
+        filterRowImpl<PNG_FILTER_VALUE_SUB>(row, prevRow, rowBytes, bpp, dst);
+        break;
+    case PNG_FILTER_VALUE_UP:
+        filterRowImpl<PNG_FILTER_VALUE_UP>(row, prevRow, rowBytes, bpp, dst);
+        break;
+    case PNG_FILTER_VALUE_AVG:
+        filterRowImpl<PNG_FILTER_VALUE_AVG>(row, prevRow, rowBytes, bpp, dst);
+        break;
+    case PNG_FILTER_VALUE_PAETH:
+        filterRowImpl<PNG_FILTER_VALUE_PAETH>(row, prevRow, rowBytes, bpp, dst);
+        break;
+    default:
+        memcpy(dst, row, rowBytes);
+        break;
+    }
+}
+
+/**
+ * The minimum sum of absolute differences heuristic, the same
+ * one libpng uses for adaptive filtering
+ */
+quint64 filteredRowCost(const quint8 *filtered, int rowBytes)
+{
+    quint64 cost = 0;
+    for (int i = 0; i < rowBytes; i++) {
+        cost += qAbs(int(qint8(filtered[i])));
+    }
+    return cost;
+}
+
+/**
+ * A horizontal band of rows that is filtered and deflated independently
+ * from the other bands
+ */
+struct ImageDataBand {
+    int firstRow = 0;
+    int numRows = 0;
+    std::vector<quint8> filtered;
+    uLong adler = 0;
+    QByteArray compressed;
+    bool isValid = true;
+};
+
+void filterBand(ImageDataBand &band, png_bytepp rows, int rowBytes, int bpp, const CompressionParams &params)
+{
+    const int filteredRowBytes = rowBytes + 1;
+    band.filtered.resize(size_t(band.numRows) * filteredRowBytes);
+
+    const std::vector<quint8> zeroRow(rowBytes, 0);
+    std::vector<quint8> candidate(params.adaptiveFilters ? filteredRowBytes : 0);
+
+    for (int i = 0; i < band.numRows; i++) {
+        const int row = band.firstRow + i;
+        const quint8 *rowData = rows[row];
+        const quint8 *prevRowData = row > 0 ? rows[row - 1] : zeroRow.data();
+        quint8 *dst = band.filtered.data() + size_t(i) * filteredRowBytes;
+
+        if (!params.adaptiveFilters) {
+            filterRow(PNG_FILTER_VALUE_NONE, rowData, prevRowData, rowBytes, bpp, dst);
+            continue;
+        }
+
+        filterRow(PNG_FILTER_VALUE_NONE, rowData, prevRowData, rowBytes, bpp, dst);
+        quint64 bestCost = filteredRowCost(dst + 1, rowBytes);
+
+        for (int filterType = PNG_FILTER_VALUE_SUB; filterType <= PNG_FILTER_VALUE_PAETH; filterType++) {
+            filterRow(filterType, rowData, prevRowData, rowBytes, bpp, candidate.data());
+            const quint64 cost = filteredRowCost(candidate.data() + 1, rowBytes);
+
+            if (cost < bestCost) {
+                bestCost = cost;
+                memcpy(dst, candidate.data(), filteredRowBytes);
+            }
+        }
+    }
+
+    band.adler = adler32(adler32(0, Z_NULL, 0), band.filtered.data(), band.filtered.size());
+}
+
+void deflateBand(ImageDataBand &band, const ImageDataBand *prevBand, bool isLastBand, const CompressionParams &params)
+{
+    z_stream stream;
+    memset(&stream, 0, sizeof(stream));
+
+    // raw deflate, the zlib wrapper is written for the whole stream at once
+    if (deflateInit2(&stream, params.level, Z_DEFLATED, -15, 8, params.strategy) != Z_OK) {
+        band.isValid = false;
+        return;
+    }
+
+    /**
+     * Prime the window with the tail of the previous band, so that the
+     * compression ratio is the same as for a single stream
+     */
+    if (prevBand) {
+        const size_t dictSize = qMin(size_t(32768), prevBand->filtered.size());
+        deflateSetDictionary(&stream,
+                             prevBand->filtered.data() + prevBand->filtered.size() - dictSize,
+                             dictSize);
+    }
+
+    // Z_SYNC_FLUSH adds an empty stored block to byte-align the band
+    band.compressed.resize(deflateBound(&stream, band.filtered.size()) + 16);
+
+    stream.next_in = const_cast<quint8*>(band.filtered.data());
+    stream.avail_in = band.filtered.size();
+    stream.next_out = reinterpret_cast<Bytef*>(band.compressed.data());
+    stream.avail_out = band.compressed.size();
+
+    const int flush = isLastBand ? Z_FINISH : Z_SYNC_FLUSH;
+    int result = Z_OK;
+
+    while (true) {
+        result = deflate(&stream, flush);
+
+        const bool isDone = isLastBand ? result == Z_STREAM_END :
+            (result == Z_OK || result == Z_BUF_ERROR) && !stream.avail_in && stream.avail_out;
+
+        if (isDone) break;
+
+        if (result != Z_OK && result != Z_BUF_ERROR) {
+            band.isValid = false;
+            break;
+        }
+
+        const int oldSize = band.compressed.size();
+        band.compressed.resize(oldSize * 2);
+        stream.next_out = reinterpret_cast<Bytef*>(band.compressed.data()) + oldSize - stream.avail_out;
+        stream.avail_out += oldSize;
+    }
+
+    band.compressed.resize(stream.total_out);
+    deflateEnd(&stream);
+}
+
+inline quint8 zlibHeaderFlags(int level)
+{
+    if (level == Z_DEFAULT_COMPRESSION || level == 6) return 0x9c;
+    if (level >= 7) return 0xda;
+    if (level >= 2) return 0x5e;
+    return 0x01;
+}
+
+/**
+ * Writes the IDAT chunks of a non-interlaced image. The rows are split
+ * into bands, which are filtered and deflated concurrently and then
+ * stitched into a single zlib stream, in the same way pigz does it:
+ * every band but the last one ends with a sync flush, the window of
+ * each band is primed with the tail of the previous one and the Adler-32
+ * checksums are combined. The result is a regular PNG file.
+ *
+ * The caller is responsible for writing IEND afterwards, png_write_end()
+ * cannot be used, because libpng doesn't know about the written data.
+ */
+bool writeImageDataParallel(png_structp png_ptr, png_bytepp rows, int numRows, int rowBytes, int bpp, bool swap16, const CompressionParams &params)
+{
+    /**
+     * The filters of a band reference the last row of the previous band,
+     * so all the rows are converted into network byte order first
+     */
+    if (swap16) {
+        QVector<int> rowIndexes(numRows);
+        std::iota(rowIndexes.begin(), rowIndexes.end(), 0);
+
+        QtConcurrent::blockingMap(rowIndexes,
+            [rows, rowBytes] (int row) {
+                quint16 *data = reinterpret_cast<quint16*>(rows[row]);
+                for (int i = 0; i < rowBytes / 2; i++) {
+                    data[i] = qToBigEndian(data[i]);
+                }
+            });
+    }
+
+    const int bandSize = 128 * 1024;
+    const int rowsPerBand = qMax(1, bandSize / (rowBytes + 1));
+
+    QVector<ImageDataBand> bands;
+    for (int row = 0; row < numRows; row += rowsPerBand) {
+        ImageDataBand band;
+        band.firstRow = row;
+        band.numRows = qMin(rowsPerBand, numRows - row);
+        bands << band;
+    }
+
+    QtConcurrent::blockingMap(bands,
+        [&] (ImageDataBand &band) {
+            filterBand(band, rows, rowBytes, bpp, params);
+        });
+
+    QVector<int> bandIndexes(bands.size());
+    std::iota(bandIndexes.begin(), bandIndexes.end(), 0);
+
+    /**
+     * The window of every band is primed with the filtered data of the
+     * previous one, so the filtered data can be released only when all
+     * the bands are deflated
+     */
+    ImageDataBand *bandsData = bands.data();
+    const int numBands = bands.size();
+
+    QtConcurrent::blockingMap(bandIndexes,
+        [bandsData, numBands, &params] (int index) {
+            deflateBand(bandsData[index], index > 0 ? &bandsData[index - 1] : 0,
+                        index == numBands - 1, params);
+        });
+
+    for (int i = 0; i < numBands; i++) {
+        std::vector<quint8>().swap(bandsData[i].filtered);
+    }
+
+    QByteArray stream;
+    stream.append(char(0x78));
+    stream.append(char(zlibHeaderFlags(params.level)));
+
+    uLong adler = adler32(0, Z_NULL, 0);
+
+    Q_FOREACH (const ImageDataBand &band, bands) {
+        if (!band.isValid) return false;
+
+        stream.append(band.compressed);
+        adler = adler32_combine(adler, band.adler, size_t(band.numRows) * (rowBytes + 1));
+    }
+
+    const quint32 adlerBE = qToBigEndian(quint32(adler));
+    stream.append(reinterpret_cast<const char*>(&adlerBE), sizeof(adlerBE));
+
+    const int maxChunkSize = 1024 * 1024;
+    for (int pos = 0; pos < stream.size(); pos += maxChunkSize) {
+        png_write_chunk(png_ptr, (png_const_bytep)"IDAT",
+                        reinterpret_cast<png_const_bytep>(stream.constData()) + pos,
+                        qMin(maxChunkSize, stream.size() - pos));
+    }
+
+    return true;
+}
 }
 
 KisPNGConverter::KisPNGConverter(KisDocument *doc, bool batchMode)
@@ -411,6 +732,16 @@ void _flush_fn(png_structp png_ptr)
 }
 
 KisImportExportErrorCode KisPNGConverter::buildImage(QIODevice* iod)
+{
+    return decode(iod, true);
+}
+
+KisImportExportErrorCode KisPNGConverter::buildDevice(QIODevice* iod)
+{
+    return decode(iod, false);
+}
+
+KisImportExportErrorCode KisPNGConverter::decode(QIODevice* iod, bool createImage)
 {
     dbgFile << "Start decoding PNG File";
 
@@ -484,6 +815,7 @@ KisImportExportErrorCode KisPNGConverter::buildImage(QIODevice* iod)
     int color_nb_bits, color_type, interlace_type;
     png_get_IHDR(png_ptr, info_ptr, &width, &height, &color_nb_bits, &color_type, &interlace_type, 0, 0);
     dbgFile << "width = " << width << " height = " << height << " color_nb_bits = " << color_nb_bits << " color_type = " << color_type << " interlace_type = " << interlace_type << endl;
+
     // swap byteorder on little endian machines.
 #ifndef WORDS_BIGENDIAN
     if (color_nb_bits > 8)
@@ -638,27 +970,33 @@ KisImportExportErrorCode KisPNGConverter::buildImage(QIODevice* iod)
         return ImportExportCodes::FormatColorSpaceUnsupported;
     }
 
-    // Creating the KisImageSP
-    if (m_image == 0) {
-        KisUndoStore *store = m_doc ? m_doc->createUndoStore() : new KisSurrogateUndoStore();
-        m_image = new KisImage(store, width, height, cs, "built image");
-    }
+    m_device = new KisPaintDevice(cs);
+    KisPaintLayerSP layer;
 
-    // Read resolution
-    int unit_type;
-    png_uint_32 x_resolution, y_resolution;
+    if (createImage) {
+        // Creating the KisImageSP
+        if (m_image == 0) {
+            KisUndoStore *store = m_doc ? m_doc->createUndoStore() : new KisSurrogateUndoStore();
+            m_image = new KisImage(store, width, height, cs, "built image");
+        }
+
+        // Read resolution
+        int unit_type;
+        png_uint_32 x_resolution, y_resolution;
 
-    png_get_pHYs(png_ptr, info_ptr, &x_resolution, &y_resolution, &unit_type);
-    if (x_resolution > 0 && y_resolution > 0 && unit_type == PNG_RESOLUTION_METER) {
-        m_image->setResolution((double) POINT_TO_CM(x_resolution) / 100.0, (double) POINT_TO_CM(y_resolution) / 100.0); // It is the "invert" macro because we convert from pointer-per-inchs to points
+        png_get_pHYs(png_ptr, info_ptr, &x_resolution, &y_resolution, &unit_type);
+        if (x_resolution > 0 && y_resolution > 0 && unit_type == PNG_RESOLUTION_METER) {
+            m_image->setResolution((double) POINT_TO_CM(x_resolution) / 100.0, (double) POINT_TO_CM(y_resolution) / 100.0); // It is the "invert" macro because we convert from pointer-per-inchs to points
+        }
+
+        layer = new KisPaintLayer(m_image.data(), m_image -> nextLayerName(), UCHAR_MAX, m_device);
     }
 
     double coeff = quint8_MAX / (double)(pow((double)2, color_nb_bits) - 1);
-    KisPaintLayerSP layer = new KisPaintLayer(m_image.data(), m_image -> nextLayerName(), UCHAR_MAX);
 
     // Read comments/texts...
     png_get_text(png_ptr, info_ptr, &text_ptr, &num_comments);
-    if (m_doc) {
+    if (m_doc && layer) {
         KoDocumentInfo * info = m_doc->documentInfo();
         dbgFile << "There are " << num_comments << " comments in the text";
         for (int i = 0; i < num_comments; i++) {
@@ -724,7 +1062,7 @@ KisImportExportErrorCode KisPNGConverter::buildImage(QIODevice* iod)
     }
 
     for (png_uint_32 y = 0; y < height; y++) {
-        KisHLineIteratorSP it = layer -> paintDevice() -> createHLineIteratorNG(0, y, width);
+        KisHLineIteratorSP it = m_device->createHLineIteratorNG(0, y, width);
 
         png_bytep row_pointer = reader->readLine();
 
@@ -806,7 +1144,9 @@ KisImportExportErrorCode KisPNGConverter::buildImage(QIODevice* iod)
             return ImportExportCodes::FormatFeaturesUnsupported;
         }
     }
-    m_image->addNode(layer.data(), m_image->rootLayer().data());
+    if (layer) {
+        m_image->addNode(layer.data(), m_image->rootLayer().data());
+    }
 
     png_read_end(png_ptr, end_info);
     iod->close();
@@ -840,6 +1180,11 @@ KisImageSP KisPNGConverter::image()
     return m_image;
 }
 
+KisPaintDeviceSP KisPNGConverter::device()
+{
+    return m_device;
+}
+
 bool KisPNGConverter::saveDeviceToStore(const QString &filename, const QRect &imageRect, const qreal xRes, const qreal yRes, KisPaintDeviceSP dev, KoStore *store, KisMetaData::Store* metaData)
 {
     if (store->open(filename)) {
@@ -989,18 +1334,8 @@ KisImportExportErrorCode KisPNGConverter::buildFile(QIODevice* iodevice, const Q
     // XXX: Implement progress updating -- png_set_write_status_fn(png_ptr, progress);"
     //     setProgressTotalSteps(100/*height*/);
 
-    /* set the zlib compression level */
-    png_set_compression_level(png_ptr, options.compression);
-
     png_set_write_fn(png_ptr, (void*)iodevice, _write_fn, _flush_fn);
 
-    /* set other zlib parameters */
-    png_set_compression_mem_level(png_ptr, 8);
-    png_set_compression_strategy(png_ptr, Z_DEFAULT_STRATEGY);
-    png_set_compression_window_bits(png_ptr, 15);
-    png_set_compression_method(png_ptr, 8);
-    png_set_compression_buffer_size(png_ptr, 8192);
-
     int color_nb_bits = 8 * device->pixelSize() / device->channelCount();
     int color_type = getColorTypeforColorSpace(device->colorSpace(), options.alpha);
 
@@ -1066,6 +1401,21 @@ KisImportExportErrorCode KisPNGConverter::buildFile(QIODevice* iodevice, const Q
                  color_type, interlacetype,
                  PNG_COMPRESSION_TYPE_DEFAULT, PNG_FILTER_TYPE_DEFAULT);
 
+    const CompressionParams compression = compressionParams(options, color_type, color_nb_bits);
+
+    /* set the zlib parameters, they are used only for interlaced images,
+       the other ones are deflated by writeImageDataParallel() */
+    png_set_compression_level(png_ptr, compression.level);
+    png_set_compression_mem_level(png_ptr, 8);
+    png_set_compression_strategy(png_ptr, compression.strategy);
+    png_set_compression_window_bits(png_ptr, 15);
+    png_set_compression_method(png_ptr, 8);
+    png_set_compression_buffer_size(png_ptr, 8192);
+
+    if (!compression.adaptiveFilters) {
+        png_set_filter(png_ptr, PNG_FILTER_TYPE_BASE, PNG_FILTER_NONE);
+    }
+
     // set sRGB only if the profile is sRGB  -- http://www.w3.org/TR/PNG/#11sRGB says sRGB and iCCP should not both be present
 
     bool sRGB = device->colorSpace()->profile()->name().contains(QLatin1String("srgb"), Qt::CaseInsensitive);
@@ -1262,10 +1612,14 @@ KisImportExportErrorCode KisPNGConverter::buildFile(QIODevice* iodevice, const Q
     png_write_info(png_ptr, info_ptr);
     png_write_flush(png_ptr);
 
+    bool swapByteOrder = false;
+
     // swap byteorder on little endian machines.
 #ifndef WORDS_BIGENDIAN
-    if (color_nb_bits > 8)
+    if (color_nb_bits > 8) {
         png_set_swap(png_ptr);
+        swapByteOrder = true;
+    }
 #endif
 
     // Write the PNG
@@ -1364,10 +1718,27 @@ KisImportExportErrorCode KisPNGConverter::buildFile(QIODevice* iodevice, const Q
         }
     }
 
-    png_write_image(png_ptr, rowPointers.rows);
+    if (options.interlace) {
+        png_write_image(png_ptr, rowPointers.rows);
+
+        // Writing is over
+        png_write_end(png_ptr, info_ptr);
+    } else {
+        const int bitsPerPixel = png_get_channels(png_ptr, info_ptr) * color_nb_bits;
 
-    // Writing is over
-    png_write_end(png_ptr, info_ptr);
+        if (!writeImageDataParallel(png_ptr, rowPointers.rows, imageRect.height(),
+                                    png_get_rowbytes(png_ptr, info_ptr),
+                                    qMax(1, bitsPerPixel / 8),
+                                    swapByteOrder, compression)) {
+
+            png_destroy_write_struct(&png_ptr, &info_ptr);
+            return ImportExportCodes::Failure;
+        }
+
+        // Writing is over, no chunks are left in info_ptr after the image data
+        png_write_chunk(png_ptr, (png_const_bytep)"IEND", 0, 0);
+        png_write_flush(png_ptr);
+    }
 
     // Free memory
     png_destroy_write_struct(&png_ptr, &info_ptr);
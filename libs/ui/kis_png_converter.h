@@ -43,8 +43,20 @@ class Store;
 }
 
 struct KisPNGOptions {
+    /**
+     * Defines how the image data is filtered and deflated. The faster
+     * presets trade the file size for the saving speed, the result is
+     * still a standard PNG file.
+     */
+    enum CompressionPreset {
+        DefaultCompression = 0, ///< adaptive filtering, deflate at the \p compression level
+        FastNoFilter, ///< no filtering, fastest deflate level
+        FastRLE ///< adaptive filtering, run-length encoding strategy of deflate
+    };
+
     KisPNGOptions()
         : compression(0)
+        , compressionPreset(DefaultCompression)
         , interlace(false)
         , alpha(true)
         , exif(true)
@@ -60,6 +72,7 @@ struct KisPNGOptions {
     {}
 
     int compression;
+    CompressionPreset compressionPreset;
     bool interlace;
     bool alpha;
     bool exif;
@@ -103,6 +116,13 @@ public:
      * @param iod device to access the data
      */
     KisImportExportErrorCode buildImage(QIODevice* iod);
+    /**
+     * Decode the pixels of a PNG from a QIODevice into a paint device,
+     * without creating an image. Unlike buildImage(), it can be used
+     * outside the GUI thread when the converter is in batch mode.
+     * @param iod device to access the data
+     */
+    KisImportExportErrorCode buildDevice(QIODevice* iod);
     /**
      * Save a layer to a PNG
      * @param filename the name of the destination file
@@ -122,6 +142,11 @@ public:
      */
     KisImageSP image();
 
+    /**
+     * Retrieve the decoded paint device
+     */
+    KisPaintDeviceSP device();
+
     /**
      * @brief saveDeviceToStore saves the given paint device to the KoStore. If the device is not 8 bits sRGB, it will be converted to 8 bits sRGB.
      * @return true if the saving succeeds
@@ -134,9 +159,11 @@ public Q_SLOTS:
     virtual void cancel();
 private:
     void progress(png_structp png_ptr, png_uint_32 row_number, int pass);
+    KisImportExportErrorCode decode(QIODevice* iod, bool createImage);
 private:
     png_uint_32 m_max_row;
     KisImageSP m_image;
+    KisPaintDeviceSP m_device;
     KisDocument *m_doc;
     bool m_stop;
     bool m_batchMode;
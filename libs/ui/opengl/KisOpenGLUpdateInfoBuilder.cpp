@@ -23,6 +23,8 @@
 
 #include "KisProofingConfiguration.h"
 
+#include <KoLut3DColorConversionTransformation.h>
+
 #include <QReadWriteLock>
 #include <QReadLocker>
 #include <QWriteLocker>
@@ -42,6 +44,25 @@ struct KRITAUI_NO_EXPORT KisOpenGLUpdateInfoBuilder::Private
     KisProofingConfigurationSP proofingConfig;
     QScopedPointer<KoColorConversionTransformation> proofingTransform;
 
+    bool useLut3D = false;
+    QScopedPointer<KoColorConversionTransformation> displayTransform;
+
+    /**
+     * Replaces \p transform with its lookup table, if possible
+     */
+    KoColorConversionTransformation* tryCreateLut3D(KoColorConversionTransformation *transform) {
+        if (!useLut3D || !transform) return transform;
+
+        KoColorConversionTransformation *lut =
+            KoLut3DColorConversionTransformation::create(transform);
+
+        if (lut) {
+            delete transform;
+            transform = lut;
+        }
+        return transform;
+    }
+
     KisTextureTileInfoPoolSP pool;
     QReadWriteLock lock;
 };
@@ -87,7 +108,8 @@ KisOpenGLUpdateInfoSP KisOpenGLUpdateInfoBuilder::buildUpdateInfo(const QRect &r
                                                                                              m_d->proofingConfig->proofingDepth,
                                                                                              m_d->proofingConfig->proofingProfile);
 
-            m_d->proofingTransform.reset(KisTextureTileUpdateInfo::generateProofingTransform(
+            m_d->proofingTransform.reset(m_d->tryCreateLut3D(
+                KisTextureTileUpdateInfo::generateProofingTransform(
                                              projection->colorSpace(),
                                              m_d->conversionOptions.m_destinationColorSpace,
                                              proofingSpace,
@@ -95,7 +117,32 @@ KisOpenGLUpdateInfoSP KisOpenGLUpdateInfoBuilder::buildUpdateInfo(const QRect &r
                                              m_d->proofingConfig->intent,
                                              m_d->proofingConfig->conversionFlags,
                                              m_d->proofingConfig->warningColor,
-                                             m_d->proofingConfig->adaptationState));
+                                             m_d->proofingConfig->adaptationState)));
+        }
+    }
+
+    auto needCreateDisplayTransform =
+        [this, projection] () {
+            const KoColorSpace *srcCS = projection->colorSpace();
+            const KoColorSpace *dstCS = m_d->conversionOptions.m_destinationColorSpace;
+
+            return !m_d->displayTransform &&
+                !m_d->proofingTransform &&
+                m_d->useLut3D &&
+                !(*srcCS == *dstCS &&
+                  m_d->conversionOptions.m_conversionFlags == KoColorConversionTransformation::Empty) &&
+                KoLut3DColorConversionTransformation::isSupported(srcCS, dstCS);
+        };
+
+    if (convertColorSpace && needCreateDisplayTransform()) {
+
+        QWriteLocker locker(&m_d->lock);
+        if (needCreateDisplayTransform()) {
+            m_d->displayTransform.reset(m_d->tryCreateLut3D(
+                projection->colorSpace()->createColorConverter(
+                    m_d->conversionOptions.m_destinationColorSpace,
+                    m_d->conversionOptions.m_renderingIntent,
+                    m_d->conversionOptions.m_conversionFlags)));
         }
     }
 
@@ -156,6 +203,8 @@ KisOpenGLUpdateInfoSP KisOpenGLUpdateInfoBuilder::buildUpdateInfo(const QRect &r
                 if (convertColorSpace) {
                     if (m_d->proofingTransform) {
                         tileInfo->proofTo(m_d->conversionOptions.m_destinationColorSpace, m_d->proofingConfig->conversionFlags, m_d->proofingTransform.data());
+                    } else if (m_d->displayTransform) {
+                        tileInfo->convertTo(m_d->conversionOptions.m_destinationColorSpace, m_d->displayTransform.data());
                     } else {
                         tileInfo->convertTo(m_d->conversionOptions.m_destinationColorSpace, m_d->conversionOptions.m_renderingIntent, m_d->conversionOptions.m_conversionFlags);
                     }
@@ -218,6 +267,8 @@ void KisOpenGLUpdateInfoBuilder::setConversionOptions(const ConversionOptions &o
     QWriteLocker lock(&m_d->lock);
 
     m_d->conversionOptions = options;
+    m_d->displayTransform.reset();
+    m_d->proofingTransform.reset();
 }
 
 void KisOpenGLUpdateInfoBuilder::setChannelFlags(const QBitArray &channelFrags, bool onlyOneChannelSelected, int selectedChannelIndex)
@@ -264,6 +315,15 @@ void KisOpenGLUpdateInfoBuilder::setProofingConfig(KisProofingConfigurationSP co
     m_d->proofingTransform.reset();
 }
 
+void KisOpenGLUpdateInfoBuilder::setUseLut3D(bool value)
+{
+    QWriteLocker lock(&m_d->lock);
+
+    m_d->useLut3D = value;
+    m_d->displayTransform.reset();
+    m_d->proofingTransform.reset();
+}
+
 KisProofingConfigurationSP KisOpenGLUpdateInfoBuilder::proofingConfig() const
 {
     QReadLocker lock(&m_d->lock);
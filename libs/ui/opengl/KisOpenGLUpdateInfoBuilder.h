@@ -72,6 +72,13 @@ public:
     void setProofingConfig(KisProofingConfigurationSP config);
     KisProofingConfigurationSP proofingConfig() const;
 
+    /**
+     * If enabled, the conversion to the display color space and the
+     * soft-proofing transform are baked into a 3D lookup table, when
+     * the color spaces are supported by KoLut3DColorConversionTransformation
+     */
+    void setUseLut3D(bool value);
+
 private:
     struct Private;
     const QScopedPointer<Private> m_d;
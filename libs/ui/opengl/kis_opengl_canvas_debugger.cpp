@@ -34,6 +34,9 @@ struct KisOpenglCanvasDebugger::Private
           fpsSum(0),
           syncFlaggedCounter(0),
           syncFlaggedSum(0),
+          compressionCounter(0),
+          lastMergedTiles(0),
+          lastDroppedUpdates(0),
           isEnabled(true) {}
 
     QElapsedTimer time;
@@ -44,6 +47,10 @@ struct KisOpenglCanvasDebugger::Private
     int syncFlaggedCounter;
     int syncFlaggedSum;
 
+    int compressionCounter;
+    int lastMergedTiles;
+    int lastDroppedUpdates;
+
     bool isEnabled;
 };
 
@@ -119,3 +126,18 @@ void KisOpenglCanvasDebugger::nofitySyncStatus(bool isBusy)
         m_d->syncFlaggedCounter = 0;
     }
 }
+
+void KisOpenglCanvasDebugger::notifyUpdatesCompression(int mergedTiles, int droppedUpdates)
+{
+    if (!m_d->isEnabled) return;
+
+    m_d->compressionCounter++;
+
+    if (m_d->compressionCounter > 100) {
+        qDebug() << "Canvas updates compression: merged tiles:" << mergedTiles - m_d->lastMergedTiles
+                 << "dropped updates:" << droppedUpdates - m_d->lastDroppedUpdates;
+        m_d->compressionCounter = 0;
+        m_d->lastMergedTiles = mergedTiles;
+        m_d->lastDroppedUpdates = droppedUpdates;
+    }
+}
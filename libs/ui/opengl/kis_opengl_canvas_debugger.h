@@ -36,6 +36,7 @@ public:
 
     void nofityPaintRequested();
     void nofitySyncStatus(bool value);
+    void notifyUpdatesCompression(int mergedTiles, int droppedUpdates);
     qreal accumulatedFps();
 
 private Q_SLOTS:
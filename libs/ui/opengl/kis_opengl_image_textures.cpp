@@ -609,5 +609,7 @@ void KisOpenGLImageTextures::updateTextureFormat()
         ConversionOptions(tilesDestinationColorSpace,
                           m_renderingIntent,
                           m_conversionFlags));
+
+    m_updateInfoBuilder.setUseLut3D(KisConfig(true).useDisplayLut3D());
 }
 
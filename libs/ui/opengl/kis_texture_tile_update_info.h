@@ -241,6 +241,24 @@ public:
         }
     }
 
+    /**
+     * Converts the patch with a precalculated \p transform, e.g. a
+     * lookup table, instead of the color conversion cache
+     */
+    void convertTo(const KoColorSpace* dstCS,
+                   const KoColorConversionTransformation *transform)
+    {
+        if (m_patchRect.isValid()) {
+            const qint32 numPixels = m_patchRect.width() * m_patchRect.height();
+            DataBuffer conversionCache(dstCS->pixelSize(), m_pool);
+
+            transform->transform(m_patchPixels.data(), conversionCache.data(), numPixels);
+
+            m_patchColorSpace = dstCS;
+            conversionCache.swap(m_patchPixels);
+        }
+    }
+
     void proofTo(const KoColorSpace* dstCS,
                    KoColorConversionTransformation::ConversionFlags conversionFlags,
                    KoColorConversionTransformation *proofingTransform)
@@ -0,0 +1,223 @@
+/*
+ *  Copyright (c) 2020 Krita developers
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include "KisAdaptiveLodControllerTest.h"
+
+#include <QTest>
+#include <QSignalSpy>
+
+#include <brushengine/kis_paintop_preset.h>
+#include <brushengine/kis_paintop_settings.h>
+
+#include "kis_config.h"
+#include "kis_config_notifier.h"
+#include "tool/KisAdaptiveLodController.h"
+
+namespace {
+
+/**
+ * The budget is 50 ms and the strokes are painted at 100 fps, so the
+ * latency of a stroke is its rendering lag plus 10 ms
+ */
+const int latencyBudget = 50;
+const qreal fps = 100.0;
+
+const qreal overBudgetLag = 60.0;      // 70 ms
+const qreal withinBudgetLag = 30.0;    // 40 ms, inside the hysteresis band
+const qreal underThresholdLag = 10.0;  // 20 ms, less than half of the budget
+
+class TestPaintOpSettings : public KisPaintOpSettings
+{
+public:
+    TestPaintOpSettings(qreal size)
+        : m_size(size)
+    {
+        setProperty("paintop", "testpaintop");
+    }
+
+    void setPaintOpSize(qreal value) override {
+        m_size = value;
+    }
+
+    qreal paintOpSize() const override {
+        return m_size;
+    }
+
+    KisPaintOpSettingsSP clone() const override {
+        return new TestPaintOpSettings(*this);
+    }
+
+private:
+    qreal m_size;
+};
+
+KisPaintOpPresetSP createPreset(const QString &name, qreal size)
+{
+    KisPaintOpPresetSP preset = new KisPaintOpPreset();
+    preset->setName(name);
+    preset->setSettings(new TestPaintOpSettings(size));
+    return preset;
+}
+
+void setControllerEnabled(bool value, int budget = latencyBudget)
+{
+    {
+        KisConfig cfg(false);
+        cfg.setAdaptiveLevelOfDetail(value);
+        cfg.setAdaptiveLevelOfDetailLatencyBudget(budget);
+    }
+    KisConfigNotifier::instance()->notifyConfigChanged();
+}
+
+}
+
+void KisAdaptiveLodControllerTest::initTestCase()
+{
+    KisConfig cfg(true);
+    m_savedEnabled = cfg.adaptiveLevelOfDetail();
+    m_savedBudget = cfg.adaptiveLevelOfDetailLatencyBudget();
+
+    setControllerEnabled(true);
+}
+
+void KisAdaptiveLodControllerTest::cleanupTestCase()
+{
+    setControllerEnabled(m_savedEnabled, m_savedBudget);
+}
+
+void KisAdaptiveLodControllerTest::testHysteresis()
+{
+    KisAdaptiveLodController controller;
+    QSignalSpy spy(&controller, SIGNAL(sigPreferredLevelOfDetailChanged()));
+
+    KisPaintOpPresetSP preset = createPreset("preset", 10);
+
+    QVERIFY(controller.isEnabled());
+    QCOMPARE(controller.preferredLevelOfDetail(preset), 0);
+
+    controller.notifyStrokeFinished(overBudgetLag, fps, 0, preset);
+    QCOMPARE(controller.preferredLevelOfDetail(preset), 1);
+    QCOMPARE(spy.count(), 1);
+
+    // within the budget, but not fast enough to go back
+    controller.notifyStrokeFinished(withinBudgetLag, fps, 1, preset);
+    QCOMPARE(controller.preferredLevelOfDetail(preset), 1);
+    controller.notifyStrokeFinished(withinBudgetLag, fps, 1, preset);
+    QCOMPARE(controller.preferredLevelOfDetail(preset), 1);
+    QCOMPARE(spy.count(), 1);
+
+    controller.notifyStrokeFinished(underThresholdLag, fps, 1, preset);
+    QCOMPARE(controller.preferredLevelOfDetail(preset), 0);
+    QCOMPARE(spy.count(), 2);
+
+    // a low frame rate alone can exceed the budget: 10 ms + 1000/15 ms
+    controller.notifyStrokeFinished(10.0, 15.0, 0, preset);
+    QCOMPARE(controller.preferredLevelOfDetail(preset), 1);
+    QCOMPARE(spy.count(), 3);
+
+    // the frame rate is unknown, the stroke is ignored
+    controller.notifyStrokeFinished(overBudgetLag, 0.0, 1, preset);
+    QCOMPARE(controller.preferredLevelOfDetail(preset), 1);
+    QCOMPARE(spy.count(), 3);
+}
+
+void KisAdaptiveLodControllerTest::testLimits()
+{
+    KisAdaptiveLodController controller;
+    KisPaintOpPresetSP preset = createPreset("preset", 10);
+
+    for (int i = 0; i < 2 * KisAdaptiveLodController::maxLevelOfDetail; i++) {
+        controller.notifyStrokeFinished(overBudgetLag, fps,
+                                        controller.preferredLevelOfDetail(preset), preset);
+    }
+    QCOMPARE(controller.preferredLevelOfDetail(preset),
+             int(KisAdaptiveLodController::maxLevelOfDetail));
+
+    for (int i = 0; i < 2 * KisAdaptiveLodController::maxLevelOfDetail; i++) {
+        controller.notifyStrokeFinished(underThresholdLag, fps,
+                                        controller.preferredLevelOfDetail(preset), preset);
+    }
+    QCOMPARE(controller.preferredLevelOfDetail(preset), 0);
+
+    QCOMPARE(controller.preferredLevelOfDetail(KisPaintOpPresetSP()), 0);
+}
+
+void KisAdaptiveLodControllerTest::testCoarserLevelFromZoom()
+{
+    KisAdaptiveLodController controller;
+    KisPaintOpPresetSP preset = createPreset("preset", 10);
+
+    // the stroke was painted at level 2 because of the zoom and was still too slow
+    controller.notifyStrokeFinished(overBudgetLag, fps, 2, preset);
+    QCOMPARE(controller.preferredLevelOfDetail(preset), 3);
+}
+
+void KisAdaptiveLodControllerTest::testPresetKeying()
+{
+    KisAdaptiveLodController controller;
+
+    KisPaintOpPresetSP heavy = createPreset("heavy", 300);
+    KisPaintOpPresetSP light = createPreset("light", 300);
+    KisPaintOpPresetSP heavySmall = createPreset("heavy", 20);
+
+    controller.notifyStrokeFinished(overBudgetLag, fps, 0, heavy);
+    controller.notifyStrokeFinished(overBudgetLag, fps, 1, heavy);
+
+    QCOMPARE(controller.preferredLevelOfDetail(heavy), 2);
+    QCOMPARE(controller.preferredLevelOfDetail(light), 0);
+
+    // the same preset with a smaller brush is tracked separately
+    QCOMPARE(controller.preferredLevelOfDetail(heavySmall), 0);
+
+    // a fast light stroke doesn't affect the heavy preset
+    controller.notifyStrokeFinished(underThresholdLag, fps, 0, light);
+    QCOMPARE(controller.preferredLevelOfDetail(heavy), 2);
+
+    // a copy of the preset (e.g. a reloaded resource) shares the level
+    KisPaintOpPresetSP heavyCopy = createPreset("heavy", 300);
+    QCOMPARE(controller.preferredLevelOfDetail(heavyCopy), 2);
+}
+
+void KisAdaptiveLodControllerTest::testDisabled()
+{
+    KisAdaptiveLodController controller;
+    QSignalSpy spy(&controller, SIGNAL(sigPreferredLevelOfDetailChanged()));
+
+    KisPaintOpPresetSP preset = createPreset("preset", 10);
+
+    controller.notifyStrokeFinished(overBudgetLag, fps, 0, preset);
+    QCOMPARE(controller.preferredLevelOfDetail(preset), 1);
+    QCOMPARE(spy.count(), 1);
+
+    setControllerEnabled(false);
+
+    QVERIFY(!controller.isEnabled());
+    QCOMPARE(controller.preferredLevelOfDetail(preset), 0);
+    QCOMPARE(spy.count(), 2);
+
+    controller.notifyStrokeFinished(overBudgetLag, fps, 0, preset);
+    QCOMPARE(controller.preferredLevelOfDetail(preset), 0);
+
+    // the levels are not restored after enabling the controller again
+    setControllerEnabled(true);
+
+    QVERIFY(controller.isEnabled());
+    QCOMPARE(controller.preferredLevelOfDetail(preset), 0);
+}
+
+QTEST_MAIN(KisAdaptiveLodControllerTest)
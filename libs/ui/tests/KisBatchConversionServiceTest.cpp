@@ -0,0 +1,227 @@
+/*
+ *  Copyright (c) 2020 Krita developers
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include "KisBatchConversionServiceTest.h"
+
+#include <QTest>
+#include <QSignalSpy>
+#include <QTemporaryDir>
+#include <QImage>
+
+#include <kistest.h>
+
+#include "KisBatchConversionService.h"
+
+namespace {
+
+const int conversionTimeout = 30000;
+
+struct JobResult {
+    QString input;
+    QString output;
+    bool success;
+    QString message;
+};
+
+QList<JobResult> jobResults(const QSignalSpy &spy)
+{
+    QList<JobResult> results;
+
+    Q_FOREACH (const QList<QVariant> &args, spy) {
+        results << JobResult{args[0].toString(), args[1].toString(),
+                             args[2].toBool(), args[3].toString()};
+    }
+
+    return results;
+}
+
+QString writeJobsFile(const QTemporaryDir &dir, const QStringList &lines)
+{
+    const QString fileName = dir.filePath("jobs.jsonl");
+
+    QFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly)) return QString();
+
+    file.write(lines.join('\n').toUtf8());
+    return fileName;
+}
+
+QString createInputImage(const QTemporaryDir &dir)
+{
+    const QString fileName = dir.filePath("input.png");
+
+    QImage image(64, 48, QImage::Format_ARGB32);
+    image.fill(QColor(200, 100, 50));
+
+    return image.save(fileName) ? fileName : QString();
+}
+
+QString job(const QString &input, const QString &output, const QString &mimeType = QString())
+{
+    QString line = QString("{\"input\": \"%1\", \"output\": \"%2\"").arg(input).arg(output);
+    if (!mimeType.isEmpty()) {
+        line += QString(", \"mimetype\": \"%1\"").arg(mimeType);
+    }
+    return line + "}";
+}
+
+}
+
+void KisBatchConversionServiceTest::testMissingJobsFile()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+
+    KisBatchConversionService service(1);
+    QVERIFY(!service.addJobsFromFile(dir.filePath("nonexistent.jsonl")));
+}
+
+void KisBatchConversionServiceTest::testMalformedJobs()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+
+    const QString jobsFile = writeJobsFile(dir, {
+        "# comments and empty lines are skipped",
+        "",
+        "this is not json",
+        "{\"input\": \"a.kra\"}",
+        job(dir.filePath("a.kra"), dir.filePath("a.unknownformat")),
+        // relative paths are resolved against the current directory
+        job("nonexistent_input.png", "nonexistent_output.png")
+    });
+    QVERIFY(!jobsFile.isEmpty());
+
+    KisBatchConversionService service(1);
+    QSignalSpy resultSpy(&service, SIGNAL(sigJobResult(QString, QString, bool, QString)));
+    QSignalSpy finishedSpy(&service, SIGNAL(sigFinished(int)));
+
+    QVERIFY(service.addJobsFromFile(jobsFile));
+
+    // the jobs that cannot be parsed are reported right away
+    QCOMPARE(resultSpy.count(), 3);
+
+    QVERIFY(finishedSpy.wait(conversionTimeout));
+
+    const QList<JobResult> results = jobResults(resultSpy);
+    QCOMPARE(results.size(), 4);
+
+    Q_FOREACH (const JobResult &result, results) {
+        QVERIFY(!result.success);
+        QVERIFY(!result.message.isEmpty());
+    }
+
+    QCOMPARE(results[1].input, QDir::current().absoluteFilePath("a.kra"));
+    QVERIFY(results[1].output.isEmpty());
+
+    QCOMPARE(results[2].message, QString("unknown output mimetype"));
+
+    QCOMPARE(results[3].input, QDir::current().absoluteFilePath("nonexistent_input.png"));
+    QCOMPARE(results[3].output, QDir::current().absoluteFilePath("nonexistent_output.png"));
+    QVERIFY(!QFile::exists(results[3].output));
+
+    QCOMPARE(finishedSpy.count(), 1);
+    QCOMPARE(finishedSpy.first().first().toInt(), 4);
+    QCOMPARE(service.exitCode(), 1);
+}
+
+void KisBatchConversionServiceTest::testConversion()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+
+    const QString input = createInputImage(dir);
+    QVERIFY(!input.isEmpty());
+
+    const QString guessedOutput = dir.filePath("guessed.png");
+    const QString explicitOutput = dir.filePath("explicit.kra");
+
+    const QString jobsFile = writeJobsFile(dir, {
+        job(input, guessedOutput),
+        job(input, explicitOutput, "application/x-krita")
+    });
+    QVERIFY(!jobsFile.isEmpty());
+
+    KisBatchConversionService service(2);
+    QSignalSpy resultSpy(&service, SIGNAL(sigJobResult(QString, QString, bool, QString)));
+    QSignalSpy finishedSpy(&service, SIGNAL(sigFinished(int)));
+
+    QVERIFY(service.addJobsFromFile(jobsFile));
+    QVERIFY(finishedSpy.wait(conversionTimeout));
+
+    const QList<JobResult> results = jobResults(resultSpy);
+    QCOMPARE(results.size(), 2);
+
+    Q_FOREACH (const JobResult &result, results) {
+        QVERIFY2(result.success, qPrintable(result.message));
+        QCOMPARE(result.input, input);
+        QVERIFY(QFile::exists(result.output));
+    }
+
+    QImage converted(guessedOutput);
+    QCOMPARE(converted.size(), QSize(64, 48));
+    QCOMPARE(converted.pixelColor(10, 10), QColor(200, 100, 50));
+
+    QCOMPARE(finishedSpy.first().first().toInt(), 0);
+    QCOMPARE(service.exitCode(), 0);
+}
+
+void KisBatchConversionServiceTest::testFailedJobExitCode()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+
+    const QString input = createInputImage(dir);
+    QVERIFY(!input.isEmpty());
+
+    const QString jobsFile = writeJobsFile(dir, {
+        job(input, dir.filePath("ok.png")),
+        job(dir.filePath("nonexistent.png"), dir.filePath("failed.png")),
+        job(input, dir.filePath("ok2.png"))
+    });
+    QVERIFY(!jobsFile.isEmpty());
+
+    KisBatchConversionService service(1);
+    QSignalSpy resultSpy(&service, SIGNAL(sigJobResult(QString, QString, bool, QString)));
+    QSignalSpy finishedSpy(&service, SIGNAL(sigFinished(int)));
+
+    QVERIFY(service.addJobsFromFile(jobsFile));
+    QVERIFY(finishedSpy.wait(conversionTimeout));
+
+    // a failed job doesn't stop the rest of the batch
+    const QList<JobResult> results = jobResults(resultSpy);
+    QCOMPARE(results.size(), 3);
+
+    int numFailed = 0;
+    Q_FOREACH (const JobResult &result, results) {
+        if (!result.success) {
+            numFailed++;
+            QCOMPARE(result.input, dir.filePath("nonexistent.png"));
+        }
+    }
+    QCOMPARE(numFailed, 1);
+
+    QVERIFY(QFile::exists(dir.filePath("ok.png")));
+    QVERIFY(QFile::exists(dir.filePath("ok2.png")));
+    QVERIFY(!QFile::exists(dir.filePath("failed.png")));
+
+    QCOMPARE(finishedSpy.first().first().toInt(), 1);
+    QCOMPARE(service.exitCode(), 1);
+}
+
+KISTEST_MAIN(KisBatchConversionServiceTest)
@@ -0,0 +1,249 @@
+/*
+ *  Copyright (c) 2020 Krita developers
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include "kis_canvas_updates_compressor_test.h"
+
+#include <QTest>
+
+#include "kis_update_info.h"
+#include "canvas/kis_canvas_updates_compressor.h"
+#include "opengl/kis_texture_tile_info_pool.h"
+
+namespace {
+
+const int tileSize = 64;
+const QRect imageRect(0, 0, 4 * tileSize, 4 * tileSize);
+
+/**
+ * Builds an openGL update info the same way KisOpenGLUpdateInfoBuilder
+ * does: one tile info per texture tile of the image touched by \p rect
+ */
+KisOpenGLUpdateInfoSP createInfo(const QRect &rect, int levelOfDetail = 0)
+{
+    KisTextureTileInfoPoolSP pool(new KisTextureTileInfoPool(tileSize, tileSize));
+
+    KisOpenGLUpdateInfoSP info = new KisOpenGLUpdateInfo();
+    info->assignDirtyImageRect(rect);
+    info->assignLevelOfDetail(levelOfDetail);
+
+    for (int row = 0; row < imageRect.height() / tileSize; row++) {
+        for (int col = 0; col < imageRect.width() / tileSize; col++) {
+            const QRect tileRect(col * tileSize, row * tileSize, tileSize, tileSize);
+            if (!tileRect.intersects(rect)) continue;
+
+            info->tileList.append(
+                KisTextureTileUpdateInfoSP(
+                    new KisTextureTileUpdateInfo(col, row, tileRect, rect, imageRect,
+                                                 levelOfDetail, pool)));
+        }
+    }
+
+    return info;
+}
+
+QList<QPoint> tileIndexes(KisUpdateInfoSP info)
+{
+    KisOpenGLUpdateInfo *glInfo = dynamic_cast<KisOpenGLUpdateInfo*>(info.data());
+    QList<QPoint> result;
+
+    if (glInfo) {
+        Q_FOREACH (KisTextureTileUpdateInfoSP tile, glInfo->tileList) {
+            result << QPoint(tile->tileCol(), tile->tileRow());
+        }
+    }
+
+    return result;
+}
+
+}
+
+void KisCanvasUpdatesCompressorTest::testMergeTiles()
+{
+    KisCanvasUpdatesCompressor compressor;
+
+    KisOpenGLUpdateInfoSP oldInfo = createInfo(QRect(0, 0, 2 * tileSize, tileSize));
+    KisOpenGLUpdateInfoSP newInfo = createInfo(QRect(0, 0, tileSize, tileSize));
+
+    QVERIFY(compressor.putUpdateInfo(oldInfo));
+    compressor.putUpdateInfo(newInfo);
+
+    QCOMPARE(compressor.mergedTilesCount(), 1);
+    QCOMPARE(compressor.droppedUpdatesCount(), 0);
+
+    KisUpdateInfoList list;
+    compressor.takeUpdateInfo(list);
+
+    QCOMPARE(list.size(), 2);
+    QCOMPARE(list[0].data(), oldInfo.data());
+    QCOMPARE(list[1].data(), newInfo.data());
+
+    // only the tile not covered by the new update is left in the old one
+    QCOMPARE(tileIndexes(list[0]), QList<QPoint>() << QPoint(1, 0));
+    QCOMPARE(tileIndexes(list[1]), QList<QPoint>() << QPoint(0, 0));
+}
+
+void KisCanvasUpdatesCompressorTest::testPartiallyCoveredTiles()
+{
+    KisCanvasUpdatesCompressor compressor;
+
+    KisOpenGLUpdateInfoSP oldInfo = createInfo(QRect(0, 0, 2 * tileSize, tileSize));
+    KisOpenGLUpdateInfoSP newInfo = createInfo(QRect(0, 0, tileSize / 2, tileSize / 2));
+
+    compressor.putUpdateInfo(oldInfo);
+    compressor.putUpdateInfo(newInfo);
+
+    // the new patch covers only a part of the old tile, it must be kept
+    QCOMPARE(compressor.mergedTilesCount(), 0);
+    QCOMPARE(compressor.droppedUpdatesCount(), 0);
+
+    KisUpdateInfoList list;
+    compressor.takeUpdateInfo(list);
+
+    QCOMPARE(list.size(), 2);
+    QCOMPARE(tileIndexes(list[0]), QList<QPoint>() << QPoint(0, 0) << QPoint(1, 0));
+}
+
+void KisCanvasUpdatesCompressorTest::testSupersededUpdates()
+{
+    KisCanvasUpdatesCompressor compressor;
+
+    KisOpenGLUpdateInfoSP oldInfo = createInfo(QRect(10, 10, 20, 20));
+    KisOpenGLUpdateInfoSP otherInfo = createInfo(QRect(3 * tileSize, 3 * tileSize, 10, 10));
+    KisOpenGLUpdateInfoSP newInfo = createInfo(QRect(0, 0, 2 * tileSize, 2 * tileSize));
+
+    compressor.putUpdateInfo(oldInfo);
+    compressor.putUpdateInfo(otherInfo);
+    compressor.putUpdateInfo(newInfo);
+
+    QCOMPARE(compressor.droppedUpdatesCount(), 1);
+    QCOMPARE(compressor.mergedTilesCount(), 0);
+
+    KisUpdateInfoList list;
+    compressor.takeUpdateInfo(list);
+
+    // the superseding update is moved to the end of the queue
+    QCOMPARE(list.size(), 2);
+    QCOMPARE(list[0].data(), otherInfo.data());
+    QCOMPARE(list[1].data(), newInfo.data());
+}
+
+void KisCanvasUpdatesCompressorTest::testAllTilesSuperseded()
+{
+    KisCanvasUpdatesCompressor compressor;
+
+    /**
+     * The old update sticks out of the image, so its dirty rect is not
+     * contained in the new one, though its only tile patch is
+     */
+    const QRect tileRect(3 * tileSize, 3 * tileSize, tileSize, tileSize);
+    KisOpenGLUpdateInfoSP oldInfo = createInfo(tileRect.adjusted(10, 10, 10, 10));
+    KisOpenGLUpdateInfoSP newInfo = createInfo(tileRect);
+
+    QVERIFY(!newInfo->dirtyImageRect().contains(oldInfo->dirtyImageRect()));
+
+    compressor.putUpdateInfo(oldInfo);
+    compressor.putUpdateInfo(newInfo);
+
+    QCOMPARE(compressor.mergedTilesCount(), 1);
+    QCOMPARE(compressor.droppedUpdatesCount(), 1);
+
+    KisUpdateInfoList list;
+    compressor.takeUpdateInfo(list);
+
+    QCOMPARE(list.size(), 1);
+    QCOMPARE(list[0].data(), newInfo.data());
+}
+
+void KisCanvasUpdatesCompressorTest::testDifferentLevelOfDetail()
+{
+    KisCanvasUpdatesCompressor compressor;
+
+    const QRect rect(0, 0, 2 * tileSize, tileSize);
+
+    compressor.putUpdateInfo(createInfo(rect, 0));
+    compressor.putUpdateInfo(createInfo(rect, 1));
+
+    QCOMPARE(compressor.mergedTilesCount(), 0);
+    QCOMPARE(compressor.droppedUpdatesCount(), 0);
+
+    KisUpdateInfoList list;
+    compressor.takeUpdateInfo(list);
+
+    QCOMPARE(list.size(), 2);
+    QCOMPARE(tileIndexes(list[0]).size(), 2);
+    QCOMPARE(tileIndexes(list[1]).size(), 2);
+}
+
+void KisCanvasUpdatesCompressorTest::testMarkersAreNotCompressed()
+{
+    KisCanvasUpdatesCompressor compressor;
+
+    KisUpdateInfoSP marker =
+        new KisMarkerUpdateInfo(KisMarkerUpdateInfo::StartBatch, QRect(10, 10, 20, 20));
+
+    compressor.putUpdateInfo(marker);
+    compressor.putUpdateInfo(createInfo(imageRect));
+
+    QCOMPARE(compressor.droppedUpdatesCount(), 0);
+
+    KisUpdateInfoList list;
+    compressor.takeUpdateInfo(list);
+
+    QCOMPARE(list.size(), 2);
+    QCOMPARE(list[0].data(), marker.data());
+}
+
+void KisCanvasUpdatesCompressorTest::testVisibleTilesFirst_data()
+{
+    QTest::addColumn<int>("levelOfDetail");
+    QTest::addColumn<QRect>("viewportRect");
+    QTest::addColumn<QList<QPoint>>("expectedOrder");
+
+    const QList<QPoint> originalOrder =
+        QList<QPoint>() << QPoint(0, 0) << QPoint(1, 0) << QPoint(2, 0) << QPoint(3, 0);
+
+    const QList<QPoint> visibleFirstOrder =
+        QList<QPoint>() << QPoint(2, 0) << QPoint(3, 0) << QPoint(0, 0) << QPoint(1, 0);
+
+    const QRect viewportRect(2 * tileSize + 10, 0, 100, 100);
+
+    QTest::newRow("lod0") << 0 << viewportRect << visibleFirstOrder;
+    QTest::newRow("lod1") << 1 << viewportRect << visibleFirstOrder;
+    QTest::newRow("no-viewport") << 0 << QRect() << originalOrder;
+    QTest::newRow("all-visible") << 0 << imageRect << originalOrder;
+}
+
+void KisCanvasUpdatesCompressorTest::testVisibleTilesFirst()
+{
+    QFETCH(int, levelOfDetail);
+    QFETCH(QRect, viewportRect);
+    QFETCH(QList<QPoint>, expectedOrder);
+
+    KisCanvasUpdatesCompressor compressor;
+    compressor.setViewportImageRect(viewportRect);
+
+    compressor.putUpdateInfo(createInfo(QRect(0, 0, imageRect.width(), tileSize), levelOfDetail));
+
+    KisUpdateInfoList list;
+    compressor.takeUpdateInfo(list);
+
+    QCOMPARE(list.size(), 1);
+    QCOMPARE(tileIndexes(list[0]), expectedOrder);
+}
+
+QTEST_MAIN(KisCanvasUpdatesCompressorTest)
@@ -0,0 +1,156 @@
+/*
+ *  Copyright (c) 2020 Krita developers
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include "kis_image_pyramid_test.h"
+
+#include <QTest>
+
+#include <KoColorSpaceRegistry.h>
+
+#include <kis_debug.h>
+#include <kis_paint_device.h>
+
+#include "canvas/kis_image_pyramid.h"
+
+namespace {
+
+const int pixelSize = 4;
+
+void fillRandom(QByteArray &bytes, quint32 seed)
+{
+    for (int i = 0; i < bytes.size(); i++) {
+        seed = seed * 1103515245 + 12345;
+        bytes[i] = char(seed >> 16);
+    }
+}
+
+}
+
+void KisImagePyramidTest::testDownsamplePixels_data()
+{
+    QTest::addColumn<int>("numSrcPixels");
+    QTest::addColumn<bool>("saturated");
+
+    /**
+     * The SSE2 kernel processes 8 source pixels at a time, the rest
+     * of the row is handled by the scalar tail
+     */
+    Q_FOREACH (int numSrcPixels, QList<int>({2, 4, 6, 8, 10, 14, 16, 18, 22, 30, 34, 66, 126})) {
+        QTest::newRow(QString("random-%1").arg(numSrcPixels).toLatin1()) << numSrcPixels << false;
+        QTest::newRow(QString("saturated-%1").arg(numSrcPixels).toLatin1()) << numSrcPixels << true;
+    }
+}
+
+void KisImagePyramidTest::testDownsamplePixels()
+{
+    QFETCH(int, numSrcPixels);
+    QFETCH(bool, saturated);
+
+    QByteArray row0(numSrcPixels * pixelSize, char(0xff));
+    QByteArray row1(numSrcPixels * pixelSize, char(0xff));
+
+    if (!saturated) {
+        fillRandom(row0, numSrcPixels);
+        fillRandom(row1, numSrcPixels + 1);
+    }
+
+    const int numDstBytes = numSrcPixels / 2 * pixelSize;
+
+    // a guard byte after the row catches the writes out of bounds
+    QByteArray result(numDstBytes + 1, char(0x5a));
+    QByteArray reference(numDstBytes + 1, char(0x5a));
+
+    KisImagePyramid::downsamplePixels(reinterpret_cast<const quint8*>(row0.constData()),
+                                      reinterpret_cast<const quint8*>(row1.constData()),
+                                      reinterpret_cast<quint8*>(result.data()),
+                                      numSrcPixels);
+
+    KisImagePyramid::downsamplePixelsScalar(reinterpret_cast<const quint8*>(row0.constData()),
+                                            reinterpret_cast<const quint8*>(row1.constData()),
+                                            reinterpret_cast<quint8*>(reference.data()),
+                                            numSrcPixels);
+
+    QCOMPARE(result, reference);
+    QCOMPARE(result[numDstBytes], char(0x5a));
+
+    if (saturated) {
+        QCOMPARE(result.left(numDstBytes), QByteArray(numDstBytes, char(0xff)));
+    }
+}
+
+void KisImagePyramidTest::testDownsampleByFactor2_data()
+{
+    QTest::addColumn<QRect>("srcRect");
+    QTest::addColumn<QRect>("expectedRect");
+
+    QTest::newRow("aligned") << QRect(0, 0, 64, 64) << QRect(0, 0, 32, 32);
+    QTest::newRow("odd-size") << QRect(2, 4, 67, 45) << QRect(1, 2, 34, 23);
+    QTest::newRow("odd-origin") << QRect(1, 3, 66, 44) << QRect(0, 1, 34, 23);
+    QTest::newRow("single-pixel") << QRect(5, 7, 1, 1) << QRect(2, 3, 1, 1);
+    QTest::newRow("tile-border") << QRect(61, 63, 7, 3) << QRect(30, 31, 4, 2);
+}
+
+void KisImagePyramidTest::testDownsampleByFactor2()
+{
+    QFETCH(QRect, srcRect);
+    QFETCH(QRect, expectedRect);
+
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb8();
+    const QRect fillRect(0, 0, 160, 160);
+
+    QByteArray srcBytes(fillRect.width() * fillRect.height() * pixelSize, 0);
+    fillRandom(srcBytes, 17);
+
+    KisPaintDeviceSP src = new KisPaintDevice(cs);
+    KisPaintDeviceSP dst = new KisPaintDevice(cs);
+    src->writeBytes(reinterpret_cast<const quint8*>(srcBytes.constData()), fillRect);
+
+    KisImagePyramid pyramid(2);
+    const QRect dstRect = pyramid.downsampleByFactor2(srcRect, src.data(), dst.data());
+
+    QCOMPARE(dstRect, expectedRect);
+
+    QByteArray dstBytes(dstRect.width() * dstRect.height() * pixelSize, 0);
+    dst->readBytes(reinterpret_cast<quint8*>(dstBytes.data()), dstRect);
+
+    // every pixel of the destination is the average of a 2x2 source block
+    for (int y = 0; y < dstRect.height(); y++) {
+        for (int x = 0; x < dstRect.width(); x++) {
+            const int srcX = 2 * (dstRect.x() + x);
+            const int srcY = 2 * (dstRect.y() + y);
+
+            for (int ch = 0; ch < pixelSize; ch++) {
+                auto srcValue = [&] (int dx, int dy) {
+                    return int(quint8(srcBytes[((srcY + dy) * fillRect.width() + srcX + dx) * pixelSize + ch]));
+                };
+
+                const int expected = (srcValue(0, 0) + srcValue(1, 0) +
+                                      srcValue(0, 1) + srcValue(1, 1)) / 4;
+
+                const int actual = quint8(dstBytes[(y * dstRect.width() + x) * pixelSize + ch]);
+
+                if (actual != expected) {
+                    qDebug() << ppVar(x) << ppVar(y) << ppVar(ch) << ppVar(actual) << ppVar(expected);
+                    QFAIL("downsampled pixel differs from the reference");
+                }
+            }
+        }
+    }
+}
+
+QTEST_MAIN(KisImagePyramidTest)
@@ -0,0 +1,146 @@
+/*
+ *  Copyright (c) 2020 Krita developers
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include "KisAdaptiveLodController.h"
+
+#include <QGlobalStatic>
+#include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
+
+#include "kis_paintop_preset.h"
+#include "kis_paintop_settings.h"
+
+#include "kis_config.h"
+#include "kis_config_notifier.h"
+
+
+Q_GLOBAL_STATIC(KisAdaptiveLodController, s_instance)
+
+
+struct KisAdaptiveLodController::Private
+{
+    /**
+     * The level of detail is decreased only when the stroke is
+     * rendered at least twice faster than the budget, otherwise the
+     * controller would oscillate between the two neighbouring levels
+     */
+    static constexpr qreal decreaseThreshold = 0.5;
+
+    bool isEnabled = false;
+    int latencyBudget = 50;
+
+    QHash<QString, int> presetLevels;
+
+    mutable QMutex mutex;
+
+    static QString presetKey(KisPaintOpPresetSP preset) {
+        return QString("%1@%2").arg(preset->name()).arg(preset->settings()->paintOpSize());
+    }
+};
+
+KisAdaptiveLodController::KisAdaptiveLodController()
+    : m_d(new Private())
+{
+    connect(KisConfigNotifier::instance(), SIGNAL(configChanged()), SLOT(slotConfigChanged()));
+    slotConfigChanged();
+}
+
+KisAdaptiveLodController::~KisAdaptiveLodController()
+{
+}
+
+KisAdaptiveLodController *KisAdaptiveLodController::instance()
+{
+    return s_instance;
+}
+
+bool KisAdaptiveLodController::isEnabled() const
+{
+    QMutexLocker locker(&m_d->mutex);
+    return m_d->isEnabled;
+}
+
+int KisAdaptiveLodController::preferredLevelOfDetail(KisPaintOpPresetSP preset) const
+{
+    if (!preset) return 0;
+
+    QMutexLocker locker(&m_d->mutex);
+    return m_d->isEnabled ? m_d->presetLevels.value(Private::presetKey(preset), 0) : 0;
+}
+
+void KisAdaptiveLodController::slotConfigChanged()
+{
+    KisConfig cfg(true);
+
+    bool levelChanged = false;
+
+    {
+        QMutexLocker locker(&m_d->mutex);
+
+        const bool isEnabled = cfg.adaptiveLevelOfDetail();
+        levelChanged = isEnabled != m_d->isEnabled && !m_d->presetLevels.isEmpty();
+
+        m_d->isEnabled = isEnabled;
+        m_d->latencyBudget = qMax(1, cfg.adaptiveLevelOfDetailLatencyBudget());
+
+        if (!m_d->isEnabled) {
+            m_d->presetLevels.clear();
+        }
+    }
+
+    if (levelChanged) {
+        emit sigPreferredLevelOfDetailChanged();
+    }
+}
+
+void KisAdaptiveLodController::notifyStrokeFinished(qreal renderingLag, qreal fps, int levelOfDetail, KisPaintOpPresetSP preset)
+{
+    if (!preset || qFuzzyCompare(fps, 0.0)) return;
+
+    bool levelChanged = false;
+
+    {
+        QMutexLocker locker(&m_d->mutex);
+        if (!m_d->isEnabled) return;
+
+        const qreal latency = renderingLag + 1000.0 / fps;
+        const QString key = Private::presetKey(preset);
+
+        const int oldLevel = m_d->presetLevels.value(key, 0);
+        int level = oldLevel;
+
+        if (latency > m_d->latencyBudget) {
+            /**
+             * The stroke might have been painted at a coarser level than
+             * we requested (because of the zoom), so we should continue
+             * from the level it has actually been painted at.
+             */
+            level = qMin(int(maxLevelOfDetail), qMax(level, levelOfDetail) + 1);
+        } else if (latency < Private::decreaseThreshold * m_d->latencyBudget) {
+            level = qMax(0, level - 1);
+        }
+
+        m_d->presetLevels.insert(key, level);
+        levelChanged = level != oldLevel;
+    }
+
+    if (levelChanged) {
+        emit sigPreferredLevelOfDetailChanged();
+    }
+}
@@ -0,0 +1,81 @@
+/*
+ *  Copyright (c) 2020 Krita developers
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#ifndef KISADAPTIVELODCONTROLLER_H
+#define KISADAPTIVELODCONTROLLER_H
+
+#include <QObject>
+
+#include "kis_types.h"
+#include "kritaui_export.h"
+
+/**
+ * KisAdaptiveLodController selects the level of detail for Instant
+ * Preview strokes based on the latency measured in the previous
+ * strokes of the same preset.
+ *
+ * The latency of a stroke is estimated as the time the rendering has
+ * lagged behind the cursor after the user released the stylus plus the
+ * duration of one canvas frame. When the latency exceeds the budget set
+ * in the config, the level of detail of the next stroke is increased;
+ * when the stroke is rendered well within the budget, it is decreased
+ * back. The zoom-based level of detail is still used as the lower
+ * bound, so the controller can only make the preview coarser, never
+ * finer than the zoom level allows.
+ */
+class KRITAUI_EXPORT KisAdaptiveLodController : public QObject
+{
+    Q_OBJECT
+public:
+    KisAdaptiveLodController();
+    ~KisAdaptiveLodController();
+
+    static KisAdaptiveLodController* instance();
+
+    bool isEnabled() const;
+
+    /**
+     * \return the level of detail the next stroke painted with \p preset
+     * should use at least, in range [0...maxLevelOfDetail]
+     */
+    int preferredLevelOfDetail(KisPaintOpPresetSP preset) const;
+
+    /**
+     * Called by the stroke when it is finished. \p renderingLag and
+     * \p fps are the values measured by KisStrokeEfficiencyMeasurer
+     * for the stroke painted at level of detail \p levelOfDetail.
+     */
+    void notifyStrokeFinished(qreal renderingLag, qreal fps, int levelOfDetail, KisPaintOpPresetSP preset);
+
+    static const int maxLevelOfDetail = 3;
+
+Q_SIGNALS:
+    /**
+     * Emitted when the preferred level of detail of any preset changes
+     */
+    void sigPreferredLevelOfDetailChanged();
+
+private Q_SLOTS:
+    void slotConfigChanged();
+
+private:
+    struct Private;
+    const QScopedPointer<Private> m_d;
+};
+
+#endif // KISADAPTIVELODCONTROLLER_H
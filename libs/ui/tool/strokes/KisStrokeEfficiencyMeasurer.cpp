@@ -125,4 +125,10 @@ qreal KisStrokeEfficiencyMeasurer::averageFps() const
     return m_d->renderingTime ? m_d->framesCount * 1000.0 / m_d->renderingTime : 0.0;
 }
 
+qreal KisStrokeEfficiencyMeasurer::renderingLag() const
+{
+    return qMax(0, (m_d->renderingStartTime + m_d->renderingTime) -
+                   (m_d->cursorMoveStartTime + m_d->cursorMoveTime));
+}
+
 
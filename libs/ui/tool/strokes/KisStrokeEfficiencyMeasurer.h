@@ -42,6 +42,13 @@ public:
     qreal averageRenderingSpeed() const;
     qreal averageFps() const;
 
+    /**
+     * The time (in milliseconds) the rendering of the stroke has
+     * continued after the cursor has stopped moving, that is, how much
+     * the brush lagged behind the stylus at the end of the stroke.
+     */
+    qreal renderingLag() const;
+
     void notifyRenderingStarted();
     void notifyRenderingFinished();
 
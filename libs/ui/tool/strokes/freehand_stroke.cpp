@@ -34,6 +34,7 @@
 #include <mutex>
 
 #include "KisStrokeEfficiencyMeasurer.h"
+#include "KisAdaptiveLodController.h"
 #include <KisStrokeSpeedMonitor.h>
 #include <strokes/KisFreehandStrokeInfo.h>
 #include <strokes/KisMaskedFreehandStrokePainter.h>
@@ -66,6 +67,7 @@ struct FreehandStrokeStrategy::Private
     KisResourcesSnapshotSP resources;
 
     KisStrokeEfficiencyMeasurer efficiencyMeasurer;
+    bool hasLodClone = false;
 
     QElapsedTimer timeSinceLastUpdate;
     int currentUpdatePeriod = 40;
@@ -108,6 +110,17 @@ FreehandStrokeStrategy::~FreehandStrokeStrategy()
                                                             m_d->efficiencyMeasurer.averageFps(),
                                                             m_d->resources->currentPaintOpPreset());
 
+    /**
+     * When Instant Preview is active, the user sees the LoD clone of the
+     * stroke, so only its measurements are relevant for the latency
+     */
+    if (!m_d->hasLodClone) {
+        KisAdaptiveLodController::instance()->notifyStrokeFinished(m_d->efficiencyMeasurer.renderingLag(),
+                                                                   m_d->efficiencyMeasurer.averageFps(),
+                                                                   m_d->randomSource.levelOfDetail(),
+                                                                   m_d->resources->currentPaintOpPreset());
+    }
+
     KisUpdateTimeMonitor::instance()->endStrokeMeasure();
 }
 
@@ -127,7 +140,8 @@ void FreehandStrokeStrategy::init()
     }
 
     KisUpdateTimeMonitor::instance()->startStrokeMeasure();
-    m_d->efficiencyMeasurer.setEnabled(KisStrokeSpeedMonitor::instance()->haveStrokeSpeedMeasurement());
+    m_d->efficiencyMeasurer.setEnabled(KisStrokeSpeedMonitor::instance()->haveStrokeSpeedMeasurement() ||
+                                       KisAdaptiveLodController::instance()->isEnabled());
 }
 
 void FreehandStrokeStrategy::initStrokeCallback()
@@ -336,6 +350,7 @@ KisStrokeStrategy* FreehandStrokeStrategy::createLodClone(int levelOfDetail)
     if (!m_d->resources->presetAllowsLod()) return 0;
 
     FreehandStrokeStrategy *clone = new FreehandStrokeStrategy(*this, levelOfDetail);
+    m_d->hasLodClone = true;
     return clone;
 }
 
@@ -0,0 +1,102 @@
+/*
+ *  Copyright (c) 2020 Krita developers
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include "KisLoadingPreviewWidget.h"
+
+#include <QMouseEvent>
+#include <QPainter>
+#include <QWheelEvent>
+
+#include <klocalizedstring.h>
+
+KisLoadingPreviewWidget::KisLoadingPreviewWidget(const QImage &preview, QWidget *parent)
+    : QWidget(parent)
+    , m_preview(preview)
+    , m_zoom(1.0)
+    , m_userZoomed(false)
+{
+    setAttribute(Qt::WA_OpaquePaintEvent);
+    setCursor(Qt::BusyCursor);
+    fitToWidget();
+}
+
+void KisLoadingPreviewWidget::fitToWidget()
+{
+    if (m_preview.isNull() || width() <= 0 || height() <= 0) return;
+
+    m_zoom = qMin(qreal(width()) / m_preview.width(),
+                  qreal(height()) / m_preview.height());
+    m_offset = 0.5 * QPointF(width() - m_zoom * m_preview.width(),
+                             height() - m_zoom * m_preview.height());
+}
+
+void KisLoadingPreviewWidget::paintEvent(QPaintEvent *event)
+{
+    Q_UNUSED(event);
+
+    QPainter gc(this);
+    gc.fillRect(rect(), palette().color(QPalette::Dark));
+
+    gc.setRenderHint(QPainter::SmoothPixmapTransform, m_zoom < 1.0);
+    gc.drawImage(QRectF(m_offset, m_zoom * QSizeF(m_preview.size())), m_preview);
+
+    const QString text = i18n("Loading layers...");
+    const QRect textRect = gc.fontMetrics().boundingRect(text).adjusted(-8, -4, 8, 4);
+
+    gc.setOpacity(0.8);
+    gc.fillRect(textRect.translated(-textRect.topLeft() + QPoint(8, 8)), palette().color(QPalette::Window));
+    gc.setOpacity(1.0);
+    gc.drawText(textRect.translated(-textRect.topLeft() + QPoint(8, 8)), Qt::AlignCenter, text);
+}
+
+void KisLoadingPreviewWidget::wheelEvent(QWheelEvent *event)
+{
+    const qreal factor = event->angleDelta().y() > 0 ? 1.25 : 0.8;
+    const QPointF pos = event->posF();
+
+    m_offset = pos - factor * (pos - m_offset);
+    m_zoom *= factor;
+    m_userZoomed = true;
+
+    update();
+}
+
+void KisLoadingPreviewWidget::mousePressEvent(QMouseEvent *event)
+{
+    m_lastMousePos = event->pos();
+}
+
+void KisLoadingPreviewWidget::mouseMoveEvent(QMouseEvent *event)
+{
+    if (!(event->buttons() & Qt::LeftButton)) return;
+
+    m_offset += event->pos() - m_lastMousePos;
+    m_lastMousePos = event->pos();
+    m_userZoomed = true;
+
+    update();
+}
+
+void KisLoadingPreviewWidget::resizeEvent(QResizeEvent *event)
+{
+    Q_UNUSED(event);
+
+    if (!m_userZoomed) {
+        fitToWidget();
+    }
+}
@@ -0,0 +1,54 @@
+/*
+ *  Copyright (c) 2020 Krita developers
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#ifndef KISLOADINGPREVIEWWIDGET_H
+#define KISLOADINGPREVIEWWIDGET_H
+
+#include <QWidget>
+#include <QImage>
+#include <kritaui_export.h>
+
+/**
+ * Shows the preview of a document while it is being loaded. The
+ * preview can be zoomed with the mouse wheel and panned by dragging.
+ */
+class KRITAUI_EXPORT KisLoadingPreviewWidget : public QWidget
+{
+    Q_OBJECT
+public:
+    explicit KisLoadingPreviewWidget(const QImage &preview, QWidget *parent = 0);
+
+protected:
+    void paintEvent(QPaintEvent *event) override;
+    void wheelEvent(QWheelEvent *event) override;
+    void mousePressEvent(QMouseEvent *event) override;
+    void mouseMoveEvent(QMouseEvent *event) override;
+    void resizeEvent(QResizeEvent *event) override;
+
+private:
+    void fitToWidget();
+
+private:
+    QImage m_preview;
+    qreal m_zoom;
+    QPointF m_offset;
+    QPoint m_lastMousePos;
+    bool m_userZoomed;
+};
+
+#endif // KISLOADINGPREVIEWWIDGET_H
@@ -0,0 +1,241 @@
+/*  This file is part of the KDE project
+
+    Copyright (c) 2020 Krita developers
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "KoResourceIndex.h"
+
+#include <QBuffer>
+#include <QDataStream>
+#include <QFileInfo>
+#include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QSaveFile>
+#include <QSet>
+
+#include "WidgetsDebug.h"
+
+namespace {
+const quint32 INDEX_MAGIC = 0x4b524958; // "KRIX"
+const quint32 INDEX_VERSION = 2;
+
+QByteArray encodeThumbnail(const QImage &thumbnail)
+{
+    QImage image = thumbnail;
+
+    if (image.width() > KoResourceIndex::thumbnailSize() ||
+        image.height() > KoResourceIndex::thumbnailSize()) {
+
+        image = image.scaled(KoResourceIndex::thumbnailSize(), KoResourceIndex::thumbnailSize(),
+                             Qt::KeepAspectRatio, Qt::SmoothTransformation);
+    }
+
+    QByteArray data;
+    QBuffer buffer(&data);
+    buffer.open(QIODevice::WriteOnly);
+    image.save(&buffer, "PNG");
+
+    return data;
+}
+}
+
+QDataStream &operator<<(QDataStream &stream, const KoResourceIndex::Entry &entry)
+{
+    stream << entry.size << entry.lastModified << entry.valid
+           << entry.md5 << entry.name << entry.thumbnailData;
+    return stream;
+}
+
+QDataStream &operator>>(QDataStream &stream, KoResourceIndex::Entry &entry)
+{
+    stream >> entry.size >> entry.lastModified >> entry.valid
+           >> entry.md5 >> entry.name >> entry.thumbnailData;
+    return stream;
+}
+
+QImage KoResourceIndex::Entry::thumbnail() const
+{
+    QImage image;
+    if (!thumbnailData.isEmpty()) {
+        image.loadFromData(thumbnailData, "PNG");
+    }
+    return image;
+}
+
+struct KoResourceIndex::Private
+{
+    QString indexFilename;
+    QHash<QString, Entry> entries;
+    QSet<QString> usedEntries;
+    bool isDirty = false;
+    mutable QMutex mutex;
+
+    bool isFresh(const QString &filename, const Entry &entry) const {
+        QFileInfo info(filename);
+        return info.exists() &&
+            info.size() == entry.size &&
+            info.lastModified() == entry.lastModified;
+    }
+};
+
+KoResourceIndex::KoResourceIndex(const QString &indexFilename)
+    : m_d(new Private)
+{
+    m_d->indexFilename = indexFilename;
+
+    QFile file(indexFilename);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return;
+    }
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_5_6);
+
+    quint32 magic = 0;
+    quint32 version = 0;
+    stream >> magic >> version;
+
+    if (magic != INDEX_MAGIC || version != INDEX_VERSION) {
+        debugWidgets << "Ignoring resource index of unknown format" << indexFilename;
+        return;
+    }
+
+    QHash<QString, Entry> entries;
+    stream >> entries;
+
+    if (stream.status() != QDataStream::Ok) {
+        warnWidgets << "Could not read resource index" << indexFilename;
+        return;
+    }
+
+    m_d->entries = entries;
+}
+
+KoResourceIndex::~KoResourceIndex()
+{
+}
+
+bool KoResourceIndex::lookup(const QString &filename, Entry *entry) const
+{
+    QMutexLocker l(&m_d->mutex);
+
+    auto it = m_d->entries.constFind(filename);
+    if (it == m_d->entries.constEnd()) return false;
+
+    const_cast<Private*>(m_d.data())->usedEntries.insert(filename);
+
+    if (!m_d->isFresh(filename, *it)) return false;
+
+    *entry = *it;
+    return true;
+}
+
+void KoResourceIndex::update(const QString &filename, bool valid, const QByteArray &md5,
+                             const QString &name, const QImage &thumbnail)
+{
+    QFileInfo info(filename);
+
+    Entry entry;
+    entry.size = info.size();
+    entry.lastModified = info.lastModified();
+    entry.valid = valid;
+
+    if (valid) {
+        entry.md5 = md5;
+        entry.name = name;
+    }
+
+    const bool hasThumbnail = valid && !thumbnail.isNull();
+
+    {
+        QMutexLocker l(&m_d->mutex);
+        m_d->usedEntries.insert(filename);
+
+        auto it = m_d->entries.constFind(filename);
+        if (it != m_d->entries.constEnd() &&
+            it->size == entry.size &&
+            it->lastModified == entry.lastModified &&
+            it->valid == entry.valid &&
+            it->md5 == entry.md5 &&
+            it->name == entry.name &&
+            it->thumbnailData.isEmpty() == !hasThumbnail) {
+
+            return;
+        }
+    }
+
+    if (hasThumbnail) {
+        entry.thumbnailData = encodeThumbnail(thumbnail);
+    }
+
+    QMutexLocker l(&m_d->mutex);
+    m_d->entries[filename] = entry;
+    m_d->isDirty = true;
+}
+
+bool KoResourceIndex::save()
+{
+    QMutexLocker l(&m_d->mutex);
+
+    for (auto it = m_d->entries.begin(); it != m_d->entries.end();) {
+        if (!m_d->usedEntries.contains(it.key())) {
+            it = m_d->entries.erase(it);
+            m_d->isDirty = true;
+        } else {
+            ++it;
+        }
+    }
+
+    if (!m_d->isDirty) return true;
+
+    QSaveFile file(m_d->indexFilename);
+    if (!file.open(QIODevice::WriteOnly)) {
+        warnWidgets << "Could not write resource index" << m_d->indexFilename;
+        return false;
+    }
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_5_6);
+    stream << INDEX_MAGIC << INDEX_VERSION << m_d->entries;
+
+    if (stream.status() != QDataStream::Ok || !file.commit()) {
+        warnWidgets << "Could not write resource index" << m_d->indexFilename;
+        return false;
+    }
+
+    m_d->isDirty = false;
+    return true;
+}
+
+bool KoResourceIndex::isModified() const
+{
+    QMutexLocker l(&m_d->mutex);
+
+    if (m_d->isDirty) return true;
+
+    for (auto it = m_d->entries.constBegin(); it != m_d->entries.constEnd(); ++it) {
+        if (!m_d->usedEntries.contains(it.key())) return true;
+    }
+
+    return false;
+}
+
+int KoResourceIndex::thumbnailSize()
+{
+    return 128;
+}
@@ -0,0 +1,105 @@
+/*  This file is part of the KDE project
+
+    Copyright (c) 2020 Krita developers
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef KORESOURCEINDEX_H
+#define KORESOURCEINDEX_H
+
+#include <QScopedPointer>
+#include <QString>
+#include <QByteArray>
+#include <QDateTime>
+#include <QImage>
+
+#include "kritawidgets_export.h"
+
+/**
+ * KoResourceIndex is a persistent cache of the metadata of the resource
+ * files loaded by a resource server. For every file it keeps the size and
+ * the modification time the file had when it was loaded, together with
+ * the md5, the name and a small thumbnail of the resource.
+ *
+ * On the next start the server looks the file up in the index: if the
+ * file has not changed, the md5 is taken from the index instead of being
+ * hashed again.
+ *
+ * The thumbnails are needed only for the resources that are registered
+ * without reading their files (see KoResource::setLazyLoaded()), so they
+ * are kept PNG-encoded and decoded only when asked for.
+ *
+ * All the methods except save() are thread-safe, so the index can be
+ * used from the threads loading the resources.
+ */
+class KRITAWIDGETS_EXPORT KoResourceIndex
+{
+public:
+    struct Entry {
+        qint64 size = -1;
+        QDateTime lastModified;
+        bool valid = false;
+        QByteArray md5;
+        QString name;
+        QByteArray thumbnailData;
+
+        /// @return the decoded thumbnail, or a null image if there is none
+        QImage thumbnail() const;
+    };
+
+public:
+    /**
+     * Reads the index from \p indexFilename. If the file does not exist
+     * or has an unknown format, the index is empty.
+     */
+    explicit KoResourceIndex(const QString &indexFilename);
+    ~KoResourceIndex();
+
+    /**
+     * Fetches the entry of \p filename.
+     *
+     * @return true if the entry exists and the file has not
+     *         been changed since the entry was written
+     */
+    bool lookup(const QString &filename, Entry *entry) const;
+
+    /**
+     * Writes the entry of \p filename. The size and the modification
+     * time are taken from the file itself, the thumbnail is downscaled
+     * to thumbnailSize(). Pass a null \p thumbnail if it is not needed.
+     * If the stored entry is the same, the index is not changed.
+     */
+    void update(const QString &filename, bool valid, const QByteArray &md5,
+                const QString &name, const QImage &thumbnail);
+
+    /**
+     * Writes the index to disk if it has been changed. The entries of the
+     * files that have been neither looked up nor updated since the index
+     * was read are dropped.
+     */
+    bool save();
+
+    /// @return true if save() has anything to write
+    bool isModified() const;
+
+    static int thumbnailSize();
+
+private:
+    struct Private;
+    const QScopedPointer<Private> m_d;
+};
+
+#endif // KORESOURCEINDEX_H
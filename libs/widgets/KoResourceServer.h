@@ -29,8 +29,14 @@
 #include <QString>
 #include <QStringList>
 #include <QList>
+#include <QSet>
+#include <QVector>
+#include <QScopedPointer>
 #include <QFileInfo>
 #include <QDir>
+#include <QtConcurrent>
+
+#include <algorithm>
 
 #include <QTemporaryFile>
 #include <QDomDocument>
@@ -38,6 +44,9 @@
 #include "KoResourceServerPolicies.h"
 #include "KoResourceServerObserver.h"
 #include "KoResourceTagStore.h"
+#include "KoResourceIndex.h"
+
+#include <KisStartupTrace.h>
 #include "KoResourcePaths.h"
 
 
@@ -63,6 +72,7 @@ public:
     KoResourceServerBase(const QString& type, const QString& extensions)
         : m_type(type)
         , m_extensions(extensions)
+        , m_loadInParallel(true)
     {
     }
 
@@ -80,6 +90,14 @@ public:
     */
     QString extensions() const { return m_extensions; }
 
+    /**
+    * Sets whether loadResources() may parse the resource files in
+    * several threads. Disable it for the resource types whose loading
+    * is not thread-safe.
+    */
+    void setLoadInParallel(bool value) { m_loadInParallel = value; }
+    bool loadInParallel() const { return m_loadInParallel; }
+
     QStringList fileNames()
     {
         QStringList extensionList = m_extensions.split(':');
@@ -106,6 +124,7 @@ private:
 protected:
 
     QMutex m_loadLock;
+    bool m_loadInParallel;
 
 };
 
@@ -142,6 +161,7 @@ public:
         m_blackListFile = KoResourcePaths::locateLocal("data", type + ".blacklist");
         m_blackListFileNames = readBlackListFile();
         m_tagStore = new KoResourceTagStore(this);
+        m_index.reset(new KoResourceIndex(KoResourcePaths::locateLocal("data", type + ".index")));
     }
 
     ~KoResourceServer() override
@@ -170,16 +190,28 @@ public:
      * Loads a set of resources and adds them to the resource server.
      * If a filename appears twice the resource will only be added once. Resources that can't
      * be loaded or and invalid aren't added to the server.
+     *
+     * The resources are created in the calling thread, but parsed in
+     * parallel (unless disabled with setLoadInParallel()), and then
+     * added to the server in the order of \p filenames.
+     *
      * @param filenames list of filenames to be loaded
      */
     void loadResources(QStringList filenames) override {
 
-        QStringList uniqueFiles;
+        KisStartupTrace::Scope traceScope(type(), "resources");
 
-        while (!filenames.empty()) {
+        struct LoadJob {
+            QString filename;
+            QString shortFilename;
+            QList<PointerType> resources;
+            QVector<bool> loaded;
+        };
 
-            QString front = filenames.first();
-            filenames.pop_front();
+        QSet<QString> uniqueFiles;
+        QVector<LoadJob> jobs;
+
+        Q_FOREACH (const QString &front, filenames) {
 
             // In the save location, people can use sub-folders... And then they probably want
             // to load both versions! See https://bugs.kde.org/show_bug.cgi?id=321361.
@@ -194,35 +226,59 @@ public:
             // XXX: Don't load resources with the same filename. Actually, we should look inside
             //      the resource to find out whether they are really the same, but for now this
             //      will prevent the same brush etc. showing up twice.
-            if (!uniqueFiles.contains(fname)) {
-                m_loadLock.lock();
-                uniqueFiles.append(fname);
-                QList<PointerType> resources = createResources(front);
-                Q_FOREACH (PointerType resource, resources) {
-                    Q_CHECK_PTR(resource);
-                    if (resource->load() && resource->valid() && !resource->md5().isEmpty()) {
-                        addResourceToMd5Registry(resource);
-
-                        m_resourcesByFilename[resource->shortFilename()] = resource;
-
-                        if (resource->name().isEmpty()) {
-                            resource->setName(fname);
-                        }
-                        if (m_resourcesByName.contains(resource->name())) {
-                            resource->setName(resource->name() + "(" + resource->shortFilename() + ")");
-                        }
-                        m_resourcesByName[resource->name()] = resource;
-                        notifyResourceAdded(resource);
+            if (uniqueFiles.contains(fname)) continue;
+            uniqueFiles.insert(fname);
+
+            LoadJob job;
+            job.filename = front;
+            job.shortFilename = fname;
+            job.resources = createResources(front);
+            jobs.append(job);
+        }
+
+        auto loadJob = [this] (LoadJob &job) {
+            const bool useIndex = job.resources.size() == 1;
+            Q_FOREACH (PointerType resource, job.resources) {
+                Q_CHECK_PTR(resource);
+                job.loaded.append(loadResource(resource, useIndex ? job.filename : QString()));
+            }
+        };
+
+        if (m_loadInParallel) {
+            QtConcurrent::blockingMap(jobs, loadJob);
+        } else {
+            std::for_each(jobs.begin(), jobs.end(), loadJob);
+        }
+
+        Q_FOREACH (const LoadJob &job, jobs) {
+            m_loadLock.lock();
+            for (int i = 0; i < job.resources.size(); i++) {
+                PointerType resource = job.resources[i];
+
+                if (job.loaded[i]) {
+                    addResourceToMd5Registry(resource);
+
+                    m_resourcesByFilename[resource->shortFilename()] = resource;
+
+                    if (resource->name().isEmpty()) {
+                        resource->setName(job.shortFilename);
                     }
-                    else {
-                        warnWidgets << "Loading resource " << front << "failed." << type();
-                        Policy::deleteResource(resource);
+                    if (m_resourcesByName.contains(resource->name())) {
+                        resource->setName(resource->name() + "(" + resource->shortFilename() + ")");
                     }
+                    m_resourcesByName[resource->name()] = resource;
+                    notifyResourceAdded(resource);
+                }
+                else {
+                    warnWidgets << "Loading resource " << job.filename << "failed." << type();
+                    Policy::deleteResource(resource);
                 }
-                m_loadLock.unlock();
             }
+            m_loadLock.unlock();
         }
 
+        m_index->save();
+
         m_resources = sortedResources();
 
         Q_FOREACH (ObserverType* observer, m_observers) {
@@ -715,6 +771,46 @@ protected:
     }
 
 private:
+    /**
+     * Loads a single resource. Called from the loading threads, so
+     * it must not touch the server's own structures. If \p indexFilename
+     * is not empty, the resource is the only one stored in the file, and
+     * its md5 can be taken from (and is written to) the index. Unchanged
+     * resources that support lazy loading are set up from the index
+     * without reading the file.
+     */
+    bool loadResource(PointerType resource, const QString &indexFilename) {
+        KoResourceIndex::Entry entry;
+        const bool isIndexed =
+            !indexFilename.isEmpty() &&
+            m_index->lookup(indexFilename, &entry);
+
+        if (isIndexed && entry.valid && !entry.md5.isEmpty() &&
+            resource->supportsLazyLoading()) {
+
+            resource->setLazyLoaded(entry.name, entry.md5, entry.thumbnail());
+            return true;
+        }
+
+        bool result = resource->load() && resource->valid();
+
+        if (result && isIndexed && !entry.md5.isEmpty()) {
+            resource->setMD5(entry.md5);
+        }
+
+        result = result && !resource->md5().isEmpty();
+
+        // a fresh entry stays as it is, the file has not changed
+        if (!indexFilename.isEmpty() && !(isIndexed && entry.valid == result)) {
+            m_index->update(indexFilename, result,
+                            result ? resource->md5() : QByteArray(),
+                            resource->name(),
+                            resource->supportsLazyLoading() ? resource->image() : QImage());
+        }
+
+        return result;
+    }
+
     void addResourceToMd5Registry(PointerType resource) {
         const QByteArray md5 = resource->md5();
         if (!md5.isEmpty()) {
@@ -740,6 +836,7 @@ private:
     QList<ObserverType*> m_observers;
     QString m_blackListFile;
     KoResourceTagStore* m_tagStore;
+    QScopedPointer<KoResourceIndex> m_index;
 
 };
 
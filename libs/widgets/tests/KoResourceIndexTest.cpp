@@ -0,0 +1,152 @@
+/*
+ *  Copyright (c) 2020 Krita developers
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include "KoResourceIndexTest.h"
+
+#include <QTest>
+#include <QFile>
+#include <QTemporaryDir>
+
+#include "KoResourceIndex.h"
+
+namespace {
+void writeFile(const QString &filename, const QByteArray &data)
+{
+    QFile file(filename);
+    QVERIFY(file.open(QIODevice::WriteOnly));
+    file.write(data);
+}
+}
+
+void KoResourceIndexTest::testLookup()
+{
+    QTemporaryDir dir;
+    const QString indexFilename = dir.filePath("test.index");
+    const QString resourceFilename = dir.filePath("resource.kpp");
+
+    writeFile(resourceFilename, "resource data");
+
+    QImage thumbnail(512, 256, QImage::Format_ARGB32);
+    thumbnail.fill(Qt::red);
+
+    {
+        KoResourceIndex index(indexFilename);
+        KoResourceIndex::Entry entry;
+        QVERIFY(!index.lookup(resourceFilename, &entry));
+
+        index.update(resourceFilename, true, "md5sum", "Resource", thumbnail);
+        QVERIFY(index.save());
+    }
+
+    KoResourceIndex index(indexFilename);
+    KoResourceIndex::Entry entry;
+    QVERIFY(index.lookup(resourceFilename, &entry));
+    QVERIFY(entry.valid);
+    QCOMPARE(entry.md5, QByteArray("md5sum"));
+    QCOMPARE(entry.name, QString("Resource"));
+    QCOMPARE(entry.thumbnail().size(), QSize(KoResourceIndex::thumbnailSize(), KoResourceIndex::thumbnailSize() / 2));
+}
+
+void KoResourceIndexTest::testChangedFile()
+{
+    QTemporaryDir dir;
+    const QString indexFilename = dir.filePath("test.index");
+    const QString resourceFilename = dir.filePath("resource.kpp");
+
+    writeFile(resourceFilename, "resource data");
+
+    {
+        KoResourceIndex index(indexFilename);
+        index.update(resourceFilename, true, "md5sum", "Resource", QImage());
+        QVERIFY(index.save());
+    }
+
+    writeFile(resourceFilename, "changed resource data");
+
+    KoResourceIndex index(indexFilename);
+    KoResourceIndex::Entry entry;
+    QVERIFY(!index.lookup(resourceFilename, &entry));
+}
+
+void KoResourceIndexTest::testDropUnusedEntries()
+{
+    QTemporaryDir dir;
+    const QString indexFilename = dir.filePath("test.index");
+    const QString resource1 = dir.filePath("resource1.kpp");
+    const QString resource2 = dir.filePath("resource2.kpp");
+
+    writeFile(resource1, "resource 1");
+    writeFile(resource2, "resource 2");
+
+    {
+        KoResourceIndex index(indexFilename);
+        index.update(resource1, true, "md5sum1", "Resource 1", QImage());
+        index.update(resource2, true, "md5sum2", "Resource 2", QImage());
+        QVERIFY(index.save());
+    }
+
+    {
+        // resource2 has been removed from the server
+        KoResourceIndex index(indexFilename);
+        KoResourceIndex::Entry entry;
+        QVERIFY(index.lookup(resource1, &entry));
+        QVERIFY(index.save());
+    }
+
+    KoResourceIndex index(indexFilename);
+    KoResourceIndex::Entry entry;
+    QVERIFY(index.lookup(resource1, &entry));
+    QVERIFY(!index.lookup(resource2, &entry));
+}
+
+void KoResourceIndexTest::testUnchangedEntry()
+{
+    QTemporaryDir dir;
+    const QString indexFilename = dir.filePath("test.index");
+    const QString resourceFilename = dir.filePath("resource.kpp");
+
+    writeFile(resourceFilename, "resource data");
+
+    {
+        KoResourceIndex index(indexFilename);
+        QVERIFY(!index.isModified());
+
+        index.update(resourceFilename, true, "md5sum", "Resource", QImage());
+        QVERIFY(index.isModified());
+        QVERIFY(index.save());
+        QVERIFY(!index.isModified());
+
+        // the same data doesn't make the index dirty
+        index.update(resourceFilename, true, "md5sum", "Resource", QImage());
+        QVERIFY(!index.isModified());
+    }
+
+    KoResourceIndex index(indexFilename);
+    KoResourceIndex::Entry entry;
+    QVERIFY(index.lookup(resourceFilename, &entry));
+    QVERIFY(entry.thumbnailData.isEmpty());
+    QVERIFY(entry.thumbnail().isNull());
+
+    index.update(resourceFilename, true, "md5sum", "Resource", QImage());
+    QVERIFY(!index.isModified());
+
+    index.update(resourceFilename, true, "md5sum", "Renamed Resource", QImage());
+    QVERIFY(index.isModified());
+}
+
+QTEST_GUILESS_MAIN(KoResourceIndexTest)
@@ -34,9 +34,8 @@
 #include <KoID.h>
 #include <kis_hsv_adjustment.h>
 
+#include "kis_rgb_batch.h"
 
-#define SCALE_TO_FLOAT( v ) KoColorSpaceMaths< _channel_type_, float>::scaleToA( v )
-#define SCALE_FROM_FLOAT( v  ) KoColorSpaceMaths< float, _channel_type_>::scaleToA( v )
 
 class KisColorBalanceMath;
 template<typename _channel_type_, typename traits>
@@ -51,37 +50,39 @@ public:
 void transform(const quint8 *srcU8, quint8 *dstU8, qint32 nPixels) const override
 {
     KisColorBalanceMath bal;
-    const RGBPixel* src = reinterpret_cast<const RGBPixel*>(srcU8);
-    RGBPixel* dst = reinterpret_cast<RGBPixel*>(dstU8);
-    float value_red, value_green, value_blue, hue, saturation, lightness;
-
-    while(nPixels > 0) {
-
-        float red = SCALE_TO_FLOAT(src->red);
-        float green = SCALE_TO_FLOAT(src->green);
-        float blue = SCALE_TO_FLOAT(src->blue);
-        RGBToHSL(red, green, blue, &hue, &saturation, &lightness);
-
-        value_red = bal.colorBalanceTransform(red, lightness, m_cyan_shadows, m_cyan_midtones, m_cyan_highlights);
-        value_green = bal.colorBalanceTransform(green, lightness, m_magenta_shadows, m_magenta_midtones, m_magenta_highlights);
-        value_blue = bal.colorBalanceTransform(blue, lightness, m_yellow_shadows, m_yellow_midtones, m_yellow_highlights);
-
-        if(m_preserve_luminosity)
-        {
-            float h1, s1, l1, h2, s2, l2;
-            RGBToHSL(SCALE_TO_FLOAT(src->red), SCALE_TO_FLOAT(src->green), SCALE_TO_FLOAT(src->blue), &h1, &s1, &l1);
-            RGBToHSL(value_red, value_green, value_blue, &h2, &s2, &l2);
-            HSLToRGB(h2, s2, l1, &value_red, &value_green, &value_blue);
-        }
-        dst->red = SCALE_FROM_FLOAT(value_red);
-        dst->green = SCALE_FROM_FLOAT(value_green);
-        dst->blue = SCALE_FROM_FLOAT(value_blue);
-        dst->alpha = src->alpha;
-
-        --nPixels;
-        ++src;
-        ++dst;
-    }
+
+    const float cyan_shadows = m_cyan_shadows;
+    const float cyan_midtones = m_cyan_midtones;
+    const float cyan_highlights = m_cyan_highlights;
+    const float magenta_shadows = m_magenta_shadows;
+    const float magenta_midtones = m_magenta_midtones;
+    const float magenta_highlights = m_magenta_highlights;
+    const float yellow_shadows = m_yellow_shadows;
+    const float yellow_midtones = m_yellow_midtones;
+    const float yellow_highlights = m_yellow_highlights;
+    const bool preserve_luminosity = m_preserve_luminosity;
+
+    KisRgbBatch::processPixels<_channel_type_, traits>(srcU8, dstU8, nPixels,
+        [=] (float &red, float &green, float &blue) mutable {
+            float hue, saturation, lightness;
+            RGBToHSL(red, green, blue, &hue, &saturation, &lightness);
+
+            float value_red = bal.colorBalanceTransform(red, lightness, cyan_shadows, cyan_midtones, cyan_highlights);
+            float value_green = bal.colorBalanceTransform(green, lightness, magenta_shadows, magenta_midtones, magenta_highlights);
+            float value_blue = bal.colorBalanceTransform(blue, lightness, yellow_shadows, yellow_midtones, yellow_highlights);
+
+            if(preserve_luminosity)
+            {
+                // the lightness of the source pixel has already been calculated above
+                float h2, s2, l2;
+                RGBToHSL(value_red, value_green, value_blue, &h2, &s2, &l2);
+                HSLToRGB(h2, s2, lightness, &value_red, &value_green, &value_blue);
+            }
+
+            red = value_red;
+            green = value_green;
+            blue = value_blue;
+        });
 }
 
 
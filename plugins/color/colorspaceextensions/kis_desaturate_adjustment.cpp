@@ -31,8 +31,7 @@
 #include <KoColorTransformation.h>
 #include <KoID.h>
 
-#define SCALE_TO_FLOAT( v ) KoColorSpaceMaths< _channel_type_, float>::scaleToA( v )
-#define SCALE_FROM_FLOAT( v  ) KoColorSpaceMaths< float, _channel_type_>::scaleToA( v )
+#include "kis_rgb_batch.h"
 
 template<typename _channel_type_,typename traits>
 class KisDesaturateAdjustment : public KoColorTransformation
@@ -49,62 +48,49 @@ public:
 
     void transform(const quint8 *srcU8, quint8 *dstU8, qint32 nPixels) const override
     {
-        const RGBPixel* src = reinterpret_cast<const RGBPixel*>(srcU8);
-        RGBPixel* dst = reinterpret_cast<RGBPixel*>(dstU8);
-        float r, g, b, gray;
-        while (nPixels > 0) {
-
-            r = SCALE_TO_FLOAT(src->red);
-            g = SCALE_TO_FLOAT(src->green);
-            b = SCALE_TO_FLOAT(src->blue);
-
-            // http://www.tannerhelland.com/3643/grayscale-image-algorithm-vb6/
-            switch(m_type) {
-            case 0: // lightness
-            {
-                gray = (qMax(qMax(r, g), b) + qMin(qMin(r, g), b)) / 2;
-                break;
-            }
-            case 1: // luminosity BT 709
-            {
-                gray = r * 0.2126 + g * 0.7152 + b * 0.0722;
-                break;
-
-            }
-
-            case 2: // luminosity BT 601
-            {
-                gray = r * 0.299 + g * 0.587 + b * 0.114;
-                break;
-
-            }
-            case 3: // average
-            {
-                gray = (r + g + b) / 3;
-                break;
-            }
-            case 4: // min
-            {
-                gray = qMin(qMin(r, g), b);
-                break;
-            }
-            case 5: // min
-            {
-                gray = qMax(qMax(r, g), b);
-                break;
-            }
-
-            default:
-                gray = 0;
-            }
-            dst->red = SCALE_FROM_FLOAT(gray);
-            dst->green = SCALE_FROM_FLOAT(gray);
-            dst->blue = SCALE_FROM_FLOAT(gray);
-            dst->alpha = src->alpha;
-
-            --nPixels;
-            ++src;
-            ++dst;
+        // http://www.tannerhelland.com/3643/grayscale-image-algorithm-vb6/
+        switch(m_type) {
+        case 0: // lightness
+            processPixels(srcU8, dstU8, nPixels,
+                [] (float r, float g, float b) {
+                    return (qMax(qMax(r, g), b) + qMin(qMin(r, g), b)) / 2;
+                });
+            break;
+        case 1: // luminosity BT 709
+            processPixels(srcU8, dstU8, nPixels,
+                [] (float r, float g, float b) -> float {
+                    return r * 0.2126 + g * 0.7152 + b * 0.0722;
+                });
+            break;
+        case 2: // luminosity BT 601
+            processPixels(srcU8, dstU8, nPixels,
+                [] (float r, float g, float b) -> float {
+                    return r * 0.299 + g * 0.587 + b * 0.114;
+                });
+            break;
+        case 3: // average
+            processPixels(srcU8, dstU8, nPixels,
+                [] (float r, float g, float b) {
+                    return (r + g + b) / 3;
+                });
+            break;
+        case 4: // min
+            processPixels(srcU8, dstU8, nPixels,
+                [] (float r, float g, float b) {
+                    return qMin(qMin(r, g), b);
+                });
+            break;
+        case 5: // max
+            processPixels(srcU8, dstU8, nPixels,
+                [] (float r, float g, float b) {
+                    return qMax(qMax(r, g), b);
+                });
+            break;
+        default:
+            processPixels(srcU8, dstU8, nPixels,
+                [] (float, float, float) {
+                    return 0.0f;
+                });
         }
     }
 
@@ -141,6 +127,17 @@ public:
         }
     }
 
+private:
+
+    template<class GrayFunc>
+    void processPixels(const quint8 *srcU8, quint8 *dstU8, qint32 nPixels, GrayFunc grayFunc) const
+    {
+        KisRgbBatch::processPixels<_channel_type_, traits>(srcU8, dstU8, nPixels,
+            [grayFunc] (float &r, float &g, float &b) {
+                r = g = b = grayFunc(r, g, b);
+            });
+    }
+
 private:
 
     int m_type;
@@ -35,6 +35,8 @@
 #include <KoColorTransformation.h>
 #include <KoID.h>
 
+#include "kis_rgb_batch.h"
+
 #define SCALE_TO_FLOAT( v ) KoColorSpaceMaths< _channel_type_, float>::scaleToA( v )
 #define SCALE_FROM_FLOAT( v  ) KoColorSpaceMaths< float, _channel_type_>::scaleToA( v )
 
@@ -101,16 +103,9 @@ public:
 
     void transform(const quint8 *srcU8, quint8 *dstU8, qint32 nPixels) const override
     {
-
         //if (m_model="RGBA" || m_colorize) {
         /*It'd be nice to have LCH automatically selector for LAB in the future, but I don't know how to select LAB
          * */
-            const RGBPixel* src = reinterpret_cast<const RGBPixel*>(srcU8);
-            RGBPixel* dst = reinterpret_cast<RGBPixel*>(dstU8);
-            float h, s, v;
-            float r = 0.0;
-            float g = 0.0;
-            float b = 0.0;
             qreal lumaR, lumaG, lumaB;
             //Default to rec 709 when there's no coefficients given//
             if (m_lumaRed<=0 || m_lumaGreen<=0 || m_lumaBlue<=0) {
@@ -122,101 +117,131 @@ public:
                 lumaG   = m_lumaGreen;
                 lumaB   = m_lumaBlue;
             }
-            while (nPixels > 0) {
-
-                if (m_colorize) {
-                    h = m_adj_h * 360;
-                    if (h >= 360.0) h = 0;
-
-                    s = m_adj_s;
-
-                    r = SCALE_TO_FLOAT(src->red);
-                    g = SCALE_TO_FLOAT(src->green);
-                    b = SCALE_TO_FLOAT(src->blue);
 
-                    float luminance = r * lumaR + g * lumaG + b * lumaB;
+            const double adj_h = m_adj_h;
+            const double adj_s = m_adj_s;
+            const double adj_v = m_adj_v;
+
+            /**
+             * The type of the adjustment is selected once per run, so that
+             * the per-pixel code is inlined into a loop without any branching
+             * on the parameters
+             */
+            if (m_colorize) {
+                float h = adj_h * 360;
+                if (h >= 360.0) h = 0;
+
+                const float s = adj_s;
+
+                KisRgbBatch::processPixels<_channel_type_, traits>(srcU8, dstU8, nPixels,
+                    [=] (float &r, float &g, float &b) {
+                        float luminance = r * lumaR + g * lumaG + b * lumaB;
+
+                        if (adj_v > 0) {
+                            luminance *= (1.0 - adj_v);
+                            luminance += 1.0 - (1.0 - adj_v);
+                        }
+                        else if (adj_v < 0 ){
+                            luminance *= (adj_v + 1.0);
+                        }
+                        const float v = luminance;
+                        HSLToRGB(h, s, v, &r, &g, &b);
 
-                    if (m_adj_v > 0) {
-                        luminance *= (1.0 - m_adj_v);
-                        luminance += 1.0 - (1.0 - m_adj_v);
-                    }
-                    else if (m_adj_v < 0 ){
-                        luminance *= (m_adj_v + 1.0);
-                    }
-                    v = luminance;
-                    HSLToRGB(h, s, v, &r, &g, &b);
+                        clamp< _channel_type_ >(&r, &g, &b);
+                    });
 
-                } else {
+            } else if (m_type == 0) {
 
-                    if (m_type == 0) {
-                        RGBToHSV(SCALE_TO_FLOAT(src->red), SCALE_TO_FLOAT(src->green), SCALE_TO_FLOAT(src->blue), &h, &s, &v);
-                        h += m_adj_h * 180;
+                KisRgbBatch::processPixels<_channel_type_, traits>(srcU8, dstU8, nPixels,
+                    [=] (float &r, float &g, float &b) {
+                        float h, s, v;
+                        RGBToHSV(r, g, b, &h, &s, &v);
+                        h += adj_h * 180;
                         if (h > 360) h -= 360;
                         if (h < 0) h += 360;
-                        s += m_adj_s;
-                        v += m_adj_v;
+                        s += adj_s;
+                        v += adj_v;
                         HSVToRGB(h, s, v, &r, &g, &b);
-                    } else if (m_type == 1) {
 
-                        RGBToHSL(SCALE_TO_FLOAT(src->red), SCALE_TO_FLOAT(src->green), SCALE_TO_FLOAT(src->blue), &h, &s, &v);
+                        clamp< _channel_type_ >(&r, &g, &b);
+                    });
+
+            } else if (m_type == 1) {
 
-                        h += m_adj_h * 180;
+                KisRgbBatch::processPixels<_channel_type_, traits>(srcU8, dstU8, nPixels,
+                    [=] (float &r, float &g, float &b) {
+                        float h, s, v;
+                        RGBToHSL(r, g, b, &h, &s, &v);
+
+                        h += adj_h * 180;
                         if (h > 360) h -= 360;
                         if (h < 0) h += 360;
 
-                        s *= (m_adj_s + 1.0);
+                        s *= (adj_s + 1.0);
                         if (s < 0.0) s = 0.0;
                         if (s > 1.0) s = 1.0;
 
-                        if (m_adj_v < 0)
-                            v *= (m_adj_v + 1.0);
+                        if (adj_v < 0)
+                            v *= (adj_v + 1.0);
                         else
-                            v += (m_adj_v * (1.0 - v));
+                            v += (adj_v * (1.0 - v));
 
 
                         HSLToRGB(h, s, v, &r, &g, &b);
-                    } else if (m_type == 2) {
 
-                        qreal red = SCALE_TO_FLOAT(src->red);
-                        qreal green = SCALE_TO_FLOAT(src->green);
-                        qreal blue = SCALE_TO_FLOAT(src->blue);
+                        clamp< _channel_type_ >(&r, &g, &b);
+                    });
+
+            } else if (m_type == 2) {
+
+                KisRgbBatch::processPixels<_channel_type_, traits>(srcU8, dstU8, nPixels,
+                    [=] (float &r, float &g, float &b) {
+                        qreal red = r;
+                        qreal green = g;
+                        qreal blue = b;
                         qreal hue, sat, intensity;
                         RGBToHCI(red, green, blue, &hue, &sat, &intensity);
 
                         hue *=360.0;
-                        hue += m_adj_h * 180;
+                        hue += adj_h * 180;
                         //if (intensity+m_adj_v>1.0){hue+=180.0;}
                         if (hue < 0) hue += 360;
                         hue = fmod(hue, 360.0);
 
-                        sat *= (m_adj_s + 1.0);
+                        sat *= (adj_s + 1.0);
                         //sat = qBound(0.0, sat, 1.0);
 
-                        intensity += (m_adj_v);
+                        intensity += (adj_v);
 
                         HCIToRGB(hue/360.0, sat, intensity, &red, &green, &blue);
 
                         r = red;
                         g = green;
                         b = blue;
-                    } else if (m_type == 3) {
 
-                        qreal red = SCALE_TO_FLOAT(src->red);
-                        qreal green = SCALE_TO_FLOAT(src->green);
-                        qreal blue = SCALE_TO_FLOAT(src->blue);
+                        clamp< _channel_type_ >(&r, &g, &b);
+                    });
+
+            } else if (m_type == 3) {
+
+                KisRgbBatch::processPixels<_channel_type_, traits>(srcU8, dstU8, nPixels,
+                    [=] (float &r, float &g, float &b) {
+                        qreal red = r;
+                        qreal green = g;
+                        qreal blue = b;
                         qreal hue, sat, luma;
                         RGBToHCY(red, green, blue, &hue, &sat, &luma, lumaR, lumaG, lumaB);
 
                         hue *=360.0;
-                        hue += m_adj_h * 180;
+                        hue += adj_h * 180;
                         //if (luma+m_adj_v>1.0){hue+=180.0;}
                         if (hue < 0) hue += 360;
                         hue = fmod(hue, 360.0);
 
-                        sat *= (m_adj_s + 1.0);
+                        sat *= (adj_s + 1.0);
                         //sat = qBound(0.0, sat, 1.0);
 
-                        luma += m_adj_v;
+                        luma += adj_v;
 
 
                         HCYToRGB(hue/360.0, sat, luma, &red, &green, &blue, lumaR, lumaG, lumaB);
@@ -224,41 +249,43 @@ public:
                         g = green;
                         b = blue;
 
-                    } else if (m_type == 4) {
+                        clamp< _channel_type_ >(&r, &g, &b);
+                    });
 
-                        qreal red = SCALE_TO_FLOAT(src->red);
-                        qreal green = SCALE_TO_FLOAT(src->green);
-                        qreal blue = SCALE_TO_FLOAT(src->blue);
+            } else if (m_type == 4) {
+
+                KisRgbBatch::processPixels<_channel_type_, traits>(srcU8, dstU8, nPixels,
+                    [=] (float &r, float &g, float &b) {
+                        qreal red = r;
+                        qreal green = g;
+                        qreal blue = b;
                         qreal y, cb, cr;
                         RGBToYUV(red, green, blue, &y, &cb, &cr, lumaR, lumaG, lumaB);
 
-                        cb *= (m_adj_h + 1.0);
+                        cb *= (adj_h + 1.0);
                         //cb = qBound(0.0, cb, 1.0);
 
-                        cr *= (m_adj_s + 1.0);
+                        cr *= (adj_s + 1.0);
                         //cr = qBound(0.0, cr, 1.0);
 
-                        y += (m_adj_v);
+                        y += (adj_v);
 
 
                         YUVToRGB(y, cb, cr, &red, &green, &blue, lumaR, lumaG, lumaB);
                         r = red;
                         g = green;
                         b = blue;
-                    } else {
-                        Q_ASSERT_X(false, "", "invalid type");
-                    }
-                }
 
-                clamp< _channel_type_ >(&r, &g, &b);
-                dst->red = SCALE_FROM_FLOAT(r);
-                dst->green = SCALE_FROM_FLOAT(g);
-                dst->blue = SCALE_FROM_FLOAT(b);
-                dst->alpha = src->alpha;
+                        clamp< _channel_type_ >(&r, &g, &b);
+                    });
 
-                --nPixels;
-                ++src;
-                ++dst;
+            } else {
+                Q_ASSERT_X(false, "", "invalid type");
+
+                KisRgbBatch::processPixels<_channel_type_, traits>(srcU8, dstU8, nPixels,
+                    [] (float &r, float &g, float &b) {
+                        r = g = b = 0.0;
+                    });
             }
         /*} else if (m_model="LABA"){
             const LABPixel* src = reinterpret_cast<const LABPixel*>(srcU8);
@@ -0,0 +1,70 @@
+/*
+ *  Copyright (c) 2020 Krita developers
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+*/
+
+#ifndef _KIS_RGB_BATCH_H_
+#define _KIS_RGB_BATCH_H_
+
+#include <QtGlobal>
+
+#include <KoColorSpaceMaths.h>
+
+/**
+ * The adjustments of this plugin work on the float values of the RGB
+ * channels. processPixels() runs the (inlined) per-pixel function over
+ * a run of pixels in a single loop, so the adjustment selects its
+ * variant once per run instead of branching on the parameters for
+ * every pixel. The simple functions, like the ones of the desaturate
+ * adjustment, leave the loop free of branches, so the compiler can
+ * vectorize it.
+ *
+ * Unpacking the run into planar float arrays first does not pay off:
+ * the conversion of the channels is cheap, and the extra pass over
+ * the arrays costs more than it saves.
+ *
+ * The alpha channel is copied from the source pixel unchanged. The
+ * source and the destination may be the same buffer.
+ */
+namespace KisRgbBatch {
+
+template<typename _channel_type_, typename traits, class PixelFunc>
+inline void processPixels(const quint8 *srcU8, quint8 *dstU8, qint32 nPixels, PixelFunc func)
+{
+    typedef typename traits::Pixel RGBPixel;
+
+    const RGBPixel* src = reinterpret_cast<const RGBPixel*>(srcU8);
+    RGBPixel* dst = reinterpret_cast<RGBPixel*>(dstU8);
+
+    for (qint32 i = 0; i < nPixels; i++) {
+        float red = KoColorSpaceMaths<_channel_type_, float>::scaleToA(src[i].red);
+        float green = KoColorSpaceMaths<_channel_type_, float>::scaleToA(src[i].green);
+        float blue = KoColorSpaceMaths<_channel_type_, float>::scaleToA(src[i].blue);
+
+        func(red, green, blue);
+
+        const _channel_type_ alpha = src[i].alpha;
+        dst[i].red = KoColorSpaceMaths<float, _channel_type_>::scaleToA(red);
+        dst[i].green = KoColorSpaceMaths<float, _channel_type_>::scaleToA(green);
+        dst[i].blue = KoColorSpaceMaths<float, _channel_type_>::scaleToA(blue);
+        dst[i].alpha = alpha;
+    }
+}
+
+}
+
+#endif /* _KIS_RGB_BATCH_H_ */
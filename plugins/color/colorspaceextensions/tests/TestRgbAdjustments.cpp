@@ -0,0 +1,758 @@
+/*
+ *  Copyright (c) 2020 Krita developers
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include "TestRgbAdjustments.h"
+
+#include <QTest>
+
+#include <KoConfig.h>
+
+#include <KoColorModelStandardIds.h>
+#include <KoColorSpaceMaths.h>
+#include <KoColorSpaceRegistry.h>
+#include <KoColorSpaceTraits.h>
+#include <KoColorTransformation.h>
+#include <sdk/tests/kistest.h>
+
+#include "kis_color_balance_adjustment.h"
+#include "kis_desaturate_adjustment.h"
+#include "kis_hsv_adjustment.h"
+
+namespace {
+
+const int numPixels = 8;
+
+/// the source pixels in normalized RGBA
+const float sourcePixels[numPixels][4] = {
+    {0.0f, 0.0f, 0.0f, 1.0f},
+    {1.0f, 1.0f, 1.0f, 1.0f},
+    {0.5f, 0.5f, 0.5f, 0.5f},
+    {0.8f, 0.2f, 0.1f, 1.0f},
+    {0.1f, 0.6f, 0.3f, 0.25f},
+    {0.25f, 0.4f, 0.9f, 1.0f},
+    {0.95f, 0.85f, 0.05f, 0.75f},
+    {0.3f, 0.05f, 0.55f, 0.0f}
+};
+
+const int numDepths = 4;
+
+KoID colorDepth(int index)
+{
+    const KoID depths[numDepths] = {
+        Integer8BitsColorDepthID,
+        Integer16BitsColorDepthID,
+        Float16BitsColorDepthID,
+        Float32BitsColorDepthID
+    };
+
+    return depths[index];
+}
+
+struct AdjustmentCase {
+    QString name;
+    QString transformationId;
+    QVariantHash parameters;
+};
+
+QVariantHash hsvParameters(qreal h, qreal s, qreal v, int type, bool colorize)
+{
+    QVariantHash parameters;
+    parameters["h"] = h;
+    parameters["s"] = s;
+    parameters["v"] = v;
+    parameters["type"] = type;
+    parameters["colorize"] = colorize;
+    return parameters;
+}
+
+QVariantHash colorBalanceParameters(bool preserveLuminosity)
+{
+    QVariantHash parameters;
+    parameters["cyan_red_midtones"] = 0.2;
+    parameters["magenta_green_midtones"] = -0.1;
+    parameters["yellow_blue_midtones"] = 0.3;
+    parameters["cyan_red_shadows"] = -0.4;
+    parameters["magenta_green_shadows"] = 0.2;
+    parameters["yellow_blue_shadows"] = 0.1;
+    parameters["cyan_red_highlights"] = 0.3;
+    parameters["magenta_green_highlights"] = 0.1;
+    parameters["yellow_blue_highlights"] = -0.2;
+    parameters["preserve_luminosity"] = preserveLuminosity;
+    return parameters;
+}
+
+/**
+ * The cases in the order of referenceValues
+ */
+QList<AdjustmentCase> adjustmentCases()
+{
+    QList<AdjustmentCase> cases;
+
+    cases << AdjustmentCase{"hsv", "hsv_adjustment", hsvParameters(0.25, 0.3, -0.1, 0, false)};
+    cases << AdjustmentCase{"hsl", "hsv_adjustment", hsvParameters(0.25, 0.3, -0.1, 1, false)};
+    cases << AdjustmentCase{"hci", "hsv_adjustment", hsvParameters(0.25, 0.3, -0.1, 2, false)};
+    cases << AdjustmentCase{"hcy", "hsv_adjustment", hsvParameters(0.25, 0.3, -0.1, 3, false)};
+    cases << AdjustmentCase{"yuv", "hsv_adjustment", hsvParameters(0.2, -0.3, 0.05, 4, false)};
+    cases << AdjustmentCase{"colorize", "hsv_adjustment", hsvParameters(0.6, 0.5, 0.2, 0, true)};
+
+    for (int type = 0; type < 6; type++) {
+        QVariantHash parameters;
+        parameters["type"] = type;
+        cases << AdjustmentCase{QString("desaturate%1").arg(type), "desaturate_adjustment", parameters};
+    }
+
+    cases << AdjustmentCase{"balance", "ColorBalance", colorBalanceParameters(false)};
+    cases << AdjustmentCase{"balance-luma", "ColorBalance", colorBalanceParameters(true)};
+
+    return cases;
+}
+
+/**
+ * The channel values of the adjusted sourcePixels (red, green, blue,
+ * alpha) for every case and every depth, as calculated by the
+ * per-pixel implementation of the adjustments that preceded the
+ * batched one
+ */
+const double referenceValues[][numDepths][numPixels * 4] = {
+    // hsv
+    {
+        { // U8
+            0, 0, 0, 255, 230, 211, 161, 255,
+            103, 94, 72, 128, 178, 156, 0, 255,
+            0, 107, 128, 64, 104, 0, 204, 255,
+            44, 216, 0, 191, 115, 0, 80, 0,
+        },
+        { // U16
+            0, 0, 0, 65535, 58982, 54263, 41287, 65535,
+            26214, 24117, 18350, 32768, 45874, 40099, 0, 65535,
+            0, 27198, 32768, 16384, 26663, 0, 52428, 65535,
+            11312, 55704, 0, 49151, 29491, 0, 20577, 0,
+        },
+        { // F16
+            -0.0999755859, -0.0919799805, -0.0700073242, 1, 0.899902344, 0.828125, 0.629882812, 1,
+            0.399902344, 0.367919922, 0.280029297, 0.5, 0.699707031, 0.611816406, -0.122436523, 1,
+            -0.0667114258, 0.415039062, 0.5, 0.25, 0.406982422, -0.0177459717, 0.799804688, 1,
+            0.172729492, 0.850097656, -0.210327148, 0.75, 0.449707031, -0.0940551758, 0.313720703, 0,
+        },
+        { // F32
+            -0.100000001, -0.0920000002, -0.0700000003, 1, 0.899999976, 0.828000009, 0.629999995, 1,
+            0.400000006, 0.368000001, 0.280000001, 0.5, 0.699999988, 0.611875057, -0.122499965, 1,
+            -0.0666666627, 0.414999962, 0.5, 0.25, 0.406838059, -0.0177777279, 0.799999952, 1,
+            0.172609627, 0.849999964, -0.210263073, 0.75, 0.450000018, -0.094090879, 0.313977301, 0,
+        },
+    },
+    // hsl
+    {
+        { // U8
+            0, 0, 0, 255, 230, 230, 230, 255,
+            115, 115, 115, 128, 207, 184, 0, 255,
+            6, 133, 155, 64, 137, 10, 255, 255,
+            82, 230, 0, 191, 138, 0, 104, 0,
+        },
+        { // U16
+            0, 0, 0, 65535, 58982, 58982, 58982, 65535,
+            29491, 29491, 29491, 32768, 53084, 47396, 0, 65535,
+            1475, 34063, 39812, 16384, 35124, 2480, 65350, 65535,
+            21298, 58982, 0, 49151, 35389, 0, 26542, 0,
+        },
+        { // F16
+            0, 0, 0, 1, 0.899902344, 0.899902344, 0.899902344, 1,
+            0.449951172, 0.449951172, 0.449951172, 0.5, 0.809570312, 0.723144531, 0, 1,
+            0.0224609375, 0.520019531, 0.607421875, 0.25, 0.536132812, 0.0378723145, 0.997070312, 1,
+            0.325195312, 0.900390625, 0, 0.75, 0.540039062, 0, 0.404785156, 0,
+        },
+        { // F32
+            0, 0, 0, 1, 0.899999976, 0.899999976, 0.899999976, 1,
+            0.449999988, 0.449999988, 0.449999988, 0.5, 0.810000062, 0.723214328, 0, 1,
+            0.0225000381, 0.519749939, 0.607500017, 0.25, 0.535949051, 0.037838161, 0.997161806, 1,
+            0.324999928, 0.899999976, 0, 0.75, 0.540000021, 0, 0.405000031, 0,
+        },
+    },
+    // hci
+    {
+        { // U8
+            0, 0, 0, 255, 230, 230, 230, 255,
+            103, 103, 103, 128, 157, 131, 0, 255,
+            0, 114, 147, 64, 109, 20, 191, 255,
+            103, 255, 0, 191, 165, 0, 97, 0,
+        },
+        { // U16
+            0, 0, 0, 65535, 58982, 58982, 58982, 65535,
+            26214, 26214, 26214, 32768, 40342, 33703, 0, 65535,
+            0, 29207, 38151, 16384, 27870, 5039, 49010, 65535,
+            26611, 65535, 0, 49151, 42688, 0, 24940, 0,
+        },
+        { // F16
+            0, 0, 0, 1, 0.899902344, 0.899902344, 0.899902344, 1,
+            0.399902344, 0.399902344, 0.399902344, 0.5, 0.615722656, 0.514160156, -0.330078125, 1,
+            -0.327880859, 0.445800781, 0.582519531, 0.25, 0.425292969, 0.0768432617, 0.747558594, 1,
+            0.40625, 1.16894531, -0.0252838135, 0.75, 0.651367188, -0.431884766, 0.380371094, 0,
+        },
+        { // F32
+            0, 0, 0, 1, 0.899999976, 0.899999976, 0.899999976, 1,
+            0.400000006, 0.400000006, 0.400000006, 0.5, 0.615584433, 0.514285743, -0.329870135, 1,
+            -0.327833325, 0.445666671, 0.582166672, 0.25, 0.425268799, 0.0768817216, 0.747849464, 1,
+            0.406056017, 1.16926932, -0.0253253058, 0.75, 0.651388884, -0.43194443, 0.38055557, 0,
+        },
+    },
+    // hcy
+    {
+        { // U8
+            0, 0, 0, 255, 230, 230, 230, 255,
+            103, 103, 103, 128, 91, 66, 0, 255,
+            0, 123, 147, 64, 151, 38, 254, 255,
+            53, 244, 0, 191, 131, 0, 90, 0,
+        },
+        { // U16
+            0, 0, 0, 65535, 58982, 58982, 58982, 65535,
+            26214, 26214, 26214, 32768, 23316, 16926, 0, 65535,
+            0, 31618, 38007, 16384, 38579, 9825, 65203, 65535,
+            13723, 62710, 0, 49151, 33807, 0, 23158, 0,
+        },
+        { // F16
+            -0.0999755859, -0.0999755859, -0.0999755859, 1, 0.899902344, 0.899902344, 0.899902344, 1,
+            0.399902344, 0.399902344, 0.399902344, 0.5, 0.355712891, 0.258300781, -0.554199219, 1,
+            -0.0700683594, 0.482666016, 0.580078125, 0.25, 0.588867188, 0.149902344, 0.994628906, 1,
+            0.209472656, 0.95703125, -0.213256836, 0.75, 0.515625, -0.134033203, 0.353027344, 0,
+        },
+        { // F32
+            -0.100000001, -0.100000001, -0.100000001, 1, 0.899999976, 0.899999976, 0.899999976, 1,
+            0.400000006, 0.400000006, 0.400000006, 0.5, 0.355774015, 0.258274019, -0.554225981, 1,
+            -0.0700379983, 0.482462019, 0.579962015, 0.25, 0.588672757, 0.149922758, 0.994922757, 1,
+            0.209392488, 0.95689255, -0.213107467, 0.75, 0.515862525, -0.134137496, 0.353362501, 0,
+        },
+    },
+    // yuv
+    {
+        { // U8
+            0, 26, 60, 255, 208, 255, 255, 255,
+            81, 154, 188, 128, 120, 89, 75, 255,
+            7, 171, 127, 64, 28, 122, 255, 255,
+            184, 250, 34, 191, 16, 40, 221, 0,
+        },
+        { // U16
+            0, 6651, 15437, 65535, 53331, 65535, 65535, 65535,
+            20564, 39419, 48205, 32768, 30794, 22853, 19104, 65535,
+            1664, 44025, 32842, 16384, 7212, 31308, 65535, 65535,
+            47371, 64164, 8707, 49151, 4296, 10324, 56865, 0,
+        },
+        { // F16
+            -0.186279297, 0.101501465, 0.235595703, 1, 0.813964844, 1.1015625, 1.23535156, 1,
+            0.313720703, 0.6015625, 0.735351562, 0.5, 0.469726562, 0.348632812, 0.291503906, 1,
+            0.025390625, 0.671875, 0.500976562, 0.25, 0.110046387, 0.477539062, 1.234375, 1,
+            0.723144531, 0.979003906, 0.1328125, 0.75, 0.065612793, 0.157470703, 0.867675781, 0,
+        },
+        { // F32
+            -0.186220005, 0.101486214, 0.23556, 1, 0.81378001, 1.10148621, 1.23556006, 1,
+            0.31378001, 0.601486206, 0.73556, 0.5, 0.469882011, 0.348709971, 0.291492015, 1,
+            0.0253920071, 0.671782017, 0.501152039, 0.25, 0.110043004, 0.477724016, 1.23471797, 1,
+            0.722829998, 0.97907418, 0.132860005, 0.75, 0.0655550063, 0.157528445, 0.867709994, 0,
+        },
+    },
+    // colorize
+    {
+        { // U8
+            25, 46, 76, 255, 255, 255, 255, 255,
+            103, 143, 204, 128, 58, 105, 175, 255,
+            94, 137, 201, 64, 73, 121, 194, 255,
+            198, 213, 236, 191, 40, 72, 119, 0,
+        },
+        { // U16
+            6553, 11796, 19660, 65535, 65535, 65535, 65535, 65535,
+            26215, 36700, 52428, 32768, 14951, 26912, 44853, 65535,
+            24015, 35087, 51695, 16384, 18681, 31175, 49917, 65535,
+            50868, 54780, 60646, 49151, 10204, 18367, 30611, 0,
+        },
+        { // F16
+            0.0999755859, 0.180053711, 0.300048828, 1, 1, 1, 1, 1,
+            0.399902344, 0.560058594, 0.799804688, 0.5, 0.228149414, 0.410644531, 0.684082031, 1,
+            0.366455078, 0.535644531, 0.7890625, 0.25, 0.284912109, 0.475585938, 0.76171875, 1,
+            0.776367188, 0.8359375, 0.925292969, 0.75, 0.155639648, 0.280273438, 0.467041016, 0,
+        },
+        { // F32
+            0.099999994, 0.180000022, 0.300000012, 1, 1, 1, 1, 1,
+            0.400000036, 0.560000062, 0.800000012, 0.5, 0.228136003, 0.410644859, 0.684408009, 1,
+            0.366448045, 0.535395265, 0.788815975, 0.25, 0.285052001, 0.475704849, 0.761684, 1,
+            0.776199937, 0.835879982, 0.925400019, 0.75, 0.155699998, 0.280260026, 0.467099994, 0,
+        },
+    },
+    // desaturate0
+    {
+        { // U8
+            0, 0, 0, 255, 255, 255, 255, 255,
+            128, 128, 128, 128, 115, 115, 115, 255,
+            90, 90, 90, 64, 147, 147, 147, 255,
+            128, 128, 128, 191, 76, 76, 76, 0,
+        },
+        { // U16
+            0, 0, 0, 65535, 65535, 65535, 65535, 65535,
+            32768, 32768, 32768, 32768, 29491, 29491, 29491, 65535,
+            22938, 22938, 22938, 16384, 37683, 37683, 37683, 65535,
+            32768, 32768, 32768, 49151, 19660, 19660, 19660, 0,
+        },
+        { // F16
+            0, 0, 0, 1, 1, 1, 1, 1,
+            0.5, 0.5, 0.5, 0.5, 0.449951172, 0.449951172, 0.449951172, 1,
+            0.350097656, 0.350097656, 0.350097656, 0.25, 0.575195312, 0.575195312, 0.575195312, 1,
+            0.5, 0.5, 0.5, 0.75, 0.299804688, 0.299804688, 0.299804688, 0,
+        },
+        { // F32
+            0, 0, 0, 1, 1, 1, 1, 1,
+            0.5, 0.5, 0.5, 0.5, 0.450000018, 0.450000018, 0.450000018, 1,
+            0.350000024, 0.350000024, 0.350000024, 0.25, 0.574999988, 0.574999988, 0.574999988, 1,
+            0.5, 0.5, 0.5, 0.75, 0.300000012, 0.300000012, 0.300000012, 0,
+        },
+    },
+    // desaturate1
+    {
+        { // U8
+            0, 0, 0, 255, 255, 255, 255, 255,
+            128, 128, 128, 128, 82, 82, 82, 255,
+            120, 120, 120, 64, 103, 103, 103, 255,
+            208, 208, 208, 191, 36, 36, 36, 0,
+        },
+        { // U16
+            0, 0, 0, 65535, 65535, 65535, 65535, 65535,
+            32768, 32768, 32768, 32768, 20994, 20994, 20994, 65535,
+            30935, 30935, 30935, 16384, 26490, 26490, 26490, 65535,
+            53313, 53313, 53313, 49151, 9126, 9126, 9126, 0,
+        },
+        { // F16
+            0, 0, 0, 1, 1, 1, 1, 1,
+            0.5, 0.5, 0.5, 0.5, 0.3203125, 0.3203125, 0.3203125, 1,
+            0.472167969, 0.472167969, 0.472167969, 0.25, 0.404052734, 0.404052734, 0.404052734, 1,
+            0.813476562, 0.813476562, 0.813476562, 0.75, 0.139282227, 0.139282227, 0.139282227, 0,
+        },
+        { // F32
+            0, 0, 0, 1, 1, 1, 1, 1,
+            0.5, 0.5, 0.5, 0.5, 0.320340008, 0.320340008, 0.320340008, 1,
+            0.472040027, 0.472040027, 0.472040027, 0.25, 0.404210001, 0.404210001, 0.404210001, 1,
+            0.813499987, 0.813499987, 0.813499987, 0.75, 0.13925001, 0.13925001, 0.13925001, 0,
+        },
+    },
+    // desaturate2
+    {
+        { // U8
+            0, 0, 0, 255, 255, 255, 255, 255,
+            128, 128, 128, 128, 94, 94, 94, 255,
+            106, 106, 106, 64, 105, 105, 105, 255,
+            201, 201, 201, 191, 46, 46, 46, 0,
+        },
+        { // U16
+            0, 0, 0, 65535, 65535, 65535, 65535, 65535,
+            32768, 32768, 32768, 32768, 24117, 24117, 24117, 65535,
+            27282, 27282, 27282, 16384, 27010, 27010, 27010, 65535,
+            51688, 51688, 51688, 49151, 11911, 11911, 11911, 0,
+        },
+        { // F16
+            0, 0, 0, 1, 1, 1, 1, 1,
+            0.5, 0.5, 0.5, 0.5, 0.367919922, 0.367919922, 0.367919922, 1,
+            0.416259766, 0.416259766, 0.416259766, 0.25, 0.412109375, 0.412109375, 0.412109375, 1,
+            0.788574219, 0.788574219, 0.788574219, 0.75, 0.181762695, 0.181762695, 0.181762695, 0,
+        },
+        { // F32
+            0, 0, 0, 1, 1, 1, 1, 1,
+            0.5, 0.5, 0.5, 0.5, 0.368000001, 0.368000001, 0.368000001, 1,
+            0.416300029, 0.416300029, 0.416300029, 0.25, 0.412149996, 0.412149996, 0.412149996, 1,
+            0.788699985, 0.788699985, 0.788699985, 0.75, 0.18175, 0.18175, 0.18175, 0,
+        },
+    },
+    // desaturate3
+    {
+        { // U8
+            0, 0, 0, 255, 255, 255, 255, 255,
+            128, 128, 128, 128, 94, 94, 94, 255,
+            85, 85, 85, 64, 132, 132, 132, 255,
+            157, 157, 157, 191, 76, 76, 76, 0,
+        },
+        { // U16
+            0, 0, 0, 65535, 65535, 65535, 65535, 65535,
+            32768, 32768, 32768, 32768, 24030, 24030, 24030, 65535,
+            21845, 21845, 21845, 16384, 33860, 33860, 33860, 65535,
+            40413, 40413, 40413, 49151, 19660, 19660, 19660, 0,
+        },
+        { // F16
+            0, 0, 0, 1, 1, 1, 1, 1,
+            0.5, 0.5, 0.5, 0.5, 0.366699219, 0.366699219, 0.366699219, 1,
+            0.333496094, 0.333496094, 0.333496094, 0.25, 0.516601562, 0.516601562, 0.516601562, 1,
+            0.616699219, 0.616699219, 0.616699219, 0.75, 0.300048828, 0.300048828, 0.300048828, 0,
+        },
+        { // F32
+            0, 0, 0, 1, 1, 1, 1, 1,
+            0.5, 0.5, 0.5, 0.5, 0.366666675, 0.366666675, 0.366666675, 1,
+            0.333333343, 0.333333343, 0.333333343, 0.25, 0.516666651, 0.516666651, 0.516666651, 1,
+            0.616666615, 0.616666615, 0.616666615, 0.75, 0.300000012, 0.300000012, 0.300000012, 0,
+        },
+    },
+    // desaturate4
+    {
+        { // U8
+            0, 0, 0, 255, 255, 255, 255, 255,
+            128, 128, 128, 128, 26, 26, 26, 255,
+            26, 26, 26, 64, 64, 64, 64, 255,
+            13, 13, 13, 191, 13, 13, 13, 0,
+        },
+        { // U16
+            0, 0, 0, 65535, 65535, 65535, 65535, 65535,
+            32768, 32768, 32768, 32768, 6554, 6554, 6554, 65535,
+            6554, 6554, 6554, 16384, 16384, 16384, 16384, 65535,
+            3277, 3277, 3277, 49151, 3277, 3277, 3277, 0,
+        },
+        { // F16
+            0, 0, 0, 1, 1, 1, 1, 1,
+            0.5, 0.5, 0.5, 0.5, 0.0999755859, 0.0999755859, 0.0999755859, 1,
+            0.0999755859, 0.0999755859, 0.0999755859, 0.25, 0.25, 0.25, 0.25, 1,
+            0.049987793, 0.049987793, 0.049987793, 0.75, 0.049987793, 0.049987793, 0.049987793, 0,
+        },
+        { // F32
+            0, 0, 0, 1, 1, 1, 1, 1,
+            0.5, 0.5, 0.5, 0.5, 0.100000001, 0.100000001, 0.100000001, 1,
+            0.100000001, 0.100000001, 0.100000001, 0.25, 0.25, 0.25, 0.25, 1,
+            0.0500000007, 0.0500000007, 0.0500000007, 0.75, 0.0500000007, 0.0500000007, 0.0500000007, 0,
+        },
+    },
+    // desaturate5
+    {
+        { // U8
+            0, 0, 0, 255, 255, 255, 255, 255,
+            128, 128, 128, 128, 204, 204, 204, 255,
+            153, 153, 153, 64, 230, 230, 230, 255,
+            242, 242, 242, 191, 140, 140, 140, 0,
+        },
+        { // U16
+            0, 0, 0, 65535, 65535, 65535, 65535, 65535,
+            32768, 32768, 32768, 32768, 52428, 52428, 52428, 65535,
+            39321, 39321, 39321, 16384, 58982, 58982, 58982, 65535,
+            62258, 62258, 62258, 49151, 36044, 36044, 36044, 0,
+        },
+        { // F16
+            0, 0, 0, 1, 1, 1, 1, 1,
+            0.5, 0.5, 0.5, 0.5, 0.799804688, 0.799804688, 0.799804688, 1,
+            0.600097656, 0.600097656, 0.600097656, 0.25, 0.899902344, 0.899902344, 0.899902344, 1,
+            0.950195312, 0.950195312, 0.950195312, 0.75, 0.549804688, 0.549804688, 0.549804688, 0,
+        },
+        { // F32
+            0, 0, 0, 1, 1, 1, 1, 1,
+            0.5, 0.5, 0.5, 0.5, 0.800000012, 0.800000012, 0.800000012, 1,
+            0.600000024, 0.600000024, 0.600000024, 0.25, 0.899999976, 0.899999976, 0.899999976, 1,
+            0.949999988, 0.949999988, 0.949999988, 0.75, 0.550000012, 0.550000012, 0.550000012, 0,
+        },
+    },
+    // balance
+    {
+        { // U8
+            0, 36, 18, 255, 255, 255, 219, 255,
+            164, 110, 182, 128, 237, 35, 79, 255,
+            16, 158, 114, 64, 102, 89, 255, 255,
+            255, 199, 67, 191, 44, 29, 171, 0,
+        },
+        { // U16
+            0, 9175, 4587, 65535, 65535, 65535, 56360, 65535,
+            41943, 28181, 46530, 32768, 60723, 8960, 20023, 65535,
+            3839, 40679, 29459, 16384, 26165, 22838, 65535, 65535,
+            65535, 51118, 17039, 49151, 11439, 7387, 44008, 0,
+        },
+        { // F16
+            0, 0.140014648, 0.0700073242, 1, 1, 1, 0.859863281, 1,
+            0.640136719, 0.429931641, 0.709960938, 0.5, 0.926269531, 0.13671875, 0.305419922, 1,
+            0.05859375, 0.620605469, 0.449707031, 0.25, 0.399169922, 0.348388672, 1, 1,
+            1, 0.780273438, 0.260009766, 0.75, 0.174438477, 0.112792969, 0.671386719, 0,
+        },
+        { // F32
+            0, 0.140000001, 0.0700000003, 1, 1, 1, 0.860000014, 1,
+            0.639999986, 0.430000007, 0.710000038, 0.5, 0.926560044, 0.136719987, 0.305519998, 1,
+            0.0585600361, 0.620720029, 0.449520022, 0.25, 0.399240017, 0.348480016, 1, 1,
+            1, 0.780000031, 0.26000002, 0.75, 0.174560025, 0.11271999, 0.671519995, 0,
+        },
+    },
+    // balance-luma
+    {
+        { // U8
+            0, 0, 0, 255, 255, 255, 255, 255,
+            149, 86, 170, 128, 212, 18, 60, 255,
+            16, 163, 118, 64, 56, 39, 255, 255,
+            255, 179, 0, 191, 34, 22, 131, 0,
+        },
+        { // U16
+            0, 0, 0, 65535, 65535, 65535, 65535, 65535,
+            38102, 22099, 43437, 32768, 54358, 4624, 15253, 65535,
+            3956, 41919, 30357, 16384, 14171, 9831, 65535, 65535,
+            65535, 46052, 0, 49151, 8752, 5652, 33669, 0,
+        },
+        { // F16
+            0, 0, 0, 1, 1, 1, 1, 1,
+            0.581542969, 0.337158203, 0.662597656, 0.5, 0.829101562, 0.0708618164, 0.232788086, 1,
+            0.0603942871, 0.639648438, 0.463378906, 0.25, 0.216308594, 0.149902344, 1, 1,
+            1, 0.703125, 0.000183105469, 0.75, 0.133422852, 0.0863037109, 0.513671875, 0,
+        },
+        { // F32
+            0, 0, 0, 1, 1, 1, 1, 1,
+            0.581395388, 0.337209284, 0.662790716, 0.5, 0.829438925, 0.070561111, 0.232744038, 1,
+            0.0603462458, 0.639653802, 0.463231653, 0.25, 0.216223836, 0.149999976, 1, 1,
+            1, 0.702702761, 0, 0.75, 0.133551002, 0.0862389207, 0.513761103, 0,
+        },
+    }
+};
+
+KoColorTransformation* createAdjustment(const QString &transformationId,
+                                        const KoColorSpace *cs,
+                                        const QVariantHash &parameters)
+{
+    if (transformationId == "hsv_adjustment") {
+        return KisHSVAdjustmentFactory().createTransformation(cs, parameters);
+    } else if (transformationId == "desaturate_adjustment") {
+        return KisDesaturateAdjustmentFactory().createTransformation(cs, parameters);
+    } else if (transformationId == "ColorBalance") {
+        return KisColorBalanceAdjustmentFactory().createTransformation(cs, parameters);
+    }
+    return 0;
+}
+
+template<typename channel_type, typename traits>
+void fillPixels(quint8 *data, int count)
+{
+    typename traits::Pixel *pixel = reinterpret_cast<typename traits::Pixel*>(data);
+
+    for (int i = 0; i < count; i++) {
+        const float *source = sourcePixels[i % numPixels];
+        pixel[i].red = KoColorSpaceMaths<float, channel_type>::scaleToA(source[0]);
+        pixel[i].green = KoColorSpaceMaths<float, channel_type>::scaleToA(source[1]);
+        pixel[i].blue = KoColorSpaceMaths<float, channel_type>::scaleToA(source[2]);
+        pixel[i].alpha = KoColorSpaceMaths<float, channel_type>::scaleToA(source[3]);
+    }
+}
+
+template<typename channel_type, typename traits>
+QVector<double> readPixels(const quint8 *data, int count)
+{
+    const typename traits::Pixel *pixel = reinterpret_cast<const typename traits::Pixel*>(data);
+    QVector<double> values;
+
+    for (int i = 0; i < count; i++) {
+        values << double(pixel[i].red) << double(pixel[i].green)
+               << double(pixel[i].blue) << double(pixel[i].alpha);
+    }
+
+    return values;
+}
+
+/**
+ * @return the buffer with sourcePixels repeated to \p count pixels
+ */
+QByteArray createPixels(const KoColorSpace *cs, int count)
+{
+    QByteArray data(count * cs->pixelSize(), '\0');
+    quint8 *ptr = reinterpret_cast<quint8*>(data.data());
+
+    if (cs->colorDepthId() == Integer8BitsColorDepthID) {
+        fillPixels<quint8, KoBgrU8Traits>(ptr, count);
+    } else if (cs->colorDepthId() == Integer16BitsColorDepthID) {
+        fillPixels<quint16, KoBgrU16Traits>(ptr, count);
+    }
+#ifdef HAVE_OPENEXR
+    else if (cs->colorDepthId() == Float16BitsColorDepthID) {
+        fillPixels<half, KoRgbF16Traits>(ptr, count);
+    }
+#endif
+    else if (cs->colorDepthId() == Float32BitsColorDepthID) {
+        fillPixels<float, KoRgbF32Traits>(ptr, count);
+    }
+
+    return data;
+}
+
+QVector<double> pixelValues(const KoColorSpace *cs, const QByteArray &data)
+{
+    const quint8 *ptr = reinterpret_cast<const quint8*>(data.constData());
+    const int count = data.size() / cs->pixelSize();
+
+    if (cs->colorDepthId() == Integer8BitsColorDepthID) {
+        return readPixels<quint8, KoBgrU8Traits>(ptr, count);
+    } else if (cs->colorDepthId() == Integer16BitsColorDepthID) {
+        return readPixels<quint16, KoBgrU16Traits>(ptr, count);
+    }
+#ifdef HAVE_OPENEXR
+    else if (cs->colorDepthId() == Float16BitsColorDepthID) {
+        return readPixels<half, KoRgbF16Traits>(ptr, count);
+    }
+#endif
+    else if (cs->colorDepthId() == Float32BitsColorDepthID) {
+        return readPixels<float, KoRgbF32Traits>(ptr, count);
+    }
+
+    return QVector<double>();
+}
+
+/**
+ * The integer channels may differ by one level from the reference, the
+ * floating point ones by the rounding of the intermediate values
+ */
+bool fuzzyCompareChannel(const KoColorSpace *cs, double value, double reference)
+{
+    const double difference = qAbs(value - reference);
+
+    if (cs->colorDepthId() == Integer8BitsColorDepthID ||
+        cs->colorDepthId() == Integer16BitsColorDepthID) {
+
+        return difference <= 1.0;
+    }
+
+    const double tolerance = cs->colorDepthId() == Float16BitsColorDepthID ? 1e-3 : 1e-5;
+    return difference <= tolerance * qMax(1.0, qAbs(reference));
+}
+
+void compareWithReference(const KoColorSpace *cs, const QVector<double> &values, const double *reference)
+{
+    QCOMPARE(values.size(), numPixels * 4);
+
+    for (int i = 0; i < values.size(); i++) {
+        if (!fuzzyCompareChannel(cs, values[i], reference[i])) {
+            qDebug() << "pixel" << i / 4 << "channel" << i % 4
+                     << "result:" << values[i] << "reference:" << reference[i];
+            QFAIL("the adjustment differs from the per-pixel implementation");
+        }
+    }
+}
+
+}
+
+void TestRgbAdjustments::testAdjustment_data()
+{
+    QTest::addColumn<QString>("colorDepthId");
+    QTest::addColumn<QString>("transformationId");
+    QTest::addColumn<QVariantHash>("parameters");
+    QTest::addColumn<int>("referenceIndex");
+
+    const QList<AdjustmentCase> cases = adjustmentCases();
+    QCOMPARE(cases.size(), int(sizeof(referenceValues) / sizeof(referenceValues[0])));
+
+    for (int i = 0; i < cases.size(); i++) {
+        for (int depth = 0; depth < numDepths; depth++) {
+            const QString rowName = cases[i].name + "-" + colorDepth(depth).id();
+            QTest::newRow(rowName.toLatin1())
+                << colorDepth(depth).id() << cases[i].transformationId
+                << cases[i].parameters << i * numDepths + depth;
+        }
+    }
+}
+
+void TestRgbAdjustments::testAdjustment()
+{
+    QFETCH(QString, colorDepthId);
+    QFETCH(QString, transformationId);
+    QFETCH(QVariantHash, parameters);
+    QFETCH(int, referenceIndex);
+
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->colorSpace(RGBAColorModelID.id(), colorDepthId, "");
+    if (!cs) {
+        QSKIP("the color space is not available");
+    }
+
+    QScopedPointer<KoColorTransformation> adjustment(createAdjustment(transformationId, cs, parameters));
+    if (!adjustment) {
+        QSKIP("the adjustment does not support the color space");
+    }
+
+    const double *reference = referenceValues[referenceIndex / numDepths][referenceIndex % numDepths];
+
+    const QByteArray src = createPixels(cs, numPixels);
+    QByteArray dst(src.size(), '\0');
+    adjustment->transform(reinterpret_cast<const quint8*>(src.constData()),
+                          reinterpret_cast<quint8*>(dst.data()), numPixels);
+
+    compareWithReference(cs, pixelValues(cs, dst), reference);
+
+    QByteArray inPlace = src;
+    adjustment->transform(reinterpret_cast<const quint8*>(inPlace.constData()),
+                          reinterpret_cast<quint8*>(inPlace.data()), numPixels);
+
+    QCOMPARE(inPlace, dst);
+}
+
+void TestRgbAdjustments::benchmarkAdjustment_data()
+{
+    QTest::addColumn<QString>("colorDepthId");
+    QTest::addColumn<QString>("transformationId");
+    QTest::addColumn<QVariantHash>("parameters");
+    QTest::addColumn<bool>("perPixel");
+
+    const QList<AdjustmentCase> cases = adjustmentCases();
+
+    Q_FOREACH (const AdjustmentCase &adjustmentCase, cases) {
+        if (adjustmentCase.name.startsWith("desaturate") && adjustmentCase.name != "desaturate1") {
+            continue;
+        }
+
+        for (int depth = 0; depth < numDepths; depth++) {
+            const QString rowName = adjustmentCase.name + "-" + colorDepth(depth).id();
+
+            QTest::newRow((rowName + "-run").toLatin1())
+                << colorDepth(depth).id() << adjustmentCase.transformationId
+                << adjustmentCase.parameters << false;
+
+            QTest::newRow((rowName + "-per-pixel").toLatin1())
+                << colorDepth(depth).id() << adjustmentCase.transformationId
+                << adjustmentCase.parameters << true;
+        }
+    }
+}
+
+/**
+ * Compares the transformation of a whole run of pixels with calling the
+ * transformation for every pixel separately, i.e. with selecting the
+ * variant of the adjustment for every pixel
+ */
+void TestRgbAdjustments::benchmarkAdjustment()
+{
+    QFETCH(QString, colorDepthId);
+    QFETCH(QString, transformationId);
+    QFETCH(QVariantHash, parameters);
+    QFETCH(bool, perPixel);
+
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->colorSpace(RGBAColorModelID.id(), colorDepthId, "");
+    if (!cs) {
+        QSKIP("the color space is not available");
+    }
+
+    QScopedPointer<KoColorTransformation> adjustment(createAdjustment(transformationId, cs, parameters));
+    if (!adjustment) {
+        QSKIP("the adjustment does not support the color space");
+    }
+
+    const int count = 512 * 512;
+    const int pixelSize = cs->pixelSize();
+    const QByteArray src = createPixels(cs, count);
+    QByteArray dst(src.size(), '\0');
+
+    const quint8 *srcPtr = reinterpret_cast<const quint8*>(src.constData());
+    quint8 *dstPtr = reinterpret_cast<quint8*>(dst.data());
+
+    if (perPixel) {
+        QBENCHMARK {
+            for (int i = 0; i < count; i++) {
+                adjustment->transform(srcPtr + i * pixelSize, dstPtr + i * pixelSize, 1);
+            }
+        }
+    } else {
+        QBENCHMARK {
+            adjustment->transform(srcPtr, dstPtr, count);
+        }
+    }
+}
+
+KISTEST_MAIN(TestRgbAdjustments)
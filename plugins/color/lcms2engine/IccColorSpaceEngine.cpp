@@ -22,10 +22,62 @@
 
 #include "KoColorModelStandardIds.h"
 
+#include <QColor>
+#include <QSharedPointer>
+
 #include <klocalizedstring.h>
 
+#include <KoConfig.h>
+#ifdef HAVE_OPENEXR
+#include <KoHalfConversion.h>
+#endif
+
 #include "LcmsColorSpace.h"
 
+namespace {
+
+LcmsColorProfileContainer *lcmsProfileOf(const KoColorSpace *cs)
+{
+    const IccColorProfile *profile = dynamic_cast<const IccColorProfile *>(cs->profile());
+    return profile ? profile->asLcms() : 0;
+}
+
+}
+
+// -- KoLcmsFallbackColorConversionTransformation --
+
+/**
+ * Converts through QColor when one of the profiles has no LCMS
+ * representation. The color spaces are never created for the profiles
+ * that failed to load (see LcmsColorSpaceFactory::canCreateColorSpace()),
+ * so this is only a safety net against a crash in the conversion system.
+ */
+class KoLcmsFallbackColorConversionTransformation : public KoColorConversionTransformation
+{
+public:
+    KoLcmsFallbackColorConversionTransformation(const KoColorSpace *srcCs, const KoColorSpace *dstCs,
+                                                Intent renderingIntent,
+                                                ConversionFlags conversionFlags)
+        : KoColorConversionTransformation(srcCs, dstCs, renderingIntent, conversionFlags)
+    {
+    }
+
+    void transform(const quint8 *src, quint8 *dst, qint32 numPixels) const override
+    {
+        const quint32 srcPixelSize = srcColorSpace()->pixelSize();
+        const quint32 dstPixelSize = dstColorSpace()->pixelSize();
+
+        QColor c;
+        for (qint32 i = 0; i < numPixels; i++) {
+            srcColorSpace()->toQColor(src, &c);
+            dstColorSpace()->fromQColor(c, dst);
+
+            src += srcPixelSize;
+            dst += dstPixelSize;
+        }
+    }
+};
+
 // -- KoLcmsColorConversionTransformation --
 
 class KoLcmsColorConversionTransformation : public KoColorConversionTransformation
@@ -36,7 +88,6 @@ public:
                                         Intent renderingIntent,
                                         ConversionFlags conversionFlags)
         : KoColorConversionTransformation(srcCs, dstCs, renderingIntent, conversionFlags)
-        , m_transform(0)
     {
         Q_ASSERT(srcCs);
         Q_ASSERT(dstCs);
@@ -53,34 +104,118 @@ public:
         }
         conversionFlags |= KoColorConversionTransformation::CopyAlpha;
 
-        m_transform = cmsCreateTransform(srcProfile->lcmsProfile(),
-                                         srcColorSpaceType,
-                                         dstProfile->lcmsProfile(),
-                                         dstColorSpaceType,
-                                         renderingIntent,
-                                         conversionFlags);
+        cmsHTRANSFORM transform = cmsCreateTransform(srcProfile->lcmsProfile(),
+                                                     srcColorSpaceType,
+                                                     dstProfile->lcmsProfile(),
+                                                     dstColorSpaceType,
+                                                     renderingIntent,
+                                                     conversionFlags);
+
+        Q_ASSERT(transform);
+
+        m_transform = QSharedPointer<void>(transform,
+                                           [] (cmsHTRANSFORM t) {
+                                               if (t) {
+                                                   cmsDeleteTransform(t);
+                                               }
+                                           });
+    }
+
+public:
 
+    void transform(const quint8 *src, quint8 *dst, qint32 numPixels) const override
+    {
         Q_ASSERT(m_transform);
+
+        cmsDoTransform(m_transform.data(), const_cast<quint8 *>(src), dst, numPixels);
+
     }
 
-    ~KoLcmsColorConversionTransformation() override
+    /**
+     * cmsDoTransform() doesn't modify the transform, so the compiled
+     * lcms transform can be shared by all the clones
+     */
+    KoColorConversionTransformation *clone() const override
     {
-        cmsDeleteTransform(m_transform);
+        return new KoLcmsColorConversionTransformation(*this);
     }
 
+private:
+    KoLcmsColorConversionTransformation(const KoLcmsColorConversionTransformation &rhs)
+        : KoColorConversionTransformation(rhs.srcColorSpace(), rhs.dstColorSpace(),
+                                          rhs.renderingIntent(), rhs.conversionFlags())
+        , m_transform(rhs.m_transform)
+    {
+    }
+
+private:
+    QSharedPointer<void> m_transform;
+};
+
+#ifdef HAVE_OPENEXR
+
+// -- KoHalfFloatColorConversionTransformation --
+
+/**
+ * Converts between F16 and F32 versions of the same color space. The
+ * profiles are equal, so the channel values are just widened or rounded,
+ * which KoHalfConversion does in batches instead of passing every pixel
+ * through the lcms pipeline. It is the conversion used when uploading
+ * F16 images into F32 textures and F32 images into F16 (HDR) textures.
+ */
+class KoHalfFloatColorConversionTransformation : public KoColorConversionTransformation
+{
 public:
+    KoHalfFloatColorConversionTransformation(const KoColorSpace *srcCs, const KoColorSpace *dstCs,
+                                             Intent renderingIntent,
+                                             ConversionFlags conversionFlags)
+        : KoColorConversionTransformation(srcCs, dstCs, renderingIntent, conversionFlags),
+          m_fromHalf(srcCs->colorDepthId() == Float16BitsColorDepthID)
+    {
+        Q_ASSERT(srcCs->channelCount() == dstCs->channelCount());
+    }
+
+    static bool canConvert(const KoColorSpace *srcCs, const KoColorSpace *dstCs)
+    {
+        const KoID srcModel = srcCs->colorModelId();
+        const KoID srcDepth = srcCs->colorDepthId();
+        const KoID dstDepth = dstCs->colorDepthId();
+
+        return (srcModel == RGBAColorModelID || srcModel == GrayAColorModelID) &&
+                srcModel == dstCs->colorModelId() &&
+                ((srcDepth == Float16BitsColorDepthID && dstDepth == Float32BitsColorDepthID) ||
+                 (srcDepth == Float32BitsColorDepthID && dstDepth == Float16BitsColorDepthID)) &&
+                *srcCs->profile() == *dstCs->profile();
+    }
 
+public:
     void transform(const quint8 *src, quint8 *dst, qint32 numPixels) const override
     {
-        Q_ASSERT(m_transform);
+        const int numValues = numPixels * srcColorSpace()->channelCount();
 
-        cmsDoTransform(m_transform, const_cast<quint8 *>(src), dst, numPixels);
+        if (m_fromHalf) {
+            KoHalfConversion::halfToFloat(reinterpret_cast<const half*>(src),
+                                          reinterpret_cast<float*>(dst),
+                                          numValues);
+        } else {
+            KoHalfConversion::floatToHalf(reinterpret_cast<const float*>(src),
+                                          reinterpret_cast<half*>(dst),
+                                          numValues);
+        }
+    }
 
+    KoColorConversionTransformation *clone() const override
+    {
+        return new KoHalfFloatColorConversionTransformation(srcColorSpace(), dstColorSpace(),
+                                                            renderingIntent(), conversionFlags());
     }
+
 private:
-    mutable cmsHTRANSFORM m_transform;
+    bool m_fromHalf;
 };
 
+#endif /* HAVE_OPENEXR */
+
 class KoLcmsColorProofingConversionTransformation : public KoColorProofingConversionTransformation
 {
 public:
@@ -111,6 +246,14 @@ public:
         }
         conversionFlags |= KoColorConversionTransformation::CopyAlpha;
 
+        LcmsColorProfileContainer *proofingProfile = lcmsProfileOf(proofingSpace);
+        if (!proofingProfile) {
+            // LCMS creates a plain transform when no proofing is requested
+            qWarning() << "Proofing profile" << proofingSpace->profile()->name() << "could not be loaded, soft proofing is disabled";
+            conversionFlags &= ~(KoColorConversionTransformation::SoftProofing |
+                                 KoColorConversionTransformation::GamutCheck);
+        }
+
         quint16 alarm[cmsMAXCHANNELS];//this seems to be bgr???
         alarm[0] = (cmsUInt16Number)gamutWarning[2]*256;
         alarm[1] = (cmsUInt16Number)gamutWarning[1]*256;
@@ -122,7 +265,7 @@ public:
                                                  srcColorSpaceType,
                                                  dstProfile->lcmsProfile(),
                                                  dstColorSpaceType,
-                                                 dynamic_cast<const IccColorProfile *>(proofingSpace->profile())->asLcms()->lcmsProfile(),
+                                                 proofingProfile ? proofingProfile->lcmsProfile() : 0,
                                                  renderingIntent,
                                                  proofingIntent,
                                                  conversionFlags);
@@ -230,10 +373,29 @@ KoColorConversionTransformation *IccColorSpaceEngine::createColorTransformation(
     Q_ASSERT(srcColorSpace);
     Q_ASSERT(dstColorSpace);
 
+#ifdef HAVE_OPENEXR
+    if (KoHalfFloatColorConversionTransformation::canConvert(srcColorSpace, dstColorSpace)) {
+        return new KoHalfFloatColorConversionTransformation(srcColorSpace, dstColorSpace,
+                                                            renderingIntent, conversionFlags);
+    }
+#endif
+
+    LcmsColorProfileContainer *srcProfile = lcmsProfileOf(srcColorSpace);
+    LcmsColorProfileContainer *dstProfile = lcmsProfileOf(dstColorSpace);
+
+    if (!srcProfile || !dstProfile) {
+        qWarning() << "Could not load the profiles for the conversion from"
+                   << srcColorSpace->id() << srcColorSpace->profile()->name()
+                   << "to" << dstColorSpace->id() << dstColorSpace->profile()->name();
+
+        return new KoLcmsFallbackColorConversionTransformation(srcColorSpace, dstColorSpace,
+                                                               renderingIntent, conversionFlags);
+    }
+
     return new KoLcmsColorConversionTransformation(
                 srcColorSpace, computeColorSpaceType(srcColorSpace),
-                dynamic_cast<const IccColorProfile *>(srcColorSpace->profile())->asLcms(), dstColorSpace, computeColorSpaceType(dstColorSpace),
-                dynamic_cast<const IccColorProfile *>(dstColorSpace->profile())->asLcms(), renderingIntent, conversionFlags);
+                srcProfile, dstColorSpace, computeColorSpaceType(dstColorSpace),
+                dstProfile, renderingIntent, conversionFlags);
 
 }
 KoColorProofingConversionTransformation *IccColorSpaceEngine::createColorProofingTransformation(const KoColorSpace *srcColorSpace,
@@ -248,10 +410,20 @@ KoColorProofingConversionTransformation *IccColorSpaceEngine::createColorProofin
     Q_ASSERT(srcColorSpace);
     Q_ASSERT(dstColorSpace);
 
+    LcmsColorProfileContainer *srcProfile = lcmsProfileOf(srcColorSpace);
+    LcmsColorProfileContainer *dstProfile = lcmsProfileOf(dstColorSpace);
+
+    if (!srcProfile || !dstProfile) {
+        qWarning() << "Could not load the profiles for the proofing conversion from"
+                   << srcColorSpace->id() << srcColorSpace->profile()->name()
+                   << "to" << dstColorSpace->id() << dstColorSpace->profile()->name();
+        return 0;
+    }
+
     return new KoLcmsColorProofingConversionTransformation(
                 srcColorSpace, computeColorSpaceType(srcColorSpace),
-                dynamic_cast<const IccColorProfile *>(srcColorSpace->profile())->asLcms(), dstColorSpace, computeColorSpaceType(dstColorSpace),
-                dynamic_cast<const IccColorProfile *>(dstColorSpace->profile())->asLcms(), proofingSpace, renderingIntent, proofingIntent, conversionFlags, gamutWarning,
+                srcProfile, dstColorSpace, computeColorSpaceType(dstColorSpace),
+                dstProfile, proofingSpace, renderingIntent, proofingIntent, conversionFlags, gamutWarning,
                 adaptationState
                 );
 }
@@ -179,7 +179,7 @@ protected:
         Q_ASSERT(p); // No profile means the lcms color space can't work
         Q_ASSERT(profileIsCompatible(p));
         d->profile = asLcmsProfile(p);
-        Q_ASSERT(d->profile);
+        Q_ASSERT(d->profile); // checked by LcmsColorSpaceFactory::canCreateColorSpace()
         d->colorProfile = p;
         d->qcolordata = 0;
         d->lastRGBProfile = 0;
@@ -243,7 +243,7 @@ public:
     bool profileIsCompatible(const KoColorProfile *profile) const override
     {
         const IccColorProfile *p = dynamic_cast<const IccColorProfile *>(profile);
-        return (p && p->asLcms()->colorSpaceSignature() == colorSpaceSignature());
+        return (p && p->colorSpaceSignature() == colorSpaceSignature());
     }
 
     void fromQColor(const QColor &color, quint8 *dst, const KoColorProfile *koprofile = 0) const override
@@ -442,8 +442,7 @@ private:
             return 0;
         }
 
-        Q_ASSERT(iccp->asLcms());
-
+        // null if the profile created from the index couldn't be loaded
         return iccp->asLcms();
     }
 
@@ -464,7 +463,7 @@ public:
     bool profileIsCompatible(const KoColorProfile *profile) const override
     {
         const IccColorProfile *p = dynamic_cast<const IccColorProfile *>(profile);
-        return (p && p->asLcms()->colorSpaceSignature() == colorSpaceSignature());
+        return (p && p->colorSpaceSignature() == colorSpaceSignature());
     }
 
     QString colorSpaceEngine() const override
@@ -483,6 +482,18 @@ public:
 
     QList<KoColorConversionTransformationFactory *> colorConversionLinks() const override;
     KoColorProfile *createColorProfile(const QByteArray &rawData) const override;
+
+protected:
+    bool canCreateColorSpace(const KoColorProfile *profile) const override
+    {
+        /**
+         * The profiles created from the profile index are loaded only
+         * now, and the file might have been removed or broken since it
+         * was indexed
+         */
+        const IccColorProfile *p = dynamic_cast<const IccColorProfile *>(profile);
+        return p && p->asLcms();
+    }
 };
 
 #endif
@@ -39,6 +39,7 @@
 #include <KoColorSpaceEngine.h>
 
 #include "IccColorSpaceEngine.h"
+#include "colorprofiles/IccColorProfileIndex.h"
 #include "colorprofiles/LcmsColorProfileContainer.h"
 
 #include "colorspaces/cmyk_u8/CmykU8ColorSpace.h"
@@ -125,21 +126,38 @@ LcmsEnginePlugin::LcmsEnginePlugin(QObject *parent, const QVariantList &)
             profileFilenames << iccProfiledir + "/" + entry;
         }
     }
-    // Load the profiles
+    // Load the profiles. The unchanged ones are registered from the index
+    // and opened with LCMS only when they are used for the first time.
     if (!profileFilenames.empty()) {
+        IccColorProfileIndex profileIndex(KoResourcePaths::locateLocal("data", "icc_profiles.index"));
+
         for (QStringList::Iterator it = profileFilenames.begin(); it != profileFilenames.end(); ++it) {
-            KoColorProfile *profile = new IccColorProfile(*it);
+            bool isValid = false;
+            IccColorProfile::Metadata metadata;
+
+            if (profileIndex.lookup(*it, &isValid, &metadata)) {
+                if (isValid) {
+                    registry->addProfileToMap(new IccColorProfile(*it, metadata));
+                }
+                continue;
+            }
+
+            IccColorProfile *profile = new IccColorProfile(*it);
             Q_CHECK_PTR(profile);
 
             profile->load();
             if (profile->valid()) {
                 //qDebug() << "Valid profile : " << profile->fileName() << profile->name();
+                profileIndex.update(*it, true, profile->metadata());
                 registry->addProfileToMap(profile);
             } else {
                 qDebug() << "Invalid profile : " << profile->fileName() << profile->name();
+                profileIndex.update(*it, false, IccColorProfile::Metadata());
                 delete profile;
             }
         }
+
+        profileIndex.save();
     }
 
     // ------------------- LAB ---------------------------------
@@ -23,6 +23,9 @@
 #include <limits.h>
 
 #include <QFile>
+#include <QAtomicInt>
+#include <QMutex>
+#include <QMutexLocker>
 #include <QSharedPointer>
 
 #include "QDebug"
@@ -71,6 +74,14 @@ struct IccColorProfile::Private {
         QScopedPointer<IccColorProfile::Data> data;
         QScopedPointer<LcmsColorProfileContainer> lcmsProfile;
         QVector<KoChannelInfo::DoubleRange> uiMinMaxes;
+
+        /**
+         * Set for the profiles created from the profile index,
+         * they are loaded by ensureLoaded() on first use
+         */
+        QScopedPointer<Metadata> metadata;
+        QAtomicInt isLoaded;
+        QMutex loadMutex;
     };
     QSharedPointer<Shared> shared;
 };
@@ -93,6 +104,19 @@ IccColorProfile::IccColorProfile(const QByteArray &rawData)
     init();
 }
 
+IccColorProfile::IccColorProfile(const QString &fileName, const Metadata &metadata)
+    : KoColorProfile(fileName), d(new Private)
+{
+    d->shared = QSharedPointer<Private::Shared>(new Private::Shared());
+    d->shared->data.reset(new Data());
+    d->shared->metadata.reset(new Metadata(metadata));
+
+    setName(metadata.name);
+    setInfo(metadata.info);
+    setManufacturer(metadata.manufacturer);
+    setCopyright(metadata.copyright);
+}
+
 IccColorProfile::IccColorProfile(const IccColorProfile &rhs)
     : KoColorProfile(rhs)
     , d(new Private(*rhs.d))
@@ -112,6 +136,7 @@ KoColorProfile *IccColorProfile::clone() const
 
 QByteArray IccColorProfile::rawData() const
 {
+    ensureLoaded();
     return d->shared->data->rawData();
 }
 
@@ -122,6 +147,10 @@ void IccColorProfile::setRawData(const QByteArray &rawData)
 
 bool IccColorProfile::valid() const
 {
+    if (d->shared->metadata) {
+        // the metadata is trusted until the profile fails to load
+        return !d->shared->isLoaded.loadAcquire() || d->shared->lcmsProfile;
+    }
     if (d->shared->lcmsProfile) {
         return d->shared->lcmsProfile->valid();
     }
@@ -129,6 +158,9 @@ bool IccColorProfile::valid() const
 }
 float IccColorProfile::version() const
 {
+    if (d->shared->metadata) {
+        return d->shared->metadata->version;
+    }
     if (d->shared->lcmsProfile) {
         return d->shared->lcmsProfile->version();
     }
@@ -136,6 +168,9 @@ float IccColorProfile::version() const
 }
 bool IccColorProfile::isSuitableForOutput() const
 {
+    if (d->shared->metadata) {
+        return d->shared->metadata->isSuitableForOutput;
+    }
     if (d->shared->lcmsProfile) {
         return d->shared->lcmsProfile->isSuitableForOutput();
     }
@@ -144,6 +179,9 @@ bool IccColorProfile::isSuitableForOutput() const
 
 bool IccColorProfile::isSuitableForPrinting() const
 {
+    if (d->shared->metadata) {
+        return d->shared->metadata->isSuitableForPrinting;
+    }
     if (d->shared->lcmsProfile) {
         return d->shared->lcmsProfile->isSuitableForPrinting();
     }
@@ -152,6 +190,9 @@ bool IccColorProfile::isSuitableForPrinting() const
 
 bool IccColorProfile::isSuitableForDisplay() const
 {
+    if (d->shared->metadata) {
+        return d->shared->metadata->isSuitableForDisplay;
+    }
     if (d->shared->lcmsProfile) {
         return d->shared->lcmsProfile->isSuitableForDisplay();
     }
@@ -160,6 +201,7 @@ bool IccColorProfile::isSuitableForDisplay() const
 
 bool IccColorProfile::supportsPerceptual() const
 {
+    ensureLoaded();
     if (d->shared->lcmsProfile) {
         return d->shared->lcmsProfile->supportsPerceptual();
     }
@@ -167,6 +209,7 @@ bool IccColorProfile::supportsPerceptual() const
 }
 bool IccColorProfile::supportsSaturation() const
 {
+    ensureLoaded();
     if (d->shared->lcmsProfile) {
         return d->shared->lcmsProfile->supportsSaturation();
     }
@@ -174,6 +217,7 @@ bool IccColorProfile::supportsSaturation() const
 }
 bool IccColorProfile::supportsAbsolute() const
 {
+    ensureLoaded();
     if (d->shared->lcmsProfile) {
         return d->shared->lcmsProfile->supportsAbsolute();
     }
@@ -181,6 +225,7 @@ bool IccColorProfile::supportsAbsolute() const
 }
 bool IccColorProfile::supportsRelative() const
 {
+    ensureLoaded();
     if (d->shared->lcmsProfile) {
         return d->shared->lcmsProfile->supportsRelative();
     }
@@ -188,6 +233,9 @@ bool IccColorProfile::supportsRelative() const
 }
 bool IccColorProfile::hasColorants() const
 {
+    if (d->shared->metadata) {
+        return d->shared->metadata->hasColorants;
+    }
     if (d->shared->lcmsProfile) {
         return d->shared->lcmsProfile->hasColorants();
     }
@@ -195,18 +243,27 @@ bool IccColorProfile::hasColorants() const
 }
 bool IccColorProfile::hasTRC() const
 {
+    if (d->shared->metadata) {
+        return d->shared->metadata->hasTRC;
+    }
     if (d->shared->lcmsProfile)
         return d->shared->lcmsProfile->hasTRC();
     return false;
 }
 bool IccColorProfile::isLinear() const
 {
+    if (d->shared->metadata) {
+        return d->shared->metadata->isLinear;
+    }
     if (d->shared->lcmsProfile)
         return d->shared->lcmsProfile->isLinear();
     return false;
 }
 QVector <qreal> IccColorProfile::getColorantsXYZ() const
 {
+    if (d->shared->metadata) {
+        return d->shared->metadata->colorantsXYZ;
+    }
     if (d->shared->lcmsProfile) {
         return d->shared->lcmsProfile->getColorantsXYZ();
     }
@@ -214,6 +271,7 @@ QVector <qreal> IccColorProfile::getColorantsXYZ() const
 }
 QVector <qreal> IccColorProfile::getColorantsxyY() const
 {
+    ensureLoaded();
     if (d->shared->lcmsProfile) {
         return d->shared->lcmsProfile->getColorantsxyY();
     }
@@ -221,6 +279,9 @@ QVector <qreal> IccColorProfile::getColorantsxyY() const
 }
 QVector <qreal> IccColorProfile::getWhitePointXYZ() const
 {
+    if (d->shared->metadata) {
+        return d->shared->metadata->whitePointXYZ;
+    }
     QVector <qreal> d50Dummy(3);
     d50Dummy << 0.9642 << 1.0000 << 0.8249;
     if (d->shared->lcmsProfile) {
@@ -230,6 +291,7 @@ QVector <qreal> IccColorProfile::getWhitePointXYZ() const
 }
 QVector <qreal> IccColorProfile::getWhitePointxyY() const
 {
+    ensureLoaded();
     QVector <qreal> d50Dummy(3);
     d50Dummy << 0.34773 << 0.35952 << 1.0;
     if (d->shared->lcmsProfile) {
@@ -239,6 +301,9 @@ QVector <qreal> IccColorProfile::getWhitePointxyY() const
 }
 QVector <qreal> IccColorProfile::getEstimatedTRC() const
 {
+    if (d->shared->metadata) {
+        return d->shared->metadata->estimatedTRC;
+    }
     QVector <qreal> dummy(3);
     dummy.fill(2.2);//estimated sRGB trc.
     if (d->shared->lcmsProfile) {
@@ -249,27 +314,34 @@ QVector <qreal> IccColorProfile::getEstimatedTRC() const
 
 void IccColorProfile::linearizeFloatValue(QVector <qreal> & Value) const
 {
+    ensureLoaded();
     if (d->shared->lcmsProfile)
         d->shared->lcmsProfile->LinearizeFloatValue(Value);
 }
 void IccColorProfile::delinearizeFloatValue(QVector <qreal> & Value) const
 {
+    ensureLoaded();
     if (d->shared->lcmsProfile)
         d->shared->lcmsProfile->DelinearizeFloatValue(Value);
 }
 void IccColorProfile::linearizeFloatValueFast(QVector <qreal> & Value) const
 {
+    ensureLoaded();
     if (d->shared->lcmsProfile)
         d->shared->lcmsProfile->LinearizeFloatValueFast(Value);
 }
 void IccColorProfile::delinearizeFloatValueFast(QVector<qreal> &Value) const
 {
+    ensureLoaded();
     if (d->shared->lcmsProfile)
         d->shared->lcmsProfile->DelinearizeFloatValueFast(Value);
 }
 
 QByteArray IccColorProfile::uniqueId() const
 {
+    if (d->shared->metadata) {
+        return d->shared->metadata->uniqueId;
+    }
     QByteArray dummy;
     if (d->shared->lcmsProfile) {
         dummy = d->shared->lcmsProfile->getProfileUniqueId();
@@ -317,10 +389,86 @@ bool IccColorProfile::init()
 
 LcmsColorProfileContainer *IccColorProfile::asLcms() const
 {
-    Q_ASSERT(d->shared->lcmsProfile);
+    ensureLoaded();
     return d->shared->lcmsProfile.data();
 }
 
+bool IccColorProfile::ensureLoaded() const
+{
+    Private::Shared *shared = d->shared.data();
+
+    if (!shared->metadata || shared->isLoaded.loadAcquire()) {
+        return !shared->lcmsProfile.isNull();
+    }
+
+    QMutexLocker l(&shared->loadMutex);
+
+    if (!shared->isLoaded.load()) {
+        QFile file(fileName());
+        if (file.open(QIODevice::ReadOnly)) {
+            shared->data->setRawData(file.readAll());
+            file.close();
+
+            shared->lcmsProfile.reset(new LcmsColorProfileContainer(shared->data.data()));
+
+            if (shared->lcmsProfile->init() && shared->lcmsProfile->valid()) {
+                const_cast<IccColorProfile*>(this)->calculateFloatUIMinMax();
+            } else {
+                shared->lcmsProfile.reset();
+            }
+        }
+
+        if (!shared->lcmsProfile) {
+            qWarning() << "Failed to load indexed profile from " << fileName();
+        }
+
+        shared->isLoaded.storeRelease(1);
+    }
+
+    return !shared->lcmsProfile.isNull();
+}
+
+IccColorProfile::Metadata IccColorProfile::metadata() const
+{
+    if (d->shared->metadata) {
+        return *d->shared->metadata;
+    }
+
+    Metadata metadata;
+
+    if (d->shared->lcmsProfile) {
+        LcmsColorProfileContainer *lcms = d->shared->lcmsProfile.data();
+
+        metadata.name = name();
+        metadata.info = info();
+        metadata.manufacturer = manufacturer();
+        metadata.copyright = copyright();
+        metadata.uniqueId = lcms->getProfileUniqueId();
+        metadata.colorSpaceSignature = lcms->colorSpaceSignature();
+        metadata.deviceClass = lcms->deviceClass();
+        metadata.version = lcms->version();
+        metadata.isSuitableForOutput = lcms->isSuitableForOutput();
+        metadata.isSuitableForPrinting = lcms->isSuitableForPrinting();
+        metadata.isSuitableForDisplay = lcms->isSuitableForDisplay();
+        metadata.hasColorants = lcms->hasColorants();
+        metadata.hasTRC = lcms->hasTRC();
+        metadata.isLinear = lcms->isLinear();
+        metadata.colorantsXYZ = lcms->getColorantsXYZ();
+        metadata.whitePointXYZ = lcms->getWhitePointXYZ();
+        metadata.estimatedTRC = lcms->getEstimatedTRC();
+    }
+
+    return metadata;
+}
+
+quint32 IccColorProfile::colorSpaceSignature() const
+{
+    if (d->shared->metadata) {
+        return d->shared->metadata->colorSpaceSignature;
+    }
+    return asLcms()->colorSpaceSignature();
+}
+
 bool IccColorProfile::operator==(const KoColorProfile &rhs) const
 {
     const IccColorProfile *rhsIcc = dynamic_cast<const IccColorProfile *>(&rhs);
@@ -332,6 +480,7 @@ bool IccColorProfile::operator==(const KoColorProfile &rhs) const
 
 const QVector<KoChannelInfo::DoubleRange> &IccColorProfile::getFloatUIMinMax(void) const
 {
+    ensureLoaded();
     Q_ASSERT(!d->shared->uiMinMaxes.isEmpty());
     return d->shared->uiMinMaxes;
 }
@@ -76,10 +76,44 @@ public:
         virtual QVector <double> getEstimatedTRC() const = 0;
         virtual QByteArray getProfileUniqueId() const = 0;
     };
+    /**
+     * The properties of the profile that can be known without opening
+     * it with LCMS. They are kept in the profile index, so that the
+     * profiles don't have to be parsed on every start.
+     */
+    struct Metadata {
+        QString name;
+        QString info;
+        QString manufacturer;
+        QString copyright;
+        QByteArray uniqueId;
+        quint32 colorSpaceSignature = 0;
+        quint32 deviceClass = 0;
+        float version = 0.0;
+        bool isSuitableForOutput = false;
+        bool isSuitableForPrinting = false;
+        bool isSuitableForDisplay = false;
+        bool hasColorants = false;
+        bool hasTRC = false;
+        bool isLinear = false;
+        QVector<qreal> colorantsXYZ;
+        QVector<qreal> whitePointXYZ;
+        QVector<qreal> estimatedTRC;
+    };
+
 public:
 
     explicit IccColorProfile(const QString &fileName = QString());
     explicit IccColorProfile(const QByteArray &rawData);
+
+    /**
+     * Creates a valid profile from \p metadata without reading the
+     * file. The file is opened with LCMS only when something not
+     * stored in the metadata is requested for the first time. If that
+     * fails, the profile becomes invalid and asLcms() returns null.
+     */
+    IccColorProfile(const QString &fileName, const Metadata &metadata);
+
     IccColorProfile(const IccColorProfile &rhs);
     ~IccColorProfile() override;
 
@@ -129,13 +163,32 @@ public:
      */
     const QVector<KoChannelInfo::DoubleRange> &getFloatUIMinMax(void) const;
 
+    /**
+     * @return the metadata of the profile to be stored in the profile index
+     */
+    Metadata metadata() const;
+
+    /**
+     * @return the ICC color space signature (cmsColorSpaceSignature)
+     *         without opening the profile if it has been created
+     *         from metadata
+     */
+    quint32 colorSpaceSignature() const;
+
 protected:
     void setRawData(const QByteArray &rawData);
 public:
+    /**
+     * @return the LCMS representation of the profile, or null if the
+     *         profile has been created from metadata and its file
+     *         could not be loaded
+     */
     LcmsColorProfileContainer *asLcms() const;
 protected:
     bool init();
     void calculateFloatUIMinMax(void);
+private:
+    bool ensureLoaded() const;
 private:
     struct Private;
     QScopedPointer<Private> d;
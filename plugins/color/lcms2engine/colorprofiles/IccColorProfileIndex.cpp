@@ -0,0 +1,179 @@
+/*
+ *  Copyright (c) 2020 Krita developers
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+*/
+
+#include "IccColorProfileIndex.h"
+
+#include <QDataStream>
+#include <QDateTime>
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <QSaveFile>
+#include <QSet>
+
+#include "DebugPigment.h"
+
+namespace {
+const quint32 INDEX_MAGIC = 0x4b434958; // "KCIX"
+const quint32 INDEX_VERSION = 1;
+
+struct Entry {
+    qint64 size = -1;
+    QDateTime lastModified;
+    bool valid = false;
+    IccColorProfile::Metadata metadata;
+};
+
+QDataStream &operator<<(QDataStream &stream, const Entry &entry)
+{
+    const IccColorProfile::Metadata &m = entry.metadata;
+
+    stream << entry.size << entry.lastModified << entry.valid
+           << m.name << m.info << m.manufacturer << m.copyright << m.uniqueId
+           << m.colorSpaceSignature << m.deviceClass << m.version
+           << m.isSuitableForOutput << m.isSuitableForPrinting << m.isSuitableForDisplay
+           << m.hasColorants << m.hasTRC << m.isLinear
+           << m.colorantsXYZ << m.whitePointXYZ << m.estimatedTRC;
+
+    return stream;
+}
+
+QDataStream &operator>>(QDataStream &stream, Entry &entry)
+{
+    IccColorProfile::Metadata &m = entry.metadata;
+
+    stream >> entry.size >> entry.lastModified >> entry.valid
+           >> m.name >> m.info >> m.manufacturer >> m.copyright >> m.uniqueId
+           >> m.colorSpaceSignature >> m.deviceClass >> m.version
+           >> m.isSuitableForOutput >> m.isSuitableForPrinting >> m.isSuitableForDisplay
+           >> m.hasColorants >> m.hasTRC >> m.isLinear
+           >> m.colorantsXYZ >> m.whitePointXYZ >> m.estimatedTRC;
+
+    return stream;
+}
+}
+
+struct IccColorProfileIndex::Private
+{
+    QString indexFilename;
+    QHash<QString, Entry> entries;
+    QSet<QString> usedEntries;
+    bool isDirty = false;
+};
+
+IccColorProfileIndex::IccColorProfileIndex(const QString &indexFilename)
+    : m_d(new Private)
+{
+    m_d->indexFilename = indexFilename;
+
+    QFile file(indexFilename);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return;
+    }
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_5_6);
+
+    quint32 magic = 0;
+    quint32 version = 0;
+    stream >> magic >> version;
+
+    if (magic != INDEX_MAGIC || version != INDEX_VERSION) {
+        dbgPigment << "Ignoring profile index of unknown format" << indexFilename;
+        return;
+    }
+
+    QHash<QString, Entry> entries;
+    stream >> entries;
+
+    if (stream.status() != QDataStream::Ok) {
+        warnPigment << "Could not read profile index" << indexFilename;
+        return;
+    }
+
+    m_d->entries = entries;
+}
+
+IccColorProfileIndex::~IccColorProfileIndex()
+{
+}
+
+bool IccColorProfileIndex::lookup(const QString &filename, bool *valid, IccColorProfile::Metadata *metadata)
+{
+    auto it = m_d->entries.constFind(filename);
+    if (it == m_d->entries.constEnd()) return false;
+
+    QFileInfo info(filename);
+    if (info.size() != it->size || info.lastModified() != it->lastModified) {
+        return false;
+    }
+
+    m_d->usedEntries.insert(filename);
+
+    *valid = it->valid;
+    *metadata = it->metadata;
+    return true;
+}
+
+void IccColorProfileIndex::update(const QString &filename, bool valid, const IccColorProfile::Metadata &metadata)
+{
+    QFileInfo info(filename);
+
+    Entry entry;
+    entry.size = info.size();
+    entry.lastModified = info.lastModified();
+    entry.valid = valid;
+    entry.metadata = metadata;
+
+    m_d->entries[filename] = entry;
+    m_d->usedEntries.insert(filename);
+    m_d->isDirty = true;
+}
+
+bool IccColorProfileIndex::save()
+{
+    for (auto it = m_d->entries.begin(); it != m_d->entries.end();) {
+        if (!m_d->usedEntries.contains(it.key())) {
+            it = m_d->entries.erase(it);
+            m_d->isDirty = true;
+        } else {
+            ++it;
+        }
+    }
+
+    if (!m_d->isDirty) return true;
+
+    QSaveFile file(m_d->indexFilename);
+    if (!file.open(QIODevice::WriteOnly)) {
+        warnPigment << "Could not write profile index" << m_d->indexFilename;
+        return false;
+    }
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_5_6);
+    stream << INDEX_MAGIC << INDEX_VERSION << m_d->entries;
+
+    if (stream.status() != QDataStream::Ok || !file.commit()) {
+        warnPigment << "Could not write profile index" << m_d->indexFilename;
+        return false;
+    }
+
+    m_d->isDirty = false;
+    return true;
+}
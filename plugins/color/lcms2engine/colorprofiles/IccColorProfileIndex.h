@@ -0,0 +1,62 @@
+/*
+ *  Copyright (c) 2020 Krita developers
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+*/
+
+#ifndef _ICC_COLOR_PROFILE_INDEX_H_
+#define _ICC_COLOR_PROFILE_INDEX_H_
+
+#include <QScopedPointer>
+#include <QString>
+
+#include "IccColorProfile.h"
+
+/**
+ * A persistent cache of the profiles found by LcmsEnginePlugin on
+ * startup. For every profile file it keeps the size and the modification
+ * time of the file and the metadata of the profile, so that unchanged
+ * profiles can be registered without opening them with LCMS. Broken
+ * profiles are remembered as well, so that they are not tried again.
+ */
+class IccColorProfileIndex
+{
+public:
+    explicit IccColorProfileIndex(const QString &indexFilename);
+    ~IccColorProfileIndex();
+
+    /**
+     * Fetches the entry of \p filename.
+     *
+     * @return true if the entry exists and the file has not
+     *         been changed since the entry was written
+     */
+    bool lookup(const QString &filename, bool *valid, IccColorProfile::Metadata *metadata);
+
+    void update(const QString &filename, bool valid, const IccColorProfile::Metadata &metadata);
+
+    /**
+     * Writes the index to disk if it has been changed. The entries of the
+     * files that have not been looked up or updated are dropped.
+     */
+    bool save();
+
+private:
+    struct Private;
+    const QScopedPointer<Private> m_d;
+};
+
+#endif
@@ -0,0 +1,254 @@
+/*
+ *  Copyright (c) 2020 Krita developers
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include "TestIccColorProfileIndex.h"
+
+#include <QTest>
+#include <QFile>
+#include <QScopedPointer>
+#include <QTemporaryDir>
+
+#include <lcms2.h>
+
+#include "IccColorProfile.h"
+#include "IccColorProfileIndex.h"
+
+namespace {
+
+QByteArray sRgbProfileData()
+{
+    cmsHPROFILE profile = cmsCreate_sRGBProfile();
+
+    cmsUInt32Number size = 0;
+    cmsSaveProfileToMem(profile, 0, &size);
+
+    QByteArray data(size, 0);
+    cmsSaveProfileToMem(profile, data.data(), &size);
+    cmsCloseProfile(profile);
+
+    return data;
+}
+
+bool writeFile(const QString &fileName, const QByteArray &data)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly)) return false;
+    return file.write(data) == data.size();
+}
+
+IccColorProfile::Metadata sRgbMetadata()
+{
+    IccColorProfile profile(sRgbProfileData());
+    return profile.metadata();
+}
+
+void compareMetadata(const IccColorProfile::Metadata &a, const IccColorProfile::Metadata &b)
+{
+    QCOMPARE(a.name, b.name);
+    QCOMPARE(a.uniqueId, b.uniqueId);
+    QCOMPARE(a.colorSpaceSignature, b.colorSpaceSignature);
+    QCOMPARE(a.deviceClass, b.deviceClass);
+    QCOMPARE(a.isSuitableForDisplay, b.isSuitableForDisplay);
+    QCOMPARE(a.hasColorants, b.hasColorants);
+    QCOMPARE(a.hasTRC, b.hasTRC);
+    QCOMPARE(a.isLinear, b.isLinear);
+    QCOMPARE(a.colorantsXYZ, b.colorantsXYZ);
+    QCOMPARE(a.whitePointXYZ, b.whitePointXYZ);
+    QCOMPARE(a.estimatedTRC, b.estimatedTRC);
+}
+
+}
+
+void TestIccColorProfileIndex::testLookup()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+
+    const QString profileFile = dir.filePath("srgb.icc");
+    QVERIFY(writeFile(profileFile, sRgbProfileData()));
+
+    IccColorProfileIndex index(dir.filePath("icc_profiles.index"));
+
+    bool valid = false;
+    IccColorProfile::Metadata metadata;
+
+    QVERIFY(!index.lookup(profileFile, &valid, &metadata));
+
+    const IccColorProfile::Metadata expected = sRgbMetadata();
+    QVERIFY(!expected.name.isEmpty());
+    QCOMPARE(expected.colorSpaceSignature, quint32(cmsSigRgbData));
+
+    index.update(profileFile, true, expected);
+
+    QVERIFY(index.lookup(profileFile, &valid, &metadata));
+    QVERIFY(valid);
+    compareMetadata(metadata, expected);
+}
+
+void TestIccColorProfileIndex::testUpdateAndSave()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+
+    const QString indexFile = dir.filePath("icc_profiles.index");
+    const QString profileFile = dir.filePath("srgb.icc");
+    QVERIFY(writeFile(profileFile, sRgbProfileData()));
+
+    const IccColorProfile::Metadata expected = sRgbMetadata();
+
+    {
+        IccColorProfileIndex index(indexFile);
+        index.update(profileFile, true, expected);
+        QVERIFY(index.save());
+    }
+
+    QVERIFY(QFile::exists(indexFile));
+
+    IccColorProfileIndex index(indexFile);
+
+    bool valid = false;
+    IccColorProfile::Metadata metadata;
+
+    QVERIFY(index.lookup(profileFile, &valid, &metadata));
+    QVERIFY(valid);
+    compareMetadata(metadata, expected);
+
+    // the profile created from the index works without reading the file first
+    IccColorProfile profile(profileFile, metadata);
+    QVERIFY(profile.valid());
+    QCOMPARE(profile.name(), expected.name);
+    QCOMPARE(profile.colorSpaceSignature(), expected.colorSpaceSignature);
+    QVERIFY(profile.asLcms());
+    QVERIFY(profile.valid());
+}
+
+void TestIccColorProfileIndex::testStaleEntry()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+
+    const QString indexFile = dir.filePath("icc_profiles.index");
+    const QString profileFile = dir.filePath("srgb.icc");
+    const QByteArray profileData = sRgbProfileData();
+    QVERIFY(writeFile(profileFile, profileData));
+
+    {
+        IccColorProfileIndex index(indexFile);
+        index.update(profileFile, true, sRgbMetadata());
+        QVERIFY(index.save());
+    }
+
+    // the file is replaced by a different one
+    QVERIFY(writeFile(profileFile, profileData + QByteArray(16, '\0')));
+
+    IccColorProfileIndex index(indexFile);
+
+    bool valid = false;
+    IccColorProfile::Metadata metadata;
+    QVERIFY(!index.lookup(profileFile, &valid, &metadata));
+
+    // ...and the removed files are not found either
+    QVERIFY(QFile::remove(profileFile));
+    QVERIFY(!index.lookup(profileFile, &valid, &metadata));
+}
+
+void TestIccColorProfileIndex::testUnusedEntriesDropped()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+
+    const QString indexFile = dir.filePath("icc_profiles.index");
+    const QString usedFile = dir.filePath("used.icc");
+    const QString unusedFile = dir.filePath("unused.icc");
+    QVERIFY(writeFile(usedFile, sRgbProfileData()));
+    QVERIFY(writeFile(unusedFile, sRgbProfileData()));
+
+    const IccColorProfile::Metadata expected = sRgbMetadata();
+
+    {
+        IccColorProfileIndex index(indexFile);
+        index.update(usedFile, true, expected);
+        index.update(unusedFile, true, expected);
+        QVERIFY(index.save());
+    }
+
+    bool valid = false;
+    IccColorProfile::Metadata metadata;
+
+    {
+        IccColorProfileIndex index(indexFile);
+        QVERIFY(index.lookup(usedFile, &valid, &metadata));
+        QVERIFY(index.save());
+    }
+
+    IccColorProfileIndex index(indexFile);
+    QVERIFY(index.lookup(usedFile, &valid, &metadata));
+    QVERIFY(!index.lookup(unusedFile, &valid, &metadata));
+}
+
+void TestIccColorProfileIndex::testBrokenProfileEntry()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+
+    const QString indexFile = dir.filePath("icc_profiles.index");
+    const QString profileFile = dir.filePath("broken.icc");
+    QVERIFY(writeFile(profileFile, QByteArray("not a profile")));
+
+    {
+        IccColorProfileIndex index(indexFile);
+        index.update(profileFile, false, IccColorProfile::Metadata());
+        QVERIFY(index.save());
+    }
+
+    IccColorProfileIndex index(indexFile);
+
+    bool valid = true;
+    IccColorProfile::Metadata metadata;
+    QVERIFY(index.lookup(profileFile, &valid, &metadata));
+    QVERIFY(!valid);
+}
+
+void TestIccColorProfileIndex::testFailedLazyLoad()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+
+    const QString profileFile = dir.filePath("srgb.icc");
+    QVERIFY(writeFile(profileFile, sRgbProfileData()));
+
+    const IccColorProfile::Metadata metadata = sRgbMetadata();
+
+    IccColorProfile profile(profileFile, metadata);
+    QScopedPointer<KoColorProfile> clone(profile.clone());
+
+    // the file gets broken after it has been indexed
+    QVERIFY(writeFile(profileFile, QByteArray("not a profile")));
+
+    QVERIFY(profile.valid());
+    QCOMPARE(profile.name(), metadata.name);
+
+    QVERIFY(!profile.asLcms());
+    QVERIFY(!profile.valid());
+
+    // the clones share the loading state
+    QVERIFY(!clone->valid());
+    QVERIFY(!dynamic_cast<IccColorProfile*>(clone.data())->asLcms());
+}
+
+QTEST_GUILESS_MAIN(TestIccColorProfileIndex)
@@ -0,0 +1,172 @@
+/*
+ *  Copyright (c) 2020 Krita developers
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include "TestLcmsHalfFloatConversion.h"
+
+#include <QTest>
+#include <QScopedPointer>
+#include <QVector>
+
+#include <KoConfig.h>
+#include "sdk/tests/kistest.h"
+
+#include <KoColorSpaceRegistry.h>
+#include <KoColorModelStandardIds.h>
+#include <KoColorProfile.h>
+#include <KoColorConversionTransformation.h>
+
+#ifdef HAVE_OPENEXR
+#include <half.h>
+#include <lcms2.h>
+
+#include "LcmsColorSpace.h"
+
+namespace {
+
+const int NUM_PIXELS = 1001;
+
+/**
+ * Converts the pixels with lcms directly, the way the engine did before
+ * the F16 <-> F32 conversions got their own transformation
+ */
+QVector<quint8> convertWithLcms(const KoColorSpace *srcCs, const KoColorSpace *dstCs, const QVector<quint8> &src)
+{
+    const KoLcmsInfo *srcInfo = dynamic_cast<const KoLcmsInfo*>(srcCs);
+    const KoLcmsInfo *dstInfo = dynamic_cast<const KoLcmsInfo*>(dstCs);
+    if (!srcInfo || !dstInfo) return QVector<quint8>();
+
+    const QByteArray rawData = srcCs->profile()->rawData();
+    cmsHPROFILE profile = cmsOpenProfileFromMem(rawData.constData(), rawData.size());
+    if (!profile) return QVector<quint8>();
+
+    const KoColorConversionTransformation::ConversionFlags flags =
+        KoColorConversionTransformation::internalConversionFlags() |
+        KoColorConversionTransformation::CopyAlpha;
+
+    cmsHTRANSFORM transform =
+        cmsCreateTransform(profile, srcInfo->colorSpaceType(),
+                           profile, dstInfo->colorSpaceType(),
+                           KoColorConversionTransformation::internalRenderingIntent(),
+                           flags);
+
+    QVector<quint8> dst;
+
+    if (transform) {
+        dst.resize(NUM_PIXELS * dstCs->pixelSize());
+        cmsDoTransform(transform, src.constData(), dst.data(), NUM_PIXELS);
+        cmsDeleteTransform(transform);
+    }
+
+    cmsCloseProfile(profile);
+
+    return dst;
+}
+
+float channelValue(const KoColorSpace *cs, const QVector<quint8> &pixels, int index)
+{
+    if (cs->colorDepthId() == Float16BitsColorDepthID) {
+        return reinterpret_cast<const half*>(pixels.constData())[index];
+    } else {
+        return reinterpret_cast<const float*>(pixels.constData())[index];
+    }
+}
+
+}
+
+#endif
+
+void TestLcmsHalfFloatConversion::testConversion_data()
+{
+    QTest::addColumn<QString>("colorModelId");
+    QTest::addColumn<QString>("srcDepthId");
+    QTest::addColumn<QString>("dstDepthId");
+
+    QTest::newRow("rgba-f16-to-f32") << RGBAColorModelID.id() << Float16BitsColorDepthID.id() << Float32BitsColorDepthID.id();
+    QTest::newRow("rgba-f32-to-f16") << RGBAColorModelID.id() << Float32BitsColorDepthID.id() << Float16BitsColorDepthID.id();
+    QTest::newRow("graya-f16-to-f32") << GrayAColorModelID.id() << Float16BitsColorDepthID.id() << Float32BitsColorDepthID.id();
+    QTest::newRow("graya-f32-to-f16") << GrayAColorModelID.id() << Float32BitsColorDepthID.id() << Float16BitsColorDepthID.id();
+}
+
+void TestLcmsHalfFloatConversion::testConversion()
+{
+#ifdef HAVE_OPENEXR
+    QFETCH(QString, colorModelId);
+    QFETCH(QString, srcDepthId);
+    QFETCH(QString, dstDepthId);
+
+    KoColorSpaceRegistry *registry = KoColorSpaceRegistry::instance();
+
+    // both color spaces must have the same profile to get the batch conversion
+    const KoColorSpace *f32Cs = registry->colorSpace(colorModelId, Float32BitsColorDepthID.id(), 0);
+    QVERIFY(f32Cs);
+
+    const KoColorSpace *srcCs = registry->colorSpace(colorModelId, srcDepthId, f32Cs->profile());
+    const KoColorSpace *dstCs = registry->colorSpace(colorModelId, dstDepthId, f32Cs->profile());
+    QVERIFY(srcCs);
+    QVERIFY(dstCs);
+
+    const int channelCount = srcCs->channelCount();
+    const int numValues = NUM_PIXELS * channelCount;
+
+    QVector<quint8> src(NUM_PIXELS * srcCs->pixelSize());
+    for (int i = 0; i < numValues; i++) {
+        // including the values that are not representable in half
+        const float value = float((i * 7919) % 1001) / 1000.0f + (i % 3) * 1e-5f;
+
+        if (srcDepthId == Float16BitsColorDepthID.id()) {
+            reinterpret_cast<half*>(src.data())[i] = half(value);
+        } else {
+            reinterpret_cast<float*>(src.data())[i] = value;
+        }
+    }
+
+    QScopedPointer<KoColorConversionTransformation> transform(
+        srcCs->createColorConverter(dstCs,
+                                    KoColorConversionTransformation::internalRenderingIntent(),
+                                    KoColorConversionTransformation::internalConversionFlags()));
+    QVERIFY(transform);
+
+    QVector<quint8> result(NUM_PIXELS * dstCs->pixelSize());
+    transform->transform(src.constData(), result.data(), NUM_PIXELS);
+
+    const QVector<quint8> expected = convertWithLcms(srcCs, dstCs, src);
+    QCOMPARE(expected.size(), result.size());
+
+    /**
+     * lcms passes the values through its float pipeline, so they may
+     * differ from the direct conversion in one unit in the last place
+     * of half
+     */
+    for (int i = 0; i < numValues; i++) {
+        const float expectedValue = channelValue(dstCs, expected, i);
+        const float resultValue = channelValue(dstCs, result, i);
+        const float tolerance = 1e-3f * qMax(1.0f, qAbs(expectedValue));
+
+        if (qAbs(expectedValue - resultValue) > tolerance) {
+            qDebug() << "Pixel" << i / channelCount << "channel" << i % channelCount
+                     << "source:" << channelValue(srcCs, src, i)
+                     << "expected:" << expectedValue << "result:" << resultValue;
+            QFAIL("the conversion differs from lcms");
+        }
+    }
+#else
+    QSKIP("OpenEXR is not available");
+#endif
+}
+
+KISTEST_MAIN(TestLcmsHalfFloatConversion)
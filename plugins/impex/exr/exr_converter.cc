@@ -26,6 +26,7 @@
 #include <ImfChannelList.h>
 #include <ImfInputFile.h>
 #include <ImfOutputFile.h>
+#include <ImfTiledOutputFile.h>
 
 #include <ImfStringAttribute.h>
 #include "exr_extra_tags.h"
@@ -34,6 +35,7 @@
 #include <QMessageBox>
 #include <QDomDocument>
 #include <QThread>
+#include <QtConcurrent>
 
 #include <QFileInfo>
 
@@ -137,14 +139,14 @@ struct ExrPaintLayerSaveInfo {
 struct EXRConverter::Private {
     Private()
         : doc(0)
-        , alphaWasModified(false)
+        , alphaWasModified(0)
         , showNotifications(false)
     {}
 
     KisImageSP image;
     KisDocument *doc;
 
-    bool alphaWasModified;
+    QAtomicInt alphaWasModified;
     bool showNotifications;
 
     QString errorMessage;
@@ -152,6 +154,9 @@ struct EXRConverter::Private {
     template <class WrapperType>
     void unmultiplyAlpha(typename WrapperType::pixel_type *pixel);
 
+    template <class WrapperType>
+    void unmultiplyAlpha(typename WrapperType::pixel_type *pixels, int numPixels);
+
     template<typename _T_>
     void decodeData4(Imf::InputFile& file, ExrPaintLayerInfo& info, KisPaintLayerSP layer, int width, int xstart, int ystart, int height, Imf::PixelType ptype);
 
@@ -270,6 +275,12 @@ struct RgbPixelWrapper
                  qFuzzyCompare(T(pixel.b * alpha), mult.b));
     }
 
+    inline void divideColors(T divisor) {
+        pixel.r = pixel.r / divisor;
+        pixel.g = pixel.g / divisor;
+        pixel.b = pixel.b / divisor;
+    }
+
     inline void setUnmultiplied(const Rgba<T> &mult, T newAlpha) {
         const T absoluteAlpha = std::abs(newAlpha);
 
@@ -306,6 +317,10 @@ struct GrayPixelWrapper
                 qFuzzyCompare(T(pixel.gray * alpha), mult.gray);
     }
 
+    inline void divideColors(T divisor) {
+        pixel.gray = pixel.gray / divisor;
+    }
+
     inline void setUnmultiplied(const pixel_type &mult, T newAlpha) {
         const T absoluteAlpha = std::abs(newAlpha);
 
@@ -343,7 +358,7 @@ void EXRConverter::Private::unmultiplyAlpha(typename WrapperType::pixel_type *pi
             }
 
             newAlpha += alphaEpsilon<channel_type>();
-            alphaWasModified = true;
+            alphaWasModified = 1;
         }
 
         *pixel = dstPixel.pixel;
@@ -354,77 +369,158 @@ void EXRConverter::Private::unmultiplyAlpha(typename WrapperType::pixel_type *pi
     }
 }
 
-template <typename T, typename Pixel, int size, int alphaPos>
-void multiplyAlpha(Pixel *pixel)
+template <class WrapperType>
+void EXRConverter::Private::unmultiplyAlpha(typename WrapperType::pixel_type *pixels, int numPixels)
 {
-    if (alphaPos >= 0) {
-        T alpha = pixel->data[alphaPos];
+    typedef typename WrapperType::channel_type channel_type;
 
-        if (alpha > 0.0) {
-            for (int i = 0; i < size; ++i) {
-                if (i != alphaPos) {
-                    pixel->data[i] *= alpha;
-                }
+    const channel_type epsilon = alphaEpsilon<channel_type>();
+    bool hasTinyAlpha = false;
+
+    /**
+     * The pixels with alpha above the epsilon are unmultiplied in a loop
+     * without branches (the rest of the pixels are divided by 1.0), so
+     * the compiler can vectorize it for float channels. The results are
+     * exactly the same as the ones of the per-pixel version.
+     */
+    for (int i = 0; i < numPixels; ++i) {
+        WrapperType pixel(pixels[i]);
+
+        const channel_type alpha = pixel.alpha();
+        hasTinyAlpha |= std::abs(alpha) < epsilon;
+        pixel.divideColors(alpha >= epsilon ? alpha : channel_type(1.0));
+    }
+
+    /**
+     * The pixels with a tiny alpha are still untouched, they may need
+     * the alpha to be adjusted, so process them with the safe algorithm
+     */
+    if (hasTinyAlpha) {
+        for (int i = 0; i < numPixels; ++i) {
+            if (std::abs(WrapperType(pixels[i]).alpha()) < epsilon) {
+                unmultiplyAlpha<WrapperType>(pixels + i);
             }
+        }
+    }
+}
+
+template <typename T, typename Pixel, int size, int alphaPos>
+void multiplyAlpha(Pixel *pixels, int numPixels)
+{
+    if (alphaPos < 0) return;
 
-            pixel->data[alphaPos] = alpha;
+    /**
+     * The loop has no branches (fully transparent pixels are multiplied
+     * by 1.0), so the compiler can vectorize it for float channels.
+     */
+    for (int p = 0; p < numPixels; ++p) {
+        Pixel *pixel = pixels + p;
+
+        const T alpha = pixel->data[alphaPos];
+        const T factor = alpha > T(0.0) ? alpha : T(1.0);
+
+        for (int i = 0; i < size; ++i) {
+            if (i != alphaPos) {
+                pixel->data[i] *= factor;
+            }
         }
     }
 }
 
+/**
+ * The number of scanlines passed to OpenEXR in a single call. The
+ * library decodes and encodes the line blocks of one call in its
+ * global thread pool, so the strips should be big enough to feed all
+ * the threads, but we still avoid buffering the whole layer. The
+ * height is aligned to the tile size of the paint device.
+ */
+int stripHeight(int width, int pixelSize)
+{
+    const int tileSize = 64;
+    const qint64 maxStripBytes = 16 * 1024 * 1024;
+
+    const int rows = maxStripBytes / qMax(qint64(1), qint64(width) * pixelSize);
+    return qMax(tileSize, rows / tileSize * tileSize);
+}
+
+/**
+ * Calls \p func(firstRow, numRows) for chunks of \p numRows rows
+ * in parallel
+ */
+template <typename Func>
+void processRowsInParallel(int numRows, Func func)
+{
+    const int chunkSize = 16;
+
+    QVector<int> chunks;
+    for (int row = 0; row < numRows; row += chunkSize) {
+        chunks << row;
+    }
+
+    QtConcurrent::blockingMap(chunks,
+        [&] (int row) {
+            func(row, qMin(chunkSize, numRows - row));
+        });
+}
+
 template<typename _T_>
 void EXRConverter::Private::decodeData4(Imf::InputFile& file, ExrPaintLayerInfo& info, KisPaintLayerSP layer, int width, int xstart, int ystart, int height, Imf::PixelType ptype)
 {
     typedef Rgba<_T_> Rgba;
 
-    QVector<Rgba> pixels(width * height);
+    // the buffer is written into the device as is
+    Q_STATIC_ASSERT(sizeof(Rgba) == sizeof(typename KoRgbTraits<_T_>::Pixel));
+    KIS_ASSERT_RECOVER_RETURN(layer->paintDevice()->pixelSize() == sizeof(Rgba));
+
+    const int linesPerStrip = stripHeight(width, sizeof(Rgba));
+    QVector<Rgba> pixels(width * linesPerStrip);
 
     bool hasAlpha = info.channelMap.contains("A");
 
-    Imf::FrameBuffer frameBuffer;
-    Rgba* frameBufferData = (pixels.data()) - xstart - ystart * width;
-    frameBuffer.insert(info.channelMap["R"].toLatin1().constData(),
-            Imf::Slice(ptype, (char *) &frameBufferData->r,
-                       sizeof(Rgba) * 1,
-                       sizeof(Rgba) * width));
-    frameBuffer.insert(info.channelMap["G"].toLatin1().constData(),
-            Imf::Slice(ptype, (char *) &frameBufferData->g,
-                       sizeof(Rgba) * 1,
-                       sizeof(Rgba) * width));
-    frameBuffer.insert(info.channelMap["B"].toLatin1().constData(),
-            Imf::Slice(ptype, (char *) &frameBufferData->b,
-                       sizeof(Rgba) * 1,
-                       sizeof(Rgba) * width));
-    if (hasAlpha) {
-        frameBuffer.insert(info.channelMap["A"].toLatin1().constData(),
-                Imf::Slice(ptype, (char *) &frameBufferData->a,
+    for (int stripStart = ystart; stripStart < ystart + height; stripStart += linesPerStrip) {
+        const int numLines = qMin(linesPerStrip, ystart + height - stripStart);
+
+        Imf::FrameBuffer frameBuffer;
+        Rgba* frameBufferData = (pixels.data()) - xstart - stripStart * width;
+        frameBuffer.insert(info.channelMap["R"].toLatin1().constData(),
+                Imf::Slice(ptype, (char *) &frameBufferData->r,
+                           sizeof(Rgba) * 1,
+                           sizeof(Rgba) * width));
+        frameBuffer.insert(info.channelMap["G"].toLatin1().constData(),
+                Imf::Slice(ptype, (char *) &frameBufferData->g,
+                           sizeof(Rgba) * 1,
+                           sizeof(Rgba) * width));
+        frameBuffer.insert(info.channelMap["B"].toLatin1().constData(),
+                Imf::Slice(ptype, (char *) &frameBufferData->b,
                            sizeof(Rgba) * 1,
                            sizeof(Rgba) * width));
-    }
-
-    file.setFrameBuffer(frameBuffer);
-    file.readPixels(ystart, height + ystart - 1);
-    Rgba *rgba = pixels.data();
-
-    QRect paintRegion(xstart, ystart, width, height);
-    KisSequentialIterator it(layer->paintDevice(), paintRegion);
-    while (it.nextPixel()) {
         if (hasAlpha) {
-            unmultiplyAlpha<RgbPixelWrapper<_T_> >(rgba);
+            frameBuffer.insert(info.channelMap["A"].toLatin1().constData(),
+                    Imf::Slice(ptype, (char *) &frameBufferData->a,
+                               sizeof(Rgba) * 1,
+                               sizeof(Rgba) * width));
         }
 
-        typename KoRgbTraits<_T_>::Pixel* dst = reinterpret_cast<typename KoRgbTraits<_T_>::Pixel*>(it.rawData());
+        file.setFrameBuffer(frameBuffer);
+        file.readPixels(stripStart, stripStart + numLines - 1);
+
+        processRowsInParallel(numLines,
+            [&] (int firstRow, int numRows) {
+                Rgba *rgba = pixels.data() + firstRow * width;
 
-        dst->red = rgba->r;
-        dst->green = rgba->g;
-        dst->blue = rgba->b;
-        if (hasAlpha) {
-            dst->alpha = rgba->a;
-        } else {
-            dst->alpha = 1.0;
-        }
+                if (hasAlpha) {
+                    unmultiplyAlpha<RgbPixelWrapper<_T_> >(rgba, numRows * width);
+                } else {
+                    Rgba *end = rgba + numRows * width;
+
+                    for (; rgba != end; ++rgba) {
+                        rgba->a = 1.0;
+                    }
+                }
+            });
 
-        ++rgba;
+        layer->paintDevice()->writeBytes(reinterpret_cast<const quint8*>(pixels.constData()),
+                                         QRect(xstart, stripStart, width, numLines));
     }
 }
 
@@ -436,8 +532,10 @@ void EXRConverter::Private::decodeData1(Imf::InputFile& file, ExrPaintLayerInfo&
 
     KIS_ASSERT_RECOVER_RETURN(
                 layer->paintDevice()->colorSpace()->colorModelId() == GrayAColorModelID);
+    KIS_ASSERT_RECOVER_RETURN(layer->paintDevice()->pixelSize() == sizeof(pixel_type));
 
-    QVector<pixel_type> pixels(width * height);
+    const int linesPerStrip = stripHeight(width, sizeof(pixel_type));
+    QVector<pixel_type> pixels(width * linesPerStrip);
 
     Q_ASSERT(info.channelMap.contains("G"));
     dbgFile << "G -> " << info.channelMap["G"];
@@ -445,41 +543,44 @@ void EXRConverter::Private::decodeData1(Imf::InputFile& file, ExrPaintLayerInfo&
     bool hasAlpha = info.channelMap.contains("A");
     dbgFile << "Has Alpha:" << hasAlpha;
 
+    for (int stripStart = ystart; stripStart < ystart + height; stripStart += linesPerStrip) {
+        const int numLines = qMin(linesPerStrip, ystart + height - stripStart);
 
-    Imf::FrameBuffer frameBuffer;
-    pixel_type* frameBufferData = (pixels.data()) - xstart - ystart * width;
-    frameBuffer.insert(info.channelMap["G"].toLatin1().constData(),
-            Imf::Slice(ptype, (char *) &frameBufferData->gray,
-                       sizeof(pixel_type) * 1,
-                       sizeof(pixel_type) * width));
-
-    if (hasAlpha) {
-        frameBuffer.insert(info.channelMap["A"].toLatin1().constData(),
-                Imf::Slice(ptype, (char *) &frameBufferData->alpha,
+        Imf::FrameBuffer frameBuffer;
+        pixel_type* frameBufferData = (pixels.data()) - xstart - stripStart * width;
+        frameBuffer.insert(info.channelMap["G"].toLatin1().constData(),
+                Imf::Slice(ptype, (char *) &frameBufferData->gray,
                            sizeof(pixel_type) * 1,
                            sizeof(pixel_type) * width));
-    }
-
-    file.setFrameBuffer(frameBuffer);
-    file.readPixels(ystart, height + ystart - 1);
-
-    pixel_type *srcPtr = pixels.data();
-
-    QRect paintRegion(xstart, ystart, width, height);
-    KisSequentialIterator it(layer->paintDevice(), paintRegion);
-    do {
 
         if (hasAlpha) {
-            unmultiplyAlpha<GrayPixelWrapper<_T_> >(srcPtr);
+            frameBuffer.insert(info.channelMap["A"].toLatin1().constData(),
+                    Imf::Slice(ptype, (char *) &frameBufferData->alpha,
+                               sizeof(pixel_type) * 1,
+                               sizeof(pixel_type) * width));
         }
 
-        pixel_type* dstPtr = reinterpret_cast<pixel_type*>(it.rawData());
+        file.setFrameBuffer(frameBuffer);
+        file.readPixels(stripStart, stripStart + numLines - 1);
+
+        processRowsInParallel(numLines,
+            [&] (int firstRow, int numRows) {
+                pixel_type *srcPtr = pixels.data() + firstRow * width;
 
-        dstPtr->gray = srcPtr->gray;
-        dstPtr->alpha = hasAlpha ? srcPtr->alpha : channel_type(1.0);
+                if (hasAlpha) {
+                    unmultiplyAlpha<GrayPixelWrapper<_T_> >(srcPtr, numRows * width);
+                } else {
+                    pixel_type *end = srcPtr + numRows * width;
+
+                    for (; srcPtr != end; ++srcPtr) {
+                        srcPtr->alpha = channel_type(1.0);
+                    }
+                }
+            });
 
-        ++srcPtr;
-    } while (it.nextPixel());
+        layer->paintDevice()->writeBytes(reinterpret_cast<const quint8*>(pixels.constData()),
+                                         QRect(xstart, stripStart, width, numLines));
+    }
 }
 
 bool recCheckGroup(const ExrGroupLayerInfo& group, QStringList list, int idx1, int idx2)
@@ -953,7 +1054,7 @@ class Encoder
 public:
     virtual ~Encoder() {}
     virtual void prepareFrameBuffer(Imf::FrameBuffer*, int line) = 0;
-    virtual void encodeData(int line) = 0;
+    virtual void encodeData(int line, int numLines) = 0;
 
 };
 
@@ -961,13 +1062,12 @@ template<typename _T_, int size, int alphaPos>
 class EncoderImpl : public Encoder
 {
 public:
-    EncoderImpl(Imf::OutputFile* _file, const ExrPaintLayerSaveInfo* _info, int width) : file(_file), info(_info), pixels(width), m_width(width) {}
+    EncoderImpl(const ExrPaintLayerSaveInfo* _info, int width, int linesPerStrip) : info(_info), pixels(width * linesPerStrip), m_width(width) {}
     ~EncoderImpl() override {}
     void prepareFrameBuffer(Imf::FrameBuffer*, int line) override;
-    void encodeData(int line) override;
+    void encodeData(int line, int numLines) override;
 private:
     typedef ExrPixel_<_T_, size> ExrPixel;
-    Imf::OutputFile* file;
     const ExrPaintLayerSaveInfo* info;
     QVector<ExrPixel> pixels;
     int m_width;
@@ -988,56 +1088,53 @@ void EncoderImpl<_T_, size, alphaPos>::prepareFrameBuffer(Imf::FrameBuffer* fram
 }
 
 template<typename _T_, int size, int alphaPos>
-void EncoderImpl<_T_, size, alphaPos>::encodeData(int line)
+void EncoderImpl<_T_, size, alphaPos>::encodeData(int line, int numLines)
 {
-    ExrPixel *rgba = pixels.data();
-    KisHLineConstIteratorSP it = info->layerDevice->createHLineConstIteratorNG(0, line, m_width);
-    do {
-        const _T_* dst = reinterpret_cast < const _T_* >(it->oldRawData());
+    KIS_ASSERT_RECOVER_RETURN(info->layerDevice->pixelSize() == sizeof(ExrPixel));
 
-        for (int i = 0; i < size; ++i) {
-            rgba->data[i] = dst[i];
-        }
-
-        if (alphaPos != -1) {
-            multiplyAlpha<_T_, ExrPixel, size, alphaPos>(rgba);
-        }
+    info->layerDevice->readBytes(reinterpret_cast<quint8*>(pixels.data()),
+                                 QRect(0, line, m_width, numLines));
 
-        ++rgba;
-    } while (it->nextPixel());
+    if (alphaPos != -1) {
+        processRowsInParallel(numLines,
+            [this] (int firstRow, int numRows) {
+                multiplyAlpha<_T_, ExrPixel, size, alphaPos>(pixels.data() + firstRow * m_width,
+                                                             numRows * m_width);
+            });
+    }
 }
 
-Encoder* encoder(Imf::OutputFile& file, const ExrPaintLayerSaveInfo& info, int width)
+Encoder* encoder(const ExrPaintLayerSaveInfo& info, int width, int linesPerStrip)
 {
     dbgFile << "Create encoder for" << info.name << info.channels << info.layerDevice->colorSpace()->channelCount();
     switch (info.layerDevice->colorSpace()->channelCount()) {
     case 1: {
         if (info.layerDevice->colorSpace()->colorDepthId() == Float16BitsColorDepthID) {
             Q_ASSERT(info.pixelType == Imf::HALF);
-            return new EncoderImpl < half, 1, -1 > (&file, &info, width);
+            return new EncoderImpl < half, 1, -1 > (&info, width, linesPerStrip);
         } else if (info.layerDevice->colorSpace()->colorDepthId() == Float32BitsColorDepthID) {
             Q_ASSERT(info.pixelType == Imf::FLOAT);
-            return new EncoderImpl < float, 1, -1 > (&file, &info, width);
+            return new EncoderImpl < float, 1, -1 > (&info, width, linesPerStrip);
         }
         break;
     }
     case 2: {
         if (info.layerDevice->colorSpace()->colorDepthId() == Float16BitsColorDepthID) {
             Q_ASSERT(info.pixelType == Imf::HALF);
-            return new EncoderImpl<half, 2, 1>(&file, &info, width);
+            return new EncoderImpl<half, 2, 1>(&info, width, linesPerStrip);
         } else if (info.layerDevice->colorSpace()->colorDepthId() == Float32BitsColorDepthID) {
             Q_ASSERT(info.pixelType == Imf::FLOAT);
-            return new EncoderImpl<float, 2, 1>(&file, &info, width);
+            return new EncoderImpl<float, 2, 1>(&info, width, linesPerStrip);
         }
         break;
     }
     case 4: {
         if (info.layerDevice->colorSpace()->colorDepthId() == Float16BitsColorDepthID) {
             Q_ASSERT(info.pixelType == Imf::HALF);
-            return new EncoderImpl<half, 4, 3>(&file, &info, width);
+            return new EncoderImpl<half, 4, 3>(&info, width, linesPerStrip);
         } else if (info.layerDevice->colorSpace()->colorDepthId() == Float32BitsColorDepthID) {
             Q_ASSERT(info.pixelType == Imf::FLOAT);
-            return new EncoderImpl<float, 4, 3>(&file, &info, width);
+            return new EncoderImpl<float, 4, 3>(&info, width, linesPerStrip);
         }
         break;
     }
@@ -1047,27 +1144,73 @@ Encoder* encoder(Imf::OutputFile& file, const ExrPaintLayerSaveInfo& info, int w
     return 0;
 }
 
-void encodeData(Imf::OutputFile& file, const QList<ExrPaintLayerSaveInfo>& informationObjects, int width, int height)
+/**
+ * The size of the tiles of the tiled EXR files. It is the same as the
+ * size of the paint device tiles, so every strip is written as whole
+ * rows of EXR tiles read from whole rows of paint device tiles.
+ */
+const int exrTileSize = 64;
+
+void writeStrip(Imf::OutputFile& file, int /*line*/, int numLines)
+{
+    file.writePixels(numLines);
+}
+
+void writeStrip(Imf::TiledOutputFile& file, int line, int numLines)
 {
+    // OpenEXR compresses the tiles of one call in its thread pool
+    file.writeTiles(0, file.numXTiles() - 1,
+                    line / exrTileSize, (line + numLines - 1) / exrTileSize);
+}
+
+template <class OutputFileType>
+void encodeData(OutputFileType& file, const QList<ExrPaintLayerSaveInfo>& informationObjects, int width, int height)
+{
+    int pixelSize = 0;
+    Q_FOREACH (const ExrPaintLayerSaveInfo& info, informationObjects) {
+        pixelSize += info.layerDevice->pixelSize();
+    }
+
+    const int linesPerStrip = qMin(height, stripHeight(width, pixelSize));
+
     QList<Encoder*> encoders;
     Q_FOREACH (const ExrPaintLayerSaveInfo& info, informationObjects) {
-        encoders.push_back(encoder(file, info, width));
+        encoders.push_back(encoder(info, width, linesPerStrip));
     }
 
-    for (int y = 0; y < height; ++y) {
+    for (int y = 0; y < height; y += linesPerStrip) {
+        const int numLines = qMin(linesPerStrip, height - y);
+
         Imf::FrameBuffer frameBuffer;
         Q_FOREACH (Encoder* encoder, encoders) {
             encoder->prepareFrameBuffer(&frameBuffer, y);
         }
         file.setFrameBuffer(frameBuffer);
         Q_FOREACH (Encoder* encoder, encoders) {
-            encoder->encodeData(y);
+            encoder->encodeData(y, numLines);
         }
-        file.writePixels(1);
+        writeStrip(file, y, numLines);
     }
     qDeleteAll(encoders);
 }
 
+template <class OutputFileType>
+void writeFile(const QString &filename, Imf::Header &header, const QList<ExrPaintLayerSaveInfo>& informationObjects, int width, int height)
+{
+    OutputFileType file(QFile::encodeName(filename), header);
+    encodeData(file, informationObjects, width, height);
+}
+
+void writeFile(const QString &filename, Imf::Header &header, const QList<ExrPaintLayerSaveInfo>& informationObjects, int width, int height, bool tiled)
+{
+    if (tiled) {
+        header.setTileDescription(Imf::TileDescription(exrTileSize, exrTileSize, Imf::ONE_LEVEL));
+        writeFile<Imf::TiledOutputFile>(filename, header, informationObjects, width, height);
+    } else {
+        writeFile<Imf::OutputFile>(filename, header, informationObjects, width, height);
+    }
+}
+
 KisPaintDeviceSP wrapLayerDevice(KisPaintDeviceSP device)
 {
     const KoColorSpace *cs = device->colorSpace();
@@ -1092,7 +1235,7 @@ KisPaintDeviceSP wrapLayerDevice(KisPaintDeviceSP device)
     return device;
 }
 
-KisImportExportErrorCode EXRConverter::buildFile(const QString &filename, KisPaintLayerSP layer)
+KisImportExportErrorCode EXRConverter::buildFile(const QString &filename, KisPaintLayerSP layer, bool tiled)
 {
     KIS_ASSERT_RECOVER_RETURN_VALUE(layer, ImportExportCodes::InternalError);
 
@@ -1128,11 +1271,9 @@ KisImportExportErrorCode EXRConverter::buildFile(const QString &filename, KisPai
 
     // Open file for writing
     try {
-        Imf::OutputFile file(QFile::encodeName(filename), header);
-
         QList<ExrPaintLayerSaveInfo> informationObjects;
         informationObjects.push_back(info);
-        encodeData(file, informationObjects, width, height);
+        writeFile(filename, header, informationObjects, width, height, tiled);
         return ImportExportCodes::OK;
 
     } catch(std::exception &e) {
@@ -1339,7 +1480,7 @@ QString EXRConverter::Private::fetchExtraLayersInfo(QList<ExrPaintLayerSaveInfo>
     return doc.toString();
 }
 
-KisImportExportErrorCode EXRConverter::buildFile(const QString &filename, KisGroupLayerSP layer, bool flatten)
+KisImportExportErrorCode EXRConverter::buildFile(const QString &filename, KisGroupLayerSP layer, bool flatten, bool tiled)
 {
     KIS_ASSERT_RECOVER_RETURN_VALUE(layer, ImportExportCodes::InternalError);
 
@@ -1353,7 +1494,7 @@ KisImportExportErrorCode EXRConverter::buildFile(const QString &filename, KisGro
     if (flatten) {
         KisPaintDeviceSP pd = new KisPaintDevice(*image->projection());
         KisPaintLayerSP l = new KisPaintLayer(image, "projection", OPACITY_OPAQUE_U8, pd);
-        return buildFile(filename, l);
+        return buildFile(filename, l, tiled);
     }
     else {
         QList<ExrPaintLayerSaveInfo> informationObjects;
@@ -1380,8 +1521,7 @@ KisImportExportErrorCode EXRConverter::buildFile(const QString &filename, KisGro
 
         // Open file for writing
         try {
-            Imf::OutputFile file(QFile::encodeName(filename), header);
-            encodeData(file, informationObjects, width, height);
+            writeFile(filename, header, informationObjects, width, height, tiled);
             return ImportExportCodes::OK;
         } catch(std::exception &e) {
             dbgFile << "Exception while writing to exr file: " << e.what();
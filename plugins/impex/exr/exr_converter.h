@@ -37,8 +37,8 @@ public:
     ~EXRConverter() override;
 public:
     KisImportExportErrorCode buildImage(const QString &filename);
-    KisImportExportErrorCode buildFile(const QString &filename, KisPaintLayerSP layer);
-    KisImportExportErrorCode buildFile(const QString &filename, KisGroupLayerSP layer, bool flatten=false);
+    KisImportExportErrorCode buildFile(const QString &filename, KisPaintLayerSP layer, bool tiled=false);
+    KisImportExportErrorCode buildFile(const QString &filename, KisGroupLayerSP layer, bool flatten=false, bool tiled=false);
     /**
      * Retrieve the constructed image
      */
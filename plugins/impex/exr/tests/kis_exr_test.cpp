@@ -24,7 +24,9 @@
 #include  <sdk/tests/kistest.h>
 
 #include <half.h>
+#include <ImfTestFile.h>
 #include <KisMimeDatabase.h>
+#include <kis_properties_configuration.h>
 #include "filestest.h"
 
 #ifndef FILES_DATA_DIR
@@ -53,8 +55,18 @@ void KisExrTest::testImportIncorrectFormat()
     TestUtil::testImportIncorrectFormat(QString(FILES_DATA_DIR), ExrMimetype);
 }
 
+void KisExrTest::testRoundTrip_data()
+{
+    QTest::addColumn<bool>("tiled");
+
+    QTest::newRow("scanlines") << false;
+    QTest::newRow("tiled") << true;
+}
+
 void KisExrTest::testRoundTrip()
 {
+    QFETCH(bool, tiled);
+
     QString inputFileName(TestUtil::fetchDataFileLazy("CandleGlass.exr"));
 
     KisDocument *doc1 = KisPart::instance()->createDocument();
@@ -75,10 +87,18 @@ void KisExrTest::testRoundTrip()
     QString typeName = KisMimeDatabase::mimeTypeForFile(savedFileName, false);
     QByteArray mimeType(typeName.toLatin1());
 
-    r = doc1->exportDocumentSync(QUrl::fromLocalFile(savedFileName), mimeType);
+    KisPropertiesConfigurationSP exportConfiguration = new KisPropertiesConfiguration();
+    exportConfiguration->setProperty("flatten", false);
+    exportConfiguration->setProperty("tiled", tiled);
+
+    r = doc1->exportDocumentSync(QUrl::fromLocalFile(savedFileName), mimeType, exportConfiguration);
     QVERIFY(r);
     QVERIFY(QFileInfo(savedFileName).exists());
 
+    bool isTiled = false;
+    QVERIFY(Imf::isOpenExrFile(QFile::encodeName(savedFileName).constData(), isTiled));
+    QCOMPARE(isTiled, tiled);
+
     {
         KisDocument *doc2 = KisPart::instance()->createDocument();
         doc2->setFileBatchMode(true);
@@ -29,6 +29,7 @@ private Q_SLOTS:
     void testImportFromWriteonly();
     void testExportToReadonly();
     void testImportIncorrectFormat();
+    void testRoundTrip_data();
     void testRoundTrip();
 };
 
@@ -37,6 +37,7 @@
 #include <kis_paint_layer.h>
 #include <kis_png_converter.h>
 #include <KisDocument.h>
+#include <kis_kra_preview_pyramid.h>
 
 static const char CURRENT_DTD_VERSION[] = "2.0";
 
@@ -62,6 +63,19 @@ KisImportExportErrorCode KraConverter::buildImage(QIODevice *io)
         return ImportExportCodes::FileFormatIncorrect;
     }
 
+    if (!m_doc->fileBatchMode()) {
+        /**
+         * Show the user the merged image while the layers are still
+         * being loaded. The level is chosen to be big enough for the
+         * user to zoom into it a bit.
+         */
+        KisKraPreviewPyramid pyramid(m_store);
+        if (pyramid.isValid()) {
+            const int level = pyramid.levelForSize(QSize(2048, 2048));
+            m_doc->setLoadingPreview(pyramid.loadLevel(level));
+        }
+    }
+
     bool success;
     {
         if (m_store->hasFile("root") || m_store->hasFile("maindoc.xml")) {   // Fallback to "old" file format (maindoc.xml)
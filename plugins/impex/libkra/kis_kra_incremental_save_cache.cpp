@@ -0,0 +1,233 @@
+/*
+ *  Copyright (c) 2020 Krita developers
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include "kis_kra_incremental_save_cache.h"
+
+#include <QDomDocument>
+#include <QDomElement>
+#include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QSet>
+#include <QWeakPointer>
+
+#include <KoStore.h>
+
+#include <kis_debug.h>
+#include <kis_datamanager.h>
+#include <kis_paint_device.h>
+
+#include "kis_kra_tags.h"
+
+namespace {
+
+struct SavedDevice {
+    KisDataManagerSP dataManager;
+    QString location;
+};
+
+typedef QHash<QString, SavedDevice> SavedDevicesHash;
+
+struct SaveRecord {
+    QWeakPointer<QObject> documentToken;
+    QString saveId;
+    SavedDevicesHash devices;
+};
+
+struct GlobalStorage {
+    QMutex mutex;
+    QHash<QString, SaveRecord> records;
+    QSet<QObject*> watchedTokens;
+
+    void purgeDeadRecords(QObject *token) {
+        QMutexLocker l(&mutex);
+
+        watchedTokens.remove(token);
+
+        auto it = records.begin();
+        while (it != records.end()) {
+            if (it->documentToken.isNull()) {
+                it = records.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+};
+
+Q_GLOBAL_STATIC(GlobalStorage, s_storage)
+
+bool readEntry(KoStore *store, const QString &name, QByteArray *data)
+{
+    if (!store->open(name)) return false;
+    const qint64 size = store->size();
+    *data = store->read(size);
+    store->close();
+
+    return data->size() == size;
+}
+
+bool writeEntry(KoStore *store, const QString &name, const QByteArray &data)
+{
+    if (!store->open(name)) return false;
+    const bool result = store->write(data) == data.size();
+    store->close();
+
+    return result;
+}
+
+}
+
+struct KisKraIncrementalSaveCache::Private
+{
+    QSharedPointer<QObject> documentToken;
+    QString filename;
+    QString saveId;
+
+    QScopedPointer<KoStore> previousStore;
+    SavedDevicesHash previousDevices;
+    SavedDevicesHash newDevices;
+    QStringList copiedDevices;
+};
+
+KisKraIncrementalSaveCache::KisKraIncrementalSaveCache(QSharedPointer<QObject> documentToken,
+                                                       const QString &filename,
+                                                       const QString &saveId)
+    : m_d(new Private)
+{
+    m_d->documentToken = documentToken;
+    m_d->filename = filename;
+    m_d->saveId = saveId;
+
+    SaveRecord record;
+    {
+        QMutexLocker l(&s_storage->mutex);
+        record = s_storage->records.value(filename);
+    }
+
+    if (!documentToken || record.documentToken != documentToken || record.saveId.isEmpty()) {
+        return;
+    }
+
+    /**
+     * The file might have been overwritten by someone else since our
+     * previous save, so check that it is still the same file
+     */
+    QScopedPointer<KoStore> store(KoStore::createStore(filename, KoStore::Read, "", KoStore::Zip));
+    if (!store || store->bad()) return;
+
+    QByteArray rootData;
+    if (!readEntry(store.data(), "root", &rootData)) return;
+
+    QDomDocument doc;
+    if (!doc.setContent(rootData)) return;
+
+    const QDomElement imageElement = doc.documentElement().firstChildElement("IMAGE");
+    if (imageElement.attribute(KRA::SAVE_ID) != record.saveId) {
+        dbgFile << "The file has been changed since the last save, doing full save of" << filename;
+        return;
+    }
+
+    m_d->previousStore.reset(store.take());
+    m_d->previousDevices = record.devices;
+}
+
+KisKraIncrementalSaveCache::~KisKraIncrementalSaveCache()
+{
+}
+
+bool KisKraIncrementalSaveCache::copyUnchangedDevice(KisPaintDeviceSP device, const QString &key,
+                                                     KoStore *store, const QString &location)
+{
+    if (!m_d->previousStore) return false;
+
+    auto it = m_d->previousDevices.constFind(key);
+    if (it == m_d->previousDevices.constEnd()) return false;
+
+    KisDataManagerSP dataManager = device->dataManager();
+    KisDataManagerSP savedDataManager = it->dataManager;
+
+    if (dataManager->pixelSize() != savedDataManager->pixelSize() ||
+        memcmp(dataManager->defaultPixel(), savedDataManager->defaultPixel(), dataManager->pixelSize()) != 0 ||
+        !dataManager->nonSharedRegion(savedDataManager.data()).isEmpty()) {
+
+        return false;
+    }
+
+    QByteArray tilesData;
+    QByteArray defaultPixelData;
+
+    if (!readEntry(m_d->previousStore.data(), it->location, &tilesData) ||
+        !readEntry(m_d->previousStore.data(), it->location + ".defaultpixel", &defaultPixelData)) {
+
+        warnFile << "Failed to read" << it->location << "from the previous version of" << m_d->filename;
+        return false;
+    }
+
+    if (!writeEntry(store, location, tilesData) ||
+        !writeEntry(store, location + ".defaultpixel", defaultPixelData)) {
+
+        return false;
+    }
+
+    m_d->copiedDevices.append(key);
+    return true;
+}
+
+void KisKraIncrementalSaveCache::registerSavedDevice(KisPaintDeviceSP device, const QString &key,
+                                                     const QString &location)
+{
+    SavedDevice savedDevice;
+    savedDevice.dataManager = new KisDataManager(*device->dataManager());
+    savedDevice.location = location;
+
+    m_d->newDevices.insert(key, savedDevice);
+}
+
+void KisKraIncrementalSaveCache::commit()
+{
+    if (!m_d->documentToken) return;
+
+    SaveRecord record;
+    record.documentToken = m_d->documentToken;
+    record.saveId = m_d->saveId;
+    record.devices = m_d->newDevices;
+
+    QMutexLocker l(&s_storage->mutex);
+
+    s_storage->records.insert(m_d->filename, record);
+
+    QObject *token = m_d->documentToken.data();
+    if (!s_storage->watchedTokens.contains(token)) {
+        s_storage->watchedTokens.insert(token);
+
+        /**
+         * The token is deleted when the document is closed, so drop
+         * the snapshots of its layers to release the memory
+         */
+        QObject::connect(token, &QObject::destroyed,
+                         [] (QObject *object) {
+                             s_storage->purgeDeadRecords(object);
+                         });
+    }
+}
+
+QStringList KisKraIncrementalSaveCache::copiedDevices() const
+{
+    return m_d->copiedDevices;
+}
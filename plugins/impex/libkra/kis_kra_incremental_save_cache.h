@@ -0,0 +1,92 @@
+/*
+ *  Copyright (c) 2020 Krita developers
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#ifndef KIS_KRA_INCREMENTAL_SAVE_CACHE_H
+#define KIS_KRA_INCREMENTAL_SAVE_CACHE_H
+
+#include <QScopedPointer>
+#include <QSharedPointer>
+#include <QString>
+#include <QStringList>
+
+#include <kis_types.h>
+
+#include "kritalibkra_export.h"
+
+class KoStore;
+
+/**
+ * Lets the .kra saver skip serialization of the layers that have not
+ * been changed since the previous save of the same document into the
+ * same file. Their entries are copied from the previous version of the
+ * archive instead.
+ *
+ * After every successful save the cache keeps a shallow (copy-on-write)
+ * copy of the data manager of every saved device. Any write into a
+ * device detaches its tiles, so a device is unchanged if and only if it
+ * still shares all its tiles with the copy.
+ *
+ * The previous version of the file is used only if its maindoc.xml
+ * carries the save id of the recorded save, that is, if nobody has
+ * overwritten the file in the meantime.
+ */
+class KRITALIBKRA_EXPORT KisKraIncrementalSaveCache
+{
+public:
+    /**
+     * Starts a save of the document identified by \p documentToken
+     * into \p filename. The new file will be marked with \p saveId.
+     */
+    KisKraIncrementalSaveCache(QSharedPointer<QObject> documentToken,
+                               const QString &filename,
+                               const QString &saveId);
+    ~KisKraIncrementalSaveCache();
+
+    /**
+     * If \p device has not been changed since the previous save, copies
+     * its entries from the previous version of the file into \p location
+     * of \p store and returns true. Otherwise, returns false and the
+     * device should be serialized as usual.
+     */
+    bool copyUnchangedDevice(KisPaintDeviceSP device, const QString &key,
+                             KoStore *store, const QString &location);
+
+    /**
+     * Remembers that \p device has been saved into \p location
+     */
+    void registerSavedDevice(KisPaintDeviceSP device, const QString &key,
+                             const QString &location);
+
+    /**
+     * Makes the devices registered during this save available for
+     * the next one. Should be called only if the save succeeded.
+     */
+    void commit();
+
+    /**
+     * The keys of the devices that this save has copied from the
+     * previous version of the file
+     */
+    QStringList copiedDevices() const;
+
+private:
+    struct Private;
+    const QScopedPointer<Private> m_d;
+};
+
+#endif // KIS_KRA_INCREMENTAL_SAVE_CACHE_H
@@ -68,6 +68,7 @@
 #include "kis_raster_keyframe_channel.h"
 #include "kis_paint_device_frames_interface.h"
 #include "kis_filter_registry.h"
+#include "kis_image_config.h"
 
 
 using namespace KRA;
@@ -110,6 +111,14 @@ KisKraLoadVisitor::KisKraLoadVisitor(KisImageSP image,
     , m_name(name)
     , m_shapeController(shapeController)
 {
+    /**
+     * In lazy mode the tiles are not decompressed on loading. Their
+     * compressed data goes directly into the swap and is unpacked only
+     * when the tile is accessed for the first time, so hidden layers and
+     * unused animation frames never take any memory.
+     */
+    m_lazyLoading = KisImageConfig(true).lazyLoadLayerData();
+
     m_store->pushDirectory();
 
     if (!m_store->enterDirectory(m_name)) {
@@ -457,22 +466,28 @@ QStringList KisKraLoadVisitor::warningMessages() const
 
 struct SimpleDevicePolicy
 {
+    SimpleDevicePolicy(bool lazyLoading)
+        : m_lazyLoading(lazyLoading) {}
+
     bool read(KisPaintDeviceSP dev, QIODevice *stream) {
-        return dev->read(stream);
+        return dev->read(stream, m_lazyLoading);
     }
 
     void setDefaultPixel(KisPaintDeviceSP dev, const KoColor &defaultPixel) const {
         return dev->setDefaultPixel(defaultPixel);
     }
+
+    bool m_lazyLoading;
 };
 
 struct FramedDevicePolicy
 {
-    FramedDevicePolicy(int frameId)
-        :  m_frameId(frameId) {}
+    FramedDevicePolicy(int frameId, bool lazyLoading)
+        :  m_frameId(frameId),
+           m_lazyLoading(lazyLoading) {}
 
     bool read(KisPaintDeviceSP dev, QIODevice *stream) {
-        return dev->framesInterface()->readFrame(stream, m_frameId);
+        return dev->framesInterface()->readFrame(stream, m_frameId, m_lazyLoading);
     }
 
     void setDefaultPixel(KisPaintDeviceSP dev, const KoColor &defaultPixel) const {
@@ -480,6 +495,7 @@ struct FramedDevicePolicy
     }
 
     int m_frameId;
+    bool m_lazyLoading;
 };
 
 bool KisKraLoadVisitor::loadPaintDevice(KisPaintDeviceSP device, const QString& location)
@@ -493,7 +509,7 @@ bool KisKraLoadVisitor::loadPaintDevice(KisPaintDeviceSP device, const QString&
     }
 
     if (!frameInterface || frames.count() <= 1) {
-        return loadPaintDeviceFrame(device, location, SimpleDevicePolicy());
+        return loadPaintDeviceFrame(device, location, SimpleDevicePolicy(m_lazyLoading));
     } else {
         KisRasterKeyframeChannel *keyframeChannel = device->keyframeChannel();
 
@@ -507,7 +523,7 @@ bool KisKraLoadVisitor::loadPaintDevice(KisPaintDeviceSP device, const QString&
                 QString frameFilename = getLocation(keyframeChannel->frameFilename(id));
                 Q_ASSERT(!frameFilename.isEmpty());
 
-                if (!loadPaintDeviceFrame(device, frameFilename, FramedDevicePolicy(id))) {
+                if (!loadPaintDeviceFrame(device, frameFilename, FramedDevicePolicy(id, m_lazyLoading))) {
                     m_warningMessages << i18n("Could not load keyframe pixel data for frame %1 in %2.", id, location);
                 }
             }
@@ -102,6 +102,7 @@ private:
     QMap<KisNode *, QString> m_keyframeFilenames;
     QString m_name;
     int m_syntaxVersion;
+    bool m_lazyLoading;
     QStringList m_errorMessages;
     QStringList m_warningMessages;
     KoShapeControllerBase *m_shapeController;
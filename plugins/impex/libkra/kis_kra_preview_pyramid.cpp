@@ -0,0 +1,292 @@
+/*
+ *  Copyright (c) 2020 Krita developers
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include "kis_kra_preview_pyramid.h"
+
+#include <QBuffer>
+#include <QDomDocument>
+#include <QDomElement>
+#include <QPainter>
+#include <QVector>
+#include <QtConcurrent>
+
+#include <KoStore.h>
+
+#include <kis_debug.h>
+#include <kis_paint_device.h>
+
+namespace {
+
+const QString PYRAMID_PATH = "previewpyramid/";
+const QString PYRAMID_INDEX = PYRAMID_PATH + "index.xml";
+const int PYRAMID_VERSION = 1;
+
+QString tilePath(int level, int row, int column)
+{
+    return PYRAMID_PATH + QString("%1/%2_%3.png").arg(level).arg(row).arg(column);
+}
+
+QSize scaledSize(const QSize &size, int level)
+{
+    const int divisor = 1 << level;
+    return QSize(qMax(1, (size.width() + divisor - 1) / divisor),
+                 qMax(1, (size.height() + divisor - 1) / divisor));
+}
+
+struct PyramidTile {
+    int row = 0;
+    int column = 0;
+    QRect rect;
+    QImage image;
+    QByteArray data;
+};
+
+QVector<PyramidTile> tilesForRect(const QRect &rect, int tileSize)
+{
+    QVector<PyramidTile> tiles;
+
+    const int firstRow = rect.top() / tileSize;
+    const int lastRow = rect.bottom() / tileSize;
+    const int firstColumn = rect.left() / tileSize;
+    const int lastColumn = rect.right() / tileSize;
+
+    for (int row = firstRow; row <= lastRow; row++) {
+        for (int column = firstColumn; column <= lastColumn; column++) {
+            PyramidTile tile;
+            tile.row = row;
+            tile.column = column;
+            tile.rect = QRect(column * tileSize, row * tileSize, tileSize, tileSize);
+            tiles << tile;
+        }
+    }
+
+    return tiles;
+}
+
+}
+
+struct KisKraPreviewPyramid::Private
+{
+    KoStore *store = 0;
+    bool isValid = false;
+    QSize imageSize;
+    int tileSize = 0;
+    int firstLevel = 0;
+    int lastLevel = 0;
+};
+
+KisKraPreviewPyramid::KisKraPreviewPyramid(KoStore *store)
+    : m_d(new Private)
+{
+    m_d->store = store;
+
+    if (!store->hasFile(PYRAMID_INDEX) || !store->open(PYRAMID_INDEX)) {
+        return;
+    }
+
+    QDomDocument doc;
+    const bool result = doc.setContent(store->read(store->size()));
+    store->close();
+
+    if (!result) {
+        warnFile << "Could not parse the preview pyramid index";
+        return;
+    }
+
+    QDomElement root = doc.documentElement();
+    if (root.attribute("version").toInt() != PYRAMID_VERSION) {
+        return;
+    }
+
+    m_d->imageSize = QSize(root.attribute("width").toInt(), root.attribute("height").toInt());
+    m_d->tileSize = root.attribute("tileSize").toInt();
+    m_d->firstLevel = root.attribute("firstLevel").toInt();
+    m_d->lastLevel = root.attribute("lastLevel").toInt();
+
+    m_d->isValid =
+        !m_d->imageSize.isEmpty() &&
+        m_d->tileSize > 0 &&
+        m_d->firstLevel >= 0 &&
+        m_d->firstLevel <= m_d->lastLevel &&
+        m_d->lastLevel < 31;
+}
+
+KisKraPreviewPyramid::~KisKraPreviewPyramid()
+{
+}
+
+int KisKraPreviewPyramid::tileSize()
+{
+    return 256;
+}
+
+int KisKraPreviewPyramid::maxLevelSize()
+{
+    return 4096;
+}
+
+bool KisKraPreviewPyramid::save(KoStore *store, KisPaintDeviceSP projection, const QRect &bounds)
+{
+    if (bounds.isEmpty()) return false;
+
+    int level = 1;
+    while (qMax(scaledSize(bounds.size(), level).width(),
+                scaledSize(bounds.size(), level).height()) > maxLevelSize()) {
+        level++;
+    }
+
+    const int firstLevel = level;
+    QSize size = scaledSize(bounds.size(), level);
+
+    QImage image = projection->createThumbnail(size.width(), size.height(), bounds, 2);
+    if (image.size() != size) {
+        image = image.scaled(size, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+    }
+    image = image.convertToFormat(QImage::Format_ARGB32);
+
+    forever {
+        QVector<PyramidTile> tiles = tilesForRect(image.rect(), tileSize());
+
+        QtConcurrent::blockingMap(tiles,
+            [&image] (PyramidTile &tile) {
+                QBuffer buffer(&tile.data);
+                buffer.open(QIODevice::WriteOnly);
+                image.copy(tile.rect & image.rect()).save(&buffer, "PNG");
+            });
+
+        Q_FOREACH (const PyramidTile &tile, tiles) {
+            if (!store->open(tilePath(level, tile.row, tile.column))) {
+                return false;
+            }
+            const bool result = store->write(tile.data) == tile.data.size();
+            store->close();
+
+            if (!result) {
+                return false;
+            }
+        }
+
+        if (tiles.size() == 1) break;
+
+        level++;
+        size = scaledSize(bounds.size(), level);
+        image = image.scaled(size, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+    }
+
+    QDomDocument doc;
+    QDomElement root = doc.createElement("previewpyramid");
+    root.setAttribute("version", PYRAMID_VERSION);
+    root.setAttribute("width", bounds.width());
+    root.setAttribute("height", bounds.height());
+    root.setAttribute("tileSize", tileSize());
+    root.setAttribute("firstLevel", firstLevel);
+    root.setAttribute("lastLevel", level);
+    doc.appendChild(root);
+
+    if (!store->open(PYRAMID_INDEX)) {
+        return false;
+    }
+    const QByteArray data = doc.toByteArray();
+    const bool result = store->write(data) == data.size();
+    store->close();
+
+    return result;
+}
+
+bool KisKraPreviewPyramid::isValid() const
+{
+    return m_d->isValid;
+}
+
+QSize KisKraPreviewPyramid::imageSize() const
+{
+    return m_d->imageSize;
+}
+
+int KisKraPreviewPyramid::firstLevel() const
+{
+    return m_d->firstLevel;
+}
+
+int KisKraPreviewPyramid::lastLevel() const
+{
+    return m_d->lastLevel;
+}
+
+QSize KisKraPreviewPyramid::levelSize(int level) const
+{
+    return scaledSize(m_d->imageSize, level);
+}
+
+int KisKraPreviewPyramid::levelForSize(const QSize &size) const
+{
+    int level = m_d->firstLevel;
+
+    while (level < m_d->lastLevel &&
+           (levelSize(level).width() > size.width() ||
+            levelSize(level).height() > size.height())) {
+        level++;
+    }
+
+    return level;
+}
+
+QImage KisKraPreviewPyramid::loadLevel(int level, const QRect &rect) const
+{
+    KIS_SAFE_ASSERT_RECOVER_RETURN_VALUE(m_d->isValid, QImage());
+    KIS_SAFE_ASSERT_RECOVER_RETURN_VALUE(level >= m_d->firstLevel && level <= m_d->lastLevel, QImage());
+
+    const QRect levelRect(QPoint(), levelSize(level));
+    const QRect rc = rect.isEmpty() ? levelRect : rect & levelRect;
+    if (rc.isEmpty()) return QImage();
+
+    QVector<PyramidTile> tiles = tilesForRect(rc, m_d->tileSize);
+
+    /**
+     * The store can be read in one thread only, but decoding
+     * of the tiles can be done in parallel
+     */
+    for (auto it = tiles.begin(); it != tiles.end(); ++it) {
+        if (m_d->store->open(tilePath(level, it->row, it->column))) {
+            it->data = m_d->store->read(m_d->store->size());
+            m_d->store->close();
+        }
+    }
+
+    QtConcurrent::blockingMap(tiles,
+        [] (PyramidTile &tile) {
+            tile.image.loadFromData(tile.data, "PNG");
+            tile.data.clear();
+        });
+
+    QImage result(rc.size(), QImage::Format_ARGB32);
+    result.fill(Qt::transparent);
+
+    QPainter gc(&result);
+    gc.setCompositionMode(QPainter::CompositionMode_Source);
+
+    Q_FOREACH (const PyramidTile &tile, tiles) {
+        if (tile.image.isNull()) {
+            warnFile << "Could not load preview pyramid tile" << tilePath(level, tile.row, tile.column);
+            continue;
+        }
+        gc.drawImage(tile.rect.topLeft() - rc.topLeft(), tile.image);
+    }
+
+    return result;
+}
@@ -0,0 +1,94 @@
+/*
+ *  Copyright (c) 2020 Krita developers
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#ifndef KIS_KRA_PREVIEW_PYRAMID_H
+#define KIS_KRA_PREVIEW_PYRAMID_H
+
+#include <QScopedPointer>
+#include <QImage>
+
+#include <kis_types.h>
+
+#include "kritalibkra_export.h"
+
+class KoStore;
+
+/**
+ * A tiled multi-resolution pyramid of the merged image stored in the
+ * .kra file next to mergedimage.png. It lets the document show the
+ * image right after opening the file, while the layers are still being
+ * loaded.
+ *
+ * Level N of the pyramid is the projection downscaled by 2^N. The finest
+ * level stored is the first one that fits into maxLevelSize(), the
+ * coarsest one fits into a single tile. Every level is split into PNG
+ * tiles of tileSize() pixels:
+ *
+ * previewpyramid/index.xml
+ * previewpyramid/<level>/<row>_<column>.png
+ */
+class KRITALIBKRA_EXPORT KisKraPreviewPyramid
+{
+public:
+    /**
+     * Reads the pyramid index from \p store. If the file has no pyramid,
+     * isValid() returns false.
+     */
+    KisKraPreviewPyramid(KoStore *store);
+    ~KisKraPreviewPyramid();
+
+    /**
+     * Renders the pyramid of \p projection and writes it into \p store
+     */
+    static bool save(KoStore *store, KisPaintDeviceSP projection, const QRect &bounds);
+
+    static int tileSize();
+    static int maxLevelSize();
+
+    bool isValid() const;
+
+    /**
+     * The size of the full-resolution image
+     */
+    QSize imageSize() const;
+
+    /**
+     * The numbers of the finest and the coarsest levels stored in the file
+     */
+    int firstLevel() const;
+    int lastLevel() const;
+
+    QSize levelSize(int level) const;
+
+    /**
+     * Returns the finest level that fits into \p size
+     */
+    int levelForSize(const QSize &size) const;
+
+    /**
+     * Loads a \p rect of the \p level. Only the tiles intersecting the
+     * rect are decoded. If \p rect is empty, the whole level is loaded.
+     */
+    QImage loadLevel(int level, const QRect &rect = QRect()) const;
+
+private:
+    struct Private;
+    const QScopedPointer<Private> m_d;
+};
+
+#endif // KIS_KRA_PREVIEW_PYRAMID_H
@@ -56,6 +56,7 @@
 
 #include "kis_config.h"
 #include "kis_store_paintdevice_writer.h"
+#include "kis_kra_incremental_save_cache.h"
 #include "flake/kis_shape_selection.h"
 
 #include "kis_raster_keyframe_channel.h"
@@ -76,6 +77,7 @@ KisKraSaveVisitor::KisKraSaveVisitor(KoStore *store, const QString & name, QMap<
     , m_name(name)
     , m_nodeFileNames(nodeFileNames)
     , m_writer(new KisStorePaintDeviceWriter(store))
+    , m_incrementalSaveCache(0)
 {
 }
 
@@ -90,6 +92,11 @@ void KisKraSaveVisitor::setExternalUri(const QString &uri)
     m_uri = uri;
 }
 
+void KisKraSaveVisitor::setIncrementalSaveCache(KisKraIncrementalSaveCache *cache)
+{
+    m_incrementalSaveCache = cache;
+}
+
 bool KisKraSaveVisitor::visit(KisExternalLayer * layer)
 {
     bool result = false;
@@ -130,7 +137,7 @@ bool KisKraSaveVisitor::visit(KisExternalLayer * layer)
 
 bool KisKraSaveVisitor::visit(KisPaintLayer *layer)
 {
-    if (!savePaintDevice(layer->paintDevice(), getLocation(layer))) {
+    if (!savePaintDevice(layer->paintDevice(), getLocation(layer), layer->uuid().toString())) {
         m_errorMessages << i18n("Failed to save the pixel data for layer %1.", layer->name());
         return false;
     }
@@ -343,7 +350,8 @@ struct FramedDevicePolicy
 };
 
 bool KisKraSaveVisitor::savePaintDevice(KisPaintDeviceSP device,
-                                        QString location)
+                                        QString location,
+                                        const QString &cacheKey)
 {
     // Layer data
     KisConfig cfg(true);
@@ -357,7 +365,17 @@ bool KisKraSaveVisitor::savePaintDevice(KisPaintDeviceSP device,
     }
 
     if (!frameInterface || frames.count() <= 1) {
-        savePaintDeviceFrame(device, location, SimpleDevicePolicy());
+        const bool useCache = m_incrementalSaveCache && !cacheKey.isEmpty();
+
+        if (!useCache ||
+            !m_incrementalSaveCache->copyUnchangedDevice(device, cacheKey, m_store, location)) {
+
+            savePaintDeviceFrame(device, location, SimpleDevicePolicy());
+        }
+
+        if (useCache) {
+            m_incrementalSaveCache->registerSavedDevice(device, cacheKey, location);
+        }
     } else {
         KisRasterKeyframeChannel *keyframeChannel = device->keyframeChannel();
 
@@ -448,7 +466,8 @@ bool KisKraSaveVisitor::saveSelection(KisNode* node)
 
     if (selection->hasPixelSelection()) {
         KisPaintDeviceSP dev = selection->pixelSelection();
-        if (!savePaintDevice(dev, getLocation(node, DOT_PIXEL_SELECTION))) {
+        if (!savePaintDevice(dev, getLocation(node, DOT_PIXEL_SELECTION),
+                             node->uuid().toString() + DOT_PIXEL_SELECTION)) {
             m_errorMessages << i18n("Failed to save the pixel selection data for layer %1.", node->name());
             retval = false;
         }
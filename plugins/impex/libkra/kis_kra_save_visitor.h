@@ -29,6 +29,7 @@
 #include "kritalibkra_export.h"
 
 class KisPaintDeviceWriter;
+class KisKraIncrementalSaveCache;
 class KoStore;
 
 class KRITALIBKRA_EXPORT KisKraSaveVisitor : public KisNodeVisitor
@@ -41,6 +42,13 @@ public:
 public:
     void setExternalUri(const QString &uri);
 
+    /**
+     * When set, the pixel data of the devices that have not changed
+     * since the previous save is copied from the previous version
+     * of the file
+     */
+    void setIncrementalSaveCache(KisKraIncrementalSaveCache *cache);
+
     bool visit(KisNode*) override {
         return true;
     }
@@ -72,7 +80,7 @@ public:
 
 private:
 
-    bool savePaintDevice(KisPaintDeviceSP device, QString location);
+    bool savePaintDevice(KisPaintDeviceSP device, QString location, const QString &cacheKey = QString());
 
     template<class DevicePolicy>
     bool savePaintDeviceFrame(KisPaintDeviceSP device, QString location, DevicePolicy policy);
@@ -92,6 +100,7 @@ private:
     QString m_name;
     QMap<const KisNode*, QString> m_nodeFileNames;
     KisPaintDeviceWriter *m_writer;
+    KisKraIncrementalSaveCache *m_incrementalSaveCache;
     QStringList m_errorMessages;
 };
 
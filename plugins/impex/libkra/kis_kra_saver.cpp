@@ -21,6 +21,8 @@
 #include "kis_kra_tags.h"
 #include "kis_kra_save_visitor.h"
 #include "kis_kra_savexml_visitor.h"
+#include "kis_kra_preview_pyramid.h"
+#include "kis_kra_incremental_save_cache.h"
 
 #include <QDomDocument>
 #include <QDomElement>
@@ -30,6 +32,7 @@
 
 #include <QUrl>
 #include <QBuffer>
+#include <QUuid>
 
 #include <KoDocumentInfo.h>
 #include <KoColorSpaceRegistry.h>
@@ -60,6 +63,7 @@
 #include "kis_grid_config.h"
 #include "kis_guides_config.h"
 #include "KisProofingConfiguration.h"
+#include "kis_config.h"
 
 #include <KisMirrorAxisConfig.h>
 
@@ -77,7 +81,9 @@ public:
     QMap<const KisNode*, QString> keyframeFilenames;
     QString imageName;
     QString filename;
+    QString saveId;
     QStringList errorMessages;
+    QStringList incrementallyCopiedDevices;
 };
 
 KisKraSaver::KisKraSaver(KisDocument* document, const QString &filename)
@@ -85,6 +91,7 @@ KisKraSaver::KisKraSaver(KisDocument* document, const QString &filename)
 {
     m_d->doc = document;
     m_d->filename = filename;
+    m_d->saveId = QUuid::createUuid().toString();
 
     m_d->imageName = m_d->doc->documentInfo()->aboutInfo("title");
     if (m_d->imageName.isEmpty()) {
@@ -108,6 +115,7 @@ QDomElement KisKraSaver::saveXML(QDomDocument& doc,  KisImageSP image)
     imageElement.setAttribute(HEIGHT, KisDomUtils::toString(image->height()));
     imageElement.setAttribute(COLORSPACE_NAME, image->colorSpace()->id());
     imageElement.setAttribute(DESCRIPTION, m_d->doc->documentInfo()->aboutInfo("comment"));
+    imageElement.setAttribute(SAVE_ID, m_d->saveId);
     // XXX: Save profile as blob inside the image, instead of the product name.
     if (image->profile() && image->profile()-> valid()) {
         imageElement.setAttribute(PROFILE, image->profile()->name());
@@ -247,6 +255,15 @@ bool KisKraSaver::saveBinaryData(KoStore* store, KisImageSP image, const QString
     if (external)
         visitor.setExternalUri(uri);
 
+    QScopedPointer<KisKraIncrementalSaveCache> incrementalSaveCache;
+
+    KisConfig cfg(true);
+    if (cfg.incrementalKraSave() && !m_d->filename.isEmpty()) {
+        incrementalSaveCache.reset(
+            new KisKraIncrementalSaveCache(m_d->doc->saveCacheToken(), m_d->filename, m_d->saveId));
+        visitor.setIncrementalSaveCache(incrementalSaveCache.data());
+    }
+
     image->rootLayer()->accept(visitor);
 
     m_d->errorMessages.append(visitor.errorMessages());
@@ -254,6 +271,11 @@ bool KisKraSaver::saveBinaryData(KoStore* store, KisImageSP image, const QString
         return false;
     }
 
+    if (incrementalSaveCache) {
+        incrementalSaveCache->commit();
+        m_d->incrementallyCopiedDevices = incrementalSaveCache->copiedDevices();
+    }
+
     // saving annotations
     // XXX this only saves EXIF and ICC info. This would probably need
     // a redesign of the dtd of the krita file to do this more generally correct
@@ -334,6 +356,10 @@ bool KisKraSaver::saveBinaryData(KoStore* store, KisImageSP image, const QString
     if (!autosave) {
         KisPaintDeviceSP dev = image->projection();
         KisPNGConverter::saveDeviceToStore("mergedimage.png", image->bounds(), image->xRes(), image->yRes(), dev, store);
+
+        if (!KisKraPreviewPyramid::save(store, dev, image->bounds())) {
+            warnFile << "Could not save the preview pyramid";
+        }
     }
 
     saveAssistants(store, uri,external);
@@ -345,6 +371,11 @@ QStringList KisKraSaver::errorMessages() const
     return m_d->errorMessages;
 }
 
+QStringList KisKraSaver::incrementallyCopiedDevices() const
+{
+    return m_d->incrementallyCopiedDevices;
+}
+
 void KisKraSaver::saveBackgroundColor(QDomDocument& doc, QDomElement& element, KisImageSP image)
 {
     QDomElement e = doc.createElement(CANVASPROJECTIONCOLOR);
@@ -49,6 +49,13 @@ public:
     /// @return a list with everything that went wrong while saving
     QStringList errorMessages() const;
 
+    /**
+     * @return the keys of the devices that saveBinaryData() has copied
+     *         from the previous version of the file instead of saving
+     *         them again (see KisKraIncrementalSaveCache)
+     */
+    QStringList incrementallyCopiedDevices() const;
+
 private:
     void saveBackgroundColor(QDomDocument& doc, QDomElement& element, KisImageSP image);
     void saveAssistantsGlobalColor(QDomDocument& doc, QDomElement& element);
@@ -89,6 +89,7 @@ const QString COLOR_LABEL = "colorlabel";
 const QString PAINT_LAYER = "paintlayer";
 const QString PROFILE = "profile";
 const QString ROTATION = "rotation";
+const QString SAVE_ID = "saveid";
 const QString SELECTION_MASK = "selectionmask";
 const QString SHAPE_LAYER = "shapelayer";
 const QString REFERENCE_IMAGES_LAYER = "referenceimages";
@@ -39,6 +39,9 @@
 
 #include <filestest.h>
 
+#include <KoPluginLoader.h>
+#include <kis_painting_assistant.h>
+
 #include  <sdk/tests/kistest.h>
 
 
@@ -176,6 +179,43 @@ void KisKraLoaderTest::testLoadAnimated()
 
 
 
+void KisKraLoaderTest::testLoadAssistantsWithDeferredTools()
+{
+    /**
+     * In batch mode the tool plugins are deferred and no main window ever
+     * uses the tool registry. The assistant factories come from the
+     * assistant tool plugin, so loading the document must load it.
+     */
+    KoPluginLoader::instance()->defer(QString::fromLatin1("Krita/Tool"),
+                                      QString::fromLatin1("[X-Krita-Version] == 28"));
+
+    QScopedPointer<KisDocument> doc(KisPart::instance()->createDocument());
+    doc->setFileBatchMode(true);
+    doc->loadNativeFormat(QString(FILES_DATA_DIR) + QDir::separator() + "load_test_assistants.kra");
+
+    if (!KisPaintingAssistantFactoryRegistry::instance()->get("ruler")) {
+        QSKIP("The assistant tool plugin is not installed");
+    }
+
+    QCOMPARE(doc->assistants().size(), 2);
+
+    // a kra -> kra batch conversion must keep them
+    doc->exportDocumentSync(QUrl::fromLocalFile("roundtrip_assistants.kra"), doc->mimeType());
+
+    QScopedPointer<KisDocument> doc2(KisPart::instance()->createDocument());
+    doc2->setFileBatchMode(true);
+    doc2->loadNativeFormat("roundtrip_assistants.kra");
+
+    QCOMPARE(doc2->assistants().size(), 2);
+
+    QStringList ids;
+    Q_FOREACH (KisPaintingAssistantSP assistant, doc2->assistants()) {
+        ids << assistant->id();
+    }
+    ids.sort();
+    QCOMPARE(ids, QStringList() << "ruler" << "vanishing point");
+}
+
 void KisKraLoaderTest::testImportFromWriteonly()
 {
     TestUtil::testImportFromWriteonly(QString(FILES_DATA_DIR), KraMimetype);
@@ -33,6 +33,8 @@ private Q_SLOTS:
 
     void testLoadAnimated();
 
+    void testLoadAssistantsWithDeferredTools();
+
     void testImportFromWriteonly();
     void testImportIncorrectFormat();
 
@@ -54,6 +54,9 @@
 #include <generator/kis_generator_registry.h>
 
 #include <KoResourcePaths.h>
+#include <KoStore.h>
+#include "kis_kra_preview_pyramid.h"
+#include "kis_config.h"
 #include  <sdk/tests/kistest.h>
 #include <filestest.h>
 
@@ -549,4 +552,187 @@ void KisKraSaverTest::testExportToReadonly()
     TestUtil::testExportToReadonly(QString(FILES_DATA_DIR), KraMimetype);
 }
 
+void KisKraSaverTest::testPreviewPyramid()
+{
+    QScopedPointer<KisDocument> doc(createEmptyDocument());
+    KisImageSP image = doc->image();
+
+    KisPaintLayerSP layer = new KisPaintLayer(image, "paint1", OPACITY_OPAQUE_U8);
+    layer->paintDevice()->fill(image->bounds(), KoColor(Qt::red, image->colorSpace()));
+    image->addNode(layer);
+    image->initialRefreshGraph();
+
+    doc->exportDocumentSync(QUrl::fromLocalFile("previewpyramid.kra"), doc->mimeType());
+
+    QScopedPointer<KoStore> store(KoStore::createStore("previewpyramid.kra", KoStore::Read, "", KoStore::Zip));
+    KisKraPreviewPyramid pyramid(store.data());
+
+    QVERIFY(pyramid.isValid());
+    QCOMPARE(pyramid.imageSize(), QSize(1024, 1024));
+    QCOMPARE(pyramid.firstLevel(), 1);
+    QCOMPARE(pyramid.lastLevel(), 2);
+    QCOMPARE(pyramid.levelForSize(QSize(300, 300)), 2);
+
+    QImage level1 = pyramid.loadLevel(1);
+    QCOMPARE(level1.size(), QSize(512, 512));
+    QCOMPARE(QColor(level1.pixel(300, 300)), QColor(Qt::red));
+
+    QImage region = pyramid.loadLevel(1, QRect(200, 200, 100, 100));
+    QCOMPARE(region.size(), QSize(100, 100));
+    QCOMPARE(QColor(region.pixel(50, 50)), QColor(Qt::red));
+}
+
+#include <QDomDocument>
+#include "kis_kra_saver.h"
+#include "kis_kra_tags.h"
+
+/**
+ * @return the raw pixel data of the layer \p layerName as stored in the
+ *         archive \p filename
+ */
+QByteArray readLayerData(const QString &filename, const QString &layerName)
+{
+    QScopedPointer<KoStore> store(KoStore::createStore(filename, KoStore::Read, "", KoStore::Zip));
+    if (!store || store->bad() || !store->open("root")) return QByteArray();
+
+    QDomDocument doc;
+    doc.setContent(store->read(store->size()));
+    store->close();
+
+    const QDomElement imageElement = doc.documentElement().firstChildElement("IMAGE");
+    const QDomNodeList layers = imageElement.elementsByTagName(KRA::LAYER);
+
+    for (int i = 0; i < layers.size(); i++) {
+        const QDomElement layerElement = layers.at(i).toElement();
+        if (layerElement.attribute(KRA::NAME) != layerName) continue;
+
+        const QString location = imageElement.attribute(KRA::NAME) + KRA::LAYER_PATH +
+            layerElement.attribute(KRA::FILE_NAME);
+
+        if (!store->open(location)) return QByteArray();
+        const QByteArray data = store->read(store->size());
+        store->close();
+
+        return data;
+    }
+
+    return QByteArray();
+}
+
+namespace {
+
+/**
+ * Sets the incremental save option and restores the old value on
+ * destruction, even if the test fails in between
+ */
+struct IncrementalSaveOptionGuard
+{
+    IncrementalSaveOptionGuard(bool value)
+        : m_oldValue(KisConfig(true).incrementalKraSave())
+    {
+        KisConfig(false).setIncrementalKraSave(value);
+    }
+
+    ~IncrementalSaveOptionGuard()
+    {
+        KisConfig(false).setIncrementalKraSave(m_oldValue);
+    }
+
+private:
+    bool m_oldValue;
+};
+
+/**
+ * Saves \p doc with KisKraSaver directly, the way KraConverter does, and
+ * returns the keys of the devices the saver has copied from the previous
+ * version of the file in \p copiedDevices
+ */
+bool saveWithKraSaver(KisDocument *doc, const QString &filename, QStringList *copiedDevices)
+{
+    QScopedPointer<KoStore> store(KoStore::createStore(filename, KoStore::Write, doc->nativeFormatMimeType(), KoStore::Zip));
+    if (!store || store->bad()) return false;
+
+    KisKraSaver saver(doc, filename);
+
+    QDomDocument xmlDoc = doc->createDomDocument("DOC", "2.0");
+    QDomElement root = xmlDoc.documentElement();
+    root.setAttribute("editor", "Krita");
+    root.setAttribute("syntaxVersion", "2");
+    root.appendChild(saver.saveXML(xmlDoc, doc->image()));
+
+    if (!store->open("root")) return false;
+    const QByteArray xml = xmlDoc.toByteArray();
+    const bool xmlWritten = store->write(xml) == xml.size();
+    store->close();
+
+    if (!xmlWritten ||
+        !saver.saveBinaryData(store.data(), doc->image(), QString(), true, false) ||
+        !store->finalize()) {
+
+        return false;
+    }
+
+    *copiedDevices = saver.incrementallyCopiedDevices();
+    return true;
+}
+
+}
+
+void KisKraSaverTest::testIncrementalSave()
+{
+    IncrementalSaveOptionGuard optionGuard(true);
+
+    QScopedPointer<KisDocument> doc(createEmptyDocument());
+    KisImageSP image = doc->image();
+
+    KisPaintLayerSP layer1 = new KisPaintLayer(image, "paint1", OPACITY_OPAQUE_U8);
+    layer1->paintDevice()->fill(QRect(0, 0, 100, 100), KoColor(Qt::red, image->colorSpace()));
+    image->addNode(layer1);
+
+    KisPaintLayerSP layer2 = new KisPaintLayer(image, "paint2", OPACITY_OPAQUE_U8);
+    layer2->paintDevice()->fill(QRect(0, 0, 100, 100), KoColor(Qt::green, image->colorSpace()));
+    image->addNode(layer2);
+
+    image->initialRefreshGraph();
+
+    const QString filename = "incremental_save.kra";
+    QFile::remove(filename);
+
+    QStringList copiedDevices;
+
+    QVERIFY(saveWithKraSaver(doc.data(), filename, &copiedDevices));
+    QVERIFY(copiedDevices.isEmpty());
+
+    const QByteArray layer1Data = readLayerData(filename, "paint1");
+    const QByteArray layer2Data = readLayerData(filename, "paint2");
+    QVERIFY(!layer1Data.isEmpty());
+    QVERIFY(!layer2Data.isEmpty());
+
+    // only the second layer is changed, the first one should be copied
+    layer2->paintDevice()->fill(QRect(50, 50, 100, 100), KoColor(Qt::blue, image->colorSpace()));
+
+    QVERIFY(saveWithKraSaver(doc.data(), filename, &copiedDevices));
+    QCOMPARE(copiedDevices, QStringList() << layer1->uuid().toString());
+
+    QCOMPARE(readLayerData(filename, "paint1"), layer1Data);
+    QVERIFY(readLayerData(filename, "paint2") != layer2Data);
+
+    QScopedPointer<KisDocument> doc2(KisPart::instance()->createDocument());
+    QVERIFY(doc2->loadNativeFormat(filename));
+
+    KisNodeSP node1 = TestUtil::findNode(doc2->image()->rootLayer(), "paint1");
+    KisNodeSP node2 = TestUtil::findNode(doc2->image()->rootLayer(), "paint2");
+    QVERIFY(node1);
+    QVERIFY(node2);
+
+    QColor color;
+    node1->paintDevice()->pixel(75, 75, &color);
+    QCOMPARE(color, QColor(Qt::red));
+    node2->paintDevice()->pixel(25, 25, &color);
+    QCOMPARE(color, QColor(Qt::green));
+    node2->paintDevice()->pixel(75, 75, &color);
+    QCOMPARE(color, QColor(Qt::blue));
+    QCOMPARE(node2->paintDevice()->exactBounds(), QRect(0, 0, 150, 150));
+}
+
 KISTEST_MAIN(KisKraSaverTest)
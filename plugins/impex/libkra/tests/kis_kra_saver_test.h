@@ -48,6 +48,10 @@ private Q_SLOTS:
 
     void testExportToReadonly();
 
+    void testPreviewPyramid();
+
+    void testIncrementalSave();
+
 };
 
 #endif
@@ -18,12 +18,15 @@
 
 #include "kis_open_raster_load_context.h"
 
+#include <QBuffer>
 #include <QDomDocument>
+#include <QSet>
+#include <QThread>
+#include <QtConcurrent>
 
 #include <KoStore.h>
 #include <KoStoreDevice.h>
 
-#include <kis_image.h>
 #include <kis_paint_device.h>
 #include "kis_png_converter.h"
 
@@ -32,8 +35,22 @@ KisOpenRasterLoadContext::KisOpenRasterLoadContext(KoStore* _store)
 {
 }
 
-KisImageSP KisOpenRasterLoadContext::loadDeviceData(const QString & filename)
+namespace {
+
+struct DecodeJob {
+    QString fileName;
+    QByteArray data;
+    KisPaintDeviceSP device;
+};
+
+}
+
+KisPaintDeviceSP KisOpenRasterLoadContext::loadDeviceData(const QString & filename)
 {
+    if (m_preloadedDevices.contains(filename)) {
+        return m_preloadedDevices.take(filename);
+    }
+
     if (m_store->open(filename)) {
         KoStoreDevice io(m_store);
         if (!io.open(QIODevice::ReadOnly)) {
@@ -41,16 +58,79 @@ KisImageSP KisOpenRasterLoadContext::loadDeviceData(const QString & filename)
             return 0;
         }
         KisPNGConverter pngConv(0);
-        pngConv.buildImage(&io);
+        pngConv.buildDevice(&io);
         io.close();
         m_store->close();
 
-        return pngConv.image();
+        return pngConv.device();
 
     }
     return 0;
 }
 
+void KisOpenRasterLoadContext::preloadDeviceData(const QStringList &fileNames)
+{
+    /**
+     * Keep only a few compressed files in memory at once, the decoded
+     * images are needed anyway
+     */
+    const int batchSize = 2 * QThread::idealThreadCount();
+
+    QThread *callingThread = QThread::currentThread();
+
+    QSet<QString> seenFileNames;
+    QVector<DecodeJob> jobs;
+
+    for (int i = 0; i < fileNames.size(); i++) {
+        const QString &fileName = fileNames[i];
+
+        if (!seenFileNames.contains(fileName) && m_store->open(fileName)) {
+            seenFileNames.insert(fileName);
+
+            DecodeJob job;
+            job.fileName = fileName;
+            job.data = m_store->read(m_store->size());
+            m_store->close();
+
+            jobs.append(job);
+        }
+
+        if (jobs.size() < batchSize && i < fileNames.size() - 1) continue;
+
+        /**
+         * Only the paint devices are created in the workers, the image
+         * and the layers are created by the caller from its own thread
+         */
+        QtConcurrent::blockingMap(jobs,
+            [callingThread] (DecodeJob &job) {
+                QBuffer buffer(&job.data);
+                if (!buffer.open(QIODevice::ReadOnly)) return;
+
+                // no dialogs are allowed outside the GUI thread
+                KisPNGConverter pngConv(0, true);
+                pngConv.buildDevice(&buffer);
+                buffer.close();
+
+                job.device = pngConv.device();
+                job.data.clear();
+
+                if (job.device) {
+                    job.device->moveToThread(callingThread);
+                }
+            });
+
+        Q_FOREACH (const DecodeJob &job, jobs) {
+            if (job.device) {
+                m_preloadedDevices.insert(job.fileName, job.device);
+            } else {
+                dbgFile << "Could not decode" << job.fileName;
+            }
+        }
+
+        jobs.clear();
+    }
+}
+
 QDomDocument KisOpenRasterLoadContext::loadStack()
 {
     m_store->open("stack.xml");
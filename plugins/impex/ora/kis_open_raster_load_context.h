@@ -20,11 +20,13 @@
 #define _KIS_OPEN_RASTER_LOAD_CONTEXT_H_
 
 class QString;
+class QStringList;
 class QDomDocument;
 class KoStore;
 
+#include <QHash>
+
 #include <KoStoreDevice.h>
-#include <kis_image.h>
 #include <kis_paint_device.h>
 #include "kis_png_converter.h"
 #include <kis_types.h>
@@ -33,10 +35,19 @@ class KisOpenRasterLoadContext
 {
 public:
     KisOpenRasterLoadContext(KoStore *store);
-    KisImageSP loadDeviceData(const QString &fileName);
+    KisPaintDeviceSP loadDeviceData(const QString &fileName);
+
+    /**
+     * Decodes the PNG files \p fileNames in parallel. The store is read
+     * sequentially, only the decoding is done in several threads. The
+     * decoded devices are returned by loadDeviceData() afterwards.
+     */
+    void preloadDeviceData(const QStringList &fileNames);
+
     QDomDocument loadStack();
 private:
     KoStore *m_store;
+    QHash<QString, KisPaintDeviceSP> m_preloadedDevices;
 };
 
 
@@ -20,6 +20,7 @@
 
 #include <QDomElement>
 #include <QDomNode>
+#include <QStringList>
 
 #include <KoColorSpaceRegistry.h>
 
@@ -41,6 +42,21 @@
 
 #include "kis_open_raster_load_context.h"
 
+namespace {
+
+void collectLayerFiles(const QDomElement &stack, QStringList *fileNames)
+{
+    for (QDomElement elem = stack.firstChildElement(); !elem.isNull(); elem = elem.nextSiblingElement()) {
+        if (elem.nodeName() == "stack") {
+            collectLayerFiles(elem, fileNames);
+        } else if (elem.nodeName() == "layer" && !elem.attribute("src").isNull()) {
+            fileNames->append(elem.attribute("src"));
+        }
+    }
+}
+
+}
+
 struct KisOpenRasterStackLoadVisitor::Private {
     KisImageSP image;
     vKisNodeSP activeNodes;
@@ -107,6 +123,16 @@ void KisOpenRasterStackLoadVisitor::loadImage()
             for (QDomNode node2 = node.firstChild(); !node2.isNull(); node2 = node2.nextSibling()) {
                 if (node2.isElement() && node2.nodeName() == "stack") { // it's the root layer !
                     QDomElement subelem2 = node2.toElement();
+
+                    /**
+                     * Decode all the layers in parallel first, the layers
+                     * are added to the image in the order of the stack
+                     * afterwards
+                     */
+                    QStringList layerFiles;
+                    collectLayerFiles(subelem2, &layerFiles);
+                    d->loadContext->preloadDeviceData(layerFiles);
+
                     loadGroupLayer(subelem2, d->image->rootLayer());
                     break;
                 }
@@ -216,12 +242,10 @@ void KisOpenRasterStackLoadVisitor::loadGroupLayer(const QDomElement& elem, KisG
                 QString filename = subelem.attribute("src");
                 if (!filename.isNull()) {
                     const qreal opacity = KisDomUtils::toDouble(subelem.attribute("opacity", "1.0"));
-                    KisImageSP pngImage = d->loadContext->loadDeviceData(filename);
-                    if (pngImage) {
+                    KisPaintDeviceSP device = d->loadContext->loadDeviceData(filename);
+                    if (device) {
                         // If ORA doesn't have resolution info, load the default value(75 ppi) else fetch from stack.xml
                         d->image->setResolution(d->xRes, d->yRes);
-                        // now get the device
-                        KisPaintDeviceSP device = pngImage->projection();
 
                         KisPaintLayerSP layer = new KisPaintLayer(groupLayer->image() , "", opacity * 255, device);
                         d->image->addNode(layer, groupLayer, 0);
@@ -21,6 +21,12 @@
 
 #include <QTest>
 #include <QCoreApplication>
+#include <QThread>
+
+#include <KoColor.h>
+#include <KoColorSpaceRegistry.h>
+#include <kis_group_layer.h>
+#include <kis_paint_layer.h>
 
 #include "filestest.h"
 
@@ -51,6 +57,91 @@ void KisOraTest::testImportIncorrectFormat()
 }
 
 
+namespace {
+
+void fillLayer(KisPaintDeviceSP dev, int seed)
+{
+    const KoColorSpace *cs = dev->colorSpace();
+
+    // a few opaque and semi-transparent rects, different for every layer
+    for (int i = 0; i < 4; i++) {
+        const QRect rc((seed * 37 + i * 61) % 250, (seed * 23 + i * 41) % 150,
+                       20 + (seed * 13 + i * 7) % 60, 15 + (seed * 11 + i * 5) % 40);
+        const QColor color((seed * 50 + i * 20) % 256, (seed * 90 + i * 70) % 256,
+                           (seed * 30 + i * 110) % 256, i == 3 ? 128 : 255);
+        dev->fill(rc, KoColor(color, cs));
+    }
+}
+
+}
+
+void KisOraTest::testRoundTripLayers()
+{
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb8();
+    const QRect imageRect(0, 0, 300, 200);
+    const QString fileName("test_layers.ora");
+    QFile::remove(fileName);
+
+    // more layers than the loader decodes in one batch
+    const int numLayers = 2 * QThread::idealThreadCount() + 3;
+
+    QMap<QString, QImage> expectedLayers;
+
+    {
+        QScopedPointer<KisDocument> doc(KisPart::instance()->createDocument());
+        doc->setFileBatchMode(true);
+
+        KisImageSP image = new KisImage(0, imageRect.width(), imageRect.height(), cs, "ora test");
+        KisGroupLayerSP group = new KisGroupLayer(image, "group", OPACITY_OPAQUE_U8);
+        image->addNode(group, image->root());
+
+        for (int i = 0; i < numLayers; i++) {
+            const QString name = QString("layer%1").arg(i);
+            KisPaintLayerSP layer = new KisPaintLayer(image, name, OPACITY_OPAQUE_U8);
+            fillLayer(layer->paintDevice(), i);
+            image->addNode(layer, i % 3 ? image->root() : KisNodeSP(group));
+
+            expectedLayers[name] = layer->paintDevice()->convertToQImage(0, imageRect);
+        }
+
+        image->initialRefreshGraph();
+        doc->setCurrentImage(image);
+
+        QVERIFY(doc->exportDocumentSync(QUrl::fromLocalFile(fileName), OraMimetype.toLatin1()));
+    }
+
+    QScopedPointer<KisDocument> doc(KisPart::instance()->createDocument());
+    KisImportExportManager manager(doc.data());
+    doc->setFileBatchMode(true);
+
+    QVERIFY(manager.importDocument(fileName, QString()).isOk());
+
+    KisImageSP image = doc->image();
+    QVERIFY(image);
+
+    KisNodeSP group = TestUtil::findNode(image->root(), "group");
+    QVERIFY(group);
+
+    int numLoadedLayers = 0;
+
+    for (auto it = expectedLayers.constBegin(); it != expectedLayers.constEnd(); ++it) {
+        KisNodeSP node = TestUtil::findNode(image->root(), it.key());
+        QVERIFY2(node, qPrintable(it.key()));
+        QVERIFY(dynamic_cast<KisPaintLayer*>(node.data()));
+
+        const int index = it.key().mid(5).toInt();
+        QCOMPARE(node->parent() == group, index % 3 == 0);
+
+        QPoint pt;
+        if (!TestUtil::compareQImages(pt, it.value(), node->paintDevice()->convertToQImage(0, imageRect))) {
+            QFAIL(QString("Layer %1 differs at %2, %3").arg(it.key()).arg(pt.x()).arg(pt.y()).toLatin1());
+        }
+
+        numLoadedLayers++;
+    }
+
+    QCOMPARE(numLoadedLayers, numLayers);
+}
 
 KISTEST_MAIN(KisOraTest)
 
@@ -29,6 +29,8 @@ private Q_SLOTS:
     void testImportFromWriteonly();
     void testExportToReadonly();
     void testImportIncorrectFormat();
+
+    void testRoundTripLayers();
 };
 
 #endif // _KIS_ORA_TEST_H_
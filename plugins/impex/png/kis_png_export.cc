@@ -66,6 +66,7 @@ KisImportExportErrorCode KisPNGExport::convert(KisDocument *document, QIODevice
     options.alpha = configuration->getBool("alpha", true);
     options.interlace = configuration->getBool("interlaced", false);
     options.compression = configuration->getInt("compression", 3);
+    options.compressionPreset = KisPNGOptions::CompressionPreset(configuration->getInt("compressionPreset", KisPNGOptions::DefaultCompression));
     options.tryToSaveAsIndexed = configuration->getBool("indexed", false);
     KoColor c(KoColorSpaceRegistry::instance()->rgb8());
     c.fromQColor(Qt::white);
@@ -104,6 +105,7 @@ KisPropertiesConfigurationSP KisPNGExport::defaultConfiguration(const QByteArray
     cfg->setProperty("alpha", true);
     cfg->setProperty("indexed", false);
     cfg->setProperty("compression", 3);
+    cfg->setProperty("compressionPreset", int(KisPNGOptions::DefaultCompression));
     cfg->setProperty("interlaced", false);
 
     KoColor fill_color(KoColorSpaceRegistry::instance()->rgb8());
@@ -175,6 +177,8 @@ void KisWdgOptionsPNG::setConfiguration(const KisPropertiesConfigurationSP cfg)
     interlacing->setChecked(cfg->getBool("interlaced", false));
     compressionLevel->setValue(cfg->getInt("compression", 3));
     compressionLevel->setRange(1, 9, 0);
+    cmbCompressionPreset->setCurrentIndex(cfg->getInt("compressionPreset", KisPNGOptions::DefaultCompression));
+    on_cmbCompressionPreset_currentIndexChanged(cmbCompressionPreset->currentIndex());
 
     tryToSaveAsIndexed->setVisible(!isThereAlpha);
 
@@ -206,6 +210,7 @@ KisPropertiesConfigurationSP KisWdgOptionsPNG::configuration() const
     bool alpha = this->alpha->isChecked();
     bool interlace = interlacing->isChecked();
     int compression = (int)compressionLevel->value();
+    int compressionPreset = cmbCompressionPreset->currentIndex();
     bool saveAsHDR = chkSaveAsHDR->isChecked();
     bool tryToSaveAsIndexed = !saveAsHDR && this->tryToSaveAsIndexed->isChecked();
     bool saveSRGB = !saveAsHDR && chkSRGB->isChecked();
@@ -220,6 +225,7 @@ KisPropertiesConfigurationSP KisWdgOptionsPNG::configuration() const
     cfg->setProperty("alpha", alpha);
     cfg->setProperty("indexed", tryToSaveAsIndexed);
     cfg->setProperty("compression", compression);
+    cfg->setProperty("compressionPreset", compressionPreset);
     cfg->setProperty("interlaced", interlace);
     cfg->setProperty("transparencyFillcolor", transparencyFillcolor);
     cfg->setProperty("saveAsHDR", saveAsHDR);
@@ -236,6 +242,11 @@ void KisWdgOptionsPNG::on_alpha_toggled(bool checked)
     bnTransparencyFillColor->setEnabled(!checked);
 }
 
+void KisWdgOptionsPNG::on_cmbCompressionPreset_currentIndexChanged(int index)
+{
+    compressionLevel->setEnabled(index != KisPNGOptions::FastNoFilter);
+}
+
 void KisWdgOptionsPNG::slotUseHDRChanged(bool value)
 {
     tryToSaveAsIndexed->setDisabled(value);
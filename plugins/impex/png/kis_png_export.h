@@ -37,6 +37,7 @@ public:
 
 private Q_SLOTS:
     void on_alpha_toggled(bool checked);
+    void on_cmbCompressionPreset_currentIndexChanged(int index);
     void slotUseHDRChanged(bool value);
 };
 
@@ -21,11 +21,14 @@
 
 #include <QTest>
 #include <QCoreApplication>
+#include <QFile>
 
 #include "filestest.h"
 
 #include  <sdk/tests/kistest.h>
 
+#include <kis_png_converter.h>
+
 #ifndef FILES_DATA_DIR
 #error "FILES_DATA_DIR not set. A directory with the data used for testing the importing of files in krita"
 #endif
@@ -175,5 +178,86 @@ void KisPngTest::testSaveHDR()
                     KoColorSpaceRegistry::instance()->p2020PQProfile()));
 }
 
+void roundTripCompressionPreset(const KoColorSpace *colorSpace, KisPNGOptions::CompressionPreset preset, bool interlace)
+{
+    // big enough to be split into several bands by the encoder
+    QImage sourceImage(257, 600, QImage::Format_ARGB32);
+    for (int y = 0; y < sourceImage.height(); y++) {
+        QRgb *line = reinterpret_cast<QRgb*>(sourceImage.scanLine(y));
+        for (int x = 0; x < sourceImage.width(); x++) {
+            line[x] = y < 300 ?
+                qRgba(x, y, (x * y) & 0xff, 255) :
+                qRgba(qrand() & 0xff, qrand() & 0xff, qrand() & 0xff, 255);
+        }
+    }
+
+    QImage savedImage;
+
+    const QString fileName = QString("test_preset_%1_%2%3.png")
+        .arg(colorSpace->colorDepthId().id())
+        .arg(int(preset))
+        .arg(interlace ? "_interlaced" : "");
+
+    QFile::remove(fileName);
+
+    {
+        QScopedPointer<KisDocument> doc(KisPart::instance()->createDocument());
+
+        KisImageSP image = new KisImage(0, sourceImage.width(), sourceImage.height(), colorSpace, "png test");
+        KisPaintLayerSP paintLayer0 = new KisPaintLayer(image, "paint0", OPACITY_OPAQUE_U8);
+        paintLayer0->paintDevice()->convertFromQImage(sourceImage, 0);
+        image->addNode(paintLayer0, image->root());
+        image->initialRefreshGraph();
+
+        savedImage = image->projection()->convertToQImage(0);
+
+        KisImportExportManager manager(doc.data());
+        doc->setFileBatchMode(true);
+        doc->setCurrentImage(image);
+
+        KisPropertiesConfigurationSP exportConfiguration = new KisPropertiesConfiguration();
+        exportConfiguration->setProperty("compressionPreset", int(preset));
+        exportConfiguration->setProperty("interlaced", interlace);
+        exportConfiguration->setProperty("alpha", true);
+        QVERIFY(doc->exportDocumentSync(QUrl::fromLocalFile(fileName), "image/png", exportConfiguration));
+    }
+
+    {
+        QScopedPointer<KisDocument> doc(KisPart::instance()->createDocument());
+        KisImportExportManager manager(doc.data());
+        doc->setFileBatchMode(true);
+
+        KisImportExportErrorCode loadingStatus =
+            manager.importDocument(fileName, QString());
+
+        QVERIFY(loadingStatus.isOk());
+
+        KisImageSP image = doc->image();
+        image->initialRefreshGraph();
+
+        QPoint pt;
+        QVERIFY(TestUtil::compareQImages(pt, savedImage, image->projection()->convertToQImage(0), 1, 1));
+    }
+}
+
+void KisPngTest::testCompressionPresets()
+{
+    QVector<const KoColorSpace*> colorSpaces;
+    colorSpaces << KoColorSpaceRegistry::instance()->rgb8();
+    colorSpaces << KoColorSpaceRegistry::instance()->rgb16();
+
+    QVector<KisPNGOptions::CompressionPreset> presets;
+    presets << KisPNGOptions::DefaultCompression;
+    presets << KisPNGOptions::FastNoFilter;
+    presets << KisPNGOptions::FastRLE;
+
+    Q_FOREACH (const KoColorSpace *colorSpace, colorSpaces) {
+        Q_FOREACH (KisPNGOptions::CompressionPreset preset, presets) {
+            roundTripCompressionPreset(colorSpace, preset, false);
+        }
+        roundTripCompressionPreset(colorSpace, KisPNGOptions::DefaultCompression, true);
+    }
+}
+
 KISTEST_MAIN(KisPngTest)
 
@@ -28,6 +28,7 @@ private Q_SLOTS:
     void testFiles();
     void testWriteonly();
     void testSaveHDR();
+    void testCompressionPresets();
 };
 
 #endif
@@ -182,6 +182,7 @@ PSDLayerRecord::PSDLayerRecord(const PSDHeader& header)
     , layerName("UNINITIALIZED")
     , infoBlocks(header)
     , m_transparencyMaskSizeOffset(0)
+    , m_pixelDataPrepared(false)
     , m_header(header)
 {
 }
@@ -593,16 +594,59 @@ KisPaintDeviceSP PSDLayerRecord::convertMaskDeviceIfNeeded(KisPaintDeviceSP dev)
     return result;
 }
 
+PsdPixelUtils::CompressedChannelData PSDLayerRecord::compressTransparencyMask()
+{
+    KisPaintDeviceSP device = convertMaskDeviceIfNeeded(m_onlyTransparencyMask->paintDevice());
+
+    QByteArray buffer(device->pixelSize() * m_onlyTransparencyMaskRect.width() * m_onlyTransparencyMaskRect.height(), 0);
+    device->readBytes((quint8*)buffer.data(), m_onlyTransparencyMaskRect);
+
+    return PsdPixelUtils::compressChannelDataRLE((quint8*)buffer.data(), device->pixelSize(), m_onlyTransparencyMaskRect);
+}
+
 void PSDLayerRecord::writeTransparencyMaskPixelData(QIODevice *io)
 {
     if (m_onlyTransparencyMask) {
-        KisPaintDeviceSP device = convertMaskDeviceIfNeeded(m_onlyTransparencyMask->paintDevice());
+        const PsdPixelUtils::CompressedChannelData data =
+            m_pixelDataPrepared ? m_compressedTransparencyMask : compressTransparencyMask();
+
+        PsdPixelUtils::writeCompressedChannelRLE(io, data, m_transparencyMaskSizeOffset, -1, true);
+    }
+}
+
+QRect PSDLayerRecord::layerRect() const
+{
+    return QRect(left, top, right - left, bottom - top);
+}
+
+QVector<PsdPixelUtils::ChannelWritingInfo> PSDLayerRecord::channelWritingInfoList() const
+{
+    QVector<PsdPixelUtils::ChannelWritingInfo> writingInfoList;
+    Q_FOREACH (const ChannelInfo *channelInfo, channelInfoRecords) {
+        writingInfoList <<
+            PsdPixelUtils::ChannelWritingInfo(channelInfo->channelId,
+                                              channelInfo->channelInfoPosition);
+    }
+    return writingInfoList;
+}
 
-        QByteArray buffer(device->pixelSize() * m_onlyTransparencyMaskRect.width() * m_onlyTransparencyMaskRect.height(), 0);
-        device->readBytes((quint8*)buffer.data(), m_onlyTransparencyMaskRect);
+void PSDLayerRecord::preparePixelData()
+{
+    const QRect rc = layerRect();
+
+    if (!rc.isEmpty()) {
+        m_compressedChannels =
+            PsdPixelUtils::compressPixelDataRLE(m_layerContentDevice, rc,
+                                                m_header.colormode,
+                                                m_header.channelDepth / 8,
+                                                true, channelWritingInfoList());
+    }
 
-        PsdPixelUtils::writeChannelDataRLE(io, (quint8*)buffer.data(), device->pixelSize(), m_onlyTransparencyMaskRect, m_transparencyMaskSizeOffset, -1, true);
+    if (m_onlyTransparencyMask) {
+        m_compressedTransparencyMask = compressTransparencyMask();
     }
+
+    m_pixelDataPrepared = true;
 }
 
 void PSDLayerRecord::writePixelData(QIODevice *io)
@@ -610,8 +654,16 @@ void PSDLayerRecord::writePixelData(QIODevice *io)
     try {
         writePixelDataImpl(io);
     }  catch (KisAslWriterUtils::ASLWriteException &e) {
+        m_compressedChannels.clear();
+        m_compressedTransparencyMask = PsdPixelUtils::CompressedChannelData();
+        m_pixelDataPrepared = false;
+
         throw KisAslWriterUtils::ASLWriteException(PREPEND_METHOD(e.what()));
     }
+
+    m_compressedChannels.clear();
+    m_compressedTransparencyMask = PsdPixelUtils::CompressedChannelData();
+    m_pixelDataPrepared = false;
 }
 
 void PSDLayerRecord::writePixelDataImpl(QIODevice *io)
@@ -619,7 +671,7 @@ void PSDLayerRecord::writePixelDataImpl(QIODevice *io)
     dbgFile << "writing pixel data for layer" << layerName << "at" << io->pos();
 
     KisPaintDeviceSP dev = m_layerContentDevice;
-    const QRect rc(left, top, right - left, bottom - top);
+    const QRect rc = layerRect();
 
     if (rc.isEmpty()) {
         dbgFile << "Layer is empty! Writing placeholder information.";
@@ -641,14 +693,13 @@ void PSDLayerRecord::writePixelDataImpl(QIODevice *io)
     const int channelSize = m_header.channelDepth / 8;
     const psd_color_mode colorMode = m_header.colormode;
 
-    QVector<PsdPixelUtils::ChannelWritingInfo> writingInfoList;
-    Q_FOREACH (const ChannelInfo *channelInfo, channelInfoRecords) {
-        writingInfoList <<
-            PsdPixelUtils::ChannelWritingInfo(channelInfo->channelId,
-                                              channelInfo->channelInfoPosition);
-    }
+    QVector<PsdPixelUtils::ChannelWritingInfo> writingInfoList = channelWritingInfoList();
 
-    PsdPixelUtils::writePixelDataCommon(io, dev, rc, colorMode, channelSize, true, true, writingInfoList);
+    if (m_pixelDataPrepared) {
+        PsdPixelUtils::writeCompressedPixelData(io, m_compressedChannels, true, writingInfoList);
+    } else {
+        PsdPixelUtils::writePixelDataCommon(io, dev, rc, colorMode, channelSize, true, true, writingInfoList);
+    }
     writeTransparencyMaskPixelData(io);
 }
 
@@ -659,6 +710,12 @@ bool PSDLayerRecord::valid()
 }
 
 bool PSDLayerRecord::readPixelData(QIODevice *io, KisPaintDeviceSP device)
+{
+    PsdPixelUtils::RawChannelsDataSP data = fetchPixelData(io);
+    return data && decodePixelData(data, device);
+}
+
+PsdPixelUtils::RawChannelsDataSP PSDLayerRecord::fetchPixelData(QIODevice *io)
 {
     dbgFile << "Reading pixel data for layer" << layerName << "pos" << io->pos();
 
@@ -668,8 +725,21 @@ bool PSDLayerRecord::readPixelData(QIODevice *io, KisPaintDeviceSP device)
                                   right - left,
                                   bottom - top);
 
+    PsdPixelUtils::RawChannelsDataSP data;
+
     try {
-        PsdPixelUtils::readChannels(io, device, m_header.colormode, channelSize, layerRect, channelInfoRecords);
+        data = PsdPixelUtils::fetchRawChannels(io, layerRect, channelSize, channelInfoRecords, false);
+    } catch (KisAslReaderUtils::ASLParseException &e) {
+        error = e.what();
+    }
+
+    return data;
+}
+
+bool PSDLayerRecord::decodePixelData(PsdPixelUtils::RawChannelsDataSP data, KisPaintDeviceSP device)
+{
+    try {
+        PsdPixelUtils::decodeChannels(data, device, m_header.colormode);
     } catch (KisAslReaderUtils::ASLParseException &e) {
         device->clear();
         error = e.what();
@@ -701,28 +771,56 @@ QRect PSDLayerRecord::channelRect(ChannelInfo *channel) const
 
 bool PSDLayerRecord::readMask(QIODevice *io, KisPaintDeviceSP dev, ChannelInfo *channelInfo)
 {
-    KIS_ASSERT_RECOVER(channelInfo->channelId < -1) { return false; }
+    PsdPixelUtils::RawChannelsDataSP data = fetchMask(io, channelInfo);
+    return data && decodeMask(data, dev);
+}
+
+PsdPixelUtils::RawChannelsDataSP PSDLayerRecord::fetchMask(QIODevice *io, ChannelInfo *channelInfo)
+{
+    KIS_ASSERT_RECOVER(channelInfo->channelId < -1) { return PsdPixelUtils::RawChannelsDataSP(); }
 
     dbgFile << "Going to read" << channelIdToChannelType(channelInfo->channelId, m_header.colormode) << "mask";
 
     QRect maskRect = channelRect(channelInfo);
     if (maskRect.isEmpty()) {
         dbgFile << "Empty Channel";
-        return true;
     }
 
-    // the device must be a pixel selection
-    KIS_ASSERT_RECOVER(dev->pixelSize() == 1) { return false; }
-
-    dev->setDefaultPixel(KoColor(&layerMask.defaultColor, dev->colorSpace()));
-
     const int pixelSize =
         m_header.channelDepth == 16 ? 2 :
         m_header.channelDepth == 32 ? 4 : 1;
 
     QVector<ChannelInfo*> infoRecords;
     infoRecords << channelInfo;
-    PsdPixelUtils::readAlphaMaskChannels(io, dev, pixelSize, maskRect, infoRecords);
+
+    PsdPixelUtils::RawChannelsDataSP data;
+
+    try {
+        data = PsdPixelUtils::fetchRawChannels(io, maskRect, pixelSize, infoRecords, true);
+    } catch (KisAslReaderUtils::ASLParseException &e) {
+        dbgFile << "failed fetching mask data:" << e.what();
+    }
+
+    return data;
+}
+
+bool PSDLayerRecord::decodeMask(PsdPixelUtils::RawChannelsDataSP data, KisPaintDeviceSP dev) const
+{
+    if (data->rect.isEmpty()) {
+        return true;
+    }
+
+    // the device must be a pixel selection
+    KIS_ASSERT_RECOVER(dev->pixelSize() == 1) { return false; }
+
+    dev->setDefaultPixel(KoColor(&layerMask.defaultColor, dev->colorSpace()));
+
+    try {
+        PsdPixelUtils::decodeAlphaMaskChannels(data, dev);
+    } catch (KisAslReaderUtils::ASLParseException &e) {
+        dbgFile << "failed decoding mask data:" << e.what();
+        return false;
+    }
 
     return true;
 }
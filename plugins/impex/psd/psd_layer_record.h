@@ -33,6 +33,7 @@
 #include "compression.h"
 
 #include "psd_additional_layer_info_block.h"
+#include "psd_pixel_utils.h"
 
 #include <boost/function.hpp>
 
@@ -97,9 +98,31 @@ public:
     bool readPixelData(QIODevice* io, KisPaintDeviceSP device);
     bool readMask(QIODevice* io, KisPaintDeviceSP dev, ChannelInfo *channel);
 
+    /**
+     * Reading of the pixel data is split into two stages: fetching of the
+     * compressed data from \p io, which must be done sequentially, and
+     * decoding it into the device, which can be done in any thread.
+     *
+     * decodePixelData() may be called concurrently for different layers,
+     * decodeMask() doesn't modify the record at all.
+     */
+    PsdPixelUtils::RawChannelsDataSP fetchPixelData(QIODevice* io);
+    bool decodePixelData(PsdPixelUtils::RawChannelsDataSP data, KisPaintDeviceSP device);
+
+    PsdPixelUtils::RawChannelsDataSP fetchMask(QIODevice* io, ChannelInfo *channel);
+    bool decodeMask(PsdPixelUtils::RawChannelsDataSP data, KisPaintDeviceSP dev) const;
+
     void write(QIODevice* io, KisPaintDeviceSP layerContentDevice, KisNodeSP onlyTransparencyMask, const QRect &maskRect, psd_section_type sectionType, const QDomDocument &stylesXmlDoc, bool useLfxsLayerStyleFormat);
     void writePixelData(QIODevice* io);
 
+    /**
+     * Compresses the pixel data of the layer and its transparency mask
+     * without touching any IO device. It may be called concurrently for
+     * different layers after write(). The next writePixelData() call will
+     * write the prepared data and release it.
+     */
+    void preparePixelData();
+
     bool valid();
 
     QString error;
@@ -162,6 +185,10 @@ private:
 
     KisPaintDeviceSP convertMaskDeviceIfNeeded(KisPaintDeviceSP dev);
 
+    QRect layerRect() const;
+    QVector<PsdPixelUtils::ChannelWritingInfo> channelWritingInfoList() const;
+    PsdPixelUtils::CompressedChannelData compressTransparencyMask();
+
 private:
 
     KisPaintDeviceSP m_layerContentDevice;
@@ -169,6 +196,10 @@ private:
     QRect m_onlyTransparencyMaskRect;
     qint64 m_transparencyMaskSizeOffset;
 
+    bool m_pixelDataPrepared;
+    QVector<PsdPixelUtils::CompressedChannelData> m_compressedChannels;
+    PsdPixelUtils::CompressedChannelData m_compressedTransparencyMask;
+
     const PSDHeader m_header;
 };
 
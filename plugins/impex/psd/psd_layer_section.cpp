@@ -19,6 +19,8 @@
 
 
 #include <QIODevice>
+#include <QThread>
+#include <QtConcurrent>
 
 #include <KoColor.h>
 #include <KoColorSpace.h>
@@ -567,9 +569,26 @@ void PSDLayerMaskSection::writeImpl(QIODevice* io, KisNodeSP rootLayer)
 
             dbgFile << "start writing layer pixel data" << io->pos();
 
-            // Now save the pixel data
-            Q_FOREACH (PSDLayerRecord *layerRecord, layers) {
-                layerRecord->writePixelData(io);
+            /**
+             * Now save the pixel data. Compression of the layers doesn't
+             * depend on the stream, so a batch of layers is compressed in
+             * parallel and then written sequentially in the order of the
+             * records. The batch size limits the amount of compressed
+             * data kept in memory.
+             */
+            const int batchSize = qMax(1, 4 * QThread::idealThreadCount());
+
+            for (int batchStart = 0; batchStart < layers.size(); batchStart += batchSize) {
+                const QVector<PSDLayerRecord*> batch = layers.mid(batchStart, batchSize);
+
+                QtConcurrent::blockingMap(batch,
+                    [] (PSDLayerRecord *layerRecord) {
+                        layerRecord->preparePixelData();
+                    });
+
+                Q_FOREACH (PSDLayerRecord *layerRecord, batch) {
+                    layerRecord->writePixelData(io);
+                }
             }
 
         }
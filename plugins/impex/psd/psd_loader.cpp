@@ -21,6 +21,8 @@
 
 #include <QFileInfo>
 #include <QStack>
+#include <QThread>
+#include <QtConcurrent>
 
 #include <KoColorSpace.h>
 #include <KoColorSpaceRegistry.h>
@@ -52,6 +54,96 @@
 #include "psd_resource_block.h"
 #include "psd_image_data.h"
 
+namespace {
+
+/**
+ * Decodes the pixel data of the layers and masks in parallel. The
+ * compressed data is fetched from the file sequentially by the loader
+ * and is decoded in batches, so that the amount of compressed data kept
+ * in memory stays limited.
+ */
+class PixelDataDecoder
+{
+public:
+    PixelDataDecoder()
+        : m_maxPendingJobs(4 * qMax(1, QThread::idealThreadCount())),
+          m_pendingBytes(0)
+    {
+    }
+
+    bool addLayer(PSDLayerRecord *record, PsdPixelUtils::RawChannelsDataSP data, KisPaintDeviceSP device) {
+        return addJob(Job(record, data, device, false));
+    }
+
+    bool addMask(PSDLayerRecord *record, PsdPixelUtils::RawChannelsDataSP data, KisPaintDeviceSP device) {
+        return addJob(Job(record, data, device, true));
+    }
+
+    /**
+     * Decodes all the pending jobs. Returns false if any of the layers
+     * failed to decode. A failure of a mask is not fatal.
+     */
+    bool flush() {
+        QtConcurrent::blockingMap(m_jobs,
+            [] (Job &job) {
+                job.result = job.isMask ?
+                    job.record->decodeMask(job.data, job.device) :
+                    job.record->decodePixelData(job.data, job.device);
+            });
+
+        bool result = true;
+
+        Q_FOREACH (const Job &job, m_jobs) {
+            if (job.result) continue;
+
+            if (job.isMask) {
+                dbgFile << "failed reading masks for layer: " << job.record->layerName;
+            } else {
+                dbgFile << "failed reading channels for layer: " << job.record->layerName << job.record->error;
+                result = false;
+            }
+        }
+
+        m_jobs.clear();
+        m_pendingBytes = 0;
+
+        return result;
+    }
+
+private:
+    struct Job {
+        Job() {}
+        Job(PSDLayerRecord *_record, PsdPixelUtils::RawChannelsDataSP _data, KisPaintDeviceSP _device, bool _isMask)
+            : record(_record), data(_data), device(_device), isMask(_isMask) {}
+
+        PSDLayerRecord *record = 0;
+        PsdPixelUtils::RawChannelsDataSP data;
+        KisPaintDeviceSP device;
+        bool isMask = false;
+        bool result = false;
+    };
+
+    bool addJob(const Job &job) {
+        m_jobs.append(job);
+        m_pendingBytes += job.data->size();
+
+        const qint64 maxPendingBytes = 256 * 1024 * 1024;
+
+        if (m_jobs.size() >= m_maxPendingJobs || m_pendingBytes >= maxPendingBytes) {
+            return flush();
+        }
+
+        return true;
+    }
+
+private:
+    QVector<Job> m_jobs;
+    const int m_maxPendingJobs;
+    qint64 m_pendingBytes;
+};
+
+}
+
 PSDLoader::PSDLoader(KisDocument *doc)
     : m_image(0)
     , m_doc(doc)
@@ -198,6 +290,8 @@ KisImportExportErrorCode PSDLoader::decode(QIODevice *io)
     typedef QPair<QDomDocument, KisLayerSP> LayerStyleMapping;
     QVector<LayerStyleMapping> allStylesXml;
 
+    PixelDataDecoder pixelDataDecoder;
+
     // read the channels for the various layers
     for(int i = 0; i < layerSection.nLayers; ++i) {
 
@@ -280,7 +374,10 @@ KisImportExportErrorCode PSDLoader::decode(QIODevice *io)
                 allStylesXml << LayerStyleMapping(styleXml, layer);
             }
 
-            if (!layerRecord->readPixelData(io, layer->paintDevice())) {
+            PsdPixelUtils::RawChannelsDataSP pixelData = layerRecord->fetchPixelData(io);
+            if (!pixelData ||
+                !pixelDataDecoder.addLayer(layerRecord, pixelData, layer->paintDevice())) {
+
                 dbgFile << "failed reading channels for layer: " << layerRecord->layerName << layerRecord->error;
                 return ImportExportCodes::FileFormatIncorrect;
             }
@@ -300,8 +397,11 @@ KisImportExportErrorCode PSDLoader::decode(QIODevice *io)
                 KisTransparencyMaskSP mask = new KisTransparencyMask();
                 mask->setName(i18n("Transparency Mask"));
                 mask->initSelection(newLayer);
-                if (!layerRecord->readMask(io, mask->paintDevice(), channelInfo)) {
+                PsdPixelUtils::RawChannelsDataSP maskData = layerRecord->fetchMask(io, channelInfo);
+                if (!maskData) {
                     dbgFile << "failed reading masks for layer: " << layerRecord->layerName << layerRecord->error;
+                } else if (!pixelDataDecoder.addMask(layerRecord, maskData, mask->paintDevice())) {
+                    return ImportExportCodes::FileFormatIncorrect;
                 }
                 m_image->addNode(mask, newLayer);
             }
@@ -310,6 +410,10 @@ KisImportExportErrorCode PSDLoader::decode(QIODevice *io)
         lastAddedLayer = newLayer;
     }
 
+    if (!pixelDataDecoder.flush()) {
+        return ImportExportCodes::FileFormatIncorrect;
+    }
+
     const QVector<QDomDocument> &embeddedPatterns =
         layerSection.globalInfoSection.embeddedPatterns;
 
@@ -19,9 +19,14 @@
 #include "psd_pixel_utils.h"
 
 #include <QtGlobal>
-#include <QMap>
 #include <QIODevice>
 
+#include <QtConcurrent>
+
+#include <memory>
+#include <numeric>
+#include <vector>
+
 
 #include <KoColorSpace.h>
 #include <KoColorSpaceMaths.h>
@@ -126,176 +131,170 @@ inline float convertByteOrder<KoLabF32Traits>(float value) {
     return qFromBigEndian((quint32)value);
 }
 
-template <class Traits>
-void readAlphaMaskPixel(const QMap<quint16, QByteArray> &channelBytes,
-                        int col, quint8 *dstPtr);
-
-template <>
-void readAlphaMaskPixel<AlphaU8Traits>(const QMap<quint16, QByteArray> &channelBytes,
-                                       int col, quint8 *dstPtr)
+/**
+ * Describes where a PSD channel goes in the destination pixel
+ */
+struct ChannelMapping {
+    qint16 channelId;
+    int pos;
+    bool invert;
+};
+
+template <class Traits, bool invert>
+void convertChannelSpan(const quint8 *srcRow, int srcCol, int numPixels,
+                        quint8 *dstPtr, int dstPos)
 {
-    *dstPtr = reinterpret_cast<const quint8*>(channelBytes.first().constData())[col];
-}
+    typedef typename Traits::channels_type channels_type;
 
-template <>
-void readAlphaMaskPixel<AlphaU16Traits>(const QMap<quint16, QByteArray> &channelBytes,
-                                       int col, quint8 *dstPtr)
-{
-    *dstPtr = reinterpret_cast<const quint16*>(channelBytes.first().constData())[col] >> 8;
-}
+    const channels_type unitValue = KoColorSpaceMathsTraits<channels_type>::unitValue;
+    channels_type *dst = reinterpret_cast<channels_type*>(dstPtr) + dstPos;
 
-template <>
-void readAlphaMaskPixel<AlphaF32Traits>(const QMap<quint16, QByteArray> &channelBytes,
-                                        int col, quint8 *dstPtr)
-{
-    *dstPtr = reinterpret_cast<const float*>(channelBytes.first().constData())[col] * 255;
-}
+    if (srcRow) {
+        const channels_type *src = reinterpret_cast<const channels_type*>(srcRow) + srcCol;
 
-template <class Traits>
-inline typename Traits::channels_type readChannelValue(const QMap<quint16, QByteArray> &channelBytes,
-                                       quint16 channelId, int col, typename Traits::channels_type defaultValue)
-{
-    typedef typename Traits::channels_type channels_type;
-
-    if (channelBytes.contains(channelId)) {
-        const QByteArray &bytes = channelBytes[channelId];
-        if (col < bytes.size()) {
-            return convertByteOrder<Traits>(reinterpret_cast<const channels_type *>(bytes.constData())[col]);
+        for (int i = 0; i < numPixels; i++) {
+            const channels_type value = convertByteOrder<Traits>(src[i]);
+            *dst = invert ? unitValue - value : value;
+            dst += Traits::channels_nb;
         }
+    } else {
+        // a missing channel is read as the unit value
+        const channels_type value = invert ? channels_type(0) : unitValue;
 
-        dbgFile << "col index out of range channelId: "<< channelId << " col:" << col;
+        for (int i = 0; i < numPixels; i++) {
+            *dst = value;
+            dst += Traits::channels_nb;
+        }
     }
+}
 
-    return defaultValue;
+/**
+ * Index of the row of a PSD channel in the array of row pointers passed
+ * to the row writers. Only the color channels and the transparency
+ * channel are used.
+ */
+inline int channelRowIndex(qint16 channelId) {
+    return channelId == -1 ? 4 : channelId;
 }
 
 template <class Traits>
-void readGrayPixel(const QMap<quint16, QByteArray> &channelBytes,
-                  int col, quint8 *dstPtr)
+void writeRow(KisHLineIteratorSP it, const QVector<ChannelMapping> &mapping,
+              const quint8 * const *rows)
 {
-    typedef typename Traits::Pixel Pixel;
-    typedef typename Traits::channels_type channels_type;
+    int col = 0;
+    int numPixels = 0;
 
-    const channels_type unitValue = KoColorSpaceMathsTraits<channels_type>::unitValue;
-    Pixel *pixelPtr = reinterpret_cast<Pixel*>(dstPtr);
+    do {
+        numPixels = it->nConseqPixels();
+        quint8 *dstPtr = it->rawData();
+
+        Q_FOREACH (const ChannelMapping &m, mapping) {
+            const quint8 *srcRow = rows[channelRowIndex(m.channelId)];
+
+            if (m.invert) {
+                convertChannelSpan<Traits, true>(srcRow, col, numPixels, dstPtr, m.pos);
+            } else {
+                convertChannelSpan<Traits, false>(srcRow, col, numPixels, dstPtr, m.pos);
+            }
+        }
 
-    pixelPtr->gray  = readChannelValue<Traits>(channelBytes, 0, col, unitValue);
-    pixelPtr->alpha = readChannelValue<Traits>(channelBytes, -1, col, unitValue);
+        col += numPixels;
+    } while (it->nextPixels(numPixels));
 }
 
+#define PIXEL_POS(Traits, field) int(offsetof(typename Traits::Pixel, field) / sizeof(typename Traits::channels_type))
+
 template <class Traits>
-void readRgbPixel(const QMap<quint16, QByteArray> &channelBytes,
-                  int col, quint8 *dstPtr)
-{
-    typedef typename Traits::Pixel Pixel;
-    typedef typename Traits::channels_type channels_type;
+struct GrayMapping {
+    static QVector<ChannelMapping> get() {
+        return {{0, PIXEL_POS(Traits, gray), false},
+                {-1, PIXEL_POS(Traits, alpha), false}};
+    }
+};
 
-    const channels_type unitValue = KoColorSpaceMathsTraits<channels_type>::unitValue;
-    Pixel *pixelPtr = reinterpret_cast<Pixel*>(dstPtr);
+template <class Traits>
+struct RgbMapping {
+    static QVector<ChannelMapping> get() {
+        return {{0, PIXEL_POS(Traits, red), false},
+                {1, PIXEL_POS(Traits, green), false},
+                {2, PIXEL_POS(Traits, blue), false},
+                {-1, PIXEL_POS(Traits, alpha), false}};
+    }
+};
 
-    pixelPtr->blue  = readChannelValue<Traits>(channelBytes, 2, col, unitValue);
-    pixelPtr->green = readChannelValue<Traits>(channelBytes, 1, col, unitValue);
-    pixelPtr->red   = readChannelValue<Traits>(channelBytes, 0, col, unitValue);
-    pixelPtr->alpha = readChannelValue<Traits>(channelBytes, -1, col, unitValue);
+template <class Traits>
+struct CmykMapping {
+    static QVector<ChannelMapping> get() {
+        return {{0, PIXEL_POS(Traits, cyan), true},
+                {1, PIXEL_POS(Traits, magenta), true},
+                {2, PIXEL_POS(Traits, yellow), true},
+                {3, PIXEL_POS(Traits, black), true},
+                {-1, PIXEL_POS(Traits, alpha), false}};
+    }
+};
 
-}
+template <class Traits>
+struct LabMapping {
+    static QVector<ChannelMapping> get() {
+        return {{0, PIXEL_POS(Traits, L), false},
+                {1, PIXEL_POS(Traits, a), false},
+                {2, PIXEL_POS(Traits, b), false},
+                {-1, PIXEL_POS(Traits, alpha), false}};
+    }
+};
+
+#undef PIXEL_POS
 
 template <class Traits>
-void readCmykPixel(const QMap<quint16, QByteArray> &channelBytes,
-                       int col, quint8 *dstPtr)
-{
-    typedef typename Traits::Pixel Pixel;
-    typedef typename Traits::channels_type channels_type;
+void writeAlphaMaskRow(KisHLineIteratorSP it, const quint8 *srcRow);
 
-    const channels_type unitValue = KoColorSpaceMathsTraits<channels_type>::unitValue;
-    Pixel *pixelPtr = reinterpret_cast<Pixel*>(dstPtr);
+template <>
+void writeAlphaMaskRow<AlphaU8Traits>(KisHLineIteratorSP it, const quint8 *srcRow)
+{
+    int col = 0;
+    int numPixels = 0;
 
-    pixelPtr->cyan    = unitValue - readChannelValue<Traits>(channelBytes, 0, col, unitValue);
-    pixelPtr->magenta = unitValue - readChannelValue<Traits>(channelBytes, 1, col, unitValue);
-    pixelPtr->yellow  = unitValue - readChannelValue<Traits>(channelBytes, 2, col, unitValue);
-    pixelPtr->black   = unitValue - readChannelValue<Traits>(channelBytes, 3, col, unitValue);
-    pixelPtr->alpha   = readChannelValue<Traits>(channelBytes, -1, col, unitValue);
+    do {
+        numPixels = it->nConseqPixels();
+        memcpy(it->rawData(), srcRow + col, numPixels);
+        col += numPixels;
+    } while (it->nextPixels(numPixels));
 }
 
-template <class Traits>
-void readLabPixel(const QMap<quint16, QByteArray> &channelBytes,
-                  int col, quint8 *dstPtr)
+template <>
+void writeAlphaMaskRow<AlphaU16Traits>(KisHLineIteratorSP it, const quint8 *srcRow)
 {
-    typedef typename Traits::Pixel Pixel;
-    typedef typename Traits::channels_type channels_type;
+    const quint16 *src = reinterpret_cast<const quint16*>(srcRow);
 
-    const channels_type unitValue = KoColorSpaceMathsTraits<channels_type>::unitValue;
-    Pixel *pixelPtr = reinterpret_cast<Pixel*>(dstPtr);
+    int numPixels = 0;
 
-    pixelPtr->L = readChannelValue<Traits>(channelBytes, 0, col, unitValue);
-    pixelPtr->a = readChannelValue<Traits>(channelBytes, 1, col, unitValue);
-    pixelPtr->b = readChannelValue<Traits>(channelBytes, 2, col, unitValue);
-    pixelPtr->alpha = readChannelValue<Traits>(channelBytes, -1, col, unitValue);
-}
+    do {
+        numPixels = it->nConseqPixels();
+        quint8 *dst = it->rawData();
 
-void readRgbPixelCommon(int channelSize,
-                               const QMap<quint16, QByteArray> &channelBytes,
-                               int col, quint8 *dstPtr)
-{
-    if (channelSize == 1) {
-        readRgbPixel<KoBgrU8Traits>(channelBytes, col, dstPtr);
-    } else if (channelSize == 2) {
-        readRgbPixel<KoBgrU16Traits>(channelBytes, col, dstPtr);
-    } else if (channelSize == 4) {
-        readRgbPixel<KoBgrU16Traits>(channelBytes, col, dstPtr);
-    }
+        for (int i = 0; i < numPixels; i++) {
+            dst[i] = src[i] >> 8;
+        }
+        src += numPixels;
+    } while (it->nextPixels(numPixels));
 }
 
-void readGrayPixelCommon(int channelSize,
-                                const QMap<quint16, QByteArray> &channelBytes,
-                                int col, quint8 *dstPtr)
+template <>
+void writeAlphaMaskRow<AlphaF32Traits>(KisHLineIteratorSP it, const quint8 *srcRow)
 {
-    if (channelSize == 1) {
-        readGrayPixel<KoGrayU8Traits>(channelBytes, col, dstPtr);
-    } else if (channelSize == 2) {
-        readGrayPixel<KoGrayU16Traits>(channelBytes, col, dstPtr);
-    } else if (channelSize == 4) {
-        readGrayPixel<KoGrayU32Traits>(channelBytes, col, dstPtr);
-    }
-}
+    const float *src = reinterpret_cast<const float*>(srcRow);
 
-void readCmykPixelCommon(int channelSize,
-                                const QMap<quint16, QByteArray> &channelBytes,
-                                int col, quint8 *dstPtr)
-{
-    if (channelSize == 1) {
-        readCmykPixel<KoCmykU8Traits>(channelBytes, col, dstPtr);
-    } else if (channelSize == 2) {
-        readCmykPixel<KoCmykU16Traits>(channelBytes, col, dstPtr);
-    } else if (channelSize == 4) {
-        readCmykPixel<KoCmykF32Traits>(channelBytes, col, dstPtr);
-    }
-}
+    int numPixels = 0;
 
-void readLabPixelCommon(int channelSize,
-                                const QMap<quint16, QByteArray> &channelBytes,
-                                int col, quint8 *dstPtr)
-{
-    if (channelSize == 1) {
-        readLabPixel<KoLabU8Traits>(channelBytes, col, dstPtr);
-    } else if (channelSize == 2) {
-        readLabPixel<KoLabU16Traits>(channelBytes, col, dstPtr);
-    } else if (channelSize == 4) {
-        readLabPixel<KoLabF32Traits>(channelBytes, col, dstPtr);
-    }
-}
+    do {
+        numPixels = it->nConseqPixels();
+        quint8 *dst = it->rawData();
 
-void readAlphaMaskPixelCommon(int channelSize,
-                                const QMap<quint16, QByteArray> &channelBytes,
-                                int col, quint8 *dstPtr)
-{
-    if (channelSize == 1) {
-        readAlphaMaskPixel<AlphaU8Traits>(channelBytes, col, dstPtr);
-    } else if (channelSize == 2) {
-        readAlphaMaskPixel<AlphaU16Traits>(channelBytes, col, dstPtr);
-    } else if (channelSize == 4) {
-        readAlphaMaskPixel<AlphaF32Traits>(channelBytes, col, dstPtr);
-    }
+        for (int i = 0; i < numPixels; i++) {
+            dst[i] = src[i] * 255;
+        }
+        src += numPixels;
+    } while (it->nextPixels(numPixels));
 }
 
 /**********************************************************************/
@@ -391,136 +390,215 @@ psd_status psd_unzip_with_prediction(psd_uchar *src_buf, psd_int src_len,
 /* End of third party block                                           */
 /**********************************************************************/
 
-QMap<quint16, QByteArray> fetchChannelsBytes(QIODevice *io, QVector<ChannelInfo*> channelInfoRecords,
-                                            int row, int width, int channelSize, bool processMasks)
+qint64 RawChannelsData::size() const
 {
-    const int uncompressedLength = width * channelSize;
+    qint64 result = 0;
 
-    QMap<quint16, QByteArray> channelBytes;
-
-    Q_FOREACH (ChannelInfo *channelInfo, channelInfoRecords) {
-        // user supplied masks are ignored here
-        if (!processMasks && channelInfo->channelId < -1) continue;
-
-        io->seek(channelInfo->channelDataStart + channelInfo->channelOffset);
-
-        if (channelInfo->compressionType == Compression::Uncompressed) {
-            channelBytes[channelInfo->channelId] = io->read(uncompressedLength);
-            channelInfo->channelOffset += uncompressedLength;
-        }
-        else if (channelInfo->compressionType == Compression::RLE) {
-            int rleLength = channelInfo->rleRowLengths[row];
-            QByteArray compressedBytes = io->read(rleLength);
-            QByteArray uncompressedBytes = Compression::uncompress(uncompressedLength, compressedBytes, channelInfo->compressionType);
-            channelBytes.insert(channelInfo->channelId, uncompressedBytes);
-            channelInfo->channelOffset += rleLength;
-        }
-        else {
-            QString error = QString("Unsupported Compression mode: %1").arg(channelInfo->compressionType);
-            dbgFile << "ERROR: fetchChannelsBytes:" << error;
-            throw KisAslReaderUtils::ASLParseException(error);
-        }
+    Q_FOREACH (const Channel &channel, channels) {
+        result += channel.bytes.size();
     }
 
-    return channelBytes;
+    return result;
 }
 
-typedef boost::function<void(int, const QMap<quint16, QByteArray>&, int, quint8*)> PixelFunc;
-
-void readCommon(KisPaintDeviceSP dev,
-                QIODevice *io,
-                const QRect &layerRect,
-                QVector<ChannelInfo*> infoRecords,
-                int channelSize,
-                PixelFunc pixelFunc,
-                bool processMasks)
+RawChannelsDataSP fetchRawChannels(QIODevice *io,
+                                   const QRect &rect,
+                                   int channelSize,
+                                   QVector<ChannelInfo*> infoRecords,
+                                   bool processMasks)
 {
     KisOffsetKeeper keeper(io);
 
-    if (layerRect.isEmpty()) {
-        dbgFile << "Empty layer!";
-        return;
-    }
+    RawChannelsDataSP data(new RawChannelsData());
+    data->rect = rect;
+    data->channelSize = channelSize;
 
-    if (infoRecords.first()->compressionType == Compression::ZIP ||
-        infoRecords.first()->compressionType == Compression::ZIPWithPrediction) {
+    if (rect.isEmpty()) return data;
+
+    const int uncompressedLength = rect.width() * channelSize;
+
+    Q_FOREACH (ChannelInfo *info, infoRecords) {
+        // user supplied masks are ignored here
+        if (!processMasks && info->channelId < -1) continue;
 
-        const int numPixels = channelSize * layerRect.width() * layerRect.height();
+        RawChannelsData::Channel channel;
+        channel.channelId = info->channelId;
+        channel.compressionType = info->compressionType;
 
-        QMap<quint16, QByteArray> channelBytes;
+        if (info->compressionType == Compression::Uncompressed) {
+            const qint64 length = qint64(uncompressedLength) * rect.height();
+
+            io->seek(info->channelDataStart + info->channelOffset);
+            channel.bytes = io->read(length);
+            info->channelOffset += length;
+
+        } else if (info->compressionType == Compression::RLE) {
+            const int numRows = qMin(rect.height(), info->rleRowLengths.size());
+            channel.rleRowLengths = info->rleRowLengths.mid(0, numRows);
+
+            const qint64 length =
+                std::accumulate(channel.rleRowLengths.constBegin(),
+                                channel.rleRowLengths.constEnd(), qint64(0));
+
+            io->seek(info->channelDataStart + info->channelOffset);
+            channel.bytes = io->read(length);
+            info->channelOffset += length;
+
+        } else if (info->compressionType == Compression::ZIP ||
+                   info->compressionType == Compression::ZIPWithPrediction) {
 
-        Q_FOREACH (ChannelInfo *info, infoRecords) {
             io->seek(info->channelDataStart);
-            QByteArray compressedBytes = io->read(info->channelDataLength);
-            QByteArray uncompressedBytes(numPixels, 0);
+            channel.bytes = io->read(info->channelDataLength);
+
+        } else {
+            QString error = QString("Unsupported Compression mode: %1").arg(info->compressionType);
+            dbgFile << "ERROR: fetchRawChannels:" << error;
+            throw KisAslReaderUtils::ASLParseException(error);
+        }
+
+        data->channels.append(channel);
+    }
+
+    return data;
+}
+
+/**
+ * Decompresses the rows of a single channel one by one. RLE and raw rows
+ * are decoded into a reusable row buffer, ZIP streams are inflated into
+ * a plane buffer once.
+ */
+class ChannelRowReader
+{
+public:
+    ChannelRowReader(const RawChannelsData::Channel &channel, const QRect &rect, int channelSize)
+        : m_channel(channel),
+          m_rowLength(rect.width() * channelSize)
+    {
+        if (m_channel.compressionType == Compression::ZIP ||
+            m_channel.compressionType == Compression::ZIPWithPrediction) {
+
+            m_buffer.resize(m_rowLength * rect.height());
 
             bool status = false;
-            if (infoRecords.first()->compressionType == Compression::ZIP) {
-                status = psd_unzip_without_prediction((quint8*)compressedBytes.data(), compressedBytes.size(),
-                                                      (quint8*)uncompressedBytes.data(), uncompressedBytes.size());
+            if (m_channel.compressionType == Compression::ZIP) {
+                status = psd_unzip_without_prediction((quint8*)m_channel.bytes.data(), m_channel.bytes.size(),
+                                                      (quint8*)m_buffer.data(), m_buffer.size());
             } else {
-                status = psd_unzip_with_prediction((quint8*)compressedBytes.data(), compressedBytes.size(),
-                                                   (quint8*)uncompressedBytes.data(), uncompressedBytes.size(),
-                                                   layerRect.width(), channelSize * 8);
+                status = psd_unzip_with_prediction((quint8*)m_channel.bytes.data(), m_channel.bytes.size(),
+                                                   (quint8*)m_buffer.data(), m_buffer.size(),
+                                                   rect.width(), channelSize * 8);
             }
 
             if (!status) {
-                QString error = QString("Failed to unzip channel data: id = %1, compression = %2").arg(info->channelId).arg(info->compressionType);
+                QString error = QString("Failed to unzip channel data: id = %1, compression = %2").arg(m_channel.channelId).arg(m_channel.compressionType);
                 dbgFile << "ERROR:" << error;
-                dbgFile << "      " << ppVar(info->channelId);
-                dbgFile << "      " << ppVar(info->channelDataStart);
-                dbgFile << "      " << ppVar(info->channelDataLength);
-                dbgFile << "      " << ppVar(info->compressionType);
+                dbgFile << "      " << ppVar(m_channel.channelId);
+                dbgFile << "      " << ppVar(m_channel.bytes.size());
+                dbgFile << "      " << ppVar(m_channel.compressionType);
                 throw KisAslReaderUtils::ASLParseException(error);
             }
+        } else {
+            m_buffer.resize(m_rowLength);
+        }
+    }
 
-            channelBytes.insert(info->channelId, uncompressedBytes);
+    const quint8* row(int row)
+    {
+        if (m_channel.compressionType == Compression::ZIP ||
+            m_channel.compressionType == Compression::ZIPWithPrediction) {
+
+            return reinterpret_cast<const quint8*>(m_buffer.constData()) + row * m_rowLength;
         }
 
-        KisSequentialIterator it(dev, layerRect);
-        int col = 0;
-        while (it.nextPixel()) {
-            pixelFunc(channelSize, channelBytes, col, it.rawData());
-            col++;
+        quint32 packedLength = 0;
+
+        if (m_channel.compressionType == Compression::RLE) {
+            packedLength = row < m_channel.rleRowLengths.size() ? m_channel.rleRowLengths[row] : 0;
+        } else {
+            packedLength = m_rowLength;
         }
 
-    } else {
-        KisHLineIteratorSP it = dev->createHLineIteratorNG(layerRect.left(), layerRect.top(), layerRect.width());
-        for (int i = 0 ; i < layerRect.height(); i++) {
-            QMap<quint16, QByteArray> channelBytes;
+        packedLength = qBound(qint64(0), qint64(m_channel.bytes.size()) - m_srcOffset, qint64(packedLength));
 
-            channelBytes = fetchChannelsBytes(io, infoRecords,
-                                              i, layerRect.width(),
-                                              channelSize, processMasks);
+        Compression::uncompress(m_channel.bytes.constData() + m_srcOffset, packedLength,
+                                m_buffer.data(), m_rowLength,
+                                m_channel.compressionType);
 
-            for (qint64 col = 0; col < layerRect.width(); col++){
-                pixelFunc(channelSize, channelBytes, col, it->rawData());
-                it->nextPixel();
-            }
-            it->nextRow();
+        m_srcOffset += packedLength;
+
+        return reinterpret_cast<const quint8*>(m_buffer.constData());
+    }
+
+private:
+    const RawChannelsData::Channel &m_channel;
+    const int m_rowLength;
+    qint64 m_srcOffset = 0;
+    QByteArray m_buffer;
+};
+
+template <class Traits>
+void decodeCommon(RawChannelsDataSP data, KisPaintDeviceSP dev,
+                  const QVector<ChannelMapping> &mapping)
+{
+    const QRect &rect = data->rect;
+
+    std::vector<std::unique_ptr<ChannelRowReader>> readers;
+    const quint8 *rows[5] = {0, 0, 0, 0, 0};
+    int rowIndexes[5] = {-1, -1, -1, -1, -1};
+
+    for (int i = 0; i < data->channels.size(); i++) {
+        const RawChannelsData::Channel &channel = data->channels[i];
+        if (channel.channelId < -1 || channel.channelId > 3) continue;
+
+        rowIndexes[channelRowIndex(channel.channelId)] = readers.size();
+        readers.emplace_back(new ChannelRowReader(channel, rect, data->channelSize));
+    }
+
+    KisHLineIteratorSP it = dev->createHLineIteratorNG(rect.left(), rect.top(), rect.width());
+    for (int row = 0; row < rect.height(); row++) {
+        for (int i = 0; i < 5; i++) {
+            rows[i] = rowIndexes[i] >= 0 ? readers[rowIndexes[i]]->row(row) : 0;
         }
+
+        writeRow<Traits>(it, mapping, rows);
+        it->nextRow();
     }
 }
 
-void readChannels(QIODevice *io,
-                  KisPaintDeviceSP device,
-                  psd_color_mode colorMode,
-                  int channelSize,
-                  const QRect &layerRect,
-                  QVector<ChannelInfo*> infoRecords)
+template <template <class> class Mapping,
+          class Traits8, class Traits16, class Traits32>
+void decodeColorMode(RawChannelsDataSP data, KisPaintDeviceSP dev)
+{
+    if (data->channelSize == 1) {
+        decodeCommon<Traits8>(data, dev, Mapping<Traits8>::get());
+    } else if (data->channelSize == 2) {
+        decodeCommon<Traits16>(data, dev, Mapping<Traits16>::get());
+    } else if (data->channelSize == 4) {
+        decodeCommon<Traits32>(data, dev, Mapping<Traits32>::get());
+    }
+}
+
+void decodeChannels(RawChannelsDataSP data,
+                    KisPaintDeviceSP device,
+                    psd_color_mode colorMode)
 {
+    if (data->rect.isEmpty()) {
+        dbgFile << "Empty layer!";
+        return;
+    }
+
     switch (colorMode) {
     case Grayscale:
-        readCommon(device, io, layerRect, infoRecords, channelSize, &readGrayPixelCommon, false);
+        decodeColorMode<GrayMapping, KoGrayU8Traits, KoGrayU16Traits, KoGrayU32Traits>(data, device);
         break;
     case RGB:
-        readCommon(device, io, layerRect, infoRecords, channelSize, &readRgbPixelCommon, false);
+        decodeColorMode<RgbMapping, KoBgrU8Traits, KoBgrU16Traits, KoBgrU16Traits>(data, device);
         break;
     case CMYK:
-        readCommon(device, io, layerRect, infoRecords, channelSize, &readCmykPixelCommon, false);
+        decodeColorMode<CmykMapping, KoCmykU8Traits, KoCmykU16Traits, KoCmykF32Traits>(data, device);
         break;
     case Lab:
-        readCommon(device, io, layerRect, infoRecords, channelSize, &readLabPixelCommon, false);
+        decodeColorMode<LabMapping, KoLabU8Traits, KoLabU16Traits, KoLabF32Traits>(data, device);
         break;
     case Bitmap:
     case Indexed:
@@ -533,6 +611,49 @@ void readChannels(QIODevice *io,
     }
 }
 
+template <class Traits>
+void decodeAlphaMaskCommon(RawChannelsDataSP data, KisPaintDeviceSP dev)
+{
+    const QRect &rect = data->rect;
+    ChannelRowReader reader(data->channels.first(), rect, data->channelSize);
+
+    KisHLineIteratorSP it = dev->createHLineIteratorNG(rect.left(), rect.top(), rect.width());
+    for (int row = 0; row < rect.height(); row++) {
+        writeAlphaMaskRow<Traits>(it, reader.row(row));
+        it->nextRow();
+    }
+}
+
+void decodeAlphaMaskChannels(RawChannelsDataSP data,
+                             KisPaintDeviceSP device)
+{
+    if (data->rect.isEmpty()) {
+        dbgFile << "Empty layer!";
+        return;
+    }
+
+    KIS_SAFE_ASSERT_RECOVER_RETURN(data->channels.size() == 1);
+
+    if (data->channelSize == 1) {
+        decodeAlphaMaskCommon<AlphaU8Traits>(data, device);
+    } else if (data->channelSize == 2) {
+        decodeAlphaMaskCommon<AlphaU16Traits>(data, device);
+    } else if (data->channelSize == 4) {
+        decodeAlphaMaskCommon<AlphaF32Traits>(data, device);
+    }
+}
+
+void readChannels(QIODevice *io,
+                  KisPaintDeviceSP device,
+                  psd_color_mode colorMode,
+                  int channelSize,
+                  const QRect &layerRect,
+                  QVector<ChannelInfo*> infoRecords)
+{
+    RawChannelsDataSP data = fetchRawChannels(io, layerRect, channelSize, infoRecords, false);
+    decodeChannels(data, device, colorMode);
+}
+
 void readAlphaMaskChannels(QIODevice *io,
                            KisPaintDeviceSP device,
                            int channelSize,
@@ -540,10 +661,31 @@ void readAlphaMaskChannels(QIODevice *io,
                            QVector<ChannelInfo*> infoRecords)
 {
     KIS_SAFE_ASSERT_RECOVER_RETURN(infoRecords.size() == 1);
-    readCommon(device, io, layerRect, infoRecords, channelSize, &readAlphaMaskPixelCommon, true);
+
+    RawChannelsDataSP data = fetchRawChannels(io, layerRect, channelSize, infoRecords, true);
+    decodeAlphaMaskChannels(data, device);
 }
 
-void writeChannelDataRLE(QIODevice *io, const quint8 *plane, const int channelSize, const QRect &rc, const qint64 sizeFieldOffset, const qint64 rleBlockOffset, const bool writeCompressionType)
+CompressedChannelData compressChannelDataRLE(const quint8 *plane, const int channelSize, const QRect &rc)
+{
+    CompressedChannelData result;
+    result.rowLengths.reserve(rc.height());
+
+    const quint32 stride = channelSize * rc.width();
+    for (qint32 row = 0; row < rc.height(); ++row) {
+
+        QByteArray uncompressed = QByteArray::fromRawData((const char*)plane + row * stride, stride);
+        QByteArray compressed = Compression::compress(uncompressed, Compression::RLE);
+
+        // XXX: choose size for PSB!
+        result.rowLengths.append(compressed.size());
+        result.bytes.append(compressed);
+    }
+
+    return result;
+}
+
+void writeCompressedChannelRLE(QIODevice *io, const CompressedChannelData &data, const qint64 sizeFieldOffset, const qint64 rleBlockOffset, const bool writeCompressionType)
 {
     typedef KisAslWriterUtils::OffsetStreamPusher<quint32> Pusher;
     QScopedPointer<Pusher> channelBlockSizeExternalTag;
@@ -557,9 +699,6 @@ void writeChannelDataRLE(QIODevice *io, const quint8 *plane, const int channelSi
 
     const bool externalRleBlock = rleBlockOffset >= 0;
 
-    // the start of RLE sizes block
-    const qint64 channelRLESizePos = externalRleBlock ? rleBlockOffset : io->pos();
-
     {
         QScopedPointer<KisOffsetKeeper> rleOffsetKeeper;
 
@@ -568,28 +707,23 @@ void writeChannelDataRLE(QIODevice *io, const quint8 *plane, const int channelSi
             io->seek(rleBlockOffset);
         }
 
-        // write zero's for the channel lengths block
-        for(int i = 0; i < rc.height(); ++i) {
-            // XXX: choose size for PSB!
-            const quint16 fakeRLEBLockSize = 0;
-            SAFE_WRITE_EX(io, fakeRLEBLockSize);
+        // the sizes are already known, so write the RLE sizes block directly
+        Q_FOREACH (quint16 rowLength, data.rowLengths) {
+            SAFE_WRITE_EX(io, rowLength);
         }
     }
 
-    quint32 stride = channelSize * rc.width();
-    for (qint32 row = 0; row < rc.height(); ++row) {
-
-        QByteArray uncompressed = QByteArray::fromRawData((const char*)plane + row * stride, stride);
-        QByteArray compressed = Compression::compress(uncompressed, Compression::RLE);
-
-        KisAslWriterUtils::OffsetStreamPusher<quint16> rleExternalTag(io, 0, channelRLESizePos + row * sizeof(quint16));
-
-        if (io->write(compressed) != compressed.size()) {
-            throw KisAslWriterUtils::ASLWriteException("Failed to write image data");
-        }
+    if (io->write(data.bytes) != data.bytes.size()) {
+        throw KisAslWriterUtils::ASLWriteException("Failed to write image data");
     }
 }
 
+void writeChannelDataRLE(QIODevice *io, const quint8 *plane, const int channelSize, const QRect &rc, const qint64 sizeFieldOffset, const qint64 rleBlockOffset, const bool writeCompressionType)
+{
+    const CompressedChannelData data = compressChannelDataRLE(plane, channelSize, rc);
+    writeCompressedChannelRLE(io, data, sizeFieldOffset, rleBlockOffset, writeCompressionType);
+}
+
 inline void preparePixelForWrite(quint8 *dataPlane,
                                  int numPixels,
                                  int channelSize,
@@ -633,17 +767,15 @@ inline void preparePixelForWrite(quint8 *dataPlane,
     }
 }
 
-void writePixelDataCommon(QIODevice *io,
-                          KisPaintDeviceSP dev,
-                          const QRect &rc,
-                          psd_color_mode colorMode,
-                          int channelSize,
-                          bool alphaFirst,
-                          const bool writeCompressionType,
-                          QVector<ChannelWritingInfo> &writingInfoList)
+QVector<CompressedChannelData> compressPixelDataRLE(KisPaintDeviceSP dev,
+                                                   const QRect &rc,
+                                                   psd_color_mode colorMode,
+                                                   int channelSize,
+                                                   bool alphaFirst,
+                                                   const QVector<ChannelWritingInfo> &writingInfoList)
 {
     // Empty rects must be processed separately on a higher level!
-    KIS_ASSERT_RECOVER_RETURN(!rc.isEmpty());
+    KIS_ASSERT_RECOVER_RETURN_VALUE(!rc.isEmpty(), QVector<CompressedChannelData>());
 
     QVector<quint8* > tmp = dev->readPlanarBytes(rc.x() - dev->x(), rc.y() - dev->y(), rc.width(), rc.height());
     const KoColorSpace *colorSpace = dev->colorSpace();
@@ -684,38 +816,81 @@ void writePixelDataCommon(QIODevice *io,
         tmp.clear();
     }
 
-    KIS_ASSERT_RECOVER_RETURN(planes.size() >= writingInfoList.size());
+    QVector<CompressedChannelData> result;
+
+    KIS_ASSERT_RECOVER(planes.size() >= writingInfoList.size()) {
+        Q_FOREACH (quint8 *plane, planes) {
+            delete[] plane;
+        }
+        return result;
+    }
 
     const int numPixels = rc.width() * rc.height();
 
-    // write down the planes
+    result.resize(writingInfoList.size());
+
+    QVector<int> indexes(writingInfoList.size());
+    std::iota(indexes.begin(), indexes.end(), 0);
+
+    /**
+     * The channels are independent, so they are prepared and compressed
+     * in parallel. The data is written later in the required order.
+     */
+    QtConcurrent::blockingMap(indexes,
+        [&] (int i) {
+            const ChannelWritingInfo &info = writingInfoList[i];
+
+            preparePixelForWrite(planes[i], numPixels, channelSize, info.channelId, colorMode);
+            result[i] = compressChannelDataRLE(planes[i], channelSize, rc);
+            result[i].channelId = info.channelId;
+        });
+
+    Q_FOREACH (quint8 *plane, planes) {
+        delete[] plane;
+    }
+    planes.clear();
+
+    return result;
+}
+
+void writeCompressedPixelData(QIODevice *io,
+                              const QVector<CompressedChannelData> &channels,
+                              const bool writeCompressionType,
+                              const QVector<ChannelWritingInfo> &writingInfoList)
+{
+    KIS_ASSERT_RECOVER_RETURN(channels.size() == writingInfoList.size());
 
     try {
         for (int i = 0; i < writingInfoList.size(); i++) {
             const ChannelWritingInfo &info = writingInfoList[i];
 
             dbgFile << "\tWriting channel" << i << "psd channel id" << info.channelId;
-
-            preparePixelForWrite(planes[i], numPixels, channelSize, info.channelId, colorMode);
-
             dbgFile << "\t\tchannel start" << ppVar(io->pos());
 
-            writeChannelDataRLE(io, planes[i], channelSize, rc, info.sizeFieldOffset, info.rleBlockOffset, writeCompressionType);
+            writeCompressedChannelRLE(io, channels[i], info.sizeFieldOffset, info.rleBlockOffset, writeCompressionType);
         }
 
     } catch (KisAslWriterUtils::ASLWriteException &e) {
-        Q_FOREACH (quint8 *plane, planes) {
-            delete[] plane;
-        }
-        planes.clear();
-
         throw KisAslWriterUtils::ASLWriteException(PREPEND_METHOD(e.what()));
     }
+}
 
-    Q_FOREACH (quint8 *plane, planes) {
-        delete[] plane;
-    }
-    planes.clear();
+void writePixelDataCommon(QIODevice *io,
+                          KisPaintDeviceSP dev,
+                          const QRect &rc,
+                          psd_color_mode colorMode,
+                          int channelSize,
+                          bool alphaFirst,
+                          const bool writeCompressionType,
+                          QVector<ChannelWritingInfo> &writingInfoList)
+{
+    // Empty rects must be processed separately on a higher level!
+    KIS_ASSERT_RECOVER_RETURN(!rc.isEmpty());
+
+    const QVector<CompressedChannelData> channels =
+        compressPixelDataRLE(dev, rc, colorMode, channelSize, alphaFirst, writingInfoList);
+
+    writeCompressedPixelData(io, channels, writeCompressionType, writingInfoList);
 }
 
 }
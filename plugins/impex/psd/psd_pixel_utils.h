@@ -21,8 +21,11 @@
 
 #include <QVector>
 #include <QRect>
+#include <QByteArray>
+#include <QSharedPointer>
 
 #include "psd.h"
+#include "compression.h"
 #include "kis_types.h"
 
 class QIODevice;
@@ -42,6 +45,44 @@ namespace PsdPixelUtils
         int rleBlockOffset;
     };
 
+    /**
+     * Compressed image data of the channels of a layer or a mask. It is
+     * read from the file sequentially and can be decoded afterwards in
+     * any thread, since the decoding doesn't touch the IO device.
+     */
+    struct RawChannelsData {
+        struct Channel {
+            qint16 channelId = 0;
+            Compression::CompressionType compressionType = Compression::Unknown;
+            QByteArray bytes;
+            QVector<quint32> rleRowLengths;
+        };
+
+        QRect rect;
+        int channelSize = 1;
+        QVector<Channel> channels;
+
+        /**
+         * The amount of memory occupied by the compressed data
+         */
+        qint64 size() const;
+    };
+
+    typedef QSharedPointer<RawChannelsData> RawChannelsDataSP;
+
+    RawChannelsDataSP fetchRawChannels(QIODevice *io,
+                                       const QRect &rect,
+                                       int channelSize,
+                                       QVector<ChannelInfo*> infoRecords,
+                                       bool processMasks);
+
+    void decodeChannels(RawChannelsDataSP data,
+                        KisPaintDeviceSP device,
+                        psd_color_mode colorMode);
+
+    void decodeAlphaMaskChannels(RawChannelsDataSP data,
+                                 KisPaintDeviceSP device);
+
     void readChannels(QIODevice *io,
                       KisPaintDeviceSP device,
                       psd_color_mode colorMode,
@@ -55,6 +96,25 @@ namespace PsdPixelUtils
                                const QRect &layerRect,
                                QVector<ChannelInfo*> infoRecords);
 
+    /**
+     * RLE-compressed data of a single channel, ready to be written
+     */
+    struct CompressedChannelData {
+        qint16 channelId = 0;
+        QVector<quint16> rowLengths;
+        QByteArray bytes;
+    };
+
+    CompressedChannelData compressChannelDataRLE(const quint8 *plane,
+                                                 const int channelSize,
+                                                 const QRect &rc);
+
+    void writeCompressedChannelRLE(QIODevice *io,
+                                   const CompressedChannelData &data,
+                                   const qint64 sizeFieldOffset,
+                                   const qint64 rleBlockOffset,
+                                   const bool writeCompressionType);
+
     void writeChannelDataRLE(QIODevice *io,
                              const quint8 *plane,
                              const int channelSize,
@@ -63,6 +123,23 @@ namespace PsdPixelUtils
                              const qint64 rleBlockOffset,
                              const bool writeCompressionType);
 
+    /**
+     * Reads the channels of \p dev in the order of \p writingInfoList and
+     * compresses them in parallel. Doesn't touch any IO device, so it can
+     * be called for several layers concurrently.
+     */
+    QVector<CompressedChannelData> compressPixelDataRLE(KisPaintDeviceSP dev,
+                                                       const QRect &rc,
+                                                       psd_color_mode colorMode,
+                                                       int channelSize,
+                                                       bool alphaFirst,
+                                                       const QVector<ChannelWritingInfo> &writingInfoList);
+
+    void writeCompressedPixelData(QIODevice *io,
+                                  const QVector<CompressedChannelData> &channels,
+                                  const bool writeCompressionType,
+                                  const QVector<ChannelWritingInfo> &writingInfoList);
+
     void writePixelDataCommon(QIODevice *io,
                               KisPaintDeviceSP dev,
                               const QRect &rc,
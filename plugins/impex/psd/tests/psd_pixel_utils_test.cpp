@@ -0,0 +1,210 @@
+/*
+ *  Copyright (c) 2020 Krita developers
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include "psd_pixel_utils_test.h"
+
+#include <QTest>
+#include <QtEndian>
+
+#include <kistest.h>
+
+#include <KoColorSpaceRegistry.h>
+#include <KoColorSpaceMaths.h>
+#include <KoBgrColorSpaceTraits.h>
+
+#include <kis_paint_device.h>
+
+#include "psd_pixel_utils.h"
+
+using namespace PsdPixelUtils;
+
+namespace {
+
+/**
+ * The pattern has long runs of equal pixels as well as noisy spans, so
+ * that both the replicate and the literal packets of RLE are exercised
+ */
+template <class Traits>
+void fillPattern(KisPaintDeviceSP dev, const QRect &rect, bool withAlpha)
+{
+    typedef typename Traits::channels_type channels_type;
+    typedef typename Traits::Pixel Pixel;
+
+    QVector<Pixel> pixels(rect.width() * rect.height());
+
+    for (int y = 0; y < rect.height(); y++) {
+        for (int x = 0; x < rect.width(); x++) {
+            const bool isRun = (x / 7) % 2;
+            Pixel &px = pixels[y * rect.width() + x];
+
+            px.red   = isRun ? channels_type(0x5a5a) : channels_type(x * 31 + y * 17 + 1);
+            px.green = isRun ? channels_type(0x1234) : channels_type(x * 13 + y * 71 + 2);
+            px.blue  = channels_type((x + y) * 257);
+            px.alpha = withAlpha ? channels_type(x * 251 + y * 3) :
+                                   KoColorSpaceMathsTraits<channels_type>::unitValue;
+        }
+    }
+
+    dev->writeBytes(reinterpret_cast<const quint8*>(pixels.constData()), rect);
+}
+
+/**
+ * A big-endian plane of a single channel, the way uncompressed channel
+ * data is stored in the file
+ */
+template <class Traits>
+QByteArray rawPlane(KisPaintDeviceSP dev, const QRect &rect, int pos)
+{
+    typedef typename Traits::channels_type channels_type;
+
+    QVector<channels_type> pixels(rect.width() * rect.height() * Traits::channels_nb);
+    dev->readBytes(reinterpret_cast<quint8*>(pixels.data()), rect);
+
+    QByteArray plane;
+    plane.reserve(rect.width() * rect.height() * sizeof(channels_type));
+
+    for (int i = 0; i < rect.width() * rect.height(); i++) {
+        const channels_type value = qToBigEndian(pixels[i * Traits::channels_nb + pos]);
+        plane.append(reinterpret_cast<const char*>(&value), sizeof(channels_type));
+    }
+
+    return plane;
+}
+
+template <class Traits>
+RawChannelsDataSP encodeChannels(KisPaintDeviceSP dev, const QRect &rect,
+                                 Compression::CompressionType compressionType,
+                                 const QVector<qint16> &channelIds)
+{
+    const int channelSize = sizeof(typename Traits::channels_type);
+
+    RawChannelsDataSP data(new RawChannelsData());
+    data->rect = rect;
+    data->channelSize = channelSize;
+
+    if (compressionType == Compression::RLE) {
+        QVector<ChannelWritingInfo> writingInfoList;
+        Q_FOREACH (qint16 id, channelIds) {
+            writingInfoList << ChannelWritingInfo(id, -1, -1);
+        }
+
+        const QVector<CompressedChannelData> compressed =
+            compressPixelDataRLE(dev, rect, RGB, channelSize, false, writingInfoList);
+
+        Q_FOREACH (const CompressedChannelData &channelData, compressed) {
+            RawChannelsData::Channel channel;
+            channel.channelId = channelData.channelId;
+            channel.compressionType = Compression::RLE;
+            channel.bytes = channelData.bytes;
+
+            Q_FOREACH (quint16 length, channelData.rowLengths) {
+                channel.rleRowLengths << length;
+            }
+
+            data->channels << channel;
+        }
+    } else {
+        Q_FOREACH (qint16 id, channelIds) {
+            const int pos =
+                id == 0 ? Traits::red_pos :
+                id == 1 ? Traits::green_pos :
+                id == 2 ? Traits::blue_pos :
+                Traits::alpha_pos;
+
+            RawChannelsData::Channel channel;
+            channel.channelId = id;
+            channel.compressionType = Compression::Uncompressed;
+            channel.bytes = rawPlane<Traits>(dev, rect, pos);
+
+            data->channels << channel;
+        }
+    }
+
+    return data;
+}
+
+template <class Traits>
+void testRoundTripImpl(const KoColorSpace *cs,
+                       Compression::CompressionType compressionType,
+                       bool withAlpha)
+{
+    // odd size and offset, the rows don't start on the tile boundaries
+    const QRect rect(3, 5, 71, 37);
+
+    KisPaintDeviceSP src = new KisPaintDevice(cs);
+    fillPattern<Traits>(src, rect, withAlpha);
+
+    QVector<qint16> channelIds({0, 1, 2});
+    if (withAlpha) {
+        channelIds << -1;
+    }
+
+    RawChannelsDataSP data = encodeChannels<Traits>(src, rect, compressionType, channelIds);
+    QCOMPARE(data->channels.size(), channelIds.size());
+
+    KisPaintDeviceSP dst = new KisPaintDevice(cs);
+    decodeChannels(data, dst, RGB);
+
+    const int numBytes = rect.width() * rect.height() * cs->pixelSize();
+    QByteArray srcBytes(numBytes, 0);
+    QByteArray dstBytes(numBytes, 0);
+
+    src->readBytes(reinterpret_cast<quint8*>(srcBytes.data()), rect);
+    dst->readBytes(reinterpret_cast<quint8*>(dstBytes.data()), rect);
+
+    // a missing transparency channel must be decoded as opaque
+    QVERIFY(srcBytes == dstBytes);
+}
+
+}
+
+void PSDPixelUtilsTest::testRoundTrip_data()
+{
+    QTest::addColumn<int>("channelSize");
+    QTest::addColumn<int>("compressionType");
+    QTest::addColumn<bool>("withAlpha");
+
+    QTest::newRow("rle-8-alpha") << 1 << int(Compression::RLE) << true;
+    QTest::newRow("rle-8-opaque") << 1 << int(Compression::RLE) << false;
+    QTest::newRow("rle-16-alpha") << 2 << int(Compression::RLE) << true;
+    QTest::newRow("rle-16-opaque") << 2 << int(Compression::RLE) << false;
+    QTest::newRow("raw-8-alpha") << 1 << int(Compression::Uncompressed) << true;
+    QTest::newRow("raw-8-opaque") << 1 << int(Compression::Uncompressed) << false;
+    QTest::newRow("raw-16-alpha") << 2 << int(Compression::Uncompressed) << true;
+    QTest::newRow("raw-16-opaque") << 2 << int(Compression::Uncompressed) << false;
+}
+
+void PSDPixelUtilsTest::testRoundTrip()
+{
+    QFETCH(int, channelSize);
+    QFETCH(int, compressionType);
+    QFETCH(bool, withAlpha);
+
+    const Compression::CompressionType compression =
+        Compression::CompressionType(compressionType);
+
+    if (channelSize == 1) {
+        testRoundTripImpl<KoBgrU8Traits>(KoColorSpaceRegistry::instance()->rgb8(),
+                                         compression, withAlpha);
+    } else {
+        testRoundTripImpl<KoBgrU16Traits>(KoColorSpaceRegistry::instance()->rgb16(),
+                                          compression, withAlpha);
+    }
+}
+
+KISTEST_MAIN(PSDPixelUtilsTest)
@@ -23,6 +23,7 @@
 
 #include <QFile>
 #include <QApplication>
+#include <QThread>
 
 #include <QFileInfo>
 
@@ -44,6 +45,7 @@
 #include "kis_tiff_reader.h"
 #include "kis_tiff_ycbcr_reader.h"
 #include "kis_buffer_stream.h"
+#include "kis_tiff_parallel_decoder.h"
 #include "kis_tiff_writer_visitor.h"
 
 #include <KisImportExportAdditionalChecks.h>
@@ -55,6 +57,19 @@ typedef size_t tmsize_t;
 namespace
 {
 
+KisBufferStreamBase* createBufferStream(uint8 *buffer, uint16 depth, uint32 lineSize)
+{
+    if (depth < 16) {
+        return new KisBufferStreamContigBelow16(buffer, depth, lineSize);
+    }
+    else if (depth < 32) {
+        return new KisBufferStreamContigBelow32(buffer, depth, lineSize);
+    }
+    else {
+        return new KisBufferStreamContigAbove32(buffer, depth, lineSize);
+    }
+}
+
 QPair<QString, QString> getColorSpaceForColorType(uint16 sampletype, uint16 color_type, uint16 color_nb_bits, TIFF *image, uint16 &nbchannels, uint16 &extrasamplescount, uint8 &destDepth)
 {
     const int bits32 = 32;
@@ -490,9 +505,6 @@ KisImportExportErrorCode KisTIFFConverter::readTIFFDirectory(TIFF* image)
         }
     }
     KisPaintLayer* layer = new KisPaintLayer(m_image.data(), m_image -> nextLayerName(), quint8_MAX);
-    tdata_t buf = 0;
-    tdata_t* ps_buf = 0; // used only for planar configuration separated
-    KisBufferStreamBase* tiffstream;
 
     KisTIFFReaderBase* tiffReader = 0;
 
@@ -609,51 +621,96 @@ KisImportExportErrorCode KisTIFFConverter::readTIFFDirectory(TIFF* image)
         return ImportExportCodes::FileFormatIncorrect;
     }
 
+    /**
+     * The strips (or tiles) are decoded in parallel in batches, then their
+     * data is copied into the layer sequentially, because the readers and
+     * the color transformations keep state. Every slot of the batch has its
+     * own buffers and buffer stream.
+     */
+    KisTIFFParallelDecoder decoder(image);
+    const int batchSize = qMax(1, 2 * QThread::idealThreadCount());
+    const int buffersPerChunk = planarconfig == PLANARCONFIG_CONTIG ? 1 : nbchannels;
+
+    QVector<tdata_t> buffers;
+    QVector<KisBufferStreamBase*> streams;
+
+    /**
+     * Byte-aligned contiguous samples are copied directly, without
+     * unpacking them through the buffer stream
+     */
+    const bool useAlignedData =
+        planarconfig == PLANARCONFIG_CONTIG &&
+        tiffReader->supportsAlignedData();
+
+    bool decodingFailed = false;
+
     if (TIFFIsTiled(image)) {
         dbgFile << "tiled image";
         uint32 tileWidth, tileHeight;
-        uint32 x, y;
         TIFFGetField(image, TIFFTAG_TILEWIDTH, &tileWidth);
         TIFFGetField(image, TIFFTAG_TILELENGTH, &tileHeight);
         uint32 linewidth = (tileWidth * depth * nbchannels) / 8;
-        if (planarconfig == PLANARCONFIG_CONTIG) {
-            buf = _TIFFmalloc(TIFFTileSize(image));
-            if (depth < 16) {
-                tiffstream = new KisBufferStreamContigBelow16((uint8*)buf, depth, linewidth);
+        const tmsize_t bufferSize = TIFFTileSize(image);
+
+        for (int slot = 0; slot < batchSize; slot++) {
+            for (int i = 0; i < buffersPerChunk; i++) {
+                buffers << _TIFFmalloc(bufferSize);
             }
-            else if (depth < 32) {
-                tiffstream = new KisBufferStreamContigBelow32((uint8*)buf, depth, linewidth);
+            tdata_t *slotBuffers = buffers.data() + slot * buffersPerChunk;
+
+            if (planarconfig == PLANARCONFIG_CONTIG) {
+                streams << createBufferStream((uint8*)slotBuffers[0], depth, linewidth);
             }
             else {
-                tiffstream = new KisBufferStreamContigAbove32((uint8*)buf, depth, linewidth);
+                uint32 * lineSizes = new uint32[nbchannels];
+                for (uint i = 0; i < nbchannels; i++) {
+                    lineSizes[i] = (tileWidth * depth) / 8; // baseSize / lineSizeCoeffs[i];
+                }
+                streams << new KisBufferStreamSeperate((uint8**) slotBuffers, nbchannels, depth, lineSizes);
+                delete [] lineSizes;
             }
         }
-        else {
-            ps_buf = new tdata_t[nbchannels];
-            uint32 * lineSizes = new uint32[nbchannels];
-            tmsize_t baseSize = TIFFTileSize(image) / nbchannels;
-            for (uint i = 0; i < nbchannels; i++) {
-                ps_buf[i] = _TIFFmalloc(baseSize);
-                lineSizes[i] = tileWidth; // baseSize / lineSizeCoeffs[i];
+        dbgFile << linewidth << "" << nbchannels << "" << layer->paintDevice()->colorSpace()->colorChannelCount();
+
+        QVector<QPoint> tilePositions;
+        for (uint32 y = 0; y < height; y += tileHeight) {
+            for (uint32 x = 0; x < width; x += tileWidth) {
+                tilePositions << QPoint(x, y);
             }
-            tiffstream = new KisBufferStreamSeperate((uint8**) ps_buf, nbchannels, depth, lineSizes);
-            delete [] lineSizes;
         }
-        dbgFile << linewidth << "" << nbchannels << "" << layer->paintDevice()->colorSpace()->colorChannelCount();
-        for (y = 0; y < height; y += tileHeight) {
-            for (x = 0; x < width; x += tileWidth) {
-                dbgFile << "Reading tile x =" << x << " y =" << y;
-                if (planarconfig == PLANARCONFIG_CONTIG) {
-                    TIFFReadTile(image, buf, x, y, 0, (tsample_t) - 1);
-                }
-                else {
-                    for (uint i = 0; i < nbchannels; i++) {
-                        TIFFReadTile(image, ps_buf[i], x, y, 0, i);
-                    }
+
+        for (int batchStart = 0; batchStart < tilePositions.size(); batchStart += batchSize) {
+            const int batchEnd = qMin(batchStart + batchSize, tilePositions.size());
+
+            QVector<uint32> chunks;
+            QVector<tdata_t> chunkBuffers;
+
+            for (int tile = batchStart; tile < batchEnd; tile++) {
+                const QPoint pos = tilePositions[tile];
+                for (int i = 0; i < buffersPerChunk; i++) {
+                    chunks << TIFFComputeTile(image, pos.x(), pos.y(), 0, planarconfig == PLANARCONFIG_CONTIG ? 0 : i);
+                    chunkBuffers << buffers[(tile - batchStart) * buffersPerChunk + i];
                 }
+            }
+
+            decodingFailed |= !decoder.decode(chunks, chunkBuffers, bufferSize);
+
+            for (int tile = batchStart; tile < batchEnd; tile++) {
+                const uint32 x = tilePositions[tile].x();
+                const uint32 y = tilePositions[tile].y();
+                const int slot = tile - batchStart;
+                KisBufferStreamBase *tiffstream = streams[slot];
+
+                dbgFile << "Reading tile x =" << x << " y =" << y;
+
                 uint32 realTileWidth = (x + tileWidth) < width ? tileWidth : width - x;
                 for (uint yintile = 0; y + yintile < height && yintile < tileHeight / vsubsampling;) {
-                    tiffReader->copyDataToChannels(x, y + yintile , realTileWidth, tiffstream);
+                    if (useAlignedData) {
+                        tiffReader->copyAlignedDataToChannels(x, y + yintile, realTileWidth,
+                                                              (const quint8*)buffers[slot] + yintile * linewidth);
+                    } else {
+                        tiffReader->copyDataToChannels(x, y + yintile , realTileWidth, tiffstream);
+                    }
                     yintile += 1;
                     tiffstream->moveToLine(yintile);
                 }
@@ -668,63 +725,76 @@ KisImportExportErrorCode KisTIFFConverter::readTIFFDirectory(TIFF* image)
         TIFFGetFieldDefaulted(image, TIFFTAG_ROWSPERSTRIP, &rowsPerStrip);
         dbgFile << rowsPerStrip << "" << height;
         rowsPerStrip = qMin(rowsPerStrip, height); // when TIFFNumberOfStrips(image) == 1 it might happen that rowsPerStrip is incorrectly set
-        if (planarconfig == PLANARCONFIG_CONTIG) {
-            buf = _TIFFmalloc(stripsize);
-            if (depth < 16) {
-                tiffstream = new KisBufferStreamContigBelow16((uint8*)buf, depth, stripsize / rowsPerStrip);
+        const uint32 scanLineSize = stripsize / rowsPerStrip;
+
+        for (int slot = 0; slot < batchSize; slot++) {
+            for (int i = 0; i < buffersPerChunk; i++) {
+                buffers << _TIFFmalloc(stripsize);
             }
-            else if (depth < 32) {
-                tiffstream = new KisBufferStreamContigBelow32((uint8*)buf, depth, stripsize / rowsPerStrip);
+            tdata_t *slotBuffers = buffers.data() + slot * buffersPerChunk;
+
+            if (planarconfig == PLANARCONFIG_CONTIG) {
+                streams << createBufferStream((uint8*)slotBuffers[0], depth, scanLineSize);
             }
             else {
-                tiffstream = new KisBufferStreamContigAbove32((uint8*)buf, depth, stripsize / rowsPerStrip);
-            }
-        }
-        else {
-            ps_buf = new tdata_t[nbchannels];
-            uint32 scanLineSize = stripsize / rowsPerStrip;
-            dbgFile << " scanLineSize for each plan =" << scanLineSize;
-            uint32 * lineSizes = new uint32[nbchannels];
-            for (uint i = 0; i < nbchannels; i++) {
-                ps_buf[i] = _TIFFmalloc(stripsize);
-                lineSizes[i] = scanLineSize / lineSizeCoeffs[i];
+                dbgFile << " scanLineSize for each plan =" << scanLineSize;
+                uint32 * lineSizes = new uint32[nbchannels];
+                for (uint i = 0; i < nbchannels; i++) {
+                    lineSizes[i] = scanLineSize / lineSizeCoeffs[i];
+                }
+                streams << new KisBufferStreamSeperate((uint8**) slotBuffers, nbchannels, depth, lineSizes);
+                delete [] lineSizes;
             }
-            tiffstream = new KisBufferStreamSeperate((uint8**) ps_buf, nbchannels, depth, lineSizes);
-            delete [] lineSizes;
         }
 
         dbgFile << "Scanline size =" << TIFFRasterScanlineSize(image) << " / strip size =" << TIFFStripSize(image) << " / rowsPerStrip =" << rowsPerStrip << " stripsize/rowsPerStrip =" << stripsize / rowsPerStrip;
-        uint32 y = 0;
         dbgFile << " NbOfStrips =" << TIFFNumberOfStrips(image) << " rowsPerStrip =" << rowsPerStrip << " stripsize =" << stripsize;
-        for (uint32 strip = 0; y < height; strip++) {
-            if (planarconfig == PLANARCONFIG_CONTIG) {
-                TIFFReadEncodedStrip(image, TIFFComputeStrip(image, y, 0) , buf, (tsize_t) - 1);
-            }
-            else {
-                for (uint i = 0; i < nbchannels; i++) {
-                    TIFFReadEncodedStrip(image, TIFFComputeStrip(image, y, i), ps_buf[i], (tsize_t) - 1);
+
+        uint32 y = 0;
+        while (y < height) {
+            QVector<uint32> chunks;
+            QVector<tdata_t> chunkBuffers;
+
+            int numStrips = 0;
+            for (uint32 stripY = y; numStrips < batchSize && stripY < height; numStrips++, stripY += rowsPerStrip) {
+                for (int i = 0; i < buffersPerChunk; i++) {
+                    chunks << TIFFComputeStrip(image, stripY, planarconfig == PLANARCONFIG_CONTIG ? 0 : i);
+                    chunkBuffers << buffers[numStrips * buffersPerChunk + i];
                 }
             }
-            for (uint32 yinstrip = 0 ; yinstrip < rowsPerStrip && y < height ;) {
-                uint linesread = tiffReader->copyDataToChannels(0, y, width, tiffstream);
-                y += linesread;
-                yinstrip += linesread;
-                tiffstream->moveToLine(yinstrip);
+
+            decodingFailed |= !decoder.decode(chunks, chunkBuffers, stripsize);
+
+            for (int slot = 0; slot < numStrips; slot++) {
+                KisBufferStreamBase *tiffstream = streams[slot];
+
+                for (uint32 yinstrip = 0 ; yinstrip < rowsPerStrip && y < height ;) {
+                    uint linesread = 1;
+                    if (useAlignedData) {
+                        tiffReader->copyAlignedDataToChannels(0, y, width,
+                                                              (const quint8*)buffers[slot] + yinstrip * scanLineSize);
+                    } else {
+                        linesread = tiffReader->copyDataToChannels(0, y, width, tiffstream);
+                    }
+                    y += linesread;
+                    yinstrip += linesread;
+                    tiffstream->moveToLine(yinstrip);
+                }
+                tiffstream->restart();
             }
-            tiffstream->restart();
         }
     }
+
+    if (decodingFailed) {
+        dbgFile << "Some of the strips or tiles could not be decoded";
+    }
+
     tiffReader->finalize();
     delete[] lineSizeCoeffs;
     delete tiffReader;
-    delete tiffstream;
-    if (planarconfig == PLANARCONFIG_CONTIG) {
-        _TIFFfree(buf);
-    } else {
-        for (uint i = 0; i < nbchannels; i++) {
-            _TIFFfree(ps_buf[i]);
-        }
-        delete[] ps_buf;
+    qDeleteAll(streams);
+    Q_FOREACH (tdata_t buffer, buffers) {
+        _TIFFfree(buffer);
     }
 
     m_image->addNode(KisNodeSP(layer), m_image->rootLayer().data());
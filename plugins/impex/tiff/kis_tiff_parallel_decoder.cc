@@ -0,0 +1,140 @@
+/*
+ *  Copyright (c) 2020 Krita developers
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include "kis_tiff_parallel_decoder.h"
+
+#include <QAtomicInt>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QtConcurrent>
+
+#include <numeric>
+
+#include <kis_debug.h>
+
+struct KisTIFFParallelDecoder::Private
+{
+    TIFF *image = 0;
+    QByteArray fileName;
+    tdir_t directory = 0;
+    bool isTiled = false;
+
+    QMutex mutex;
+    QVector<TIFF*> freeHandles;
+    bool canOpenHandles = true;
+
+    TIFF* acquireHandle();
+    void releaseHandle(TIFF *handle);
+
+    tsize_t decodeChunk(TIFF *handle, uint32 chunk, tdata_t buffer, tsize_t bufferSize);
+};
+
+TIFF* KisTIFFParallelDecoder::Private::acquireHandle()
+{
+    {
+        QMutexLocker l(&mutex);
+        if (!freeHandles.isEmpty()) {
+            return freeHandles.takeLast();
+        }
+        if (!canOpenHandles) {
+            return 0;
+        }
+    }
+
+    TIFF *handle = TIFFOpen(fileName.constData(), "r");
+    if (handle && !TIFFSetDirectory(handle, directory)) {
+        TIFFClose(handle);
+        handle = 0;
+    }
+
+    if (!handle) {
+        QMutexLocker l(&mutex);
+        canOpenHandles = false;
+        dbgFile << "Could not reopen TIFF file for parallel decoding" << fileName;
+    }
+
+    return handle;
+}
+
+void KisTIFFParallelDecoder::Private::releaseHandle(TIFF *handle)
+{
+    QMutexLocker l(&mutex);
+    freeHandles.append(handle);
+}
+
+tsize_t KisTIFFParallelDecoder::Private::decodeChunk(TIFF *handle, uint32 chunk, tdata_t buffer, tsize_t bufferSize)
+{
+    return isTiled ?
+        TIFFReadEncodedTile(handle, chunk, buffer, bufferSize) :
+        TIFFReadEncodedStrip(handle, chunk, buffer, bufferSize);
+}
+
+KisTIFFParallelDecoder::KisTIFFParallelDecoder(TIFF *image)
+    : m_d(new Private)
+{
+    m_d->image = image;
+    m_d->fileName = TIFFFileName(image);
+    m_d->directory = TIFFCurrentDirectory(image);
+    m_d->isTiled = TIFFIsTiled(image);
+}
+
+KisTIFFParallelDecoder::~KisTIFFParallelDecoder()
+{
+    Q_FOREACH (TIFF *handle, m_d->freeHandles) {
+        TIFFClose(handle);
+    }
+}
+
+bool KisTIFFParallelDecoder::decode(const QVector<uint32> &chunks, const QVector<tdata_t> &buffers, tsize_t bufferSize)
+{
+    KIS_SAFE_ASSERT_RECOVER_RETURN_VALUE(chunks.size() == buffers.size(), false);
+
+    QVector<int> indexes(chunks.size());
+    std::iota(indexes.begin(), indexes.end(), 0);
+
+    QVector<int> failedIndexes;
+    QMutex failedIndexesMutex;
+    QAtomicInt hasErrors;
+
+    QtConcurrent::blockingMap(indexes,
+        [&] (int index) {
+            TIFF *handle = m_d->acquireHandle();
+
+            if (!handle) {
+                QMutexLocker l(&failedIndexesMutex);
+                failedIndexes.append(index);
+                return;
+            }
+
+            if (m_d->decodeChunk(handle, chunks[index], buffers[index], bufferSize) < 0) {
+                hasErrors = 1;
+            }
+
+            m_d->releaseHandle(handle);
+        });
+
+    // fallback for the chunks that got no handle: use the original one
+    Q_FOREACH (int index, failedIndexes) {
+        if (m_d->decodeChunk(m_d->image, chunks[index], buffers[index], bufferSize) < 0) {
+            hasErrors = 1;
+        }
+    }
+
+    return !hasErrors;
+}
@@ -0,0 +1,62 @@
+/*
+ *  Copyright (c) 2020 Krita developers
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef _KIS_TIFF_PARALLEL_DECODER_H_
+#define _KIS_TIFF_PARALLEL_DECODER_H_
+
+// On some platforms, tiffio.h #defines 0 in a bad
+// way for C++, as (void *)0 instead of using the correct
+// C++ value 0. Include stdio.h first to get the right one.
+#include <stdio.h>
+#include <tiffio.h>
+
+#include <QScopedPointer>
+#include <QVector>
+
+/**
+ * Decodes the encoded strips or tiles of the current directory of a TIFF
+ * file in parallel.
+ *
+ * libtiff handles are not thread-safe, so every worker thread gets its own
+ * handle to the same file, switched to the same directory. The handles are
+ * kept in a pool for the lifetime of the decoder. If the file cannot be
+ * reopened, the chunks are decoded sequentially with the original handle.
+ */
+class KisTIFFParallelDecoder
+{
+public:
+    KisTIFFParallelDecoder(TIFF *image);
+    ~KisTIFFParallelDecoder();
+
+    /**
+     * Decodes the strips (or tiles for tiled images) with the indexes
+     * \p chunks into the corresponding \p buffers, which are \p bufferSize
+     * bytes each. The data is converted to the native byte order by
+     * libtiff.
+     *
+     * @return false if any of the chunks could not be decoded
+     */
+    bool decode(const QVector<uint32> &chunks, const QVector<tdata_t> &buffers, tsize_t bufferSize);
+
+private:
+    struct Private;
+    const QScopedPointer<Private> m_d;
+};
+
+#endif
@@ -30,6 +30,28 @@
 #include <KoColorSpaceConstants.h>
 #include <KoColorSpaceTraits.h>
 
+template <typename T>
+void KisTIFFReaderBase::copyAlignedDataImpl(quint32 x, quint32 y, quint32 dataWidth, const quint8 *data,
+                                            T alphaValue, void (KisTIFFPostProcessor::*postProcess)(T*))
+{
+    const T *src = reinterpret_cast<const T*>(data);
+    const int samplesPerPixel = nbColorsSamples() + nbExtraSamples();
+
+    KisHLineIteratorSP it = paintDevice()->createHLineIteratorNG(x, y, dataWidth);
+    do {
+        T *d = reinterpret_cast<T *>(it->rawData());
+        quint8 i;
+        for (i = 0; i < nbColorsSamples(); i++) {
+            d[poses()[i]] = src[i];
+        }
+        (postProcessor()->*postProcess)(d);
+        if (transform()) transform()->transform((quint8*)d, (quint8*)d, 1);
+        d[poses()[i]] = alphaPos() < nbExtraSamples() ? src[nbColorsSamples() + alphaPos()] : alphaValue;
+
+        src += samplesPerPixel;
+    } while (it->nextPixel());
+}
+
 uint KisTIFFReaderTarget8bit::copyDataToChannels(quint32 x, quint32 y, quint32 dataWidth, KisBufferStreamBase* tiffstream)
 {
     KisHLineIteratorSP it = paintDevice()->createHLineIteratorNG(x, y, dataWidth);
@@ -54,6 +76,16 @@ uint KisTIFFReaderTarget8bit::copyDataToChannels(quint32 x, quint32 y, quint32 d
     } while (it->nextPixel());
     return 1;
 }
+bool KisTIFFReaderTarget8bit::supportsAlignedData() const
+{
+    return sourceDepth() == 8;
+}
+
+void KisTIFFReaderTarget8bit::copyAlignedDataToChannels(quint32 x, quint32 y, quint32 dataWidth, const quint8 *data)
+{
+    copyAlignedDataImpl<quint8>(x, y, dataWidth, data, quint8_MAX, &KisTIFFPostProcessor::postProcess8bit);
+}
+
 uint KisTIFFReaderTarget16bit::copyDataToChannels(quint32 x, quint32 y, quint32 dataWidth, KisBufferStreamBase* tiffstream)
 {
     KisHLineIteratorSP it = paintDevice()->createHLineIteratorNG(x, y, dataWidth);
@@ -80,6 +112,16 @@ uint KisTIFFReaderTarget16bit::copyDataToChannels(quint32 x, quint32 y, quint32
     return 1;
 }
 
+bool KisTIFFReaderTarget16bit::supportsAlignedData() const
+{
+    return sourceDepth() == 16;
+}
+
+void KisTIFFReaderTarget16bit::copyAlignedDataToChannels(quint32 x, quint32 y, quint32 dataWidth, const quint8 *data)
+{
+    copyAlignedDataImpl<quint16>(x, y, dataWidth, data, m_alphaValue, &KisTIFFPostProcessor::postProcess16bit);
+}
+
 uint KisTIFFReaderTarget32bit::copyDataToChannels(quint32 x, quint32 y, quint32 dataWidth, KisBufferStreamBase* tiffstream)
 {
     KisHLineIteratorSP it = paintDevice()->createHLineIteratorNG(x, y, dataWidth);
@@ -105,6 +147,16 @@ uint KisTIFFReaderTarget32bit::copyDataToChannels(quint32 x, quint32 y, quint32
     } while (it->nextPixel());
     return 1;
 }
+bool KisTIFFReaderTarget32bit::supportsAlignedData() const
+{
+    return sourceDepth() == 32;
+}
+
+void KisTIFFReaderTarget32bit::copyAlignedDataToChannels(quint32 x, quint32 y, quint32 dataWidth, const quint8 *data)
+{
+    copyAlignedDataImpl<quint32>(x, y, dataWidth, data, m_alphaValue, &KisTIFFPostProcessor::postProcess32bit);
+}
+
 uint KisTIFFReaderFromPalette::copyDataToChannels(quint32 x, quint32 y, quint32 dataWidth,  KisBufferStreamBase* tiffstream)
 {
     KisHLineIteratorSP it = paintDevice()->createHLineIteratorNG(x, y, dataWidth);
@@ -135,6 +135,28 @@ public:
      * @return the number of line which were copied
      */
     virtual uint copyDataToChannels(quint32 x, quint32 y, quint32 dataWidth, KisBufferStreamBase* tiffstream) = 0;
+    /**
+     * @return true if the reader can copy byte-aligned contiguous samples
+     * with copyAlignedDataToChannels(), i.e. when the depth of the source
+     * samples is the same as the depth of the paint device channels
+     */
+    virtual bool supportsAlignedData() const {
+        return false;
+    }
+    /**
+     * Copies one line of contiguous samples of the native byte order
+     * directly, without unpacking them through KisBufferStreamBase.
+     * @param x horizontal start position
+     * @param y vertical start position
+     * @param dataWidth width of the data to copy
+     * @param data the samples of the line
+     */
+    virtual void copyAlignedDataToChannels(quint32 x, quint32 y, quint32 dataWidth, const quint8 *data) {
+        Q_UNUSED(x);
+        Q_UNUSED(y);
+        Q_UNUSED(dataWidth);
+        Q_UNUSED(data);
+    }
     /**
      * This function is called when all data has been read and should be used for any postprocessing.
      */
@@ -149,7 +171,7 @@ protected:
         return m_alphapos;
     }
 
-    inline quint8 sourceDepth() {
+    inline quint8 sourceDepth() const {
         return m_sourceDepth;
     }
     inline uint16 sampleFormat() {
@@ -176,6 +198,10 @@ protected:
         return m_postprocess;
     }
 
+    template <typename T>
+    void copyAlignedDataImpl(quint32 x, quint32 y, quint32 dataWidth, const quint8 *data,
+                             T alphaValue, void (KisTIFFPostProcessor::*postProcess)(T*));
+
 private:
     KisPaintDeviceSP m_device;
     qint8 m_alphapos;
@@ -197,6 +223,8 @@ public:
     }
 public:
     uint copyDataToChannels(quint32 x, quint32 y, quint32 dataWidth, KisBufferStreamBase* tiffstream) override;
+    bool supportsAlignedData() const override;
+    void copyAlignedDataToChannels(quint32 x, quint32 y, quint32 dataWidth, const quint8 *data) override;
 };
 
 
@@ -210,6 +238,8 @@ public:
     }
 public:
     uint copyDataToChannels(quint32 x, quint32 y, quint32 dataWidth, KisBufferStreamBase* tiffstream) override ;
+    bool supportsAlignedData() const override;
+    void copyAlignedDataToChannels(quint32 x, quint32 y, quint32 dataWidth, const quint8 *data) override;
 private:
     uint16 m_alphaValue;
 };
@@ -224,6 +254,8 @@ public:
     }
 public:
     uint copyDataToChannels(quint32 x, quint32 y, quint32 dataWidth, KisBufferStreamBase* tiffstream) override ;
+    bool supportsAlignedData() const override;
+    void copyAlignedDataToChannels(quint32 x, quint32 y, quint32 dataWidth, const quint8 *data) override;
 private:
     uint32 m_alphaValue;
 };
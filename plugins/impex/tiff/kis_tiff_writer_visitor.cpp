@@ -29,6 +29,14 @@
 #include <half.h>
 #endif
 
+#include "config_tiff.h"
+#ifdef HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+#include <QThread>
+#include <QtConcurrent>
+
 namespace
 {
     bool isBitDepthFloat(QString depth) {
@@ -101,6 +109,34 @@ namespace
         }
 
     }
+
+    bool canEncodeStripsInParallel(const KisTIFFOptions *options)
+    {
+        if (options->compressionType == COMPRESSION_NONE) {
+            return true;
+        }
+
+#ifdef HAVE_ZLIB
+        if ((options->compressionType == COMPRESSION_DEFLATE ||
+             options->compressionType == COMPRESSION_ADOBE_DEFLATE) &&
+            (options->predictor == PREDICTOR_NONE ||
+             options->predictor == PREDICTOR_HORIZONTAL)) {
+
+            return true;
+        }
+#endif
+
+        return false;
+    }
+
+    template <typename T>
+    void applyHorizontalPredictor(quint8 *line, int width, int samplesPerPixel)
+    {
+        T *data = reinterpret_cast<T*>(line);
+        for (int i = width * samplesPerPixel - 1; i >= samplesPerPixel; i--) {
+            data[i] -= data[i - samplesPerPixel];
+        }
+    }
 }
 
 KisTIFFWriterVisitor::KisTIFFWriterVisitor(TIFF*image, KisTIFFOptions* options)
@@ -174,6 +210,92 @@ bool KisTIFFWriterVisitor::copyDataToStrips(KisHLineConstIteratorSP it, tdata_t
     return false;
 }
 
+bool KisTIFFWriterVisitor::encodeStrip(KisPaintDeviceSP dev, EncodedStrip &strip, int width, uint8 depth, uint16 sample_format, uint8 nbcolorssamples, quint8* poses)
+{
+    const int samplesPerPixel = nbcolorssamples + (m_options->alpha ? 1 : 0);
+    const int scanLineSize = width * samplesPerPixel * depth / 8;
+
+    QByteArray data(scanLineSize * strip.numRows, 0);
+
+    for (int row = 0; row < strip.numRows; row++) {
+        KisHLineConstIteratorSP it = dev->createHLineConstIteratorNG(0, strip.firstRow + row, width);
+        quint8 *line = reinterpret_cast<quint8*>(data.data()) + row * scanLineSize;
+
+        if (!copyDataToStrips(it, line, depth, sample_format, nbcolorssamples, poses)) {
+            return false;
+        }
+
+        if (m_options->compressionType != COMPRESSION_NONE &&
+            m_options->predictor == PREDICTOR_HORIZONTAL) {
+
+            if (depth == 32) {
+                applyHorizontalPredictor<quint32>(line, width, samplesPerPixel);
+            } else if (depth == 16) {
+                applyHorizontalPredictor<quint16>(line, width, samplesPerPixel);
+            } else {
+                applyHorizontalPredictor<quint8>(line, width, samplesPerPixel);
+            }
+        }
+    }
+
+    if (m_options->compressionType == COMPRESSION_NONE) {
+        strip.data = data;
+        return true;
+    }
+
+#ifdef HAVE_ZLIB
+    uLongf compressedSize = compressBound(data.size());
+    strip.data.resize(compressedSize);
+
+    if (compress2(reinterpret_cast<Bytef*>(strip.data.data()), &compressedSize,
+                  reinterpret_cast<const Bytef*>(data.constData()), data.size(),
+                  m_options->deflateCompress) != Z_OK) {
+        return false;
+    }
+
+    strip.data.resize(compressedSize);
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool KisTIFFWriterVisitor::writeStripsInParallel(KisPaintDeviceSP dev, int width, int height, int rowsPerStrip, uint8 depth, uint16 sample_format, uint8 nbcolorssamples, quint8* poses)
+{
+    const int batchSize = qMax(1, 2 * QThread::idealThreadCount());
+
+    for (int batchStart = 0; batchStart < height; batchStart += batchSize * rowsPerStrip) {
+        QVector<EncodedStrip> strips;
+
+        for (int y = batchStart; y < height && strips.size() < batchSize; y += rowsPerStrip) {
+            EncodedStrip strip;
+            strip.firstRow = y;
+            strip.numRows = qMin(rowsPerStrip, height - y);
+            strips << strip;
+        }
+
+        QAtomicInt hasErrors;
+
+        QtConcurrent::blockingMap(strips,
+            [&] (EncodedStrip &strip) {
+                if (!encodeStrip(dev, strip, width, depth, sample_format, nbcolorssamples, poses)) {
+                    hasErrors = 1;
+                }
+            });
+
+        if (hasErrors) return false;
+
+        Q_FOREACH (const EncodedStrip &strip, strips) {
+            const tstrip_t stripIndex = TIFFComputeStrip(image(), strip.firstRow, 0);
+            if (TIFFWriteRawStrip(image(), stripIndex, const_cast<char*>(strip.data.constData()), strip.data.size()) < 0) {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
 bool KisTIFFWriterVisitor::saveLayerProjection(KisLayer *layer)
 {
     dbgFile << "visiting on layer" << layer->name() << "";
@@ -221,8 +343,22 @@ bool KisTIFFWriterVisitor::saveLayerProjection(KisLayer *layer)
 
     // Use contiguous configuration
     TIFFSetField(image(), TIFFTAG_PLANARCONFIG, PLANARCONFIG_CONTIG);
-    // Use 8 rows per strip
-    TIFFSetField(image(), TIFFTAG_ROWSPERSTRIP, 8);
+
+    qint32 height = layer->image()->height();
+    qint32 width = layer->image()->width();
+
+    /**
+     * Uncompressed and deflated strips are encoded by ourselves in
+     * parallel and written as raw strips, so they are made bigger
+     * (about 256 KiB) to give each thread enough work. Other compressions
+     * go through libtiff's own encoder with 8 rows per strip.
+     */
+    const bool encodeInParallel = canEncodeStripsInParallel(m_options);
+    const int samplesPerPixel = m_options->alpha ? pd->channelCount() : pd->channelCount() - 1;
+    const int scanLineSize = qMax(1, width * samplesPerPixel * depth / 8);
+    const int rowsPerStrip = encodeInParallel ? qBound(1, 256 * 1024 / scanLineSize, qMax(1, height)) : 8;
+
+    TIFFSetField(image(), TIFFTAG_ROWSPERSTRIP, rowsPerStrip);
 
     // Save profile
     if (m_options->saveProfile) {
@@ -232,42 +368,52 @@ bool KisTIFFWriterVisitor::saveLayerProjection(KisLayer *layer)
             TIFFSetField(image(), TIFFTAG_ICCPROFILE, ba.size(), ba.constData());
         }
     }
+    quint8 poses[5];
+    uint8 nbcolorssamples = 0;
+
+    switch (color_type) {
+    case PHOTOMETRIC_MINISBLACK:
+        poses[0] = 0; poses[1] = 1;
+        nbcolorssamples = 1;
+        break;
+    case PHOTOMETRIC_RGB:
+        if (sample_format == SAMPLEFORMAT_IEEEFP) {
+            poses[2] = 2; poses[1] = 1; poses[0] = 0; poses[3] = 3;
+        } else {
+            poses[0] = 2; poses[1] = 1; poses[2] = 0; poses[3] = 3;
+        }
+        nbcolorssamples = 3;
+        break;
+    case PHOTOMETRIC_SEPARATED:
+        poses[0] = 0; poses[1] = 1; poses[2] = 2; poses[3] = 3; poses[4] = 4;
+        nbcolorssamples = 4;
+        break;
+    case PHOTOMETRIC_ICCLAB:
+        poses[0] = 0; poses[1] = 1; poses[2] = 2; poses[3] = 3;
+        nbcolorssamples = 3;
+        break;
+    default:
+        return false;
+    }
+
+    if (encodeInParallel) {
+        if (!writeStripsInParallel(pd, width, height, rowsPerStrip, depth, sample_format, nbcolorssamples, poses)) {
+            return false;
+        }
+        TIFFWriteDirectory(image());
+        return true;
+    }
+
     tsize_t stripsize = TIFFStripSize(image());
     tdata_t buff = _TIFFmalloc(stripsize);
-    qint32 height = layer->image()->height();
-    qint32 width = layer->image()->width();
     bool r = true;
     for (int y = 0; y < height; y++) {
         KisHLineConstIteratorSP it = pd->createHLineConstIteratorNG(0, y, width);
-        switch (color_type) {
-        case PHOTOMETRIC_MINISBLACK: {
-                quint8 poses[] = { 0, 1 };
-                r = copyDataToStrips(it, buff, depth, sample_format, 1, poses);
-            }
-            break;
-        case PHOTOMETRIC_RGB: {
-                quint8 poses[4];
-                if (sample_format == SAMPLEFORMAT_IEEEFP) {
-                    poses[2] = 2; poses[1] = 1; poses[0] = 0; poses[3] = 3;
-                } else {
-                    poses[0] = 2; poses[1] = 1; poses[2] = 0; poses[3] = 3;
-                }
-                r = copyDataToStrips(it, buff, depth, sample_format, 3, poses);
-            }
-            break;
-        case PHOTOMETRIC_SEPARATED: {
-                quint8 poses[] = { 0, 1, 2, 3, 4 };
-                r = copyDataToStrips(it, buff, depth, sample_format, 4, poses);
-            }
-            break;
-        case PHOTOMETRIC_ICCLAB: {
-                quint8 poses[] = { 0, 1, 2, 3 };
-                r = copyDataToStrips(it, buff, depth, sample_format, 3, poses);
-            }
-            break;
+        r = copyDataToStrips(it, buff, depth, sample_format, nbcolorssamples, poses);
+        if (!r) {
+            _TIFFfree(buff);
             return false;
         }
-        if (!r) return false;
         TIFFWriteScanline(image(), buff, y, (tsample_t) - 1);
     }
     _TIFFfree(buff);
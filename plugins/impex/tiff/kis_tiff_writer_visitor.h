@@ -110,6 +110,20 @@ private:
         return m_image;
     }
     bool copyDataToStrips(KisHLineConstIteratorSP it, tdata_t buff, uint8 depth, uint16 sample_format, uint8 nbcolorssamples, quint8* poses);
+
+    struct EncodedStrip {
+        int firstRow = 0;
+        int numRows = 0;
+        QByteArray data;
+    };
+
+    /**
+     * Fills the strip with the pixels of \p dev and compresses it the
+     * same way libtiff would do for the current compression and predictor.
+     * It doesn't touch the TIFF handle, so it can be called concurrently.
+     */
+    bool encodeStrip(KisPaintDeviceSP dev, EncodedStrip &strip, int width, uint8 depth, uint16 sample_format, uint8 nbcolorssamples, quint8* poses);
+    bool writeStripsInParallel(KisPaintDeviceSP dev, int width, int height, int rowsPerStrip, uint8 depth, uint16 sample_format, uint8 nbcolorssamples, quint8* poses);
     bool saveLayerProjection(KisLayer *);
 private:
     TIFF* m_image;
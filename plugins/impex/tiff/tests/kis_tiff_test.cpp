@@ -30,6 +30,15 @@
 #include "kisexiv2/kis_exiv2.h"
 #include  <sdk/tests/kistest.h>
 #include <KoColorModelStandardIdsUtils.h>
+#include <KoBgrColorSpaceTraits.h>
+
+#include <KisDocument.h>
+#include <KisPart.h>
+#include <kis_image.h>
+#include <kis_paint_layer.h>
+#include <kis_sequential_iterator.h>
+
+#include "../kis_tiff_converter.h"
 
 #ifndef FILES_DATA_DIR
 #error "FILES_DATA_DIR not set. A directory with the data used for testing the importing of files in krita"
@@ -38,6 +47,157 @@
 
 const QString TiffMimetype = "image/tiff";
 
+namespace {
+
+/**
+ * A pattern with large jumps between the neighbouring samples, so that
+ * the differences of the horizontal predictor wrap around
+ */
+template <typename T>
+T patternValue(int x, int y, int channel)
+{
+    const quint32 value = (quint32(x) * 7919u + quint32(y) * 104729u + quint32(channel) * 1299709u) * 2654435761u;
+    return T(value >> 13);
+}
+
+template <>
+float patternValue<float>(int x, int y, int channel)
+{
+    return float((x * 37 + y * 91 + channel * 53) % 1009) / 1009.0f;
+}
+
+template <typename T>
+void fillPattern(KisPaintDeviceSP dev, const QRect &rc)
+{
+    const int channelCount = dev->channelCount();
+
+    KisSequentialIterator it(dev, rc);
+    while (it.nextPixel()) {
+        T *pixel = reinterpret_cast<T*>(it.rawData());
+        for (int i = 0; i < channelCount; i++) {
+            pixel[i] = patternValue<T>(it.x(), it.y(), i);
+        }
+    }
+}
+
+bool sameBytes(KisPaintDeviceSP dev1, KisPaintDeviceSP dev2, const QRect &rc)
+{
+    if (dev1->colorSpace()->id() != dev2->colorSpace()->id()) {
+        qDebug() << "Color spaces differ:" << dev1->colorSpace()->id() << dev2->colorSpace()->id();
+        return false;
+    }
+
+    const int bufferSize = rc.width() * rc.height() * dev1->pixelSize();
+    QVector<quint8> bytes1(bufferSize);
+    QVector<quint8> bytes2(bufferSize);
+
+    dev1->readBytes(bytes1.data(), rc);
+    dev2->readBytes(bytes2.data(), rc);
+
+    return bytes1 == bytes2;
+}
+
+/**
+ * Writes an RGBA image with the pattern, deflated with the horizontal
+ * predictor, in the tiled or planar layouts the writer of Krita doesn't
+ * produce itself
+ */
+template <typename T>
+bool writePatternTiff(const QString &fileName, int width, int height, bool tiled, bool planar)
+{
+    const int samplesPerPixel = 4;
+    const int planes = planar ? samplesPerPixel : 1;
+    const int samplesPerChunkPixel = planar ? 1 : samplesPerPixel;
+
+    TIFF *image = TIFFOpen(QFile::encodeName(fileName), "w");
+    if (!image) return false;
+
+    uint16 sampleinfo[1] = { EXTRASAMPLE_UNASSALPHA };
+
+    TIFFSetField(image, TIFFTAG_IMAGEWIDTH, width);
+    TIFFSetField(image, TIFFTAG_IMAGELENGTH, height);
+    TIFFSetField(image, TIFFTAG_BITSPERSAMPLE, int(sizeof(T) * 8));
+    TIFFSetField(image, TIFFTAG_SAMPLESPERPIXEL, samplesPerPixel);
+    TIFFSetField(image, TIFFTAG_EXTRASAMPLES, 1, sampleinfo);
+    TIFFSetField(image, TIFFTAG_PHOTOMETRIC, PHOTOMETRIC_RGB);
+    TIFFSetField(image, TIFFTAG_SAMPLEFORMAT, SAMPLEFORMAT_UINT);
+    TIFFSetField(image, TIFFTAG_PLANARCONFIG, planar ? PLANARCONFIG_SEPARATE : PLANARCONFIG_CONTIG);
+    TIFFSetField(image, TIFFTAG_COMPRESSION, COMPRESSION_DEFLATE);
+    TIFFSetField(image, TIFFTAG_PREDICTOR, PREDICTOR_HORIZONTAL);
+
+    // small chunks, so that every layout is split into several batches
+    const int chunkWidth = tiled ? 16 : width;
+    const int chunkHeight = tiled ? 16 : 3;
+
+    if (tiled) {
+        TIFFSetField(image, TIFFTAG_TILEWIDTH, chunkWidth);
+        TIFFSetField(image, TIFFTAG_TILELENGTH, chunkHeight);
+    } else {
+        TIFFSetField(image, TIFFTAG_ROWSPERSTRIP, chunkHeight);
+    }
+
+    bool result = true;
+    QVector<T> buffer(chunkWidth * chunkHeight * samplesPerChunkPixel);
+
+    for (int plane = 0; plane < planes && result; plane++) {
+        for (int chunkY = 0; chunkY < height && result; chunkY += chunkHeight) {
+            for (int chunkX = 0; chunkX < width && result; chunkX += chunkWidth) {
+                const int rows = tiled ? chunkHeight : qMin(chunkHeight, height - chunkY);
+
+                buffer.fill(0);
+                for (int y = 0; y < rows && chunkY + y < height; y++) {
+                    for (int x = 0; x < chunkWidth && chunkX + x < width; x++) {
+                        for (int i = 0; i < samplesPerChunkPixel; i++) {
+                            const int channel = planar ? plane : i;
+                            buffer[(y * chunkWidth + x) * samplesPerChunkPixel + i] =
+                                patternValue<T>(chunkX + x, chunkY + y, channel);
+                        }
+                    }
+                }
+
+                const tsize_t size = rows * chunkWidth * samplesPerChunkPixel * sizeof(T);
+
+                if (tiled) {
+                    result = TIFFWriteEncodedTile(image, TIFFComputeTile(image, chunkX, chunkY, 0, plane), buffer.data(), size) >= 0;
+                } else {
+                    result = TIFFWriteEncodedStrip(image, TIFFComputeStrip(image, chunkY, plane), buffer.data(), size) >= 0;
+                }
+            }
+        }
+    }
+
+    TIFFClose(image);
+    return result;
+}
+
+/**
+ * Checks the imported pixels against the pattern written by
+ * writePatternTiff(). Krita stores integer RGBA as BGRA.
+ */
+template <typename T>
+bool hasPattern(KisPaintDeviceSP dev, const QRect &rc)
+{
+    typedef typename KoBgrTraits<T>::Pixel Pixel;
+
+    KisSequentialConstIterator it(dev, rc);
+    while (it.nextPixel()) {
+        const Pixel *pixel = reinterpret_cast<const Pixel*>(it.rawDataConst());
+
+        if (pixel->red != patternValue<T>(it.x(), it.y(), 0) ||
+            pixel->green != patternValue<T>(it.x(), it.y(), 1) ||
+            pixel->blue != patternValue<T>(it.x(), it.y(), 2) ||
+            pixel->alpha != patternValue<T>(it.x(), it.y(), 3)) {
+
+            qDebug() << "Wrong pixel at" << it.x() << it.y();
+            return false;
+        }
+    }
+
+    return true;
+}
+
+}
+
 void KisTiffTest::testFiles()
 {
     // XXX: make the exiv io backends real plugins
@@ -197,6 +357,140 @@ void KisTiffTest::testImportIncorrectFormat()
 }
 
 
+void KisTiffTest::testRoundTripDeflatePredictor_data()
+{
+    QTest::addColumn<QString>("colorDepthId");
+
+    QTest::newRow("u8") << Integer8BitsColorDepthID.id();
+    QTest::newRow("u16") << Integer16BitsColorDepthID.id();
+    QTest::newRow("f32") << Float32BitsColorDepthID.id();
+}
+
+void KisTiffTest::testRoundTripDeflatePredictor()
+{
+    QFETCH(QString, colorDepthId);
+
+    /**
+     * The options are passed to the converter directly, because the
+     * export filter replaces the horizontal predictor with the floating
+     * point one for the float color spaces
+     */
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->colorSpace(RGBAColorModelID.id(), colorDepthId, 0);
+    QVERIFY(cs);
+
+    // an odd width, and enough rows for several strips
+    const QRect rc(0, 0, 1001, 157);
+
+    KisImageSP image = new KisImage(0, rc.width(), rc.height(), cs, "tiff predictor test");
+    KisPaintLayerSP layer = new KisPaintLayer(image, "layer", OPACITY_OPAQUE_U8);
+
+    if (colorDepthId == Integer8BitsColorDepthID.id()) {
+        fillPattern<quint8>(layer->paintDevice(), rc);
+    } else if (colorDepthId == Integer16BitsColorDepthID.id()) {
+        fillPattern<quint16>(layer->paintDevice(), rc);
+    } else {
+        fillPattern<float>(layer->paintDevice(), rc);
+    }
+
+    image->addNode(layer, image->root());
+
+    const QString fileName = QString("test_tiff_predictor_%1.tif").arg(colorDepthId);
+    QFile::remove(fileName);
+
+    KisTIFFOptions options;
+    options.compressionType = COMPRESSION_DEFLATE;
+    options.predictor = PREDICTOR_HORIZONTAL;
+
+    QScopedPointer<KisDocument> doc(KisPart::instance()->createDocument());
+
+    {
+        KisTIFFConverter converter(doc.data());
+        QVERIFY(converter.buildFile(fileName, image, options).isOk());
+    }
+
+    {
+        TIFF *tiff = TIFFOpen(QFile::encodeName(fileName), "r");
+        QVERIFY(tiff);
+
+        uint16 compression = 0;
+        uint16 predictor = 0;
+        TIFFGetField(tiff, TIFFTAG_COMPRESSION, &compression);
+        TIFFGetField(tiff, TIFFTAG_PREDICTOR, &predictor);
+        const uint32 numberOfStrips = TIFFNumberOfStrips(tiff);
+        TIFFClose(tiff);
+
+        QCOMPARE(compression, uint16(COMPRESSION_DEFLATE));
+        QCOMPARE(predictor, uint16(PREDICTOR_HORIZONTAL));
+        QVERIFY(numberOfStrips > 1);
+    }
+
+    QScopedPointer<KisDocument> doc2(KisPart::instance()->createDocument());
+
+    KisTIFFConverter converter(doc2.data());
+    QVERIFY(converter.buildImage(fileName).isOk());
+    QVERIFY(converter.image());
+
+    KisNodeSP node = converter.image()->root()->firstChild();
+    QVERIFY(node);
+
+    QVERIFY(sameBytes(layer->paintDevice(), node->paintDevice(), rc));
+}
+
+void KisTiffTest::testImportChunkLayouts_data()
+{
+    QTest::addColumn<int>("depth");
+    QTest::addColumn<bool>("tiled");
+    QTest::addColumn<bool>("planar");
+
+    QTest::newRow("tiled-contig-8") << 8 << true << false;
+    QTest::newRow("tiled-contig-16") << 16 << true << false;
+    QTest::newRow("tiled-planar-8") << 8 << true << true;
+    QTest::newRow("tiled-planar-16") << 16 << true << true;
+    QTest::newRow("strips-planar-8") << 8 << false << true;
+    QTest::newRow("strips-planar-16") << 16 << false << true;
+}
+
+void KisTiffTest::testImportChunkLayouts()
+{
+    QFETCH(int, depth);
+    QFETCH(bool, tiled);
+    QFETCH(bool, planar);
+
+    // neither of the sizes is a multiple of the tile size
+    const QRect rc(0, 0, 75, 45);
+
+    const QString fileName = QString("test_tiff_layout_%1.tif").arg(QTest::currentDataTag());
+    QFile::remove(fileName);
+
+    if (depth == 8) {
+        QVERIFY(writePatternTiff<quint8>(fileName, rc.width(), rc.height(), tiled, planar));
+    } else {
+        QVERIFY(writePatternTiff<quint16>(fileName, rc.width(), rc.height(), tiled, planar));
+    }
+
+    // the converter decodes the chunks with KisTIFFParallelDecoder
+    QScopedPointer<KisDocument> doc(KisPart::instance()->createDocument());
+
+    KisTIFFConverter converter(doc.data());
+    QVERIFY(converter.buildImage(fileName).isOk());
+    QVERIFY(converter.image());
+    QCOMPARE(converter.image()->bounds(), rc);
+
+    KisNodeSP node = converter.image()->root()->firstChild();
+    QVERIFY(node);
+
+    const KoColorSpace *cs = node->paintDevice()->colorSpace();
+    QCOMPARE(cs->colorModelId().id(), RGBAColorModelID.id());
+
+    if (depth == 8) {
+        QCOMPARE(cs->colorDepthId().id(), Integer8BitsColorDepthID.id());
+        QVERIFY(hasPattern<quint8>(node->paintDevice(), rc));
+    } else {
+        QCOMPARE(cs->colorDepthId().id(), Integer16BitsColorDepthID.id());
+        QVERIFY(hasPattern<quint16>(node->paintDevice(), rc));
+    }
+}
+
 
 KISTEST_MAIN(KisTiffTest)
 
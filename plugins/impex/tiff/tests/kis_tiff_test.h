@@ -38,6 +38,11 @@ private Q_SLOTS:
     void testImportFromWriteonly();
     void testExportToReadonly();
     void testImportIncorrectFormat();
+
+    void testRoundTripDeflatePredictor_data();
+    void testRoundTripDeflatePredictor();
+    void testImportChunkLayouts_data();
+    void testImportChunkLayouts();
 };
 
 #endif
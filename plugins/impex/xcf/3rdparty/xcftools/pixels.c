@@ -496,7 +496,8 @@ getMaskOrLayerTile(struct tileDimensions *dim, struct xcfTiles *tiles,
         cnum = (c1 > want.r ? want.r : c1) - x ;
 
         {
-          static struct Tile tmptile ;
+          /* not static: tiles of different layers are decoded in parallel */
+          struct Tile tmptile ;
           unsigned dwidth = c1-c0 ;
           unsigned i, j ;
           tmptile.count = (c1-c0)*(l1-l0) ;
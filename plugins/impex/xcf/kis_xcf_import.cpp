@@ -23,6 +23,7 @@
 
 #include <QApplication>
 #include <QFile>
+#include <QtConcurrent>
 #include <qendian.h>
 
 #include <kpluginfactory.h>
@@ -116,6 +117,99 @@ struct Layer {
     KisLayerSP layer;
     int depth;
     KisMaskSP mask;
+    xcfLayer *xcf;
+    bool isRgbA;
+};
+
+bool copyLayerPixels(const Layer &layer)
+{
+    xcfLayer &xcflayer = *layer.xcf;
+
+    const int left = xcflayer.dim.c.l;
+    const int top = xcflayer.dim.c.t;
+
+    for (unsigned int x = 0; x < xcflayer.dim.width; x += TILE_WIDTH) {
+        for (unsigned int y = 0; y < xcflayer.dim.height; y += TILE_HEIGHT) {
+            rect want;
+            want.l = x + left;
+            want.t = y + top;
+            want.b = want.t + TILE_HEIGHT;
+            want.r = want.l + TILE_WIDTH;
+            Tile* tile = getMaskOrLayerTile(&xcflayer.dim, &xcflayer.pixels, want);
+            if (tile == XCF_PTR_EMPTY) {
+                return false;
+            }
+            KisHLineIteratorSP it = layer.layer->paintDevice()->createHLineIteratorNG(x, y, TILE_WIDTH);
+            rgba* data = tile->pixels;
+            for (int v = 0; v < TILE_HEIGHT; ++v) {
+                if (layer.isRgbA) {
+                    // RGB image
+                   do {
+                        KoBgrTraits<quint8>::setRed(it->rawData(), GET_RED(*data));
+                        KoBgrTraits<quint8>::setGreen(it->rawData(), GET_GREEN(*data));
+                        KoBgrTraits<quint8>::setBlue(it->rawData(), GET_BLUE(*data));
+                        KoBgrTraits<quint8>::setOpacity(it->rawData(), quint8(GET_ALPHA(*data)), 1);
+                        ++data;
+                    } while (it->nextPixel());
+                } else {
+                    // Grayscale image
+                    do {
+                        it->rawData()[0] = GET_RED(*data);
+                        it->rawData()[1] = GET_ALPHA(*data);
+                        ++data;
+                    } while (it->nextPixel());
+                }
+                it->nextRow();
+            }
+            freeTile(tile);
+        }
+    }
+
+    return true;
+}
+
+bool copyMaskPixels(const Layer &layer)
+{
+    xcfLayer &xcflayer = *layer.xcf;
+
+    const int left = xcflayer.dim.c.l;
+    const int top = xcflayer.dim.c.t;
+
+    for (unsigned int x = 0; x < xcflayer.dim.width; x += TILE_WIDTH) {
+        for (unsigned int y = 0; y < xcflayer.dim.height; y += TILE_HEIGHT) {
+            rect want;
+            want.l = x + left;
+            want.t = y + top;
+            want.b = want.t + TILE_HEIGHT;
+            want.r = want.l + TILE_WIDTH;
+            Tile* tile = getMaskOrLayerTile(&xcflayer.dim, &xcflayer.mask, want);
+            if (tile == XCF_PTR_EMPTY) {
+                return false;
+            }
+            KisHLineIteratorSP it = layer.mask->paintDevice()->createHLineIteratorNG(x, y, TILE_WIDTH);
+            rgba* data = tile->pixels;
+            for (int v = 0; v < TILE_HEIGHT; ++v) {
+                do {
+                    it->rawData()[0] = GET_ALPHA(*data);
+                    ++data;
+                } while (it->nextPixel());
+                it->nextRow();
+            }
+            freeTile(tile);
+        }
+    }
+
+    return true;
+}
+
+/**
+ * Decoding of the pixels of a layer or of its mask. The jobs are
+ * independent from each other, so they are run in parallel.
+ */
+struct PixelsJob {
+    const Layer *layer;
+    bool isMask;
+    bool result;
 };
 
 KisGroupLayerSP findGroup(const QVector<Layer> &layers, const Layer& layer, int i)
@@ -229,95 +323,64 @@ KisImportExportErrorCode KisXCFImport::convert(KisDocument *document, QIODevice
 
         layer.layer = kisLayer;
         layer.depth = xcflayer.pathLength;
+        layer.xcf = &xcflayer;
+        layer.isRgbA = isRgbA;
 
-        // Copy the data in the image
+        // Read the tile directories
         if ((errorStatus = initLayer(&xcflayer)) != XCF_OK) {
             return ImportExportCodes::FileFormatIncorrect;
         }
 
-        int left = xcflayer.dim.c.l;
-        int top = xcflayer.dim.c.t;
-
-        if (!xcflayer.isGroup) {
-
-            // Copy the data;
-            for (unsigned int x = 0; x < xcflayer.dim.width; x += TILE_WIDTH) {
-                for (unsigned int y = 0; y < xcflayer.dim.height; y += TILE_HEIGHT) {
-                    rect want;
-                    want.l = x + left;
-                    want.t = y + top;
-                    want.b = want.t + TILE_HEIGHT;
-                    want.r = want.l + TILE_WIDTH;
-                    Tile* tile = getMaskOrLayerTile(&xcflayer.dim, &xcflayer.pixels, want);
-                    if (tile == XCF_PTR_EMPTY) {
-                        return ImportExportCodes::FileFormatIncorrect;
-                    }
-                    KisHLineIteratorSP it = kisLayer->paintDevice()->createHLineIteratorNG(x, y, TILE_WIDTH);
-                    rgba* data = tile->pixels;
-                    for (int v = 0; v < TILE_HEIGHT; ++v) {
-                        if (isRgbA) {
-                            // RGB image
-                           do {
-                                KoBgrTraits<quint8>::setRed(it->rawData(), GET_RED(*data));
-                                KoBgrTraits<quint8>::setGreen(it->rawData(), GET_GREEN(*data));
-                                KoBgrTraits<quint8>::setBlue(it->rawData(), GET_BLUE(*data));
-                                KoBgrTraits<quint8>::setOpacity(it->rawData(), quint8(GET_ALPHA(*data)), 1);
-                                ++data;
-                            } while (it->nextPixel());
-                        } else {
-                            // Grayscale image
-                            do {
-                                it->rawData()[0] = GET_RED(*data);
-                                it->rawData()[1] = GET_ALPHA(*data);
-                                ++data;
-                            } while (it->nextPixel());
-                        }
-                        it->nextRow();
-                    }
-                }
-            }
-
-            // Move the layer to its position
-            kisLayer->paintDevice()->setX(left);
-            kisLayer->paintDevice()->setY(top);
-        }
         // Create the mask
         if (xcflayer.hasMask) {
             KisTransparencyMaskSP mask = new KisTransparencyMask();
             layer.mask = mask;
 
             mask->initSelection(kisLayer);
-            for (unsigned int x = 0; x < xcflayer.dim.width; x += TILE_WIDTH) {
-                for (unsigned int y = 0; y < xcflayer.dim.height; y += TILE_HEIGHT) {
-                    rect want;
-                    want.l = x + left;
-                    want.t = y + top;
-                    want.b = want.t + TILE_HEIGHT;
-                    want.r = want.l + TILE_WIDTH;
-                    Tile* tile = getMaskOrLayerTile(&xcflayer.dim, &xcflayer.mask, want);
-                    if (tile == XCF_PTR_EMPTY) {
-                        return ImportExportCodes::FileFormatIncorrect;
-                    }
-                    KisHLineIteratorSP it = mask->paintDevice()->createHLineIteratorNG(x, y, TILE_WIDTH);
-                    rgba* data = tile->pixels;
-                    for (int v = 0; v < TILE_HEIGHT; ++v) {
-                        do {
-                            it->rawData()[0] = GET_ALPHA(*data);
-                            ++data;
-                        } while (it->nextPixel());
-                        it->nextRow();
-                    }
-
-                }
-            }
-            mask->paintDevice()->setX(left);
-            mask->paintDevice()->setY(top);
         }
 
         dbgFile << xcflayer.pixels.tileptrs;
         layers.append(layer);
     }
 
+    // Copy the data in the image
+    QVector<PixelsJob> jobs;
+
+    for (int i = 0; i < layers.size(); ++i) {
+        if (!layers[i].xcf->isGroup) {
+            jobs.append({&layers[i], false, false});
+        }
+        if (layers[i].mask) {
+            jobs.append({&layers[i], true, false});
+        }
+    }
+
+    QtConcurrent::blockingMap(jobs,
+        [] (PixelsJob &job) {
+            job.result = job.isMask ? copyMaskPixels(*job.layer) : copyLayerPixels(*job.layer);
+        });
+
+    Q_FOREACH (const PixelsJob &job, jobs) {
+        if (!job.result) {
+            return ImportExportCodes::FileFormatIncorrect;
+        }
+    }
+
+    // Move the layers to their positions
+    Q_FOREACH (const Layer &layer, layers) {
+        const int left = layer.xcf->dim.c.l;
+        const int top = layer.xcf->dim.c.t;
+
+        if (!layer.xcf->isGroup) {
+            layer.layer->paintDevice()->setX(left);
+            layer.layer->paintDevice()->setY(top);
+        }
+        if (layer.mask) {
+            layer.mask->paintDevice()->setX(left);
+            layer.mask->paintDevice()->setY(top);
+        }
+    }
+
     for (uint i = 0; i <= maxDepth; ++i) {
         addLayers(layers, image, i);
     }
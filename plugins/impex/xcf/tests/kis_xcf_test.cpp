@@ -24,6 +24,9 @@
 
 #include  <sdk/tests/kistest.h>
 
+#include <kis_paint_layer.h>
+#include <kis_transparency_mask.h>
+
 #include "filestest.h"
 
 #ifndef FILES_DATA_DIR
@@ -57,6 +60,69 @@ void KisXCFTest::testImportIncorrectFormat()
     TestUtil::testImportIncorrectFormat(QString(FILES_DATA_DIR), XcfMimetype);
 }
 
+void KisXCFTest::testLayersRoundTrip()
+{
+    const QString sourceFileName = QString(FILES_DATA_DIR) + "/sources/subtract-multiply-masks.xcf";
+    const QString fileName("test_xcf_layers.ora");
+    QFile::remove(fileName);
+
+    const QStringList layerNames({"Background", "New Layer", "New Layer#1"});
+    QMap<QString, QImage> expectedLayers;
+
+    {
+        QScopedPointer<KisDocument> doc(KisPart::instance()->createDocument());
+        KisImportExportManager manager(doc.data());
+        doc->setFileBatchMode(true);
+
+        QVERIFY(manager.importDocument(sourceFileName, QString()).isOk());
+
+        KisImageSP image = doc->image();
+        QVERIFY(image);
+        image->initialRefreshGraph();
+        QCOMPARE(image->root()->childCount(), 3);
+
+        // the layers are decoded in parallel, but added in the file order
+        for (int i = 0; i < layerNames.size(); i++) {
+            KisNodeSP node = image->root()->at(i);
+            QCOMPARE(node->name(), layerNames[i]);
+            QVERIFY(dynamic_cast<KisPaintLayer*>(node.data()));
+
+            // both of the upper layers have masks
+            QCOMPARE(node->childCount(), i > 0 ? 1 : 0);
+            if (i > 0) {
+                KisTransparencyMask *mask = dynamic_cast<KisTransparencyMask*>(node->firstChild().data());
+                QVERIFY(mask);
+                QVERIFY(!mask->paintDevice()->exactBounds().isEmpty());
+            }
+
+            QVERIFY(!node->paintDevice()->exactBounds().isEmpty());
+
+            // OpenRaster has no masks, the layers are saved with the masks applied
+            expectedLayers[node->name()] = node->projection()->convertToQImage(0, image->bounds());
+        }
+
+        QVERIFY(doc->exportDocumentSync(QUrl::fromLocalFile(fileName), "image/openraster"));
+    }
+
+    QScopedPointer<KisDocument> doc(KisPart::instance()->createDocument());
+    KisImportExportManager manager(doc.data());
+    doc->setFileBatchMode(true);
+
+    QVERIFY(manager.importDocument(fileName, QString()).isOk());
+
+    KisImageSP image = doc->image();
+    QVERIFY(image);
+
+    Q_FOREACH (const QString &name, layerNames) {
+        KisNodeSP node = TestUtil::findNode(image->root(), name);
+        QVERIFY2(node, qPrintable(name));
+
+        QPoint pt;
+        if (!TestUtil::compareQImages(pt, expectedLayers[name], node->paintDevice()->convertToQImage(0, image->bounds()))) {
+            QFAIL(QString("Layer %1 differs at %2, %3").arg(name).arg(pt.x()).arg(pt.y()).toLatin1());
+        }
+    }
+}
 
 KISTEST_MAIN(KisXCFTest)
 
@@ -31,6 +31,8 @@ private Q_SLOTS:
     // You can't export to xcf
     /* void testExportToReadonly(); */
     void testImportIncorrectFormat();
+
+    void testLayersRoundTrip();
 };
 
 #endif